@@ -0,0 +1,261 @@
+/**
+ * @file benchmark.c
+ * @brief On-device micro-benchmarks implementation
+ *
+ * Every benchmark is one operation run in batches; each batch is timed with
+ * esp_timer and its per-operation average becomes one sample. Samples are
+ * sorted for the percentiles. The CPU is held at full speed for the whole
+ * run so dynamic frequency scaling does not skew the numbers.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "benchmark.h"
+#include "config_manager.h"
+#include "web_server.h"
+#include "web_assets.h"
+#include "power_manager.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "benchmark";
+
+#ifdef CONFIG_BENCHMARK_ITERATIONS
+#define BENCHMARK_ITERATIONS CONFIG_BENCHMARK_ITERATIONS
+#else
+#define BENCHMARK_ITERATIONS 200
+#endif
+
+// NVS benchmarks write flash; a tenth of the samples is enough for them
+#define BENCHMARK_NVS_ITERATIONS (BENCHMARK_ITERATIONS / 10 > 5 ? BENCHMARK_ITERATIONS / 10 : 5)
+
+// LED brightness values the NVS benchmarks alternate between, both in range
+#define BENCHMARK_BRIGHTNESS_A 128
+#define BENCHMARK_BRIGHTNESS_B 129
+
+// Large enough for the batch document with every health section
+#define BENCHMARK_JSON_BUFFER_SIZE 6144
+
+/**
+ * @brief Benchmarked operation
+ *
+ * @param arg Benchmark argument
+ * @param[out] bytes Output size, if the operation produces output
+ */
+typedef esp_err_t (*benchmark_op_t)(void *arg, size_t *bytes);
+
+/**
+ * @brief Benchmark description
+ */
+typedef struct {
+    const char *name;
+    benchmark_op_t op;
+    void *arg;
+    uint32_t iterations;        ///< Timed samples
+    uint32_t batch;             ///< Operations per sample
+} benchmark_t;
+
+// =============================================================================
+// State
+// =============================================================================
+
+static benchmark_result_t results[BENCHMARK_MAX_RESULTS];
+static size_t result_count = 0;
+static bool results_valid = false;
+
+// Only used by the task running benchmark_run()
+static float samples[BENCHMARK_ITERATIONS];
+static char json_buffer[BENCHMARK_JSON_BUFFER_SIZE];
+static system_config_t bench_config;
+static system_config_t original_config;    ///< Restored after the run
+
+// =============================================================================
+// Operations
+// =============================================================================
+
+static esp_err_t op_config_get_current(void *arg, size_t *bytes)
+{
+    return config_get_current(&bench_config);
+}
+
+static esp_err_t op_config_validate_range(void *arg, size_t *bytes)
+{
+    return config_validate_range(&bench_config);
+}
+
+/**
+ * @brief Change the benchmark config so the next save is not skipped as unchanged
+ */
+static void bench_config_change(void)
+{
+    bench_config.led_brightness = bench_config.led_brightness == BENCHMARK_BRIGHTNESS_A
+                                      ? BENCHMARK_BRIGHTNESS_B : BENCHMARK_BRIGHTNESS_A;
+}
+
+static esp_err_t op_config_save(void *arg, size_t *bytes)
+{
+    bench_config_change();
+    return config_save(&bench_config);
+}
+
+static esp_err_t op_config_save_flush(void *arg, size_t *bytes)
+{
+    bench_config_change();
+    esp_err_t ret = config_save(&bench_config);
+    if (ret == ESP_OK) {
+        ret = config_flush();
+    }
+    return ret;
+}
+
+static esp_err_t op_render_json(void *arg, size_t *bytes)
+{
+    return web_server_render_document((web_server_document_t)(uintptr_t)arg,
+                                      json_buffer, sizeof(json_buffer), bytes);
+}
+
+static esp_err_t op_asset_lookup(void *arg, size_t *bytes)
+{
+    // One lookup per embedded asset plus one that misses
+    for (size_t i = 0; i < web_assets_count; i++) {
+        if (web_assets_find(web_assets[i].path) == NULL) {
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+    return web_assets_find("/missing.html") == NULL ? ESP_OK : ESP_FAIL;
+}
+
+static const benchmark_t benchmarks[] = {
+    { "config_get_current",    op_config_get_current,    NULL, BENCHMARK_ITERATIONS, 10 },
+    { "config_validate_range", op_config_validate_range, NULL, BENCHMARK_ITERATIONS, 10 },
+    { "config_save",           op_config_save,           NULL, BENCHMARK_NVS_ITERATIONS, 1 },
+    { "config_save_flush",     op_config_save_flush,     NULL, BENCHMARK_NVS_ITERATIONS, 1 },
+    { "json_status",  op_render_json, (void *)WEB_SERVER_DOC_STATUS, BENCHMARK_ITERATIONS, 1 },
+    { "json_config",  op_render_json, (void *)WEB_SERVER_DOC_CONFIG, BENCHMARK_ITERATIONS, 1 },
+    { "json_health",  op_render_json, (void *)WEB_SERVER_DOC_HEALTH, BENCHMARK_ITERATIONS, 1 },
+    { "json_batch",   op_render_json, (void *)WEB_SERVER_DOC_BATCH,  BENCHMARK_ITERATIONS, 1 },
+    { "asset_lookup", op_asset_lookup, NULL, BENCHMARK_ITERATIONS, 10 },
+};
+
+_Static_assert(sizeof(benchmarks) / sizeof(benchmarks[0]) <= BENCHMARK_MAX_RESULTS,
+               "BENCHMARK_MAX_RESULTS too small");
+
+// =============================================================================
+// Measurement
+// =============================================================================
+
+static int compare_samples(const void *a, const void *b)
+{
+    float sa = *(const float *)a;
+    float sb = *(const float *)b;
+    return (sa > sb) - (sa < sb);
+}
+
+/**
+ * @brief Run one benchmark and fill its result
+ */
+static esp_err_t run_benchmark(const benchmark_t *bench, benchmark_result_t *result)
+{
+    size_t bytes = 0;
+    uint32_t iterations = bench->iterations < BENCHMARK_ITERATIONS ? bench->iterations : BENCHMARK_ITERATIONS;
+
+    // Warm-up: fills caches and catches failing operations before timing
+    esp_err_t ret = bench->op(bench->arg, &bytes);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "%s failed: %s", bench->name, esp_err_to_name(ret));
+        return ret;
+    }
+
+    double total = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        int64_t start = esp_timer_get_time();
+        for (uint32_t op = 0; op < bench->batch; op++) {
+            bench->op(bench->arg, &bytes);
+        }
+        samples[i] = (float)(esp_timer_get_time() - start) / bench->batch;
+        total += samples[i];
+    }
+    qsort(samples, iterations, sizeof(samples[0]), compare_samples);
+
+    *result = (benchmark_result_t) {
+        .name = bench->name,
+        .iterations = iterations,
+        .mean_us = total / iterations,
+        .p50_us = samples[iterations / 2],
+        .p99_us = samples[(iterations * 99) / 100],
+        .max_us = samples[iterations - 1],
+        .bytes = bytes,
+    };
+    return ESP_OK;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+esp_err_t benchmark_run(void)
+{
+    esp_err_t ret = config_get_current(&original_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    bench_config = original_config;
+
+    ESP_LOGI(TAG, "Running %u benchmarks, %d iterations each",
+             (unsigned)(sizeof(benchmarks) / sizeof(benchmarks[0])), BENCHMARK_ITERATIONS);
+
+    results_valid = false;
+    result_count = 0;
+    power_manager_acquire();
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        benchmark_result_t *result = &results[result_count];
+        esp_err_t bench_ret = run_benchmark(&benchmarks[i], result);
+        if (bench_ret != ESP_OK) {
+            if (ret == ESP_OK) {
+                ret = bench_ret;
+            }
+            continue;
+        }
+        result_count++;
+        ESP_LOGI(TAG, "BENCH %s n=%lu mean_us=%.3f p50_us=%.3f p99_us=%.3f max_us=%.3f bytes=%u",
+                 result->name, (unsigned long)result->iterations, result->mean_us,
+                 result->p50_us, result->p99_us, result->max_us, (unsigned)result->bytes);
+    }
+
+    // The NVS benchmarks changed the LED brightness; put the user's config back
+    esp_err_t restore_ret = config_save(&original_config);
+    if (restore_ret == ESP_OK) {
+        restore_ret = config_flush();
+    }
+    if (restore_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to restore configuration: %s", esp_err_to_name(restore_ret));
+        if (ret == ESP_OK) {
+            ret = restore_ret;
+        }
+    }
+    power_manager_release();
+    results_valid = true;
+
+    ESP_LOGI(TAG, "BENCH heap free_bytes=%lu min_free_bytes=%lu",
+             (unsigned long)esp_get_free_heap_size(), (unsigned long)esp_get_minimum_free_heap_size());
+    ESP_LOGI(TAG, "BENCH done results=%u", (unsigned)result_count);
+    return ret;
+}
+
+esp_err_t benchmark_get_results(const benchmark_result_t **out_results, size_t *count)
+{
+    if (out_results == NULL || count == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!results_valid) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *out_results = results;
+    *count = result_count;
+    return ESP_OK;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file benchmark.h
+ * @brief On-device micro-benchmarks for config_manager and web_server
+ *
+ * Built only with CONFIG_BENCHMARK_ENABLE. app_main then runs
+ * benchmark_run() as a boot stage after configuration and power management
+ * are initialized and before WiFi starts, so neither the radio nor HTTP
+ * traffic disturbs the measurements.
+ *
+ * BENCHMARKS:
+ * - config_get_current, config_validate_range, config_save and
+ *   config_save followed by config_flush (the NVS path)
+ * - JSON serialization of the status, config, health and batch documents
+ * - Static asset lookup (every embedded asset plus a miss)
+ *
+ * Each result is logged as one line that tools/benchmark.py parses and
+ * compares against a stored baseline:
+ *
+ *     BENCH json_status n=200 mean_us=41.250 p50_us=40.000 p99_us=52.000 max_us=60.000 bytes=187
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of benchmarks in one run */
+#define BENCHMARK_MAX_RESULTS 12
+
+/**
+ * @brief Result of one benchmark
+ *
+ * Times are per operation. Fast operations are timed in batches, so the
+ * percentiles are those of the batch averages.
+ */
+typedef struct {
+    const char *name;           ///< Benchmark name as logged
+    uint32_t iterations;        ///< Timed samples
+    double mean_us;             ///< Mean time per operation
+    double p50_us;              ///< Median time per operation
+    double p99_us;              ///< 99th percentile time per operation
+    double max_us;              ///< Slowest sample
+    size_t bytes;               ///< Output size for serialization benchmarks, else 0
+} benchmark_result_t;
+
+/**
+ * @brief Run all benchmarks and log the results
+ *
+ * Blocks for the duration of the run (about a second with the default
+ * iteration count). Usable directly as a boot stage.
+ *
+ * @return ESP_OK, or the first error returned by a benchmarked function
+ */
+esp_err_t benchmark_run(void);
+
+/**
+ * @brief Get the results of the last benchmark_run()
+ *
+ * @param[out] results Result array (valid until the next run)
+ * @param[out] count Number of results
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for NULL arguments,
+ *         ESP_ERR_INVALID_STATE if no run has completed
+ */
+esp_err_t benchmark_get_results(const benchmark_result_t **results, size_t *count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,261 @@
+/**
+ * @file boot_manager.c
+ * @brief Boot orchestrator implementation
+ *
+ * Every stage of a parallel boot runs in its own short-lived task. A stage
+ * task blocks on an event group until the bits of all its dependencies are
+ * set, runs its init function and then sets its own bit. boot_manager_run()
+ * waits for all bits. In sequential mode the same per-stage logic runs in
+ * table order in the calling task.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "boot_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "boot_manager";
+
+#ifdef CONFIG_BOOT_MANAGER_STAGE_STACK_SIZE
+#define BOOT_STAGE_DEFAULT_STACK_SIZE CONFIG_BOOT_MANAGER_STAGE_STACK_SIZE
+#else
+#define BOOT_STAGE_DEFAULT_STACK_SIZE 4096
+#endif
+
+#ifdef CONFIG_BOOT_MANAGER_PARALLEL
+#define BOOT_PARALLEL true
+#else
+#define BOOT_PARALLEL false
+#endif
+
+// =============================================================================
+// State
+// =============================================================================
+
+static const boot_stage_t *boot_stages = NULL;
+static boot_stage_record_t stage_records[BOOT_MANAGER_MAX_STAGES];
+static size_t stage_count = 0;
+
+// One bit per stage, set when the stage has finished in any state
+static StaticEventGroup_t finished_group_buffer;
+static EventGroupHandle_t finished_group = NULL;
+
+static int64_t boot_start_us = 0;
+static int64_t boot_end_us = 0;
+static bool boot_started = false;
+static volatile bool boot_complete = false;
+
+static boot_milestone_t milestones[BOOT_MANAGER_MAX_MILESTONES];
+static volatile size_t milestone_count = 0;
+static portMUX_TYPE milestone_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =============================================================================
+// Stage Execution
+// =============================================================================
+
+/**
+ * @brief Wait for the dependencies of a stage and run it
+ */
+static void run_stage(size_t index)
+{
+    const boot_stage_t *stage = &boot_stages[index];
+    boot_stage_record_t *record = &stage_records[index];
+
+    if (stage->depends_on != 0) {
+        xEventGroupWaitBits(finished_group, stage->depends_on, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    // A stage only runs when everything it depends on succeeded
+    for (size_t dep = 0; dep < index; dep++) {
+        if ((stage->depends_on & BOOT_STAGE_BIT(dep)) &&
+            stage_records[dep].state != BOOT_STAGE_DONE) {
+            ESP_LOGW(TAG, "Skipping stage '%s': dependency '%s' %s", stage->name,
+                     stage_records[dep].name, boot_manager_state_name(stage_records[dep].state));
+            record->start_us = record->end_us = esp_timer_get_time();
+            record->result = ESP_ERR_INVALID_STATE;
+            record->state = BOOT_STAGE_SKIPPED;
+            return;
+        }
+    }
+
+    record->state = BOOT_STAGE_RUNNING;
+    record->start_us = esp_timer_get_time();
+    record->result = stage->init();
+    record->end_us = esp_timer_get_time();
+    record->state = (record->result == ESP_OK) ? BOOT_STAGE_DONE : BOOT_STAGE_FAILED;
+
+    if (record->result != ESP_OK) {
+        ESP_LOGE(TAG, "Stage '%s' failed: %s", stage->name, esp_err_to_name(record->result));
+    }
+}
+
+/**
+ * @brief Task body of one stage in a parallel boot
+ */
+static void stage_task(void *arg)
+{
+    size_t index = (size_t)arg;
+
+    run_stage(index);
+    xEventGroupSetBits(finished_group, BOOT_STAGE_BIT(index));
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Print the boot timeline
+ */
+static void log_timeline(void)
+{
+    ESP_LOGI(TAG, "Boot timeline (%s, %u stages): %lld ms total, finished %lld ms after reset",
+             BOOT_PARALLEL ? "parallel" : "sequential", (unsigned)stage_count,
+             (boot_end_us - boot_start_us) / 1000, boot_end_us / 1000);
+    for (size_t i = 0; i < stage_count; i++) {
+        const boot_stage_record_t *record = &stage_records[i];
+        ESP_LOGI(TAG, "  %-12s start %5lld ms  took %5lld ms  %s",
+                 record->name,
+                 (record->start_us - boot_start_us) / 1000,
+                 (record->end_us - record->start_us) / 1000,
+                 boot_manager_state_name(record->state));
+    }
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+esp_err_t boot_manager_run(const boot_stage_t *stages, size_t count)
+{
+    if (stages == NULL || count == 0 || count > BOOT_MANAGER_MAX_STAGES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (boot_started) {
+        ESP_LOGE(TAG, "Boot table already run");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Only backward dependencies are allowed, which rules out cycles
+    for (size_t i = 0; i < count; i++) {
+        if (stages[i].init == NULL || stages[i].name == NULL ||
+            (stages[i].depends_on & ~(BOOT_STAGE_BIT(i) - 1)) != 0) {
+            ESP_LOGE(TAG, "Invalid boot stage %u (%s)", (unsigned)i,
+                     stages[i].name ? stages[i].name : "unnamed");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    finished_group = xEventGroupCreateStatic(&finished_group_buffer);
+    boot_stages = stages;
+    for (size_t i = 0; i < count; i++) {
+        stage_records[i] = (boot_stage_record_t) {
+            .name = stages[i].name,
+            .state = BOOT_STAGE_PENDING,
+            .result = ESP_OK,
+        };
+    }
+    stage_count = count;
+    boot_started = true;
+    boot_start_us = esp_timer_get_time();
+
+    esp_err_t ret = ESP_OK;
+    if (BOOT_PARALLEL) {
+        UBaseType_t priority = uxTaskPriorityGet(NULL);
+        for (size_t i = 0; i < count; i++) {
+            uint32_t stack_size = stages[i].stack_size ? stages[i].stack_size : BOOT_STAGE_DEFAULT_STACK_SIZE;
+            if (xTaskCreate(stage_task, stages[i].name, stack_size, (void *)i, priority, NULL) != pdPASS) {
+                ESP_LOGE(TAG, "Failed to create task for stage '%s'", stages[i].name);
+                stage_records[i].start_us = stage_records[i].end_us = esp_timer_get_time();
+                stage_records[i].result = ESP_ERR_NO_MEM;
+                stage_records[i].state = BOOT_STAGE_FAILED;
+                xEventGroupSetBits(finished_group, BOOT_STAGE_BIT(i));
+                ret = ESP_ERR_NO_MEM;
+            }
+        }
+        xEventGroupWaitBits(finished_group, BOOT_STAGE_BIT(count) - 1, pdFALSE, pdTRUE, portMAX_DELAY);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            run_stage(i);
+            xEventGroupSetBits(finished_group, BOOT_STAGE_BIT(i));
+        }
+    }
+
+    boot_end_us = esp_timer_get_time();
+    boot_complete = true;
+    log_timeline();
+
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (stage_records[i].state != BOOT_STAGE_DONE) {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+void boot_manager_mark(const char *name)
+{
+    if (name == NULL) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool recorded = false;
+
+    taskENTER_CRITICAL(&milestone_lock);
+    size_t count = milestone_count;
+    bool known = false;
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(milestones[i].name, name) == 0) {
+            known = true;
+            break;
+        }
+    }
+    if (!known && count < BOOT_MANAGER_MAX_MILESTONES) {
+        milestones[count].name = name;
+        milestones[count].at_us = now;
+        // Publish the count last so lock-free readers never see a partial entry
+        milestone_count = count + 1;
+        recorded = true;
+    }
+    taskEXIT_CRITICAL(&milestone_lock);
+
+    if (recorded) {
+        ESP_LOGI(TAG, "Milestone '%s' reached %lld ms after reset", name, now / 1000);
+    }
+}
+
+esp_err_t boot_manager_get_report(boot_report_t *report)
+{
+    if (report == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    report->parallel = BOOT_PARALLEL;
+    report->complete = boot_complete;
+    report->start_us = boot_start_us;
+    report->end_us = boot_complete ? boot_end_us : 0;
+    report->stage_count = stage_count;
+    report->stages = stage_records;
+    report->milestone_count = milestone_count;
+    report->milestones = milestones;
+    return ESP_OK;
+}
+
+const char *boot_manager_state_name(boot_stage_state_t state)
+{
+    switch (state) {
+        case BOOT_STAGE_PENDING: return "pending";
+        case BOOT_STAGE_RUNNING: return "running";
+        case BOOT_STAGE_DONE:    return "done";
+        case BOOT_STAGE_FAILED:  return "failed";
+        case BOOT_STAGE_SKIPPED: return "skipped";
+        default:                 return "unknown";
+    }
+}
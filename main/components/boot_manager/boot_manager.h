@@ -0,0 +1,155 @@
+/**
+ * @file boot_manager.h
+ * @brief Boot orchestrator with dependency-declared init stages and boot timing
+ *
+ * app_main describes its initialization as a table of stages. Each stage names
+ * the earlier stages it depends on; stages whose dependencies are satisfied run
+ * concurrently in their own task, so for example certificate parsing overlaps
+ * with WiFi bring-up instead of waiting for it.
+ *
+ * FEATURES:
+ * - Dependencies declared as a bitmask of earlier stage indices (no cycles possible)
+ * - Concurrent execution (CONFIG_BOOT_MANAGER_PARALLEL) or strictly sequential
+ *   execution in table order for comparison
+ * - Stages depending on a failed stage are skipped, not run
+ * - esp_timer timestamps (time since boot) for every stage and for named
+ *   milestones reached after boot_manager_run() returned, e.g. "httpd_ready"
+ * - Boot timeline printed to the log and exported through boot_manager_get_report()
+ *
+ * THREAD SAFETY:
+ * boot_manager_run() must be called once. boot_manager_mark() and
+ * boot_manager_get_report() may be called from any task at any time.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of stages in one boot table */
+#define BOOT_MANAGER_MAX_STAGES     16
+
+/** Maximum number of distinct milestones recorded by boot_manager_mark() */
+#define BOOT_MANAGER_MAX_MILESTONES 8
+
+/** Dependency bit for the stage at @p index in the boot table */
+#define BOOT_STAGE_BIT(index)       (1UL << (index))
+
+/**
+ * @brief Stage init function
+ * @return ESP_OK on success; any other value marks the stage failed
+ */
+typedef esp_err_t (*boot_stage_fn_t)(void);
+
+/**
+ * @brief Boot stage description
+ */
+typedef struct {
+    const char *name;           ///< Short stage name used in the log and health report
+    boot_stage_fn_t init;       ///< Init function
+    uint32_t depends_on;        ///< BOOT_STAGE_BIT() of every earlier stage this one needs
+    uint32_t stack_size;        ///< Task stack in bytes, 0 for CONFIG_BOOT_MANAGER_STAGE_STACK_SIZE
+} boot_stage_t;
+
+/**
+ * @brief Stage outcome
+ */
+typedef enum {
+    BOOT_STAGE_PENDING = 0,     ///< Not started yet
+    BOOT_STAGE_RUNNING,         ///< Init function is executing
+    BOOT_STAGE_DONE,            ///< Init function returned ESP_OK
+    BOOT_STAGE_FAILED,          ///< Init function returned an error
+    BOOT_STAGE_SKIPPED          ///< Not run because a dependency failed or was skipped
+} boot_stage_state_t;
+
+/**
+ * @brief Timing record of one stage
+ *
+ * Timestamps are esp_timer_get_time() values, i.e. microseconds since boot.
+ */
+typedef struct {
+    const char *name;           ///< Stage name
+    boot_stage_state_t state;   ///< Outcome
+    esp_err_t result;           ///< Return value of the init function
+    int64_t start_us;           ///< Init function entered (dependencies finished)
+    int64_t end_us;             ///< Init function returned (or stage was skipped)
+} boot_stage_record_t;
+
+/**
+ * @brief Named point in time reached during or after boot
+ */
+typedef struct {
+    const char *name;           ///< Milestone name as passed to boot_manager_mark()
+    int64_t at_us;              ///< First time the milestone was reached
+} boot_milestone_t;
+
+/**
+ * @brief Boot timing report
+ */
+typedef struct {
+    bool parallel;              ///< Stages ran concurrently
+    bool complete;              ///< boot_manager_run() has returned
+    int64_t start_us;           ///< boot_manager_run() entered
+    int64_t end_us;             ///< Last stage finished
+    size_t stage_count;         ///< Valid entries in stages
+    const boot_stage_record_t *stages;          ///< Stage records in table order
+    size_t milestone_count;     ///< Valid entries in milestones
+    const boot_milestone_t *milestones;         ///< Milestones in the order they were reached
+} boot_report_t;
+
+/**
+ * @brief Run a boot table and wait until every stage has finished
+ *
+ * Each stage may only depend on stages that appear before it in the table.
+ * The table and the stage names must stay valid for the lifetime of the
+ * application; they are referenced from the report.
+ *
+ * @param stages Stage table
+ * @param count  Number of stages (at most BOOT_MANAGER_MAX_STAGES)
+ * @return
+ *     - ESP_OK if every stage succeeded
+ *     - ESP_FAIL if at least one stage failed or was skipped
+ *     - ESP_ERR_INVALID_ARG for an invalid table (forward or self dependency)
+ *     - ESP_ERR_INVALID_STATE if called more than once
+ *     - ESP_ERR_NO_MEM if a stage task could not be created
+ */
+esp_err_t boot_manager_run(const boot_stage_t *stages, size_t count);
+
+/**
+ * @brief Record the first time a named milestone is reached
+ *
+ * Later calls with the same name are ignored, so this can be called on every
+ * occurrence of an event (e.g. every web server start). @p name must be a
+ * string literal or otherwise outlive the application.
+ *
+ * @param name Milestone name
+ */
+void boot_manager_mark(const char *name);
+
+/**
+ * @brief Get the boot timing report
+ *
+ * The returned pointers reference internal storage that is only appended to.
+ *
+ * @param[out] report Report
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if report is NULL
+ */
+esp_err_t boot_manager_get_report(boot_report_t *report);
+
+/**
+ * @brief Name of a stage state ("pending", "running", "done", "failed", "skipped")
+ */
+const char *boot_manager_state_name(boot_stage_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
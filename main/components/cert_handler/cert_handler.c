@@ -11,10 +11,26 @@
 
 #include "cert_handler.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/error.h"
 #include <string.h>
 
 static const char* TAG = "CERT_HANDLER";
 
+// Server credentials, parsed once by cert_handler_init()
+static mbedtls_x509_crt server_crt;
+static mbedtls_pk_context server_pk;
+static bool credentials_parsed = false;
+
+// Serializes cert_handler_init(), which boot stages and the web server may call concurrently
+static StaticSemaphore_t init_mutex_buffer;
+static SemaphoreHandle_t init_mutex = NULL;
+static portMUX_TYPE init_mutex_lock = portMUX_INITIALIZER_UNLOCKED;
+
 // External references to embedded certificate files
 // These symbols are created by ESP-IDF EMBED_FILES feature
 extern const uint8_t server_crt_start[] asm("_binary_server_crt_start");
@@ -66,8 +82,74 @@ esp_err_t cert_handler_get_ca_cert(const char** cert_data, size_t* cert_len)
     return ESP_OK;
 }
 
-esp_err_t cert_handler_init(void)
+/**
+ * @brief Parse the embedded server certificate and private key
+ */
+static esp_err_t parse_server_credentials(void)
+{
+    mbedtls_x509_crt_init(&server_crt);
+    mbedtls_pk_init(&server_pk);
+
+    int ret = mbedtls_x509_crt_parse(&server_crt, server_crt_start, server_crt_end - server_crt_start);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to parse server certificate: -0x%04x", -ret);
+        mbedtls_x509_crt_free(&server_crt);
+        mbedtls_pk_free(&server_pk);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Key parsing validates RSA keys, which needs a random source for blinding
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctr_drbg);
+    ret = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, NULL, 0);
+    if (ret == 0) {
+        ret = mbedtls_pk_parse_key(&server_pk, server_key_start, server_key_end - server_key_start,
+                                   NULL, 0, mbedtls_ctr_drbg_random, &ctr_drbg);
+    }
+    mbedtls_ctr_drbg_free(&ctr_drbg);
+    mbedtls_entropy_free(&entropy);
+
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to parse server private key: -0x%04x", -ret);
+        mbedtls_x509_crt_free(&server_crt);
+        mbedtls_pk_free(&server_pk);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+#ifdef CONFIG_WEB_SERVER_HTTPS_KEY_ECDSA
+    mbedtls_pk_type_t expected_type = MBEDTLS_PK_ECKEY;
+#else
+    mbedtls_pk_type_t expected_type = MBEDTLS_PK_RSA;
+#endif
+    if (mbedtls_pk_get_type(&server_pk) != expected_type) {
+        ESP_LOGW(TAG, "Server key is %s, configuration expects %s - rebuild to regenerate certificates",
+                 mbedtls_pk_get_name(&server_pk), expected_type == MBEDTLS_PK_RSA ? "RSA" : "EC");
+    }
+
+    credentials_parsed = true;
+    return ESP_OK;
+}
+
+int cert_handler_select_cert(mbedtls_ssl_context *ssl)
+{
+    if (!credentials_parsed) {
+        ESP_LOGE(TAG, "Server credentials not initialized");
+        return MBEDTLS_ERR_SSL_BAD_CONFIG;
+    }
+    return mbedtls_ssl_set_hs_own_cert(ssl, &server_crt, &server_pk);
+}
+
+/**
+ * @brief Verify and parse the embedded certificates (caller holds init_mutex)
+ */
+static esp_err_t cert_handler_init_locked(void)
 {
+    if (credentials_parsed) {
+        return ESP_OK;
+    }
+
     ESP_LOGI(TAG, "Initializing certificate management");
     
     // Verify server certificate is available
@@ -91,14 +173,53 @@ esp_err_t cert_handler_init(void)
         return ESP_ERR_NOT_FOUND;
     }
     
+    esp_err_t ret = parse_server_credentials();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
     ESP_LOGI(TAG, "Certificates initialized successfully");
     ESP_LOGI(TAG, "  Server cert: %zu bytes", server_cert_len);
-    ESP_LOGI(TAG, "  Server key:  %zu bytes", server_key_len);
+    ESP_LOGI(TAG, "  Server key:  %zu bytes (%s %d-bit)", server_key_len,
+             mbedtls_pk_get_name(&server_pk), (int)mbedtls_pk_get_bitlen(&server_pk));
     ESP_LOGI(TAG, "  CA cert:     %zu bytes", ca_cert_len);
     
     return ESP_OK;
 }
 
+esp_err_t cert_handler_init(void)
+{
+    if (credentials_parsed) {
+        return ESP_OK;
+    }
+
+    taskENTER_CRITICAL(&init_mutex_lock);
+    if (init_mutex == NULL) {
+        init_mutex = xSemaphoreCreateMutexStatic(&init_mutex_buffer);
+    }
+    taskEXIT_CRITICAL(&init_mutex_lock);
+
+    // A concurrent caller that lost the race waits here and then finds the credentials parsed
+    xSemaphoreTake(init_mutex, portMAX_DELAY);
+    esp_err_t ret = cert_handler_init_locked();
+    xSemaphoreGive(init_mutex);
+    return ret;
+}
+
+esp_err_t cert_handler_get_key_type(const char** type, size_t* bits)
+{
+    if (type == NULL || bits == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!credentials_parsed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *type = mbedtls_pk_get_name(&server_pk);
+    *bits = mbedtls_pk_get_bitlen(&server_pk);
+    return ESP_OK;
+}
+
 esp_err_t cert_handler_get_info(char* info_buffer, size_t buffer_size)
 {
     if (info_buffer == NULL || buffer_size == 0) {
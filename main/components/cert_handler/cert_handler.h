@@ -4,7 +4,8 @@
  * 
  * This module provides access to embedded SSL certificates generated during
  * the build process. Certificates are automatically generated with 25-year
- * validity for long-term IoT device deployment.
+ * validity for long-term IoT device deployment. The server key is ECDSA P-256
+ * or RSA, selected with CONFIG_WEB_SERVER_HTTPS_KEY_TYPE.
  * 
  * @author ESP32 Distance Project
  * @date 2025
@@ -13,6 +14,7 @@
 #pragma once
 
 #include "esp_err.h"
+#include "mbedtls/ssl.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -58,14 +60,41 @@ esp_err_t cert_handler_get_ca_cert(const char** cert_data, size_t* cert_len);
  * @brief Initialize certificate management
  * 
  * Verifies that all required certificates are available and properly
- * embedded in the firmware. This should be called during system
- * initialization before starting the HTTPS server.
+ * embedded in the firmware, then parses the server certificate and private
+ * key once. TLS handshakes use the parsed objects through
+ * cert_handler_select_cert(), so no connection pays for PEM/ASN.1 parsing.
+ * This should be called during system initialization before starting the
+ * HTTPS server. Calling it again after success is a no-op, and concurrent
+ * callers block until the first one has finished parsing.
  * 
- * @return ESP_OK if all certificates are available,
- *         ESP_ERR_NOT_FOUND if any certificates are missing
+ * @return ESP_OK if all certificates are available and valid,
+ *         ESP_ERR_NOT_FOUND if any certificates are missing,
+ *         ESP_ERR_INVALID_STATE if the server certificate or key cannot be parsed
  */
 esp_err_t cert_handler_init(void);
 
+/**
+ * @brief TLS certificate selection callback for the HTTPS server
+ * 
+ * Installs the server certificate and key parsed by cert_handler_init() on
+ * the handshake. Matches esp_https_server_cert_select_cb, so it can be set
+ * as httpd_ssl_config_t::cert_select_cb.
+ * 
+ * @param ssl TLS context of the handshake in progress
+ * @return 0 on success, an mbedTLS error code otherwise
+ */
+int cert_handler_select_cert(mbedtls_ssl_context *ssl);
+
+/**
+ * @brief Get the type and size of the server key
+ * 
+ * @param[out] type Key algorithm name as reported by mbedTLS ("EC" or "RSA")
+ * @param[out] bits Key size in bits (256 for ECDSA P-256)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if parameters are NULL,
+ *         ESP_ERR_INVALID_STATE if cert_handler_init() has not succeeded
+ */
+esp_err_t cert_handler_get_key_type(const char** type, size_t* bits);
+
 /**
  * @brief Get certificate information for logging
  * 
@@ -17,6 +17,9 @@
 #include "nvs.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <stddef.h>
 #include <string.h>
 
 static const char *TAG = "config_manager";
@@ -31,25 +34,175 @@ static const char *TAG = "config_manager";
 #define NVS_NAMESPACE "esp32_config"
 
 /**
- * @brief NVS key for configuration blob
+ * @brief NVS key of the schema version (configuration layout in NVS)
  */
-#define NVS_CONFIG_KEY "config"
+#define NVS_VERSION_KEY "version"
 
 /**
- * @brief Mutex for thread-safe access to configuration
+ * @brief NVS key of the save counter
+ */
+#define NVS_SAVE_COUNT_KEY "save_count"
+
+/**
+ * @brief NVS key of the version 1 configuration blob (migrated on load)
+ */
+#define NVS_LEGACY_CONFIG_KEY "config"
+
+#define CONFIG_DESC_NUM(member, ctype, nvs, path, scale, min, max, def, bit) \
+    { #member, nvs, path, offsetof(system_config_t, member), sizeof(((system_config_t*)0)->member), \
+      ctype, 0, scale, min, max, def, NULL, bit }
+
+#define CONFIG_DESC_STR(member, nvs, path, flags, def, bit) \
+    { #member, nvs, path, offsetof(system_config_t, member), sizeof(((system_config_t*)0)->member), \
+      CONFIG_TYPE_STRING, flags, 1, 0, 0, 0, def, bit }
+
+/**
+ * @brief Configuration descriptor table (REQ-CFG-3, REQ-CFG-6)
+ *
+ * Single source for defaults, range validation, JSON mapping and NVS layout.
+ * Every field has its own NVS key (schema version 2). A key only exists while
+ * its value differs from the factory default, so a missing key simply means
+ * "default" and new fields need no migration. NVS keys must never be reused
+ * for a different meaning.
+ */
+static const config_descriptor_t config_descriptors[] = {
+    // Template: Distance sensor (example values - customize for your hardware)
+    CONFIG_DESC_NUM(distance_min_mm, CONFIG_TYPE_U16, "dist_min", "distance_sensor.min_distance_cm", 10,
+                    CONFIG_DISTANCE_MIN_MM_MIN, CONFIG_DISTANCE_MIN_MM_MAX, 100, CONFIG_FIELD_DISTANCE_MIN_MM),
+    CONFIG_DESC_NUM(distance_max_mm, CONFIG_TYPE_U16, "dist_max", "distance_sensor.max_distance_cm", 10,
+                    CONFIG_DISTANCE_MAX_MM_MIN, CONFIG_DISTANCE_MAX_MM_MAX, 4000, CONFIG_FIELD_DISTANCE_MAX_MM),
+    CONFIG_DESC_NUM(measurement_interval_ms, CONFIG_TYPE_U16, "meas_int", "distance_sensor.measurement_interval_ms", 1,
+                    CONFIG_MEASUREMENT_INTERVAL_MS_MIN, CONFIG_MEASUREMENT_INTERVAL_MS_MAX, 100,
+                    CONFIG_FIELD_MEASUREMENT_INTERVAL_MS),
+    CONFIG_DESC_NUM(sensor_timeout_ms, CONFIG_TYPE_U32, "sens_tmo", "distance_sensor.sensor_timeout_ms", 1,
+                    CONFIG_SENSOR_TIMEOUT_MS_MIN, CONFIG_SENSOR_TIMEOUT_MS_MAX, 30, CONFIG_FIELD_SENSOR_TIMEOUT_MS),
+    CONFIG_DESC_NUM(temperature_c_x10, CONFIG_TYPE_I16, "temp_x10", "distance_sensor.temperature_c", 10,
+                    CONFIG_TEMPERATURE_C_X10_MIN, CONFIG_TEMPERATURE_C_X10_MAX, 200, CONFIG_FIELD_TEMPERATURE_C_X10),
+    CONFIG_DESC_NUM(smoothing_factor, CONFIG_TYPE_U16, "smoothing", "distance_sensor.smoothing_alpha", 1000,
+                    CONFIG_SMOOTHING_FACTOR_MIN, CONFIG_SMOOTHING_FACTOR_MAX, 300, CONFIG_FIELD_SMOOTHING_FACTOR),
+
+    // Template: LED strip
+    CONFIG_DESC_NUM(led_count, CONFIG_TYPE_U8, "led_count", "led.count", 1,
+                    CONFIG_LED_COUNT_MIN, CONFIG_LED_COUNT_MAX, 30, CONFIG_FIELD_LED_COUNT),
+    CONFIG_DESC_NUM(led_brightness, CONFIG_TYPE_U8, "led_bright", "led.brightness", 1,
+                    CONFIG_LED_BRIGHTNESS_MIN, CONFIG_LED_BRIGHTNESS_MAX, 128, CONFIG_FIELD_LED_BRIGHTNESS),
+
+    // WiFi (empty SSID/password initially for AP mode)
+    CONFIG_DESC_STR(wifi_ssid, "wifi_ssid", "wifi.ssid", 0, "", CONFIG_FIELD_WIFI_SSID),
+    CONFIG_DESC_STR(wifi_password, "wifi_pass", "wifi.password", CONFIG_DESC_SECRET, "", CONFIG_FIELD_WIFI_PASSWORD),
+    CONFIG_DESC_NUM(wifi_ap_channel, CONFIG_TYPE_U8, "ap_channel", "wifi.ap_channel", 1,
+                    CONFIG_WIFI_AP_CHANNEL_MIN, CONFIG_WIFI_AP_CHANNEL_MAX, 1, CONFIG_FIELD_WIFI_AP_CHANNEL),
+    CONFIG_DESC_NUM(wifi_ap_max_conn, CONFIG_TYPE_U8, "ap_max_conn", "wifi.ap_max_conn", 1,
+                    CONFIG_WIFI_AP_MAX_CONN_MIN, CONFIG_WIFI_AP_MAX_CONN_MAX, 4, CONFIG_FIELD_WIFI_AP_MAX_CONN),
+    CONFIG_DESC_NUM(wifi_sta_max_retry, CONFIG_TYPE_U8, "sta_retry", "wifi.sta_max_retry", 1,
+                    CONFIG_WIFI_STA_MAX_RETRY_MIN, CONFIG_WIFI_STA_MAX_RETRY_MAX, 5, CONFIG_FIELD_WIFI_STA_MAX_RETRY),
+    CONFIG_DESC_NUM(wifi_sta_timeout_ms, CONFIG_TYPE_U32, "sta_timeout", "wifi.sta_timeout_ms", 1,
+                    CONFIG_WIFI_STA_TIMEOUT_MS_MIN, CONFIG_WIFI_STA_TIMEOUT_MS_MAX, 10000,
+                    CONFIG_FIELD_WIFI_STA_TIMEOUT_MS),
+};
+
+#define CONFIG_DESCRIPTOR_COUNT (sizeof(config_descriptors) / sizeof(config_descriptors[0]))
+
+/**
+ * @brief Version 1 NVS blob layout (frozen copy used for migration)
+ */
+typedef struct {
+    uint32_t config_version;
+    uint32_t save_count;
+    uint16_t distance_min_mm;
+    uint16_t distance_max_mm;
+    uint16_t measurement_interval_ms;
+    uint32_t sensor_timeout_ms;
+    int16_t temperature_c_x10;
+    uint16_t smoothing_factor;
+    uint8_t led_count;
+    uint8_t led_brightness;
+    char wifi_ssid[33];
+    char wifi_password[65];
+    uint8_t wifi_ap_channel;
+    uint8_t wifi_ap_max_conn;
+    uint8_t wifi_sta_max_retry;
+    uint32_t wifi_sta_timeout_ms;
+} config_v1_blob_t;
+
+/**
+ * @brief Spin attempts before a seqlock reader yields to a preempted writer
+ */
+#define CONFIG_READ_SPIN_LIMIT 16
+
+/**
+ * @brief Mutex serializing configuration writers (in-memory updates)
  */
 static SemaphoreHandle_t config_mutex = NULL;
 
+/**
+ * @brief Mutex serializing NVS writes (taken before config_mutex)
+ */
+static SemaphoreHandle_t persist_mutex = NULL;
+
+/**
+ * @brief Latest configuration passed to config_save() and not yet written
+ * @note Guarded by config_mutex
+ */
+static system_config_t pending_config;
+
+/**
+ * @brief Persistence state reported by config_get_persist_status()
+ * @note Guarded by config_mutex
+ */
+static config_persist_status_t persist_status = { .last_error = ESP_OK };
+
+#ifdef CONFIG_CONFIG_MANAGER_ASYNC_SAVE
+/**
+ * @brief Writer task performing debounced NVS writes
+ */
+static TaskHandle_t writer_task = NULL;
+
+#define CONFIG_WRITER_STACK_SIZE 4096
+#define CONFIG_WRITER_PRIORITY   (tskIDLE_PRIORITY + 1)
+#endif
+
 /**
  * @brief Current runtime configuration
+ *
+ * Published with a seqlock: writers (holding config_mutex) make config_seq odd,
+ * update the structure and make it even again; readers copy without locking
+ * and retry if the sequence was odd or changed during the copy.
  */
 static system_config_t current_config;
 
+/**
+ * @brief Seqlock sequence for current_config (even = stable)
+ */
+static volatile uint32_t config_seq = 0;
+
+/**
+ * @brief Keeps the seqlock write section short and on one core; also guards
+ * the subscriber table
+ */
+static portMUX_TYPE config_seq_lock = portMUX_INITIALIZER_UNLOCKED;
+
 /**
  * @brief Initialization flag
  */
 static bool config_initialized = false;
 
+/**
+ * @brief Change subscription slot
+ */
+typedef struct {
+    bool used;
+    uint32_t field_mask;
+    config_change_cb_t callback;
+    QueueHandle_t queue;
+    void* arg;
+} config_subscriber_t;
+
+/**
+ * @brief Registered change subscriptions (guarded by config_seq_lock)
+ */
+static config_subscriber_t subscribers[CONFIG_MAX_SUBSCRIBERS];
+
 // =============================================================================
 // PRIVATE FUNCTION DECLARATIONS
 // =============================================================================
@@ -67,6 +220,116 @@ static void config_init_defaults(system_config_t* config);
  */
 static esp_err_t config_validate_relationships(const system_config_t* config);
 
+/**
+ * @brief Load configuration from NVS
+ * @param[out] config Configuration to populate
+ * @param[in] allow_reset Perform a factory reset (once) if loading fails
+ * @return ESP_OK on success, error code otherwise
+ */
+static esp_err_t config_load_internal(system_config_t* config, bool allow_reset);
+
+/**
+ * @brief Store a numeric field value without range checking
+ * @param[out] config Configuration to modify
+ * @param[in] desc Field descriptor (numeric type)
+ * @param[in] value Value to store
+ */
+static void config_store_field_value(system_config_t* config, const config_descriptor_t* desc, int32_t value);
+
+/**
+ * @brief Publish a new current configuration to lock-free readers
+ * @param[in] config Configuration to publish
+ * @return Mask of fields that differ from the previous configuration
+ * @note Caller must hold config_mutex once the manager is initialized
+ */
+static uint32_t config_publish(const system_config_t* config);
+
+/**
+ * @brief Compute the mask of fields that differ between two configurations
+ * @param[in] a First configuration
+ * @param[in] b Second configuration
+ * @return Mask of config_field_t bits
+ */
+static uint32_t config_diff(const system_config_t* a, const system_config_t* b);
+
+/**
+ * @brief Notify subscribers of a configuration update
+ * @param[in] changed_fields Fields changed by the update
+ * @param[in] config New configuration
+ * @note Must be called without config_mutex held
+ */
+static void config_notify(uint32_t changed_fields, const system_config_t* config);
+
+/**
+ * @brief Save synchronously, superseding any pending asynchronous save
+ * @param[in] config Validated configuration to persist and publish
+ * @return ESP_OK on success, error code otherwise
+ */
+static esp_err_t config_save_sync(const system_config_t* config);
+
+/**
+ * @brief Write the dirty fields of a configuration to NVS
+ *
+ * Fields whose stored value already matches are not touched; if nothing
+ * differs, no write or commit happens at all.
+ *
+ * @param[in] config Configuration to write
+ * @param[out] save_count Save count of the blob now stored in NVS
+ * @return ESP_OK on success (written or skipped), error code otherwise
+ * @note Caller must hold persist_mutex
+ */
+static esp_err_t config_write_nvs(const system_config_t* config, uint32_t* save_count);
+
+/**
+ * @brief Write the pending configuration, if any, to NVS
+ * @return ESP_OK if nothing was pending or the write succeeded
+ */
+static esp_err_t config_persist_pending(void);
+
+#ifdef CONFIG_CONFIG_MANAGER_ASYNC_SAVE
+/**
+ * @brief Writer task: waits for save requests, debounces and persists them
+ * @param arg Unused
+ */
+static void config_writer_task(void* arg);
+#endif
+
+/**
+ * @brief Read all field keys into a configuration, keeping defaults for missing keys
+ * @param[in] nvs_handle Open NVS handle
+ * @param[out] config Configuration to populate
+ * @return ESP_OK on success, error code for unreadable keys
+ */
+static esp_err_t config_nvs_read(nvs_handle_t nvs_handle, system_config_t* config);
+
+/**
+ * @brief Read one field key
+ * @return ESP_OK, ESP_ERR_NVS_NOT_FOUND if the key does not exist, or error code
+ */
+static esp_err_t config_nvs_read_field(nvs_handle_t nvs_handle, const config_descriptor_t* field,
+                                       system_config_t* config);
+
+/**
+ * @brief Write one field key
+ */
+static esp_err_t config_nvs_write_field(nvs_handle_t nvs_handle, const config_descriptor_t* field,
+                                        const system_config_t* config);
+
+/**
+ * @brief Compare one field of two configurations
+ */
+static bool config_field_equal(const config_descriptor_t* field, const system_config_t* a,
+                               const system_config_t* b);
+
+/**
+ * @brief Migrate a configuration stored in an older NVS layout
+ * @param[in] nvs_handle NVS handle opened read-write
+ * @return ESP_OK if the stored configuration was migrated to the current layout
+ * @return ESP_ERR_NOT_FOUND if there is nothing to migrate
+ * @note Caller must hold persist_mutex
+ */
+static esp_err_t config_nvs_migrate(nvs_handle_t nvs_handle);
+
 // =============================================================================
 // PUBLIC API IMPLEMENTATION
 // =============================================================================
@@ -80,10 +343,19 @@ esp_err_t config_init(void)
 
     ESP_LOGI(TAG, "Initializing configuration management subsystem");
 
-    // Create mutex for thread safety
+    // Create mutexes for thread safety
     config_mutex = xSemaphoreCreateMutex();
-    if (config_mutex == NULL) {
+    persist_mutex = xSemaphoreCreateMutex();
+    if (config_mutex == NULL || persist_mutex == NULL) {
         ESP_LOGE(TAG, "Failed to create configuration mutex");
+        if (config_mutex != NULL) {
+            vSemaphoreDelete(config_mutex);
+            config_mutex = NULL;
+        }
+        if (persist_mutex != NULL) {
+            vSemaphoreDelete(persist_mutex);
+            persist_mutex = NULL;
+        }
         return ESP_ERR_NO_MEM;
     }
 
@@ -98,24 +370,39 @@ esp_err_t config_init(void)
         ESP_LOGE(TAG, "Failed to initialize NVS: %s", esp_err_to_name(ret));
         vSemaphoreDelete(config_mutex);
         config_mutex = NULL;
+        vSemaphoreDelete(persist_mutex);
+        persist_mutex = NULL;
         return ret;
     }
 
     // Load configuration from NVS (will fall back to defaults if not found)
-    ret = config_load(&current_config);
-    if (ret != ESP_OK) {
+    system_config_t loaded_config;
+    ret = config_load(&loaded_config);
+    if (ret == ESP_OK) {
+        config_publish(&loaded_config);
+    } else {
         ESP_LOGW(TAG, "Failed to load initial configuration, using factory defaults: %s", esp_err_to_name(ret));
         // Don't fail initialization - use factory defaults instead
-        config_init_defaults(&current_config);
+        config_init_defaults(&loaded_config);
+        config_publish(&loaded_config);
         
         // Try to save the factory defaults to establish a good NVS state
-        esp_err_t save_ret = config_save(&current_config);
+        esp_err_t save_ret = config_save(&loaded_config);
         if (save_ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to save factory defaults to NVS: %s", esp_err_to_name(save_ret));
             // Continue anyway - we have valid defaults in memory
         }
     }
 
+#ifdef CONFIG_CONFIG_MANAGER_ASYNC_SAVE
+    // Without the writer task config_save() stays synchronous
+    if (xTaskCreate(config_writer_task, "config_writer", CONFIG_WRITER_STACK_SIZE, NULL,
+                    CONFIG_WRITER_PRIORITY, &writer_task) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to create config writer task, saves will be synchronous");
+        writer_task = NULL;
+    }
+#endif
+
     config_initialized = true;
     ESP_LOGI(TAG, "Configuration management initialized successfully");
     ESP_LOGI(TAG, "Configuration version: %lu, save count: %lu", 
@@ -125,36 +412,62 @@ esp_err_t config_init(void)
 }
 
 esp_err_t config_load(system_config_t* config)
+{
+    return config_load_internal(config, true);
+}
+
+static esp_err_t config_load_internal(system_config_t* config, bool allow_reset)
 {
     if (config == NULL) {
         ESP_LOGE(TAG, "Configuration pointer is NULL");
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Take mutex for thread safety
-    if (config_mutex != NULL && xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        ESP_LOGE(TAG, "Failed to acquire configuration mutex");
+    // Take mutex for thread safety (loading may migrate and write NVS)
+    if (persist_mutex != NULL && xSemaphoreTake(persist_mutex, pdMS_TO_TICKS(5000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to acquire persistence mutex");
         return ESP_ERR_TIMEOUT;
     }
 
     ESP_LOGD(TAG, "Loading configuration from NVS");
 
     nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(ret));
         goto factory_reset;
     }
 
-    // Get required size for configuration blob
-    size_t required_size = sizeof(system_config_t);
-    ret = nvs_get_blob(nvs_handle, NVS_CONFIG_KEY, config, &required_size);
-    nvs_close(nvs_handle);
-
+    uint32_t version = 0;
+    ret = nvs_get_u32(nvs_handle, NVS_VERSION_KEY, &version);
     if (ret == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "No configuration found in NVS, using factory defaults");
+        // Older layouts have no version key; convert them in place
+        ret = config_nvs_migrate(nvs_handle);
+        if (ret == ESP_OK) {
+            version = CONFIG_VERSION;
+        } else if (ret == ESP_ERR_NOT_FOUND) {
+            ESP_LOGW(TAG, "No configuration found in NVS, using factory defaults");
+        }
+    }
+    if (ret != ESP_OK) {
+        nvs_close(nvs_handle);
+        if (ret != ESP_ERR_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to read configuration from NVS: %s", esp_err_to_name(ret));
+        }
+        goto factory_reset;
+    }
+
+    // Check configuration version compatibility
+    if (version != CONFIG_VERSION) {
+        nvs_close(nvs_handle);
+        ESP_LOGW(TAG, "Configuration version mismatch (stored: %lu, current: %d)",
+                 version, CONFIG_VERSION);
         goto factory_reset;
-    } else if (ret != ESP_OK) {
+    }
+
+    ret = config_nvs_read(nvs_handle, config);
+    nvs_close(nvs_handle);
+    if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read configuration from NVS: %s", esp_err_to_name(ret));
         goto factory_reset;
     }
@@ -166,30 +479,27 @@ esp_err_t config_load(system_config_t* config)
         goto factory_reset;
     }
 
-    // Check configuration version compatibility
-    if (config->config_version != CONFIG_VERSION) {
-        ESP_LOGW(TAG, "Configuration version mismatch (loaded: %lu, current: %d)", 
-                 config->config_version, CONFIG_VERSION);
-        goto factory_reset;
-    }
-
-    if (config_mutex != NULL) {
-        xSemaphoreGive(config_mutex);
+    if (persist_mutex != NULL) {
+        xSemaphoreGive(persist_mutex);
     }
 
     ESP_LOGI(TAG, "Configuration loaded successfully from NVS");
     return ESP_OK;
 
 factory_reset:
-    if (config_mutex != NULL) {
-        xSemaphoreGive(config_mutex);
+    if (persist_mutex != NULL) {
+        xSemaphoreGive(persist_mutex);
+    }
+    if (!allow_reset) {
+        // Freshly written defaults did not load back - do not loop
+        return (ret != ESP_OK) ? ret : ESP_FAIL;
     }
     
     ESP_LOGW(TAG, "Performing factory reset due to load failure");
     ret = config_factory_reset();
     if (ret == ESP_OK) {
         // Reload the factory defaults
-        return config_load(config);
+        return config_load_internal(config, false);
     }
     return ret;
 }
@@ -208,49 +518,55 @@ esp_err_t config_save(const system_config_t* config)
         return ret;
     }
 
-    // Take mutex for thread safety
-    if (config_mutex != NULL && xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        ESP_LOGE(TAG, "Failed to acquire configuration mutex");
-        return ESP_ERR_TIMEOUT;
-    }
+#ifdef CONFIG_CONFIG_MANAGER_ASYNC_SAVE
+    if (config_initialized && writer_task != NULL) {
+        if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ESP_LOGE(TAG, "Failed to acquire configuration mutex");
+            return ESP_ERR_TIMEOUT;
+        }
 
-    ESP_LOGD(TAG, "Saving configuration to NVS");
+        // Becomes current immediately; the writer task persists it once saves stop
+        pending_config = *config;
+        persist_status.pending = true;
+        uint32_t changed_fields = config_publish(config);
 
-    nvs_handle_t nvs_handle;
-    ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace for write: %s", esp_err_to_name(ret));
-        if (config_mutex != NULL) {
-            xSemaphoreGive(config_mutex);
+        xSemaphoreGive(config_mutex);
+        xTaskNotifyGive(writer_task);
+        ESP_LOGD(TAG, "Configuration save queued");
+
+        if (changed_fields != 0) {
+            config_notify(changed_fields, config);
         }
-        return ret;
+        return ESP_OK;
     }
+#endif
 
-    // Create a copy with updated save count
-    system_config_t config_to_save = *config;
-    config_to_save.save_count++;
+    return config_save_sync(config);
+}
 
-    // Write configuration blob atomically
-    ret = nvs_set_blob(nvs_handle, NVS_CONFIG_KEY, &config_to_save, sizeof(system_config_t));
-    if (ret == ESP_OK) {
-        ret = nvs_commit(nvs_handle);
+esp_err_t config_flush(void)
+{
+    if (!config_initialized) {
+        ESP_LOGE(TAG, "Configuration manager not initialized");
+        return ESP_ERR_INVALID_STATE;
     }
+    return config_persist_pending();
+}
 
-    nvs_close(nvs_handle);
-
-    if (ret == ESP_OK) {
-        // Update current configuration
-        current_config = config_to_save;
-        ESP_LOGI(TAG, "Configuration saved successfully (save count: %lu)", config_to_save.save_count);
-    } else {
-        ESP_LOGE(TAG, "Failed to save configuration to NVS: %s", esp_err_to_name(ret));
+esp_err_t config_get_persist_status(config_persist_status_t* status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
-
-    if (config_mutex != NULL) {
-        xSemaphoreGive(config_mutex);
+    if (!config_initialized) {
+        return ESP_ERR_INVALID_STATE;
     }
-
-    return ret;
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    *status = persist_status;
+    xSemaphoreGive(config_mutex);
+    return ESP_OK;
 }
 
 esp_err_t config_validate_range(const system_config_t* config)
@@ -262,67 +578,18 @@ esp_err_t config_validate_range(const system_config_t* config)
 
     ESP_LOGD(TAG, "Validating configuration parameters");
 
-    // Distance sensor parameters
-    if (!config_is_valid_int_range("distance_min_mm", config->distance_min_mm, 
-                               CONFIG_DISTANCE_MIN_MM_MIN, CONFIG_DISTANCE_MIN_MM_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("distance_max_mm", config->distance_max_mm,
-                               CONFIG_DISTANCE_MAX_MM_MIN, CONFIG_DISTANCE_MAX_MM_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("measurement_interval_ms", (int32_t)config->measurement_interval_ms,
-                               CONFIG_MEASUREMENT_INTERVAL_MS_MIN, CONFIG_MEASUREMENT_INTERVAL_MS_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("sensor_timeout_ms", (int32_t)config->sensor_timeout_ms,
-                               CONFIG_SENSOR_TIMEOUT_MS_MIN, CONFIG_SENSOR_TIMEOUT_MS_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("temperature_c_x10", config->temperature_c_x10,
-                               CONFIG_TEMPERATURE_C_X10_MIN, CONFIG_TEMPERATURE_C_X10_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("smoothing_factor", config->smoothing_factor,
-                               CONFIG_SMOOTHING_FACTOR_MIN, CONFIG_SMOOTHING_FACTOR_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    // LED parameters
-    if (!config_is_valid_int_range("led_count", (int32_t)config->led_count,
-                               CONFIG_LED_COUNT_MIN, CONFIG_LED_COUNT_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("led_brightness", (int32_t)config->led_brightness,
-                               CONFIG_LED_BRIGHTNESS_MIN, CONFIG_LED_BRIGHTNESS_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    // WiFi parameters
-    if (!config_is_valid_int_range("wifi_ap_channel", (int32_t)config->wifi_ap_channel,
-                               CONFIG_WIFI_AP_CHANNEL_MIN, CONFIG_WIFI_AP_CHANNEL_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("wifi_ap_max_conn", (int32_t)config->wifi_ap_max_conn,
-                               CONFIG_WIFI_AP_MAX_CONN_MIN, CONFIG_WIFI_AP_MAX_CONN_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("wifi_sta_max_retry", (int32_t)config->wifi_sta_max_retry,
-                               CONFIG_WIFI_STA_MAX_RETRY_MIN, CONFIG_WIFI_STA_MAX_RETRY_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    if (!config_is_valid_int_range("wifi_sta_timeout_ms", (int32_t)config->wifi_sta_timeout_ms,
-                               CONFIG_WIFI_STA_TIMEOUT_MS_MIN, CONFIG_WIFI_STA_TIMEOUT_MS_MAX)) {
-        return ESP_ERR_INVALID_SIZE;
+    for (size_t i = 0; i < CONFIG_DESCRIPTOR_COUNT; i++) {
+        const config_descriptor_t* desc = &config_descriptors[i];
+        if (desc->type == CONFIG_TYPE_STRING) {
+            const char* value = (const char*)config + desc->offset;
+            if (strnlen(value, desc->size) >= desc->size) {
+                ESP_LOGE(TAG, "Parameter %s is not terminated within %u bytes", desc->name, desc->size);
+                return ESP_ERR_INVALID_SIZE;
+            }
+        } else if (!config_is_valid_int_range(desc->name, config_get_field_value(config, desc),
+                                              desc->min_value, desc->max_value)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
     }
 
     // Validate inter-parameter relationships
@@ -336,8 +603,8 @@ esp_err_t config_factory_reset(void)
     system_config_t default_config;
     config_init_defaults(&default_config);
 
-    // Save defaults to NVS
-    esp_err_t ret = config_save(&default_config);
+    // Save defaults to NVS right away, dropping any pending save
+    esp_err_t ret = config_save_sync(&default_config);
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Factory reset completed successfully");
     } else {
@@ -357,7 +624,101 @@ bool config_is_valid_int_range(const char* param_name, int32_t value, int32_t mi
     return true;
 }
 
+const config_descriptor_t* config_get_descriptors(size_t* count)
+{
+    if (count != NULL) {
+        *count = CONFIG_DESCRIPTOR_COUNT;
+    }
+    return config_descriptors;
+}
+
+const config_descriptor_t* config_find_descriptor(const char* json_path)
+{
+    if (json_path == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < CONFIG_DESCRIPTOR_COUNT; i++) {
+        if (config_descriptors[i].json_path != NULL && strcmp(config_descriptors[i].json_path, json_path) == 0) {
+            return &config_descriptors[i];
+        }
+    }
+    return NULL;
+}
+
+int32_t config_get_field_value(const system_config_t* config, const config_descriptor_t* desc)
+{
+    const void* value = (const uint8_t*)config + desc->offset;
+
+    switch (desc->type) {
+    case CONFIG_TYPE_U8:
+        return *(const uint8_t*)value;
+    case CONFIG_TYPE_U16:
+        return *(const uint16_t*)value;
+    case CONFIG_TYPE_U32:
+        return (int32_t)*(const uint32_t*)value;
+    case CONFIG_TYPE_I16:
+        return *(const int16_t*)value;
+    default:
+        return 0;
+    }
+}
+
+esp_err_t config_set_field_value(system_config_t* config, const config_descriptor_t* desc, int32_t value)
+{
+    if (config == NULL || desc == NULL || desc->type == CONFIG_TYPE_STRING) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (value < desc->min_value || value > desc->max_value) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    config_store_field_value(config, desc, value);
+    return ESP_OK;
+}
+
+static void config_store_field_value(system_config_t* config, const config_descriptor_t* desc, int32_t value)
+{
+    void* field = (uint8_t*)config + desc->offset;
+    switch (desc->type) {
+    case CONFIG_TYPE_U8:
+        *(uint8_t*)field = (uint8_t)value;
+        break;
+    case CONFIG_TYPE_U16:
+        *(uint16_t*)field = (uint16_t)value;
+        break;
+    case CONFIG_TYPE_U32:
+        *(uint32_t*)field = (uint32_t)value;
+        break;
+    case CONFIG_TYPE_I16:
+        *(int16_t*)field = (int16_t)value;
+        break;
+    default:
+        break;
+    }
+}
+
+esp_err_t config_set_field_string(system_config_t* config, const config_descriptor_t* desc,
+                                  const char* value, size_t len)
+{
+    if (config == NULL || desc == NULL || value == NULL || desc->type != CONFIG_TYPE_STRING) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len >= desc->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    char* field = (char*)config + desc->offset;
+    memcpy(field, value, len);
+    field[len] = '\0';
+    return ESP_OK;
+}
+
 esp_err_t config_get_current(system_config_t* config)
+{
+    return config_get_snapshot(config, NULL);
+}
+
+esp_err_t config_get_snapshot(system_config_t* config, uint32_t* generation)
 {
     if (config == NULL) {
         ESP_LOGE(TAG, "Configuration pointer is NULL");
@@ -369,18 +730,40 @@ esp_err_t config_get_current(system_config_t* config)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // Take mutex for thread safety
-    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        ESP_LOGE(TAG, "Failed to acquire configuration mutex");
-        return ESP_ERR_TIMEOUT;
-    }
-
-    *config = current_config;
+    // Seqlock read: never blocks, retries if a writer was active during the copy
+    uint32_t spins = 0;
+    uint32_t seq_begin;
+    uint32_t seq_end;
+    do {
+        seq_begin = __atomic_load_n(&config_seq, __ATOMIC_ACQUIRE);
+        if (seq_begin & 1) {
+            // Writer in progress; it may be preempted on our core, so let it finish
+            if (++spins >= CONFIG_READ_SPIN_LIMIT) {
+                taskYIELD();
+                spins = 0;
+            }
+            continue;
+        }
+        memcpy(config, &current_config, sizeof(*config));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq_end = __atomic_load_n(&config_seq, __ATOMIC_RELAXED);
+        if (seq_end == seq_begin) {
+            break;
+        }
+    } while (true);
 
-    xSemaphoreGive(config_mutex);
+    if (generation != NULL) {
+        *generation = seq_begin >> 1;
+    }
     return ESP_OK;
 }
 
+uint32_t config_get_generation(void)
+{
+    // Even sequence values count completed updates
+    return __atomic_load_n(&config_seq, __ATOMIC_ACQUIRE) >> 1;
+}
+
 esp_err_t config_set_current(const system_config_t* config)
 {
     if (config == NULL) {
@@ -406,17 +789,402 @@ esp_err_t config_set_current(const system_config_t* config)
         return ESP_ERR_TIMEOUT;
     }
 
-    current_config = *config;
+    uint32_t changed_fields = config_publish(config);
 
     xSemaphoreGive(config_mutex);
-    ESP_LOGD(TAG, "Current configuration updated");
+    ESP_LOGD(TAG, "Current configuration updated (changed fields: 0x%04lx)", (unsigned long)changed_fields);
+
+    if (changed_fields != 0) {
+        config_notify(changed_fields, config);
+    }
     return ESP_OK;
 }
 
+esp_err_t config_subscribe(uint32_t field_mask, config_change_cb_t callback, QueueHandle_t queue,
+                           void* arg, config_subscription_t* handle)
+{
+    if ((field_mask & CONFIG_FIELDS_ALL) == 0 || (callback == NULL) == (queue == NULL)) {
+        ESP_LOGE(TAG, "Invalid configuration subscription");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int slot = -1;
+    taskENTER_CRITICAL(&config_seq_lock);
+    for (int i = 0; i < CONFIG_MAX_SUBSCRIBERS; i++) {
+        if (!subscribers[i].used) {
+            subscribers[i] = (config_subscriber_t) {
+                .used = true,
+                .field_mask = field_mask & CONFIG_FIELDS_ALL,
+                .callback = callback,
+                .queue = queue,
+                .arg = arg,
+            };
+            slot = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&config_seq_lock);
+
+    if (slot < 0) {
+        ESP_LOGE(TAG, "No free configuration subscription slots");
+        return ESP_ERR_NO_MEM;
+    }
+    if (handle != NULL) {
+        *handle = slot;
+    }
+    ESP_LOGD(TAG, "Configuration subscription %d added (fields: 0x%04lx)", slot, (unsigned long)field_mask);
+    return ESP_OK;
+}
+
+esp_err_t config_unsubscribe(config_subscription_t handle)
+{
+    if (handle < 0 || handle >= CONFIG_MAX_SUBSCRIBERS) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    taskENTER_CRITICAL(&config_seq_lock);
+    if (subscribers[handle].used) {
+        subscribers[handle].used = false;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&config_seq_lock);
+    return ret;
+}
+
 // =============================================================================
 // PRIVATE FUNCTION IMPLEMENTATIONS
 // =============================================================================
 
+static esp_err_t config_save_sync(const system_config_t* config)
+{
+    // Lock order: persist_mutex, then config_mutex
+    if (persist_mutex != NULL && xSemaphoreTake(persist_mutex, pdMS_TO_TICKS(5000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to acquire persistence mutex");
+        return ESP_ERR_TIMEOUT;
+    }
+    if (config_mutex != NULL && xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to acquire configuration mutex");
+        if (persist_mutex != NULL) {
+            xSemaphoreGive(persist_mutex);
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+
+    ESP_LOGD(TAG, "Saving configuration to NVS");
+
+    system_config_t config_to_save = *config;
+    esp_err_t ret = config_write_nvs(config, &config_to_save.save_count);
+
+    uint32_t changed_fields = 0;
+    if (ret == ESP_OK) {
+        // Update current configuration; this save supersedes any pending one
+        changed_fields = config_publish(&config_to_save);
+        persist_status.pending = false;
+    }
+    persist_status.last_error = ret;
+
+    if (config_mutex != NULL) {
+        xSemaphoreGive(config_mutex);
+    }
+    if (persist_mutex != NULL) {
+        xSemaphoreGive(persist_mutex);
+    }
+
+    if (changed_fields != 0 && config_initialized) {
+        config_notify(changed_fields, &config_to_save);
+    }
+
+    return ret;
+}
+
+static esp_err_t config_write_nvs(const system_config_t* config, uint32_t* save_count)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS namespace for write: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    system_config_t defaults;
+    config_init_defaults(&defaults);
+
+    // Only dirty fields are written; fields back at their default lose their key
+    int written = 0;
+    for (size_t i = 0; i < CONFIG_DESCRIPTOR_COUNT && ret == ESP_OK; i++) {
+        const config_descriptor_t* field = &config_descriptors[i];
+        system_config_t stored = defaults;
+        esp_err_t read_ret = config_nvs_read_field(nvs_handle, field, &stored);
+        bool present = (read_ret == ESP_OK);
+
+        if (present && config_field_equal(field, &stored, config)) {
+            continue;
+        }
+        if (config_field_equal(field, &defaults, config)) {
+            if (present) {
+                ret = nvs_erase_key(nvs_handle, field->nvs_key);
+                written++;
+            }
+            continue;
+        }
+        ret = config_nvs_write_field(nvs_handle, field, config);
+        written++;
+    }
+
+    uint32_t version = 0;
+    if (ret == ESP_OK && (nvs_get_u32(nvs_handle, NVS_VERSION_KEY, &version) != ESP_OK ||
+                          version != CONFIG_VERSION)) {
+        ret = nvs_set_u32(nvs_handle, NVS_VERSION_KEY, CONFIG_VERSION);
+        written++;
+    }
+
+    uint32_t stored_count = config->save_count;
+    nvs_get_u32(nvs_handle, NVS_SAVE_COUNT_KEY, &stored_count);
+
+    if (ret == ESP_OK && written == 0) {
+        nvs_close(nvs_handle);
+        *save_count = stored_count;
+        persist_status.skipped++;
+        ESP_LOGD(TAG, "Configuration unchanged in NVS, write skipped");
+        return ESP_OK;
+    }
+
+    if (ret == ESP_OK) {
+        ret = nvs_set_u32(nvs_handle, NVS_SAVE_COUNT_KEY, stored_count + 1);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+
+    nvs_close(nvs_handle);
+
+    if (ret == ESP_OK) {
+        *save_count = stored_count + 1;
+        persist_status.commits++;
+        ESP_LOGI(TAG, "Configuration saved successfully (%d keys updated, save count: %lu)",
+                 written, *save_count);
+    } else {
+        ESP_LOGE(TAG, "Failed to save configuration to NVS: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static esp_err_t config_nvs_read(nvs_handle_t nvs_handle, system_config_t* config)
+{
+    config_init_defaults(config);
+
+    for (size_t i = 0; i < CONFIG_DESCRIPTOR_COUNT; i++) {
+        esp_err_t ret = config_nvs_read_field(nvs_handle, &config_descriptors[i], config);
+        if (ret != ESP_OK && ret != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to read '%s': %s", config_descriptors[i].nvs_key, esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    // Metadata is optional; a missing counter means never saved
+    nvs_get_u32(nvs_handle, NVS_SAVE_COUNT_KEY, &config->save_count);
+    config->config_version = CONFIG_VERSION;
+    return ESP_OK;
+}
+
+static esp_err_t config_nvs_read_field(nvs_handle_t nvs_handle, const config_descriptor_t* field,
+                                       system_config_t* config)
+{
+    void* value = (uint8_t*)config + field->offset;
+
+    switch (field->type) {
+    case CONFIG_TYPE_U8:
+        return nvs_get_u8(nvs_handle, field->nvs_key, (uint8_t*)value);
+    case CONFIG_TYPE_U16:
+        return nvs_get_u16(nvs_handle, field->nvs_key, (uint16_t*)value);
+    case CONFIG_TYPE_U32:
+        return nvs_get_u32(nvs_handle, field->nvs_key, (uint32_t*)value);
+    case CONFIG_TYPE_I16:
+        return nvs_get_i16(nvs_handle, field->nvs_key, (int16_t*)value);
+    case CONFIG_TYPE_STRING: {
+        // Read into a scratch buffer so a failed read leaves the field untouched
+        char buf[CONFIG_WIFI_PASSWORD_MAX_LEN];
+        if (field->size > sizeof(buf)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        size_t len = field->size;
+        esp_err_t ret = nvs_get_str(nvs_handle, field->nvs_key, buf, &len);
+        if (ret == ESP_OK) {
+            memcpy(value, buf, len);
+        }
+        return ret;
+    }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+static esp_err_t config_nvs_write_field(nvs_handle_t nvs_handle, const config_descriptor_t* field,
+                                        const system_config_t* config)
+{
+    const void* value = (const uint8_t*)config + field->offset;
+
+    switch (field->type) {
+    case CONFIG_TYPE_U8:
+        return nvs_set_u8(nvs_handle, field->nvs_key, *(const uint8_t*)value);
+    case CONFIG_TYPE_U16:
+        return nvs_set_u16(nvs_handle, field->nvs_key, *(const uint16_t*)value);
+    case CONFIG_TYPE_U32:
+        return nvs_set_u32(nvs_handle, field->nvs_key, *(const uint32_t*)value);
+    case CONFIG_TYPE_I16:
+        return nvs_set_i16(nvs_handle, field->nvs_key, *(const int16_t*)value);
+    case CONFIG_TYPE_STRING: {
+        char buf[CONFIG_WIFI_PASSWORD_MAX_LEN];
+        if (field->size > sizeof(buf)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        // Terminate explicitly in case the caller filled the whole buffer
+        memcpy(buf, value, field->size);
+        buf[field->size - 1] = '\0';
+        return nvs_set_str(nvs_handle, field->nvs_key, buf);
+    }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+static bool config_field_equal(const config_descriptor_t* field, const system_config_t* a,
+                               const system_config_t* b)
+{
+    const char* va = (const char*)a + field->offset;
+    const char* vb = (const char*)b + field->offset;
+
+    if (field->type == CONFIG_TYPE_STRING) {
+        return strncmp(va, vb, field->size) == 0;
+    }
+    return memcmp(va, vb, field->size) == 0;
+}
+
+static esp_err_t config_nvs_migrate(nvs_handle_t nvs_handle)
+{
+    // Version 1: whole configuration in one blob
+    config_v1_blob_t blob;
+    size_t blob_size = sizeof(blob);
+    esp_err_t ret = nvs_get_blob(nvs_handle, NVS_LEGACY_CONFIG_KEY, &blob, &blob_size);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (ret != ESP_OK || blob_size != sizeof(blob) || blob.config_version != 1) {
+        ESP_LOGW(TAG, "Unrecognized legacy configuration blob, discarding it");
+        nvs_erase_key(nvs_handle, NVS_LEGACY_CONFIG_KEY);
+        nvs_commit(nvs_handle);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_LOGI(TAG, "Migrating configuration from version 1 blob to per-field keys");
+
+    system_config_t config;
+    config_init_defaults(&config);
+    config.distance_min_mm = blob.distance_min_mm;
+    config.distance_max_mm = blob.distance_max_mm;
+    config.measurement_interval_ms = blob.measurement_interval_ms;
+    config.sensor_timeout_ms = blob.sensor_timeout_ms;
+    config.temperature_c_x10 = blob.temperature_c_x10;
+    config.smoothing_factor = blob.smoothing_factor;
+    config.led_count = blob.led_count;
+    config.led_brightness = blob.led_brightness;
+    memcpy(config.wifi_ssid, blob.wifi_ssid, sizeof(config.wifi_ssid));
+    memcpy(config.wifi_password, blob.wifi_password, sizeof(config.wifi_password));
+    config.wifi_ssid[sizeof(config.wifi_ssid) - 1] = '\0';
+    config.wifi_password[sizeof(config.wifi_password) - 1] = '\0';
+    config.wifi_ap_channel = blob.wifi_ap_channel;
+    config.wifi_ap_max_conn = blob.wifi_ap_max_conn;
+    config.wifi_sta_max_retry = blob.wifi_sta_max_retry;
+    config.wifi_sta_timeout_ms = blob.wifi_sta_timeout_ms;
+
+    system_config_t defaults;
+    config_init_defaults(&defaults);
+
+    // Write non-default fields, then the version key, then drop the blob -
+    // all in one commit so an interrupted migration is simply repeated
+    ret = ESP_OK;
+    for (size_t i = 0; i < CONFIG_DESCRIPTOR_COUNT && ret == ESP_OK; i++) {
+        if (!config_field_equal(&config_descriptors[i], &defaults, &config)) {
+            ret = config_nvs_write_field(nvs_handle, &config_descriptors[i], &config);
+        }
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_set_u32(nvs_handle, NVS_SAVE_COUNT_KEY, blob.save_count);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_set_u32(nvs_handle, NVS_VERSION_KEY, CONFIG_VERSION);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_erase_key(nvs_handle, NVS_LEGACY_CONFIG_KEY);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Configuration migration failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "Configuration migrated (save count: %lu)", blob.save_count);
+    return ESP_OK;
+}
+
+static esp_err_t config_persist_pending(void)
+{
+    if (xSemaphoreTake(persist_mutex, pdMS_TO_TICKS(5000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to acquire persistence mutex");
+        return ESP_ERR_TIMEOUT;
+    }
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        xSemaphoreGive(persist_mutex);
+        ESP_LOGE(TAG, "Failed to acquire configuration mutex");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    if (!persist_status.pending) {
+        xSemaphoreGive(config_mutex);
+        xSemaphoreGive(persist_mutex);
+        return ESP_OK;
+    }
+
+    // Write with config_mutex held so counters and pending state stay consistent;
+    // readers are lock-free and config_save() callers wait at most one commit
+    uint32_t save_count = 0;
+    esp_err_t ret = config_write_nvs(&pending_config, &save_count);
+    persist_status.last_error = ret;
+    if (ret == ESP_OK) {
+        persist_status.pending = false;
+
+        // Reflect the stored save count; metadata changes are not notified
+        system_config_t updated = current_config;
+        updated.save_count = save_count;
+        config_publish(&updated);
+    }
+
+    xSemaphoreGive(config_mutex);
+    xSemaphoreGive(persist_mutex);
+    return ret;
+}
+
+#ifdef CONFIG_CONFIG_MANAGER_ASYNC_SAVE
+static void config_writer_task(void* arg)
+{
+    const TickType_t debounce = pdMS_TO_TICKS(CONFIG_CONFIG_MANAGER_SAVE_DEBOUNCE_MS);
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Debounce: wait until no further save arrived for a full period
+        while (ulTaskNotifyTake(pdTRUE, debounce) > 0) {
+        }
+
+        if (config_persist_pending() != ESP_OK) {
+            // Keep the pending data and retry after another debounce period
+            xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+        }
+    }
+}
+#endif
+
 static void config_init_defaults(system_config_t* config)
 {
     memset(config, 0, sizeof(system_config_t));
@@ -425,29 +1193,68 @@ static void config_init_defaults(system_config_t* config)
     config->config_version = CONFIG_VERSION;
     config->save_count = 0;
 
-    // Template: Distance sensor defaults (example values - customize for your hardware)
-    config->distance_min_mm = 100;      // 10 cm minimum
-    config->distance_max_mm = 4000;     // 4 m maximum  
-    config->measurement_interval_ms = 100;
-    config->sensor_timeout_ms = 30000;
-    config->temperature_c_x10 = 200;    // 20.0°C
-    config->smoothing_factor = 300;     // 0.3 alpha
-
-    // Template: LED defaults (example values - customize for your hardware)
-    config->led_count = 30;
-    config->led_brightness = 128;
-
-    // WiFi defaults (empty SSID/password initially for AP mode)
-    memset(config->wifi_ssid, 0, CONFIG_WIFI_SSID_MAX_LEN);
-    memset(config->wifi_password, 0, CONFIG_WIFI_PASSWORD_MAX_LEN);
-    config->wifi_ap_channel = 1;
-    config->wifi_ap_max_conn = 4;
-    config->wifi_sta_max_retry = 5;
-    config->wifi_sta_timeout_ms = 10000;
+    for (size_t i = 0; i < CONFIG_DESCRIPTOR_COUNT; i++) {
+        const config_descriptor_t* desc = &config_descriptors[i];
+        if (desc->type == CONFIG_TYPE_STRING) {
+            char* value = (char*)config + desc->offset;
+            strncpy(value, desc->default_string ? desc->default_string : "", desc->size - 1);
+        } else {
+            config_store_field_value(config, desc, desc->default_value);
+        }
+    }
 
     ESP_LOGD(TAG, "Initialized configuration with template defaults");
 }
 
+static uint32_t config_publish(const system_config_t* config)
+{
+    // Only writers touch current_config outside the seqlock, so diffing here is safe
+    uint32_t changed_fields = config_diff(&current_config, config);
+
+    // Critical section keeps the odd window short: no preemption on this core
+    taskENTER_CRITICAL(&config_seq_lock);
+    __atomic_store_n(&config_seq, config_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&current_config, config, sizeof(current_config));
+    __atomic_store_n(&config_seq, config_seq + 1, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL(&config_seq_lock);
+
+    return changed_fields;
+}
+
+static uint32_t config_diff(const system_config_t* a, const system_config_t* b)
+{
+    uint32_t changed = 0;
+
+    for (size_t i = 0; i < CONFIG_DESCRIPTOR_COUNT; i++) {
+        if (!config_field_equal(&config_descriptors[i], a, b)) {
+            changed |= config_descriptors[i].field;
+        }
+    }
+    return changed;
+}
+
+static void config_notify(uint32_t changed_fields, const system_config_t* config)
+{
+    // Snapshot the table so callbacks run without any lock held
+    config_subscriber_t active[CONFIG_MAX_SUBSCRIBERS];
+    taskENTER_CRITICAL(&config_seq_lock);
+    memcpy(active, subscribers, sizeof(active));
+    taskEXIT_CRITICAL(&config_seq_lock);
+
+    for (int i = 0; i < CONFIG_MAX_SUBSCRIBERS; i++) {
+        uint32_t fields = changed_fields & active[i].field_mask;
+        if (!active[i].used || fields == 0) {
+            continue;
+        }
+        if (active[i].callback != NULL) {
+            active[i].callback(fields, config, active[i].arg);
+        } else if (xQueueSend(active[i].queue, &fields, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "Subscriber %d queue full, change notification dropped", i);
+        }
+    }
+}
+
 static esp_err_t config_validate_relationships(const system_config_t* config)
 {
     // Validate that distance_max_mm > distance_min_mm
@@ -498,9 +1305,12 @@ esp_err_t config_nvs_health_check(size_t* free_entries, size_t* total_entries)
     }
 
     // Try to read our configuration to verify integrity
-    size_t required_size = sizeof(system_config_t);
     system_config_t test_config;
-    esp_err_t read_ret = nvs_get_blob(nvs_handle, NVS_CONFIG_KEY, &test_config, &required_size);
+    uint32_t version = 0;
+    esp_err_t read_ret = nvs_get_u32(nvs_handle, NVS_VERSION_KEY, &version);
+    if (read_ret == ESP_OK) {
+        read_ret = config_nvs_read(nvs_handle, &test_config);
+    }
     
     nvs_close(nvs_handle);
 
@@ -9,6 +9,7 @@
  * FEATURES:
  * - Runtime configuration structure matching compile-time defaults
  * - NVS persistence with power-loss protection
+ * - Optional asynchronous, debounced saves that skip unchanged writes
  * - Parameter validation with range checking
  * - Thread-safe access with mutex protection
  * - Automatic fallback to factory defaults
@@ -16,7 +17,9 @@
  * 
  * THREAD SAFETY:
  * All functions are thread-safe and can be called from multiple tasks simultaneously.
- * Internal mutex protection ensures data consistency.
+ * Writers are serialized by an internal mutex. Readers of the current configuration
+ * never block: they copy a seqlock-protected snapshot and can poll a generation
+ * counter to detect changes without copying.
  * 
  * ERROR HANDLING:
  * All functions return esp_err_t codes for proper error handling integration
@@ -37,7 +40,10 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,9 +55,12 @@ extern "C" {
 
 /**
  * @brief Current configuration version
- * @note Used for compatibility checking and migration
+ * @note Used for compatibility checking and migration. Version 1 stored the
+ *       whole structure as one NVS blob; version 2 uses one NVS key per field
+ *       and only stores fields that differ from the factory defaults, so new
+ *       fields can be added without a version bump.
  */
-#define CONFIG_VERSION 1
+#define CONFIG_VERSION 2
 
 /**
  * @brief Maximum length for WiFi SSID (including null terminator)
@@ -76,7 +85,7 @@ extern "C" {
  */
 typedef struct {
     // Configuration metadata
-    uint32_t config_version;         ///< Configuration version (current: 1)
+    uint32_t config_version;         ///< Configuration version (current: 2)
     uint32_t save_count;             ///< Number of times configuration has been saved
     
     // Distance sensor settings (runtime configurable)
@@ -100,6 +109,185 @@ typedef struct {
     uint32_t wifi_sta_timeout_ms;    ///< STA connection timeout in ms (1000-30000)
 } system_config_t;
 
+// =============================================================================
+// CHANGE NOTIFICATION
+// =============================================================================
+
+/**
+ * @brief Bit masks identifying fields of system_config_t
+ * @note Metadata (config_version, save_count) is not reported as a change
+ */
+typedef enum {
+    CONFIG_FIELD_DISTANCE_MIN_MM         = (1U << 0),
+    CONFIG_FIELD_DISTANCE_MAX_MM         = (1U << 1),
+    CONFIG_FIELD_MEASUREMENT_INTERVAL_MS = (1U << 2),
+    CONFIG_FIELD_SENSOR_TIMEOUT_MS       = (1U << 3),
+    CONFIG_FIELD_TEMPERATURE_C_X10       = (1U << 4),
+    CONFIG_FIELD_SMOOTHING_FACTOR        = (1U << 5),
+    CONFIG_FIELD_LED_COUNT               = (1U << 6),
+    CONFIG_FIELD_LED_BRIGHTNESS          = (1U << 7),
+    CONFIG_FIELD_WIFI_SSID               = (1U << 8),
+    CONFIG_FIELD_WIFI_PASSWORD           = (1U << 9),
+    CONFIG_FIELD_WIFI_AP_CHANNEL         = (1U << 10),
+    CONFIG_FIELD_WIFI_AP_MAX_CONN        = (1U << 11),
+    CONFIG_FIELD_WIFI_STA_MAX_RETRY      = (1U << 12),
+    CONFIG_FIELD_WIFI_STA_TIMEOUT_MS     = (1U << 13),
+} config_field_t;
+
+/**
+ * @brief Field groups for common subscribers
+ */
+#define CONFIG_FIELDS_SENSOR (CONFIG_FIELD_DISTANCE_MIN_MM | CONFIG_FIELD_DISTANCE_MAX_MM | \
+                              CONFIG_FIELD_MEASUREMENT_INTERVAL_MS | CONFIG_FIELD_SENSOR_TIMEOUT_MS | \
+                              CONFIG_FIELD_TEMPERATURE_C_X10 | CONFIG_FIELD_SMOOTHING_FACTOR)
+#define CONFIG_FIELDS_LED    (CONFIG_FIELD_LED_COUNT | CONFIG_FIELD_LED_BRIGHTNESS)
+#define CONFIG_FIELDS_WIFI   (CONFIG_FIELD_WIFI_SSID | CONFIG_FIELD_WIFI_PASSWORD | \
+                              CONFIG_FIELD_WIFI_AP_CHANNEL | CONFIG_FIELD_WIFI_AP_MAX_CONN | \
+                              CONFIG_FIELD_WIFI_STA_MAX_RETRY | CONFIG_FIELD_WIFI_STA_TIMEOUT_MS)
+#define CONFIG_FIELDS_ALL    (CONFIG_FIELDS_SENSOR | CONFIG_FIELDS_LED | CONFIG_FIELDS_WIFI)
+
+/**
+ * @brief Maximum number of simultaneous change subscriptions
+ */
+#define CONFIG_MAX_SUBSCRIBERS 8
+
+/**
+ * @brief Change notification callback
+ *
+ * Called once per configuration update (coalesced: all fields changed by one
+ * config_set_current()/config_save() are reported together) in the context of
+ * the task performing the update. Keep it short; use a queue subscription for
+ * work that may block. The callback may read the configuration but must not
+ * update it.
+ *
+ * @param changed_fields Mask of changed fields (config_field_t), limited to the
+ *                       subscribed mask
+ * @param config New configuration
+ * @param arg User argument given to config_subscribe()
+ */
+typedef void (*config_change_cb_t)(uint32_t changed_fields, const system_config_t* config, void* arg);
+
+/**
+ * @brief Subscription handle returned by config_subscribe()
+ */
+typedef int config_subscription_t;
+
+/**
+ * @brief Subscribe to changes of selected configuration fields
+ *
+ * Exactly one of @p callback and @p queue must be given. Queue subscribers
+ * receive the changed field mask as a uint32_t item; the send never blocks
+ * and a notification is dropped (with a warning) if the queue is full.
+ *
+ * @param[in] field_mask Fields of interest (config_field_t bits, CONFIG_FIELDS_*)
+ * @param[in] callback Callback to invoke, or NULL when using a queue
+ * @param[in] queue Queue of uint32_t items to post to, or NULL when using a callback
+ * @param[in] arg User argument passed to the callback
+ * @param[out] handle Subscription handle for config_unsubscribe() (optional, can be NULL)
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG if the mask is empty or not exactly one target is given
+ * @return ESP_ERR_NO_MEM if all CONFIG_MAX_SUBSCRIBERS slots are in use
+ */
+esp_err_t config_subscribe(uint32_t field_mask, config_change_cb_t callback, QueueHandle_t queue,
+                           void* arg, config_subscription_t* handle);
+
+/**
+ * @brief Remove a subscription created by config_subscribe()
+ * @param[in] handle Subscription handle
+ * @return ESP_OK on success
+ * @return ESP_ERR_NOT_FOUND if the handle is not an active subscription
+ */
+esp_err_t config_unsubscribe(config_subscription_t handle);
+
+// =============================================================================
+// CONFIGURATION DESCRIPTORS
+// =============================================================================
+
+/**
+ * @brief Storage type of a configuration field
+ */
+typedef enum {
+    CONFIG_TYPE_U8,
+    CONFIG_TYPE_U16,
+    CONFIG_TYPE_U32,
+    CONFIG_TYPE_I16,
+    CONFIG_TYPE_STRING,
+} config_type_t;
+
+/**
+ * @brief Descriptor flag: write-only field (never serialized, empty input keeps the value)
+ */
+#define CONFIG_DESC_SECRET (1U << 0)
+
+/**
+ * @brief Description of one field of system_config_t
+ *
+ * The descriptor table drives defaults, range validation, NVS persistence and
+ * the JSON representation used by the web interface. JSON values are the
+ * stored value divided by json_scale (e.g. distance_min_mm is exposed in cm).
+ */
+typedef struct {
+    const char* name;               ///< Field name (logging)
+    const char* nvs_key;            ///< NVS key (max 15 characters)
+    const char* json_path;          ///< Dotted JSON path, NULL if not exposed
+    uint16_t offset;                ///< Offset in system_config_t
+    uint16_t size;                  ///< Field size in bytes (buffer size for strings)
+    config_type_t type;             ///< Storage type
+    uint8_t flags;                  ///< CONFIG_DESC_* flags
+    uint16_t json_scale;            ///< Stored units per JSON unit
+    int32_t min_value;              ///< Minimum valid value (numeric fields)
+    int32_t max_value;              ///< Maximum valid value (numeric fields)
+    int32_t default_value;          ///< Factory default (numeric fields)
+    const char* default_string;     ///< Factory default (string fields)
+    uint32_t field;                 ///< config_field_t bit
+} config_descriptor_t;
+
+/**
+ * @brief Get the configuration descriptor table
+ * @param[out] count Number of descriptors (optional, can be NULL)
+ * @return Pointer to the first descriptor (table lives in flash)
+ */
+const config_descriptor_t* config_get_descriptors(size_t* count);
+
+/**
+ * @brief Find a descriptor by its JSON path (e.g. "wifi.ap_channel")
+ * @param[in] json_path Dotted JSON path
+ * @return Descriptor, or NULL if no field has this path
+ */
+const config_descriptor_t* config_find_descriptor(const char* json_path);
+
+/**
+ * @brief Read a numeric field through its descriptor
+ * @param[in] config Configuration to read
+ * @param[in] desc Field descriptor (must not be a string field)
+ * @return Field value
+ */
+int32_t config_get_field_value(const system_config_t* config, const config_descriptor_t* desc);
+
+/**
+ * @brief Set a numeric field through its descriptor, checking its range
+ * @param[out] config Configuration to modify
+ * @param[in] desc Field descriptor
+ * @param[in] value New value
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG for string fields or NULL arguments
+ * @return ESP_ERR_INVALID_SIZE if the value is out of range (field unchanged)
+ */
+esp_err_t config_set_field_value(system_config_t* config, const config_descriptor_t* desc, int32_t value);
+
+/**
+ * @brief Set a string field through its descriptor
+ * @param[out] config Configuration to modify
+ * @param[in] desc Field descriptor
+ * @param[in] value New value (need not be NUL-terminated)
+ * @param[in] len Length of value
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG for numeric fields or NULL arguments
+ * @return ESP_ERR_INVALID_SIZE if the value does not fit (field unchanged)
+ */
+esp_err_t config_set_field_string(system_config_t* config, const config_descriptor_t* desc,
+                                  const char* value, size_t len);
+
 // =============================================================================
 // CONFIGURATION API (REQ-CFG-5)
 // =============================================================================
@@ -125,6 +313,8 @@ esp_err_t config_init(void);
  * @brief Load configuration from NVS
  * 
  * Reads current configuration from NVS storage into provided structure.
+ * Fields without an NVS key get their factory default. A version 1 blob is
+ * migrated to per-field keys on first load, keeping the user's settings.
  * If NVS read fails or validation fails, automatically calls config_factory_reset()
  * to restore defaults and persist them.
  * 
@@ -142,23 +332,64 @@ esp_err_t config_load(system_config_t* config);
  * @brief Save configuration to NVS
  * 
  * Validates configuration parameters using config_validate_range() and saves
- * to NVS if validation passes. Updates save_count and performs atomic write
- * operation for power-loss protection.
+ * to NVS if validation passes. The configuration becomes current immediately.
+ * 
+ * With CONFIG_CONFIG_MANAGER_ASYNC_SAVE the write is handed to a background
+ * writer task and this function returns without touching flash. The writer
+ * waits until no further save arrived for CONFIG_CONFIG_MANAGER_SAVE_DEBOUNCE_MS,
+ * so bursts of saves result in a single write. Call config_flush() before
+ * restarting to make sure the data reached NVS.
+ * 
+ * In both modes the write is skipped if NVS already holds an identical
+ * configuration; otherwise save_count is incremented and the blob is written
+ * atomically for power-loss protection.
  * 
  * @param[in] config Pointer to configuration structure to save
- * @return ESP_OK on success
+ * @return ESP_OK on success (or when queued in asynchronous mode)
  * @return ESP_ERR_INVALID_ARG if config is NULL or validation fails
- * @return Other ESP error codes for NVS write failures
+ * @return Other ESP error codes for NVS write failures (synchronous mode)
  * 
  * @requirement REQ-CFG-5 AC-4
  */
 esp_err_t config_save(const system_config_t* config);
 
+/**
+ * @brief Persistence state of the configuration
+ */
+typedef struct {
+    bool pending;                   ///< A save is queued and not yet in NVS
+    uint32_t commits;               ///< NVS writes performed since boot
+    uint32_t skipped;               ///< Saves skipped because NVS already matched
+    esp_err_t last_error;           ///< Result of the last NVS write attempt
+} config_persist_status_t;
+
+/**
+ * @brief Write any pending asynchronous save to NVS now
+ * 
+ * Blocks until the write completed. Must be called before a deliberate
+ * restart; a no-op when nothing is pending or saves are synchronous.
+ * 
+ * @return ESP_OK if nothing was pending or the write succeeded
+ * @return ESP_ERR_INVALID_STATE if config manager not initialized
+ * @return Other ESP error codes for NVS write failures
+ */
+esp_err_t config_flush(void);
+
+/**
+ * @brief Get the persistence state (pending save, write counters)
+ * 
+ * @param[out] status Pointer to status structure to populate
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG if status is NULL
+ * @return ESP_ERR_INVALID_STATE if config manager not initialized
+ */
+esp_err_t config_get_persist_status(config_persist_status_t* status);
+
 /**
  * @brief Validate configuration parameter ranges
  * 
- * Validates all parameters in configuration structure against defined ranges
- * and inter-parameter relationships. Logs specific error messages for invalid
+ * Validates all parameters in configuration structure against the ranges in
+ * the descriptor table and inter-parameter relationships. Logs specific error messages for invalid
  * parameters.
  * 
  * @param[in] config Pointer to configuration structure to validate
@@ -173,8 +404,9 @@ esp_err_t config_validate_range(const system_config_t* config);
 /**
  * @brief Reset configuration to factory defaults
  * 
- * Restores compile-time defaults from config.h and persists them to NVS
- * using config_save(). Completes the error recovery sequence atomically.
+ * Restores the defaults from the descriptor table and persists them to NVS
+ * synchronously, discarding any pending asynchronous save. Completes the
+ * error recovery sequence atomically.
  * 
  * @return ESP_OK on success
  * @return Other ESP error codes for save operation failures
@@ -205,10 +437,11 @@ esp_err_t config_factory_reset(void);
 bool config_is_valid_int_range(const char* param_name, int32_t value, int32_t min_val, int32_t max_val);
 
 /**
- * @brief Get current configuration (thread-safe)
+ * @brief Get current configuration (thread-safe, non-blocking)
  * 
- * Returns a copy of the current configuration structure with mutex protection.
- * This function is safe to call from multiple tasks simultaneously.
+ * Returns a consistent copy of the current configuration structure. Readers
+ * never take a lock and never wait for NVS writes, so this is cheap enough to
+ * call from sensor loops. Equivalent to config_get_snapshot(config, NULL).
  * 
  * @param[out] config Pointer to configuration structure to populate
  * @return ESP_OK on success
@@ -217,10 +450,43 @@ bool config_is_valid_int_range(const char* param_name, int32_t value, int32_t mi
  */
 esp_err_t config_get_current(system_config_t* config);
 
+/**
+ * @brief Get current configuration together with its generation
+ * 
+ * The returned generation matches the copied configuration exactly, so a
+ * caller can cache it and later compare with config_get_generation().
+ * 
+ * @param[out] config Pointer to configuration structure to populate
+ * @param[out] generation Generation of the copy (optional, can be NULL)
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG if config is NULL
+ * @return ESP_ERR_INVALID_STATE if config manager not initialized
+ */
+esp_err_t config_get_snapshot(system_config_t* config, uint32_t* generation);
+
+/**
+ * @brief Get the configuration generation counter
+ * 
+ * Incremented on every update of the current configuration (config_set_current(),
+ * config_save(), factory reset). Reading it costs a single atomic load, so tasks
+ * can check it every iteration and only copy the configuration when it changed:
+ * 
+ * @code
+ * if (config_get_generation() != cached_generation) {
+ *     config_get_snapshot(&cached_config, &cached_generation);
+ * }
+ * @endcode
+ * 
+ * @return Current generation (0 before initialization)
+ */
+uint32_t config_get_generation(void);
+
 /**
  * @brief Update current configuration (thread-safe)
  * 
- * Updates the current configuration with validation and mutex protection.
+ * Updates the current configuration with validation. Concurrent writers are
+ * serialized by the internal mutex; readers see either the old or the new
+ * configuration, never a mix.
  * Does not automatically save to NVS - call config_save() separately if
  * persistence is required.
  * 
@@ -0,0 +1,402 @@
+/**
+ * @file measurement.c
+ * @brief Distance measurement pipeline implementation
+ *
+ * An esp_timer fires once per sample period and notifies the sampler task,
+ * which reads the source, filters and publishes one sample. Periods that
+ * elapse while a sample is still being processed are counted as late, not
+ * caught up, just like a real sensor that cannot be read faster.
+ *
+ * Ring slots are written seqlock style: the sampler clears a slot's sequence
+ * number, writes the sample and then stores the new sequence number and the
+ * head. A reader whose copy does not carry the sequence number it expects
+ * before and after copying lost the sample to the writer and skips it.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "measurement.h"
+#include "measurement_history.h"
+#include "config_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+static const char *TAG = "measurement";
+
+#define MEASUREMENT_TASK_STACK_SIZE 3072
+#define MEASUREMENT_TASK_PRIORITY   6   // Above the httpd task so load does not delay samples
+
+#define MEASUREMENT_RING_MASK (MEASUREMENT_RING_SIZE - 1)
+_Static_assert((MEASUREMENT_RING_SIZE & MEASUREMENT_RING_MASK) == 0, "MEASUREMENT_RING_SIZE must be a power of two");
+
+// EMA state and smoothing factor are Q16.16 fixed point
+#define FILTER_SHIFT 16
+#define FILTER_ONE   (1 << FILTER_SHIFT)
+
+#define CONFIG_FIELDS_PIPELINE (CONFIG_FIELD_DISTANCE_MIN_MM | CONFIG_FIELD_DISTANCE_MAX_MM | \
+                                CONFIG_FIELD_MEASUREMENT_INTERVAL_MS | CONFIG_FIELD_SMOOTHING_FACTOR | \
+                                CONFIG_FIELD_LED_COUNT)
+
+/**
+ * @brief Pipeline parameters taken from the configuration
+ */
+typedef struct {
+    uint16_t min_mm;
+    uint16_t max_mm;
+    uint32_t alpha_q16;             ///< smoothing_factor / 1000 in Q16.16
+    uint8_t led_count;
+    uint32_t interval_us;           ///< measurement_interval_ms in microseconds
+} pipeline_params_t;
+
+/**
+ * @brief Ring slot
+ */
+typedef struct {
+    uint32_t seq;                   ///< Sequence number of the sample, 0 while it is written
+    measurement_t sample;
+} ring_slot_t;
+
+// =============================================================================
+// State
+// =============================================================================
+
+static TaskHandle_t s_task = NULL;
+static esp_timer_handle_t s_timer = NULL;
+
+// Source, parameters and statistics, guarded by s_lock
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static const char *s_source_name = "none";
+static measurement_source_t s_source = NULL;
+static void *s_source_ctx = NULL;
+static uint32_t s_fixed_interval_us = 0;    // Source period independent of the configuration, 0 if none
+static pipeline_params_t s_params;
+static measurement_stats_t s_stats;
+
+// Written only by the sampler task
+static ring_slot_t s_ring[MEASUREMENT_RING_SIZE];
+static uint32_t s_last_seq = 0;             // Newest published sample (read atomically)
+static int32_t s_filtered_q16 = 0;
+static bool s_filter_valid = false;
+
+// =============================================================================
+// Filtering
+// =============================================================================
+
+static pipeline_params_t params_from_config(const system_config_t *config)
+{
+    pipeline_params_t params = {
+        .min_mm = config->distance_min_mm,
+        .max_mm = config->distance_max_mm,
+        .alpha_q16 = ((uint32_t)config->smoothing_factor * FILTER_ONE) / 1000,
+        .led_count = config->led_count,
+        .interval_us = (uint32_t)config->measurement_interval_ms * 1000,
+    };
+    return params;
+}
+
+/**
+ * @brief Feed a valid reading into the EMA and return the filtered distance
+ */
+static uint16_t filter_update(uint16_t raw_mm, uint32_t alpha_q16)
+{
+    int32_t raw_q16 = (int32_t)raw_mm << FILTER_SHIFT;
+    if (!s_filter_valid) {
+        // The first reading seeds the filter instead of rising from zero
+        s_filtered_q16 = raw_q16;
+        s_filter_valid = true;
+    } else {
+        s_filtered_q16 += (int32_t)(((int64_t)alpha_q16 * (raw_q16 - s_filtered_q16)) >> FILTER_SHIFT);
+    }
+    return (uint16_t)((s_filtered_q16 + FILTER_ONE / 2) >> FILTER_SHIFT);
+}
+
+/**
+ * @brief Map a distance onto the LED strip, nearest LED first
+ */
+static int16_t led_index(uint16_t distance_mm, const pipeline_params_t *params)
+{
+    if (params->led_count == 0 || params->max_mm <= params->min_mm) {
+        return MEASUREMENT_LED_NONE;
+    }
+    if (distance_mm <= params->min_mm) {
+        return 0;
+    }
+    if (distance_mm >= params->max_mm) {
+        return params->led_count - 1;
+    }
+    return (int16_t)(((uint32_t)(distance_mm - params->min_mm) * (params->led_count - 1)) /
+                     (params->max_mm - params->min_mm));
+}
+
+// =============================================================================
+// Ring Buffer
+// =============================================================================
+
+static void ring_publish(measurement_t *sample)
+{
+    uint32_t seq = s_last_seq + 1;
+    sample->seq = seq;
+
+    ring_slot_t *slot = &s_ring[seq & MEASUREMENT_RING_MASK];
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->sample = *sample;
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_last_seq, seq, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Copy the sample with sequence number @p seq out of the ring
+ *
+ * @return false if the slot was overwritten before or during the copy
+ */
+static bool ring_copy(uint32_t seq, measurement_t *sample)
+{
+    const ring_slot_t *slot = &s_ring[seq & MEASUREMENT_RING_MASK];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) {
+        return false;
+    }
+    *sample = slot->sample;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq;
+}
+
+// =============================================================================
+// Sampler
+// =============================================================================
+
+static void sample_timer_callback(void *arg)
+{
+    xTaskNotifyGive(s_task);
+}
+
+/**
+ * @brief (Re)start the sample timer with the period of the current source
+ *
+ * Called with s_lock released.
+ */
+static void sample_timer_restart(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    bool running = s_source != NULL;
+    uint32_t interval_us = s_fixed_interval_us != 0 ? s_fixed_interval_us : s_params.interval_us;
+    s_stats.running = running;
+    s_stats.interval_us = interval_us;
+    taskEXIT_CRITICAL(&s_lock);
+
+    esp_timer_stop(s_timer);
+    if (running && interval_us > 0) {
+        esp_timer_start_periodic(s_timer, interval_us);
+        ESP_LOGI(TAG, "Sampling %s every %lu us", s_source_name, (unsigned long)interval_us);
+    }
+}
+
+static void sampler_task(void *arg)
+{
+    while (1) {
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        taskENTER_CRITICAL(&s_lock);
+        measurement_source_t source = s_source;
+        void *ctx = s_source_ctx;
+        pipeline_params_t params = s_params;
+        uint32_t interval_us = s_fixed_interval_us != 0 ? s_fixed_interval_us : s_params.interval_us;
+        if (ticks > 1) {
+            s_stats.late_ticks += ticks - 1;
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (source == NULL) {
+            continue;
+        }
+
+        measurement_t sample = {
+            .timestamp_us = esp_timer_get_time(),
+            .led_index = MEASUREMENT_LED_NONE,
+        };
+        uint16_t raw_mm = 0;
+        measurement_status_t status = source(ctx, &raw_mm);
+        if (status == MEASUREMENT_OK && (raw_mm < params.min_mm || raw_mm > params.max_mm)) {
+            status = MEASUREMENT_OUT_OF_RANGE;
+        }
+        if (status == MEASUREMENT_OK || status == MEASUREMENT_OUT_OF_RANGE) {
+            sample.raw_mm = raw_mm;
+        }
+        if (status == MEASUREMENT_OK) {
+            sample.filtered_mm = filter_update(raw_mm, params.alpha_q16);
+            sample.led_index = led_index(sample.filtered_mm, &params);
+        } else if (s_filter_valid) {
+            // Keep reporting the last good value; invalid readings do not enter the filter
+            sample.filtered_mm = (uint16_t)((s_filtered_q16 + FILTER_ONE / 2) >> FILTER_SHIFT);
+        }
+        sample.status = status;
+        ring_publish(&sample);
+        measurement_history_add(&sample, interval_us);
+
+        uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - sample.timestamp_us);
+        taskENTER_CRITICAL(&s_lock);
+        s_stats.samples++;
+        if (status != MEASUREMENT_OK) {
+            s_stats.errors++;
+        }
+        if (elapsed_us > s_stats.max_sample_us) {
+            s_stats.max_sample_us = elapsed_us;
+        }
+        taskEXIT_CRITICAL(&s_lock);
+    }
+}
+
+/**
+ * @brief Configuration change callback: pick up new filter, range and period
+ */
+static void config_changed(uint32_t changed_fields, const system_config_t *config, void *arg)
+{
+    pipeline_params_t params = params_from_config(config);
+
+    taskENTER_CRITICAL(&s_lock);
+    bool restart = params.interval_us != s_params.interval_us && s_fixed_interval_us == 0;
+    s_params = params;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (restart) {
+        sample_timer_restart();
+    }
+}
+
+static esp_err_t set_source(const char *name, measurement_source_t source, void *ctx, uint32_t fixed_interval_us)
+{
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    s_source_name = source != NULL ? name : "none";
+    s_source = source;
+    s_source_ctx = ctx;
+    s_fixed_interval_us = fixed_interval_us;
+    s_stats.source = s_source_name;
+    taskEXIT_CRITICAL(&s_lock);
+
+    sample_timer_restart();
+    return ESP_OK;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+esp_err_t measurement_init(void)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    system_config_t config;
+    esp_err_t ret = config_get_current(&config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    s_params = params_from_config(&config);
+    s_stats.source = s_source_name;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = sample_timer_callback,
+        .name = "measure",
+    };
+    if (esp_timer_create(&timer_args, &s_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create sample timer");
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(sampler_task, "measure", MEASUREMENT_TASK_STACK_SIZE, NULL,
+                    MEASUREMENT_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create sampler task");
+        esp_timer_delete(s_timer);
+        s_timer = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ret = config_subscribe(CONFIG_FIELDS_PIPELINE, config_changed, NULL, NULL, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to subscribe to configuration changes: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+#ifdef CONFIG_EMULATOR_MOCK_DATA
+    return set_source("mock", measurement_mock_read, NULL, CONFIG_MEASUREMENT_MOCK_INTERVAL_US);
+#else
+    ESP_LOGI(TAG, "Pipeline ready, waiting for a distance source");
+    return ESP_OK;
+#endif
+}
+
+esp_err_t measurement_set_source(const char *name, measurement_source_t source, void *ctx)
+{
+    return set_source(name, source, ctx, 0);
+}
+
+esp_err_t measurement_get_latest(measurement_t *sample)
+{
+    // The newest slot is only overwritten a full ring later; retry if we raced it
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint32_t seq = __atomic_load_n(&s_last_seq, __ATOMIC_ACQUIRE);
+        if (seq == 0) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (ring_copy(seq, sample)) {
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+void measurement_reader_init(measurement_reader_t *reader)
+{
+    reader->next_seq = __atomic_load_n(&s_last_seq, __ATOMIC_ACQUIRE) + 1;
+    reader->dropped = 0;
+}
+
+size_t measurement_read(measurement_reader_t *reader, measurement_t *samples, size_t max)
+{
+    size_t count = 0;
+    uint32_t last = __atomic_load_n(&s_last_seq, __ATOMIC_ACQUIRE);
+
+    while (count < max && (int32_t)(last - reader->next_seq) >= 0) {
+        uint32_t behind = last - reader->next_seq + 1;
+        if (behind > MEASUREMENT_RING_SIZE) {
+            // Overwritten while we were away: continue with the oldest sample still held
+            reader->dropped += behind - MEASUREMENT_RING_SIZE;
+            reader->next_seq = last - MEASUREMENT_RING_SIZE + 1;
+        }
+        if (ring_copy(reader->next_seq, &samples[count])) {
+            count++;
+        } else {
+            // The sampler lapped us on this slot; never wait for it
+            reader->dropped++;
+        }
+        reader->next_seq++;
+    }
+    return count;
+}
+
+void measurement_get_stats(measurement_stats_t *stats)
+{
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+const char *measurement_status_str(measurement_status_t status)
+{
+    switch (status) {
+        case MEASUREMENT_OK:           return "ok";
+        case MEASUREMENT_TIMEOUT:      return "timeout";
+        case MEASUREMENT_OUT_OF_RANGE: return "out_of_range";
+        case MEASUREMENT_NO_ECHO:      return "no_echo";
+        default:                       return "invalid";
+    }
+}
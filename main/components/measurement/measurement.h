@@ -0,0 +1,185 @@
+/**
+ * @file measurement.h
+ * @brief Distance measurement pipeline: sampler, EMA filter and sample ring
+ *
+ * A sampler task reads the registered distance source at a fixed rate,
+ * smooths valid readings with a fixed-point exponential moving average
+ * (smoothing_factor from the configuration), maps them onto the LED strip
+ * (distance_min_mm..distance_max_mm onto led_count LEDs) and appends every
+ * sample to a ring buffer. Consumers read the ring without locks:
+ *
+ *     measurement_reader_t reader;
+ *     measurement_reader_init(&reader);
+ *     ...
+ *     measurement_t samples[16];
+ *     size_t n = measurement_read(&reader, samples, 16);
+ *
+ * There is one writer (the sampler task) and any number of readers, each
+ * with its own cursor. A reader that falls more than MEASUREMENT_RING_SIZE
+ * samples behind skips the overwritten samples and counts them as dropped;
+ * the sampler never waits for a consumer. A consumer polling every P ms
+ * keeps up with a sample period of T ms while P / T stays well below the
+ * ring size.
+ *
+ * SOURCES:
+ * - Hardware drivers register a read function with measurement_set_source();
+ *   the sampler then runs every measurement_interval_ms
+ * - With CONFIG_EMULATOR_MOCK_DATA a simulated target is sampled every
+ *   CONFIG_MEASUREMENT_MOCK_INTERVAL_US, far faster than the configurable
+ *   minimum, to load-test the sample-to-dashboard path
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEASUREMENT_RING_SIZE 128       ///< Samples kept in the ring (power of two)
+#define MEASUREMENT_LED_NONE  (-1)      ///< LED index of samples outside the range
+
+/**
+ * @brief Result of one reading
+ *
+ * The names match the "status" strings returned by measurement_status_str()
+ * and shown by the dashboard.
+ */
+typedef enum {
+    MEASUREMENT_OK = 0,             ///< Valid distance
+    MEASUREMENT_TIMEOUT,            ///< Sensor did not answer within sensor_timeout_ms
+    MEASUREMENT_OUT_OF_RANGE,       ///< Distance outside distance_min_mm..distance_max_mm
+    MEASUREMENT_NO_ECHO,            ///< Nothing in front of the sensor
+    MEASUREMENT_INVALID,            ///< Reading failed
+} measurement_status_t;
+
+/**
+ * @brief One sample as stored in the ring
+ */
+typedef struct {
+    uint32_t seq;                   ///< Sample number, starting at 1
+    int64_t timestamp_us;           ///< esp_timer time of the reading
+    uint16_t raw_mm;                ///< Distance as read (0 unless status is OK or OUT_OF_RANGE)
+    uint16_t filtered_mm;           ///< EMA of the valid readings so far
+    int16_t led_index;              ///< LED for filtered_mm, MEASUREMENT_LED_NONE if not OK
+    uint8_t status;                 ///< measurement_status_t
+} measurement_t;
+
+/**
+ * @brief Distance source
+ *
+ * Called on the sampler task once per sample. Must not block longer than
+ * the sensor timeout.
+ *
+ * @param ctx Context given to measurement_set_source()
+ * @param[out] distance_mm Distance read (set for MEASUREMENT_OK and OUT_OF_RANGE)
+ * @return Reading status; range checking is done by the pipeline
+ */
+typedef measurement_status_t (*measurement_source_t)(void *ctx, uint16_t *distance_mm);
+
+/**
+ * @brief Consumer cursor into the sample ring
+ */
+typedef struct {
+    uint32_t next_seq;              ///< Next sample to read
+    uint32_t dropped;               ///< Samples overwritten before they were read
+} measurement_reader_t;
+
+/**
+ * @brief Pipeline statistics
+ */
+typedef struct {
+    bool running;                   ///< A source is registered and sampled
+    const char *source;             ///< Source name ("mock", "sensor" or "none")
+    uint32_t interval_us;           ///< Sample period
+    uint32_t samples;               ///< Samples produced
+    uint32_t errors;                ///< Samples with a status other than OK
+    uint32_t late_ticks;            ///< Periods that started before the previous sample finished
+    uint32_t max_sample_us;         ///< Longest read + filter + publish
+} measurement_stats_t;
+
+/**
+ * @brief Create the sampler task and start sampling the mock source if enabled
+ *
+ * Reads the filter and range parameters from the configuration manager and
+ * follows later changes. Requires config_init().
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task or timer cannot be
+ *         created, or the error of the configuration subscription
+ */
+esp_err_t measurement_init(void);
+
+/**
+ * @brief Register the distance source and start sampling
+ *
+ * Replaces the current source. The sampler runs every
+ * measurement_interval_ms of the configuration.
+ *
+ * @param name Source name for statistics (static string)
+ * @param source Read function, NULL to stop sampling
+ * @param ctx Context passed to @p source
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before measurement_init()
+ */
+esp_err_t measurement_set_source(const char *name, measurement_source_t source, void *ctx);
+
+/**
+ * @brief Get the newest sample
+ *
+ * @param[out] sample Newest sample
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no sample was produced yet
+ */
+esp_err_t measurement_get_latest(measurement_t *sample);
+
+/**
+ * @brief Start a reader at the newest sample
+ *
+ * The first measurement_read() returns samples produced after this call.
+ */
+void measurement_reader_init(measurement_reader_t *reader);
+
+/**
+ * @brief Read the samples produced since the last read
+ *
+ * Never blocks. Safe to call from any task; each reader must only be used
+ * by one task at a time.
+ *
+ * @param reader Cursor, advanced past the returned samples
+ * @param[out] samples Oldest unread samples first
+ * @param max Capacity of @p samples
+ * @return Number of samples copied
+ */
+size_t measurement_read(measurement_reader_t *reader, measurement_t *samples, size_t max);
+
+/**
+ * @brief Get pipeline statistics
+ */
+void measurement_get_stats(measurement_stats_t *stats);
+
+/**
+ * @brief Status name as used in the JSON API ("ok", "timeout", ...)
+ */
+const char *measurement_status_str(measurement_status_t status);
+
+#ifdef CONFIG_EMULATOR_MOCK_DATA
+/**
+ * @brief Simulated distance source (measurement_mock.c)
+ *
+ * A target moving back and forth across the configured range with sensor
+ * noise and occasional timeouts and missing echoes.
+ *
+ * @param ctx Unused
+ */
+measurement_status_t measurement_mock_read(void *ctx, uint16_t *distance_mm);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,257 @@
+/**
+ * @file measurement_history.c
+ * @brief Delta-encoded, downsampled measurement history
+ *
+ * The sampler task appends under a short critical section; readers copy a
+ * whole tier (at most MEASUREMENT_HISTORY_TIER_BYTES) under the same lock and
+ * decode the copy, so a slow HTTP client never holds up the sampler.
+ *
+ * Each tier keeps the value of the point before its oldest one as the base
+ * for decoding; dropping the oldest point decodes it into the new base.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "measurement_history.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+#define HISTORY_ESCAPE    0x80      // Followed by the absolute value, little endian
+#define HISTORY_MAX_DELTA 127
+#define HISTORY_MAX_GAPS  (MEASUREMENT_HISTORY_TIER_BYTES / 3)  // Escaped gaps that fill a tier
+
+/**
+ * @brief One tier: byte ring of encoded points and its aggregation state
+ */
+typedef struct {
+    uint8_t data[MEASUREMENT_HISTORY_TIER_BYTES];
+    size_t head;                    ///< Offset of the oldest point
+    size_t len;                     ///< Encoded bytes in use
+    size_t count;                   ///< Points stored
+    uint16_t base;                  ///< Value of the point before the oldest one
+    uint16_t last;                  ///< Value of the newest point
+    uint32_t period_us;             ///< Time between points
+    int64_t end_us;                 ///< Time of the newest point
+    int64_t interval;               ///< Interval being aggregated (1 s and 1 min tiers), -1 before the first
+    uint32_t sum;                   ///< Sum of the valid values in the interval
+    uint32_t samples;               ///< Number of valid values in the interval
+} history_tier_t;
+
+#define HISTORY_TIER_INIT(period) { .base = MEASUREMENT_HISTORY_GAP, .last = MEASUREMENT_HISTORY_GAP, \
+                                    .period_us = (period), .interval = -1 }
+
+static history_tier_t s_tiers[MEASUREMENT_HISTORY_TIER_COUNT] = {
+    [MEASUREMENT_HISTORY_RAW]    = HISTORY_TIER_INIT(0),
+    [MEASUREMENT_HISTORY_SECOND] = HISTORY_TIER_INIT(1000000),
+    [MEASUREMENT_HISTORY_MINUTE] = HISTORY_TIER_INIT(60000000),
+};
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =============================================================================
+// Encoding
+// =============================================================================
+
+static inline uint8_t tier_byte(const history_tier_t *tier, size_t offset)
+{
+    return tier->data[(tier->head + offset) % MEASUREMENT_HISTORY_TIER_BYTES];
+}
+
+static void tier_clear(history_tier_t *tier)
+{
+    tier->head = 0;
+    tier->len = 0;
+    tier->count = 0;
+    tier->base = MEASUREMENT_HISTORY_GAP;
+    tier->last = MEASUREMENT_HISTORY_GAP;
+}
+
+/**
+ * @brief Drop the oldest point, making its value the new base
+ */
+static void tier_drop_oldest(history_tier_t *tier)
+{
+    uint8_t first = tier_byte(tier, 0);
+    size_t size = 1;
+    if (first == HISTORY_ESCAPE) {
+        tier->base = (uint16_t)(tier_byte(tier, 1) | (tier_byte(tier, 2) << 8));
+        size = 3;
+    } else {
+        tier->base = (uint16_t)(tier->base + (int8_t)first);
+    }
+    tier->head = (tier->head + size) % MEASUREMENT_HISTORY_TIER_BYTES;
+    tier->len -= size;
+    tier->count--;
+}
+
+static void tier_append(history_tier_t *tier, uint16_t value)
+{
+    uint8_t encoded[3];
+    size_t size;
+    int32_t delta = (int32_t)value - tier->last;
+    if (value != MEASUREMENT_HISTORY_GAP && tier->last != MEASUREMENT_HISTORY_GAP &&
+        delta >= -HISTORY_MAX_DELTA && delta <= HISTORY_MAX_DELTA) {
+        encoded[0] = (uint8_t)(int8_t)delta;
+        size = 1;
+    } else {
+        encoded[0] = HISTORY_ESCAPE;
+        encoded[1] = (uint8_t)(value & 0xFF);
+        encoded[2] = (uint8_t)(value >> 8);
+        size = 3;
+    }
+
+    while (tier->len + size > MEASUREMENT_HISTORY_TIER_BYTES) {
+        tier_drop_oldest(tier);
+    }
+    for (size_t i = 0; i < size; i++) {
+        tier->data[(tier->head + tier->len + i) % MEASUREMENT_HISTORY_TIER_BYTES] = encoded[i];
+    }
+    tier->len += size;
+    tier->count++;
+    tier->last = value;
+}
+
+// =============================================================================
+// Downsampling
+// =============================================================================
+
+static void tier_accumulate(measurement_history_tier_t index, int64_t time_us, uint16_t value);
+
+/**
+ * @brief Store the mean of the interval being aggregated and pass it on
+ */
+static void tier_close_interval(measurement_history_tier_t index)
+{
+    history_tier_t *tier = &s_tiers[index];
+    uint16_t mean = tier->samples > 0
+                        ? (uint16_t)((tier->sum + tier->samples / 2) / tier->samples)
+                        : MEASUREMENT_HISTORY_GAP;
+    tier_append(tier, mean);
+    tier->end_us = tier->interval * tier->period_us;
+    tier->sum = 0;
+    tier->samples = 0;
+
+    if (index + 1 < MEASUREMENT_HISTORY_TIER_COUNT) {
+        tier_accumulate(index + 1, tier->end_us, mean);
+    }
+}
+
+/**
+ * @brief Add a value to the interval of an aggregated tier containing @p time_us
+ */
+static void tier_accumulate(measurement_history_tier_t index, int64_t time_us, uint16_t value)
+{
+    history_tier_t *tier = &s_tiers[index];
+    int64_t interval = time_us / tier->period_us;
+
+    if (tier->interval < 0) {
+        tier->interval = interval;
+    }
+    if (interval > tier->interval) {
+        tier_close_interval(index);
+
+        // Intervals without any sample become gaps; the tier after them sees
+        // the jump in time and fills its own gaps
+        int64_t skipped = interval - tier->interval - 1;
+        if (skipped >= HISTORY_MAX_GAPS) {
+            tier_clear(tier);
+        } else if (skipped > 0) {
+            for (int64_t i = 0; i < skipped; i++) {
+                tier_append(tier, MEASUREMENT_HISTORY_GAP);
+            }
+            tier->end_us = (interval - 1) * tier->period_us;
+        }
+        tier->interval = interval;
+    }
+
+    if (value != MEASUREMENT_HISTORY_GAP) {
+        tier->sum += value;
+        tier->samples++;
+    }
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void measurement_history_add(const measurement_t *sample, uint32_t interval_us)
+{
+    uint16_t value = sample->status == MEASUREMENT_OK ? sample->filtered_mm : MEASUREMENT_HISTORY_GAP;
+
+    taskENTER_CRITICAL(&s_lock);
+    history_tier_t *raw = &s_tiers[MEASUREMENT_HISTORY_RAW];
+    if (raw->period_us != interval_us) {
+        // Points of the raw tier are spaced by the period; start over when it changes
+        tier_clear(raw);
+        raw->period_us = interval_us;
+    }
+    tier_append(raw, value);
+    raw->end_us = sample->timestamp_us;
+
+    tier_accumulate(MEASUREMENT_HISTORY_SECOND, sample->timestamp_us, value);
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t measurement_history_snapshot(measurement_history_tier_t tier, uint8_t *buf, size_t size,
+                                       measurement_history_info_t *info,
+                                       measurement_history_cursor_t *cursor)
+{
+    if (tier >= MEASUREMENT_HISTORY_TIER_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (size < MEASUREMENT_HISTORY_TIER_BYTES) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const history_tier_t *source = &s_tiers[tier];
+    taskENTER_CRITICAL(&s_lock);
+    size_t first = MEASUREMENT_HISTORY_TIER_BYTES - source->head;
+    if (first > source->len) {
+        first = source->len;
+    }
+    memcpy(buf, &source->data[source->head], first);
+    memcpy(buf + first, source->data, source->len - first);
+    info->period_us = source->period_us;
+    info->end_us = source->end_us;
+    info->count = source->count;
+    info->bytes = source->len;
+    cursor->value = source->base;
+    taskEXIT_CRITICAL(&s_lock);
+
+    cursor->data = buf;
+    cursor->len = info->bytes;
+    cursor->pos = 0;
+    return ESP_OK;
+}
+
+bool measurement_history_next(measurement_history_cursor_t *cursor, uint16_t *value)
+{
+    if (cursor->pos >= cursor->len) {
+        return false;
+    }
+
+    uint8_t first = cursor->data[cursor->pos];
+    if (first == HISTORY_ESCAPE) {
+        if (cursor->pos + 3 > cursor->len) {
+            return false;
+        }
+        cursor->value = (uint16_t)(cursor->data[cursor->pos + 1] | (cursor->data[cursor->pos + 2] << 8));
+        cursor->pos += 3;
+    } else {
+        cursor->value = (uint16_t)(cursor->value + (int8_t)first);
+        cursor->pos++;
+    }
+    *value = cursor->value;
+    return true;
+}
+
+const char *measurement_history_tier_str(measurement_history_tier_t tier)
+{
+    switch (tier) {
+        case MEASUREMENT_HISTORY_RAW:    return "raw";
+        case MEASUREMENT_HISTORY_SECOND: return "1s";
+        case MEASUREMENT_HISTORY_MINUTE: return "1m";
+        default:                         return "unknown";
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * @file measurement_history.h
+ * @brief Fixed-size in-RAM time series of filtered distances
+ *
+ * Every sample of the measurement pipeline is appended to three tiers:
+ *
+ * - raw: every sample, at the sampler period
+ * - 1 s: mean of the valid samples of each second
+ * - 1 min: mean of the valid 1 s points of each minute
+ *
+ * Each tier is a byte ring of MEASUREMENT_HISTORY_TIER_BYTES. Points are
+ * delta encoded: one signed byte for a change of up to ±127 mm, or an escape
+ * byte followed by the absolute 16-bit value (always used after a gap). A
+ * slowly moving target therefore costs one byte per point, and the oldest
+ * points are dropped when a tier is full. Points without a valid reading are
+ * stored as MEASUREMENT_HISTORY_GAP.
+ *
+ * Readers take a snapshot of a tier and decode it outside the lock:
+ *
+ *     measurement_history_cursor_t cursor;
+ *     measurement_history_snapshot(MEASUREMENT_HISTORY_SECOND, buf, sizeof(buf), &info, &cursor);
+ *     uint16_t value;
+ *     while (measurement_history_next(&cursor, &value)) { ... }
+ *
+ * Point i of n (oldest first) belongs to
+ * info.end_us - (n - 1 - i) * info.period_us.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "measurement.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEASUREMENT_HISTORY_TIER_BYTES 1024     ///< Encoded size of each tier
+#define MEASUREMENT_HISTORY_GAP        0xFFFF   ///< Point without a valid reading
+
+/**
+ * @brief Downsampling tiers
+ */
+typedef enum {
+    MEASUREMENT_HISTORY_RAW = 0,    ///< Every sample
+    MEASUREMENT_HISTORY_SECOND,     ///< One point per second
+    MEASUREMENT_HISTORY_MINUTE,     ///< One point per minute
+    MEASUREMENT_HISTORY_TIER_COUNT
+} measurement_history_tier_t;
+
+/**
+ * @brief Snapshot description
+ */
+typedef struct {
+    uint32_t period_us;             ///< Time between points
+    int64_t end_us;                 ///< Time of the newest point (start of its interval for 1 s and 1 min)
+    size_t count;                   ///< Points in the snapshot
+    size_t bytes;                   ///< Encoded size of the snapshot
+} measurement_history_info_t;
+
+/**
+ * @brief Decoder over a snapshot
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    uint16_t value;                 ///< Value of the previous point
+} measurement_history_cursor_t;
+
+/**
+ * @brief Append a pipeline sample to all tiers
+ *
+ * Called by the sampler task for every sample.
+ *
+ * @param sample Sample; only the filtered distance of MEASUREMENT_OK samples is stored
+ * @param interval_us Current sampler period (the raw tier is cleared when it changes)
+ */
+void measurement_history_add(const measurement_t *sample, uint32_t interval_us);
+
+/**
+ * @brief Copy one tier for decoding
+ *
+ * @param tier Tier to copy
+ * @param buf Buffer for the encoded points, at least MEASUREMENT_HISTORY_TIER_BYTES
+ * @param size Size of @p buf
+ * @param[out] info Period, end time and size of the snapshot
+ * @param[out] cursor Decoder positioned before the oldest point
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown tier,
+ *         ESP_ERR_INVALID_SIZE if @p buf is too small
+ */
+esp_err_t measurement_history_snapshot(measurement_history_tier_t tier, uint8_t *buf, size_t size,
+                                       measurement_history_info_t *info,
+                                       measurement_history_cursor_t *cursor);
+
+/**
+ * @brief Decode the next point of a snapshot
+ *
+ * @param cursor Decoder from measurement_history_snapshot()
+ * @param[out] value Distance in mm, or MEASUREMENT_HISTORY_GAP
+ * @return false after the newest point
+ */
+bool measurement_history_next(measurement_history_cursor_t *cursor, uint16_t *value);
+
+/**
+ * @brief Tier name as used in the HTTP API ("raw", "1s", "1m")
+ */
+const char *measurement_history_tier_str(measurement_history_tier_t tier);
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,10 +7,15 @@
  * requiring network device emulation.
  * 
  * Implementation Details:
- * - UART1 configured at 115200 baud (can be increased for better throughput)
- * - RX task reads frames from UART and injects into lwIP
- * - TX path: lwIP calls output function, we send to UART
- * - Simple framing: [LENGTH:2][DATA:N]
+ * - UART1 baud rate set by CONFIG_UART_TUNNEL_BAUD_RATE
+ * - RX task is woken by UART driver events, drains every buffered frame per
+ *   burst and reads them straight into pooled pbufs (no intermediate copy)
+ * - TX path: lwIP calls output function, pbuf segments are written to UART
+ *   without heap allocation (small segments coalesced with the header)
+ * - Framing v2: [SYNC:2][LENGTH:2][DATA:N][CRC16:2] (see header)
+ * - Corrupt or truncated frames are pushed back into a small backlog and
+ *   rescanned for the next sync marker, so buffered frames behind line
+ *   noise are not lost
  * 
  * @author ESP32 Distance Project
  * @date 2025
@@ -21,152 +26,565 @@
 #include "esp_netif.h"
 #include "esp_netif_net_stack.h"
 #include "esp_event.h"
+#include "esp_timer.h"
 #include "driver/uart.h"
+#ifdef CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "lwip/netif.h"
 #include "lwip/pbuf.h"
 #include "lwip/etharp.h"
 #include "lwip/err.h"
 #include "lwip/tcpip.h"
+#include "sdkconfig.h"
 #include <string.h>
 #include <stdlib.h>
 
 static const char *TAG = "netif_uart_tunnel";
 
-// Debug counters
-static uint32_t s_rx_count = 0;
-static uint32_t s_tx_count = 0;
+// Traffic statistics (see netif_uart_tunnel_get_stats)
+static netif_uart_tunnel_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;  // Guards the latency histograms
+static const uint32_t s_latency_bounds_us[] = NETIF_UART_TUNNEL_LATENCY_BOUNDS_US;
 
 // UART configuration
 #define UART_NUM UART_NUM_1
 #define UART_TX_PIN 17
 #define UART_RX_PIN 16
-#define UART_BAUD_RATE 115200
-#define UART_BUF_SIZE 2048
-
-// Framing protocol
-#define MAX_FRAME_SIZE 1500  // Standard MTU
-#define FRAME_HEADER_SIZE 2  // 2 bytes for length
+#ifdef CONFIG_UART_TUNNEL_BAUD_RATE
+#define UART_BAUD_RATE CONFIG_UART_TUNNEL_BAUD_RATE
+#else
+#define UART_BAUD_RATE 921600
+#endif
+#define UART_RX_BUF_SIZE 8192       // Holds a full TCP window of frames
+#define UART_TX_BUF_SIZE 4096
+#define UART_EVENT_QUEUE_SIZE 20
+
+// Framing protocol (v2, see netif_uart_tunnel_sim.h)
+#define MAX_FRAME_SIZE NETIF_UART_TUNNEL_MAX_FRAME
+#define FRAME_HEADER_SIZE 4         // Sync marker (2) + length (2)
+#define FRAME_CRC_SIZE 2
+#define FRAME_WIRE_MAX (FRAME_HEADER_SIZE + MAX_FRAME_SIZE + FRAME_CRC_SIZE)
 
 // Task configuration
 #define RX_TASK_STACK_SIZE 4096
 #define RX_TASK_PRIORITY 2  // Lower than display_logic (3) to avoid blocking
-#define UART_READ_TIMEOUT_MS 100  // Timeout for uart_read_bytes
+#define RX_FRAME_TIMEOUT_MS 100     // Max gap inside a frame before it is rescanned
+
+// RX buffer pool
+#define RX_POOL_SIZE 8              // Frames lwIP may hold at once (TCP window is 4 segments)
+#define RX_POOL_WAIT_MS 1000        // Max wait for lwIP to release a buffer before dropping
+#define RX_DISCARD_CHUNK 64         // Stack buffer used to drain dropped frames
+
+// TX staging (header and small pbuf segments are coalesced into one write)
+#define TX_STAGE_SIZE 256           // Fits header + Ethernet/IP/TCP headers or a bare ACK
+#define TX_DIRECT_MIN 128           // Segments this large are written straight from the pbuf
+
+/**
+ * @brief Preallocated RX buffer handed to lwIP as a custom pbuf
+ *
+ * The pbuf_custom header must stay the first member: lwIP passes the pbuf
+ * pointer back to rx_pool_free_pbuf(), which casts it to the slot.
+ */
+typedef struct rx_slot {
+    struct pbuf_custom pbuf;
+    struct rx_slot *next;
+    uint8_t data[MAX_FRAME_SIZE];
+} rx_slot_t;
 
 // Module state
 static esp_netif_t *s_netif_handle = NULL;
 static TaskHandle_t s_rx_task_handle = NULL;
+static QueueHandle_t s_uart_queue = NULL;
 static bool s_initialized = false;
 static esp_netif_driver_base_t *s_driver_base = NULL;
+#ifdef CONFIG_PM_ENABLE
+// Held while the tunnel is up: the UART runs from APB, and bytes arriving in
+// light sleep would be lost
+static esp_pm_lock_handle_t s_pm_apb_lock = NULL;
+static esp_pm_lock_handle_t s_pm_awake_lock = NULL;
+#endif
+
+// RX pool state (free list guarded by spinlock, counting semaphore tracks free slots)
+static rx_slot_t s_rx_slots[RX_POOL_SIZE];
+static rx_slot_t *s_rx_free_list = NULL;
+static portMUX_TYPE s_rx_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+static StaticSemaphore_t s_rx_pool_sem_buffer;
+static SemaphoreHandle_t s_rx_pool_sem = NULL;
+
+// RX backlog - bytes of a rejected frame waiting to be rescanned (RX task only).
+// A rejected frame never holds more than one wire frame of unread data, so one
+// frame of space is enough.
+static uint8_t s_rx_backlog[FRAME_WIRE_MAX];
+static size_t s_rx_backlog_len = 0;
+static size_t s_rx_backlog_pos = 0;
+
+// TX staging buffer - only touched from netif_linkoutput() in tcpip_thread
+static uint8_t s_tx_stage[TX_STAGE_SIZE];
+static size_t s_tx_staged = 0;
+
+// ============================================================================
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+// ============================================================================
+
+static const uint16_t s_crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
 
 /**
- * @brief UART RX task - receives frames and injects into lwIP
+ * @brief Feed bytes into a running CRC (nibble table, 32 bytes of rodata)
  */
-static void uart_rx_task(void *arg)
+static uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len)
 {
-    uint8_t *frame_buffer = malloc(MAX_FRAME_SIZE + FRAME_HEADER_SIZE);
-    if (frame_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate RX buffer");
-        vTaskDelete(NULL);
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+/**
+ * @brief Add one frame latency sample to a histogram
+ */
+static void stats_record_latency(netif_uart_tunnel_latency_t *hist, int64_t start_us)
+{
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - start_us);
+    size_t bucket = 0;
+
+    while (bucket < sizeof(s_latency_bounds_us) / sizeof(s_latency_bounds_us[0]) &&
+           latency_us >= s_latency_bounds_us[bucket]) {
+        bucket++;
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    hist->buckets[bucket]++;
+    hist->total_us += latency_us;
+    if (latency_us > hist->max_us) {
+        hist->max_us = latency_us;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+// ============================================================================
+// RX Buffer Pool
+// ============================================================================
+
+/**
+ * @brief Return a slot to the free list
+ *
+ * Called from whichever task frees the pbuf (normally tcpip_thread).
+ */
+static void rx_pool_put(rx_slot_t *slot)
+{
+    taskENTER_CRITICAL(&s_rx_pool_lock);
+    slot->next = s_rx_free_list;
+    s_rx_free_list = slot;
+    taskEXIT_CRITICAL(&s_rx_pool_lock);
+    xSemaphoreGive(s_rx_pool_sem);
+}
+
+/**
+ * @brief Take a free slot, waiting up to @p timeout for lwIP to release one
+ *
+ * @return Slot or NULL if the pool stayed exhausted
+ */
+static rx_slot_t *rx_pool_get(TickType_t timeout)
+{
+    if (xSemaphoreTake(s_rx_pool_sem, timeout) != pdTRUE) {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL(&s_rx_pool_lock);
+    rx_slot_t *slot = s_rx_free_list;
+    s_rx_free_list = slot->next;
+    taskEXIT_CRITICAL(&s_rx_pool_lock);
+
+    slot->next = NULL;
+    return slot;
+}
+
+/**
+ * @brief lwIP custom pbuf free callback - returns the buffer to the pool
+ */
+static void rx_pool_free_pbuf(struct pbuf *p)
+{
+    rx_pool_put((rx_slot_t *)p);
+}
+
+/**
+ * @brief Build the free list on first use
+ *
+ * The pool and its semaphore are static and survive deinit: pbufs still
+ * queued inside lwIP return their slots whenever they are released.
+ */
+static void rx_pool_init(void)
+{
+    if (s_rx_pool_sem != NULL) {
         return;
     }
 
-    ESP_LOGI(TAG, "UART RX task started");
-    
-    // Flush any garbage data in UART buffer
-    uart_flush(UART_NUM);
-    ESP_LOGI(TAG, "UART buffer flushed, waiting for stable connection...");
-    //TODO: why is here a task delay?
-    vTaskDelay(pdMS_TO_TICKS(1000));  // Wait 1 second for things to settle
+    s_rx_pool_sem = xSemaphoreCreateCountingStatic(RX_POOL_SIZE, RX_POOL_SIZE,
+                                                   &s_rx_pool_sem_buffer);
+    s_rx_free_list = NULL;
+    for (int i = RX_POOL_SIZE - 1; i >= 0; i--) {
+        s_rx_slots[i].pbuf.custom_free_function = rx_pool_free_pbuf;
+        s_rx_slots[i].next = s_rx_free_list;
+        s_rx_free_list = &s_rx_slots[i];
+    }
+}
 
-    while (1) {
-        // Read frame length (2 bytes, big-endian) with timeout
-        uint8_t len_buf[2];
-        int len = uart_read_bytes(UART_NUM, len_buf, 2, pdMS_TO_TICKS(UART_READ_TIMEOUT_MS));
-        
-        if (len != 2) {
-            // No data or timeout - yield to other tasks
-            vTaskDelay(pdMS_TO_TICKS(10));
-            continue;
+// ============================================================================
+// RX Stream Reader
+// ============================================================================
+
+/**
+ * @brief Check whether unparsed bytes are waiting in the backlog or UART
+ */
+static bool rx_data_available(void)
+{
+    size_t buffered = 0;
+
+    if (s_rx_backlog_pos < s_rx_backlog_len) {
+        return true;
+    }
+    return uart_get_buffered_data_len(UART_NUM, &buffered) == ESP_OK && buffered > 0;
+}
+
+/**
+ * @brief Read stream bytes, serving the rescan backlog before the UART
+ *
+ * @return Number of bytes read (less than @p len on timeout)
+ */
+static size_t rx_read(uint8_t *dst, size_t len, TickType_t timeout)
+{
+    size_t got = 0;
+
+    if (s_rx_backlog_pos < s_rx_backlog_len) {
+        size_t avail = s_rx_backlog_len - s_rx_backlog_pos;
+        got = (len < avail) ? len : avail;
+        memcpy(dst, s_rx_backlog + s_rx_backlog_pos, got);
+        s_rx_backlog_pos += got;
+    }
+
+    if (got < len) {
+        int n = uart_read_bytes(UART_NUM, dst + got, len - got, timeout);
+        if (n > 0) {
+            got += n;
         }
+    }
 
-        uint16_t frame_len = (len_buf[0] << 8) | len_buf[1];
-        
-        if (frame_len == 0 || frame_len > MAX_FRAME_SIZE) {
-            ESP_LOGW(TAG, "Invalid frame length: %d - flushing UART to resync", frame_len);
-            uart_flush(UART_NUM);
-            vTaskDelay(pdMS_TO_TICKS(100));  // Wait a bit before trying again
-            continue;
+    return got;
+}
+
+/**
+ * @brief Push the bytes of a rejected frame back for rescanning
+ *
+ * Called with everything after the first sync byte of the rejected frame.
+ * The pieces are placed in front of any backlog bytes not read yet, so the
+ * stream order is preserved and the next sync marker is found in place.
+ */
+static void rx_unread(const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len,
+                      const uint8_t *c, size_t c_len)
+{
+    size_t remaining = s_rx_backlog_len - s_rx_backlog_pos;
+    size_t total = a_len + b_len + c_len;
+
+    if (total + remaining > sizeof(s_rx_backlog)) {
+        // Cannot happen with the framing limits; drop instead of overflowing
+        ESP_LOGW(TAG, "RX: Backlog overflow - dropping %d bytes", (int)(total + remaining));
+        s_rx_backlog_len = 0;
+        s_rx_backlog_pos = 0;
+        return;
+    }
+
+    memmove(s_rx_backlog + total, s_rx_backlog + s_rx_backlog_pos, remaining);
+    memcpy(s_rx_backlog, a, a_len);
+    memcpy(s_rx_backlog + a_len, b, b_len);
+    memcpy(s_rx_backlog + a_len + b_len, c, c_len);
+    s_rx_backlog_len = total + remaining;
+    s_rx_backlog_pos = 0;
+}
+
+/**
+ * @brief Drain a frame that could not be buffered
+ *
+ * Keeps the stream aligned on the next frame when the pool is exhausted.
+ */
+static void rx_discard(size_t len)
+{
+    uint8_t scratch[RX_DISCARD_CHUNK];
+
+    while (len > 0) {
+        size_t chunk = (len < sizeof(scratch)) ? len : sizeof(scratch);
+        size_t got = rx_read(scratch, chunk, pdMS_TO_TICKS(RX_FRAME_TIMEOUT_MS));
+        if (got == 0) {
+            return;
         }
-        
-        ESP_LOGD(TAG, "RX: Got valid length header: %d bytes", frame_len);
+        len -= got;
+    }
+}
 
-        // Read frame data
-        len = uart_read_bytes(UART_NUM, frame_buffer, frame_len, pdMS_TO_TICKS(1000));
-        
-        if (len != frame_len) {
-            ESP_LOGW(TAG, "Failed to read complete frame: got %d, expected %d", len, frame_len);
-            continue;
+// ============================================================================
+// RX / TX Path
+// ============================================================================
+
+/**
+ * @brief Hand a complete frame to lwIP
+ *
+ * Ownership of @p slot passes to lwIP, which returns it through
+ * rx_pool_free_pbuf() once the packet has been processed.
+ */
+static void rx_deliver(rx_slot_t *slot, uint16_t frame_len, int64_t start_us)
+{
+    // Dump first 64 bytes for debugging (verbose level)
+    ESP_LOGV(TAG, "RX: First bytes (hex):");
+    int dump_len = (frame_len < 64) ? frame_len : 64;
+    for (int i = 0; i < dump_len; i += 16) {
+        char hex_str[80];
+        int pos = 0;
+        for (int j = 0; j < 16 && (i + j) < dump_len; j++) {
+            pos += sprintf(hex_str + pos, "%02x ", slot->data[i + j]);
         }
+        ESP_LOGV(TAG, "  [%02d]: %s", i, hex_str);
+    }
 
-        ESP_LOGD(TAG, "RX: Complete frame received: %d bytes", frame_len);
-        
-        // Dump first 64 bytes for debugging (verbose level)
-        ESP_LOGV(TAG, "RX: First bytes (hex):");
-        int dump_len = (frame_len < 64) ? frame_len : 64;
-        for (int i = 0; i < dump_len; i += 16) {
-            char hex_str[80];
-            int pos = 0;
-            for (int j = 0; j < 16 && (i + j) < dump_len; j++) {
-                pos += sprintf(hex_str + pos, "%02x ", frame_buffer[i + j]);
+    // Get the lwIP netif from esp_netif
+    struct netif *lwip_netif = (s_netif_handle != NULL) ? esp_netif_get_netif_impl(s_netif_handle) : NULL;
+    if (lwip_netif == NULL || lwip_netif->input == NULL) {
+        ESP_LOGE(TAG, "Failed to get lwIP netif");
+        s_stats.rx_drop_netif++;
+        rx_pool_put(slot);
+        return;
+    }
+
+    // Wrap the slot in a custom pbuf; lwIP frees it via rx_pool_free_pbuf()
+    struct pbuf *p = pbuf_alloced_custom(PBUF_RAW, frame_len, PBUF_REF, &slot->pbuf,
+                                         slot->data, MAX_FRAME_SIZE);
+    if (p == NULL) {
+        ESP_LOGW(TAG, "RX: Failed to wrap frame in pbuf");
+        s_stats.rx_drop_netif++;
+        rx_pool_put(slot);
+        return;
+    }
+
+    // Hand ownership to lwIP (tcpip_input queues it for the TCP/IP thread)
+    err_t err = lwip_netif->input(p, lwip_netif);
+    if (err != ERR_OK) {
+        ESP_LOGW(TAG, "lwIP input failed: %d", err);
+        s_stats.rx_drop_netif++;
+        pbuf_free(p);
+    } else {
+        s_stats.rx_frames++;
+        s_stats.rx_bytes += frame_len;
+        stats_record_latency(&s_stats.rx_latency, start_us);
+        ESP_LOGD(TAG, "RX: Packet queued: %d bytes (count=%lu). TX count=%lu", frame_len, s_stats.rx_frames, s_stats.tx_frames);
+    }
+}
+
+/**
+ * @brief Parse one frame from the stream
+ *
+ * Bytes before a sync marker are skipped one at a time. A frame that fails
+ * the length check, arrives truncated or has a bad CRC is pushed back minus
+ * its first byte, so the scan resumes inside it instead of discarding
+ * whatever is buffered behind it.
+ */
+static void rx_process_frame(void)
+{
+    const TickType_t timeout = pdMS_TO_TICKS(RX_FRAME_TIMEOUT_MS);
+    uint8_t header[FRAME_HEADER_SIZE];
+    uint8_t crc_buf[FRAME_CRC_SIZE];
+
+    if (rx_read(header, 1, 0) != 1) {
+        return;
+    }
+    if (header[0] != NETIF_UART_TUNNEL_SYNC_0) {
+        s_stats.rx_sync_bytes_skipped++;
+        return;
+    }
+    int64_t start_us = esp_timer_get_time();
+
+    size_t got = rx_read(header + 1, FRAME_HEADER_SIZE - 1, timeout);
+    if (got != FRAME_HEADER_SIZE - 1 || header[1] != NETIF_UART_TUNNEL_SYNC_1) {
+        s_stats.rx_sync_bytes_skipped++;
+        rx_unread(header + 1, got, NULL, 0, NULL, 0);
+        return;
+    }
+
+    uint16_t frame_len = (header[2] << 8) | header[3];
+    if (frame_len == 0 || frame_len > MAX_FRAME_SIZE) {
+        ESP_LOGD(TAG, "RX: Invalid frame length %d - rescanning", frame_len);
+        s_stats.rx_drop_oversized++;
+        rx_unread(header + 1, FRAME_HEADER_SIZE - 1, NULL, 0, NULL, 0);
+        return;
+    }
+
+    // Frame data goes straight into a pool buffer that lwIP will own
+    rx_slot_t *slot = rx_pool_get(pdMS_TO_TICKS(RX_POOL_WAIT_MS));
+    if (slot == NULL) {
+        ESP_LOGW(TAG, "RX: Buffer pool exhausted - dropping %d byte frame", frame_len);
+        s_stats.rx_drop_no_buffer++;
+        rx_discard(frame_len + FRAME_CRC_SIZE);
+        return;
+    }
+
+    got = rx_read(slot->data, frame_len, timeout);
+    size_t crc_got = (got == frame_len) ? rx_read(crc_buf, FRAME_CRC_SIZE, timeout) : 0;
+    if (crc_got != FRAME_CRC_SIZE) {
+        ESP_LOGW(TAG, "RX: Truncated frame (%d/%d bytes) - rescanning", (int)(got + crc_got), frame_len + FRAME_CRC_SIZE);
+        s_stats.rx_drop_short_read++;
+        rx_unread(header + 1, FRAME_HEADER_SIZE - 1, slot->data, got, crc_buf, crc_got);
+        rx_pool_put(slot);
+        return;
+    }
+
+    // CRC covers the length field and the payload
+    uint16_t crc = crc16_update(0xFFFF, header + 2, 2);
+    crc = crc16_update(crc, slot->data, frame_len);
+    if (crc != ((crc_buf[0] << 8) | crc_buf[1])) {
+        ESP_LOGW(TAG, "RX: CRC mismatch on %d byte frame - rescanning", frame_len);
+        s_stats.rx_drop_crc++;
+        rx_unread(header + 1, FRAME_HEADER_SIZE - 1, slot->data, frame_len, crc_buf, FRAME_CRC_SIZE);
+        rx_pool_put(slot);
+        return;
+    }
+
+    rx_deliver(slot, frame_len, start_us);
+}
+
+/**
+ * @brief UART RX task - reads frames into pool pbufs and injects into lwIP
+ *
+ * Sleeps on the UART driver event queue while the line is idle. Once data
+ * arrives, every buffered frame is parsed before waiting again, so a burst
+ * of packets costs a single wakeup. Queued events are still drained between
+ * frames to catch FIFO overruns.
+ */
+static void uart_rx_task(void *arg)
+{
+    ESP_LOGI(TAG, "UART RX task started");
+    
+    // Discard anything received before the driver was ready; the sync marker
+    // realigns the stream, so no settle delay is needed
+    uart_flush_input(UART_NUM);
+
+    while (1) {
+        uart_event_t event;
+        TickType_t wait = rx_data_available() ? 0 : portMAX_DELAY;
+
+        while (xQueueReceive(s_uart_queue, &event, wait) == pdTRUE) {
+            if (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL) {
+                ESP_LOGW(TAG, "RX: UART %s - flushing input", 
+                         (event.type == UART_FIFO_OVF) ? "FIFO overflow" : "ring buffer full");
+                s_stats.uart_overruns++;
+                uart_flush_input(UART_NUM);
+                xQueueReset(s_uart_queue);
+                break;
             }
-            ESP_LOGV(TAG, "  [%02d]: %s", i, hex_str);
+            wait = 0;
         }
 
-        // Inject packet into lwIP using esp_netif_receive helper
-        if (s_netif_handle != NULL) {
-            ESP_LOGD(TAG, "RX: Injecting %d bytes into lwIP via esp_netif_receive...", frame_len);
-            
-            // Get the lwIP netif from esp_netif
-            struct netif *lwip_netif = esp_netif_get_netif_impl(s_netif_handle);
-            if (lwip_netif == NULL) {
-                ESP_LOGE(TAG, "Failed to get lwIP netif");
-                continue;
-            }
-            
-            // Debug: Check netif state
-            ESP_LOGV(TAG, "RX: netif flags=0x%02x, up=%d, link_up=%d", 
-                     lwip_netif->flags,
-                     (lwip_netif->flags & NETIF_FLAG_UP) ? 1 : 0,
-                     (lwip_netif->flags & NETIF_FLAG_LINK_UP) ? 1 : 0);
-            
-            // Feed to esp_netif - it takes ownership of the buffer contents
-            esp_err_t err = esp_netif_receive(s_netif_handle, frame_buffer, frame_len, NULL);
-            if (err != ESP_OK) {
-                ESP_LOGW(TAG, "esp_netif_receive failed: %s", esp_err_to_name(err));
-            } else {
-                s_rx_count++;
-                ESP_LOGD(TAG, "RX: Packet successfully queued (count=%lu). TX count=%lu", s_rx_count, s_tx_count);
+        while (rx_data_available()) {
+            rx_process_frame();
+            if (uxQueueMessagesWaiting(s_uart_queue) > 0) {
+                break;  // Check for overruns, then continue with the burst
             }
         }
     }
 
-    free(frame_buffer);
     vTaskDelete(NULL);
 }
 
 /**
- * @brief Free RX buffer - no-op since we use stack-allocated buffer
- * 
- * This callback is called by esp_netif after processing received data.
- * Since our frame_buffer in uart_rx_task is stack-allocated (not heap),
- * we don't need to free anything here.
+ * @brief Free RX buffer callback for esp_netif
+ *
+ * Received frames bypass esp_netif_receive() and are handed to lwIP as pool
+ * pbufs, so buffers normally come back through rx_pool_free_pbuf(). Any
+ * pool buffer released through esp_netif is returned to the pool as well.
  */
 static void driver_free_rx_buffer(void *h, void *buffer)
 {
-    // No-op: frame_buffer is stack-allocated in uart_rx_task
-    // esp_netif calls this after copying data out of our buffer
+    for (int i = 0; i < RX_POOL_SIZE; i++) {
+        if (buffer == s_rx_slots[i].data) {
+            rx_pool_put(&s_rx_slots[i]);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Write the staged bytes to UART
+ *
+ * @return true if every staged byte was accepted by the UART driver
+ */
+static bool tx_flush(void)
+{
+    if (s_tx_staged == 0) {
+        return true;
+    }
+
+    int written = uart_write_bytes(UART_NUM, (const char *)s_tx_stage, s_tx_staged);
+    bool ok = (written == (int)s_tx_staged);
+    s_tx_staged = 0;
+    return ok;
+}
+
+/**
+ * @brief Queue frame bytes for transmission
+ *
+ * Small pieces are copied into the staging buffer so the frame header and
+ * protocol headers leave in a single uart_write_bytes() call. Large pieces
+ * are written directly from the caller's buffer after flushing the stage,
+ * avoiding a copy of the payload. The UART driver's TX ring buffer provides
+ * the preallocated backing storage for both.
+ */
+static bool tx_append(const void *data, size_t len)
+{
+    if (len >= TX_DIRECT_MIN) {
+        if (!tx_flush()) {
+            return false;
+        }
+        return uart_write_bytes(UART_NUM, (const char *)data, len) == (int)len;
+    }
+
+    if (s_tx_staged + len > sizeof(s_tx_stage) && !tx_flush()) {
+        return false;
+    }
+
+    memcpy(s_tx_stage + s_tx_staged, data, len);
+    s_tx_staged += len;
+    return true;
+}
+
+/**
+ * @brief Stage the v2 frame header and seed the frame CRC
+ */
+static uint16_t tx_begin(uint16_t frame_len)
+{
+    s_tx_staged = 0;
+    s_tx_stage[s_tx_staged++] = NETIF_UART_TUNNEL_SYNC_0;
+    s_tx_stage[s_tx_staged++] = NETIF_UART_TUNNEL_SYNC_1;
+    s_tx_stage[s_tx_staged++] = (frame_len >> 8) & 0xFF;
+    s_tx_stage[s_tx_staged++] = frame_len & 0xFF;
+    return crc16_update(0xFFFF, s_tx_stage + 2, 2);
+}
+
+/**
+ * @brief Append the CRC trailer and push the frame out
+ */
+static bool tx_end(uint16_t crc)
+{
+    uint8_t crc_buf[FRAME_CRC_SIZE] = { (crc >> 8) & 0xFF, crc & 0xFF };
+    return tx_append(crc_buf, sizeof(crc_buf)) && tx_flush();
 }
 
 /**
@@ -174,6 +592,7 @@ static void driver_free_rx_buffer(void *h, void *buffer)
  * 
  * This is the LOW-LEVEL output function called by lwIP's Ethernet layer.
  * It receives a pbuf chain and must transmit the complete Ethernet frame.
+ * Segments are written in chain order without flattening the frame.
  * 
  * Called in tcpip_thread context!
  */
@@ -181,47 +600,40 @@ static err_t netif_linkoutput(struct netif *netif, struct pbuf *p)
 {
     if (p->tot_len > MAX_FRAME_SIZE) {
         ESP_LOGE(TAG, "TX: Frame too large: %d bytes", p->tot_len);
+        s_stats.tx_drop_oversized++;
         return ERR_IF;
     }
 
-    s_tx_count++;
-    ESP_LOGD(TAG, "TX: *** LINKOUTPUT CALLED *** count=%lu, tot_len=%d", s_tx_count, p->tot_len);
+    int64_t start_us = esp_timer_get_time();
+    ESP_LOGD(TAG, "TX: *** LINKOUTPUT CALLED *** count=%lu, tot_len=%d", s_stats.tx_frames + 1, p->tot_len);
 
-    // Allocate temporary buffer for the complete frame
-    uint8_t *frame_buf = (uint8_t *)malloc(p->tot_len);
-    if (frame_buf == NULL) {
-        ESP_LOGE(TAG, "TX: Failed to allocate frame buffer");
-        return ERR_MEM;
-    }
+    // Frame header is staged with the first segments
+    uint16_t crc = tx_begin(p->tot_len);
 
-    // Copy pbuf chain into contiguous buffer
-    uint16_t copied = pbuf_copy_partial(p, frame_buf, p->tot_len, 0);
-    if (copied != p->tot_len) {
-        ESP_LOGW(TAG, "TX: pbuf copy incomplete: %d/%d", copied, p->tot_len);
-        free(frame_buf);
-        return ERR_BUF;
+    uint16_t sent = 0;
+    for (struct pbuf *q = p; q != NULL && sent < p->tot_len; q = q->next) {
+        if (q->len == 0) {
+            continue;
+        }
+        crc = crc16_update(crc, q->payload, q->len);
+        if (!tx_append(q->payload, q->len)) {
+            ESP_LOGE(TAG, "TX: Incomplete write after %d/%d bytes", sent, p->tot_len);
+            s_stats.tx_errors++;
+            s_tx_staged = 0;
+            return ERR_IF;
+        }
+        sent += q->len;
     }
 
-    // Send frame length header (2 bytes, big-endian)
-    uint8_t len_buf[2];
-    len_buf[0] = (p->tot_len >> 8) & 0xFF;
-    len_buf[1] = p->tot_len & 0xFF;
-    
-    int written = uart_write_bytes(UART_NUM, (const char*)len_buf, 2);
-    if (written != 2) {
-        ESP_LOGE(TAG, "TX: Failed to write length header");
-        free(frame_buf);
+    if (sent != p->tot_len || !tx_end(crc)) {
+        ESP_LOGE(TAG, "TX: Incomplete write: %d/%d", sent, p->tot_len);
+        s_stats.tx_errors++;
         return ERR_IF;
     }
 
-    // Send frame data
-    written = uart_write_bytes(UART_NUM, (const char*)frame_buf, p->tot_len);
-    free(frame_buf);
-    
-    if (written != p->tot_len) {
-        ESP_LOGE(TAG, "TX: Incomplete write: %d/%d", written, p->tot_len);
-        return ERR_IF;
-    }
+    s_stats.tx_frames++;
+    s_stats.tx_bytes += p->tot_len;
+    stats_record_latency(&s_stats.tx_latency, start_us);
 
     ESP_LOGD(TAG, "TX: Frame sent successfully: %d bytes", p->tot_len);
     return ERR_OK;
@@ -230,32 +642,32 @@ static err_t netif_linkoutput(struct netif *netif, struct pbuf *p)
 /**
  * @brief esp_netif transmit function - sends IP packets to UART
  * 
- * Called by esp_netif layer (legacy, kept for compatibility).
+ * Called by esp_netif layer (legacy, kept for compatibility). Like
+ * netif_linkoutput() it only runs in tcpip_thread, so the stage is shared.
  */
 static esp_err_t netif_transmit(void *h, void *buffer, size_t len)
 {
-    s_tx_count++;
-    ESP_LOGD(TAG, "TX: *** TRANSMIT CALLED *** count=%lu, len=%d", s_tx_count, len);
+    ESP_LOGD(TAG, "TX: *** TRANSMIT CALLED *** count=%lu, len=%d", s_stats.tx_frames + 1, len);
     
-    // STEP 2: Enable TX (UART now initialized)
     if (len > MAX_FRAME_SIZE) {
         ESP_LOGE(TAG, "Frame too large: %d bytes", len);
+        s_stats.tx_drop_oversized++;
         return ESP_ERR_INVALID_SIZE;
     }
 
-    ESP_LOGD(TAG, "TX: Sending %d bytes...", len);
+    int64_t start_us = esp_timer_get_time();
+    uint16_t crc = tx_begin(len);
+    crc = crc16_update(crc, buffer, len);
+    if (!tx_append(buffer, len) || !tx_end(crc)) {
+        ESP_LOGE(TAG, "TX: Incomplete write of %d bytes", len);
+        s_stats.tx_errors++;
+        s_tx_staged = 0;
+        return ESP_FAIL;
+    }
 
-    // Send frame length (big-endian)
-    uint8_t len_buf[2];
-    len_buf[0] = (len >> 8) & 0xFF;
-    len_buf[1] = len & 0xFF;
-    
-    int written = uart_write_bytes(UART_NUM, (const char*)len_buf, 2);
-    ESP_LOGD(TAG, "TX: Length header written: %d bytes", written);
-    
-    // Send frame data
-    written = uart_write_bytes(UART_NUM, (const char*)buffer, len);
-    ESP_LOGD(TAG, "TX: Frame data written: %d bytes", written);
+    s_stats.tx_frames++;
+    s_stats.tx_bytes += len;
+    stats_record_latency(&s_stats.tx_latency, start_us);
     
     return ESP_OK;
 }
@@ -287,7 +699,8 @@ static esp_err_t init_uart(void)
         return ret;
     }
     
-    ret = uart_driver_install(UART_NUM, UART_BUF_SIZE * 2, UART_BUF_SIZE * 2, 0, NULL, 0);
+    ret = uart_driver_install(UART_NUM, UART_RX_BUF_SIZE, UART_TX_BUF_SIZE,
+                              UART_EVENT_QUEUE_SIZE, &s_uart_queue, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "UART driver install failed: %s", esp_err_to_name(ret));
         return ret;
@@ -443,6 +856,7 @@ esp_err_t netif_uart_tunnel_init(const netif_uart_tunnel_config_t *config)
     }
 
     // STEP 3: Start RX task with low priority and timeout
+    rx_pool_init();
     BaseType_t task_ret = xTaskCreate(uart_rx_task, "uart_rx", RX_TASK_STACK_SIZE, 
                                       NULL, RX_TASK_PRIORITY, &s_rx_task_handle);
     if (task_ret != pdPASS) {
@@ -451,8 +865,21 @@ esp_err_t netif_uart_tunnel_init(const netif_uart_tunnel_config_t *config)
         uart_driver_delete(UART_NUM);
         return ESP_FAIL;
     }
-    ESP_LOGD(TAG, "UART RX task started (priority %d, timeout %dms)", 
-             RX_TASK_PRIORITY, UART_READ_TIMEOUT_MS);
+    ESP_LOGD(TAG, "UART RX task started (priority %d, frame timeout %dms)", 
+             RX_TASK_PRIORITY, RX_FRAME_TIMEOUT_MS);
+
+#ifdef CONFIG_PM_ENABLE
+    if (s_pm_apb_lock == NULL) {
+        esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "uart_tunnel_apb", &s_pm_apb_lock);
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "uart_tunnel", &s_pm_awake_lock);
+    }
+    if (s_pm_apb_lock != NULL && s_pm_awake_lock != NULL) {
+        esp_pm_lock_acquire(s_pm_apb_lock);
+        esp_pm_lock_acquire(s_pm_awake_lock);
+    } else {
+        ESP_LOGW(TAG, "PM locks unavailable - frequency scaling may corrupt UART frames");
+    }
+#endif
 
     s_initialized = true;
     
@@ -492,6 +919,13 @@ esp_err_t netif_uart_tunnel_deinit(void)
     uart_driver_delete(UART_NUM);
     ESP_LOGI(TAG, "UART driver deleted");
 
+#ifdef CONFIG_PM_ENABLE
+    if (s_pm_apb_lock != NULL && s_pm_awake_lock != NULL) {
+        esp_pm_lock_release(s_pm_awake_lock);
+        esp_pm_lock_release(s_pm_apb_lock);
+    }
+#endif
+
     s_initialized = false;
     ESP_LOGI(TAG, "UART tunnel deinitialized");
 
@@ -502,3 +936,23 @@ esp_netif_t* netif_uart_tunnel_get_handle(void)
 {
     return s_netif_handle;
 }
+
+esp_err_t netif_uart_tunnel_get_stats(netif_uart_tunnel_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // RX pool is set up on first init and kept afterwards
+    if (s_rx_pool_sem == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    stats->rx_task_stack_free = (s_rx_task_handle != NULL) ?
+                                uxTaskGetStackHighWaterMark(s_rx_task_handle) : 0;
+    return ESP_OK;
+}
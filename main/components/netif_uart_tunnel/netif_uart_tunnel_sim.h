@@ -9,10 +9,13 @@
  * - ESP32 (QEMU): lwIP stack -> netif -> UART1 -> TCP socket
  * - Host: TCP socket -> TUN device -> Linux network stack
  * 
- * Framing Protocol:
- * - Simple length-prefixed frames: [LENGTH:2 bytes][DATA:N bytes]
- * - Length is big-endian uint16_t
- * - Maximum frame size: 1500 bytes (MTU)
+ * Framing Protocol (v2):
+ * - Frames: [SYNC:2 = A5 5A][LENGTH:2][DATA:N][CRC16:2]
+ * - Length and CRC are big-endian uint16_t
+ * - CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over LENGTH and DATA
+ * - DATA is an Ethernet frame of at most 1514 bytes (1500 byte MTU + header)
+ * - Frames are sent back to back; receivers resync on the sync marker
+ * - Must match tools/serial_tun_bridge.py
  * 
  * @note This is a simulator-only component (_sim suffix)
  * @author ESP32 Distance Project
@@ -29,6 +32,10 @@
 extern "C" {
 #endif
 
+#define NETIF_UART_TUNNEL_SYNC_0 0xA5       ///< First frame sync byte
+#define NETIF_UART_TUNNEL_SYNC_1 0x5A       ///< Second frame sync byte
+#define NETIF_UART_TUNNEL_MAX_FRAME 1514    ///< Max Ethernet frame (MTU 1500 + 14 byte header)
+
 /**
  * @brief Configuration for UART tunnel network interface
  */
@@ -39,6 +46,50 @@ typedef struct {
     uint8_t gateway[4];           ///< Gateway IP (e.g., {192,168,100,1})
 } netif_uart_tunnel_config_t;
 
+#define NETIF_UART_TUNNEL_LATENCY_BUCKETS 6   ///< Latency histogram bucket count
+
+/**
+ * @brief Upper bounds (microseconds) of the latency histogram buckets
+ *
+ * Bucket i counts frames with latency below bound i; the last bucket is
+ * open ended and counts everything from the last bound upwards.
+ */
+#define NETIF_UART_TUNNEL_LATENCY_BOUNDS_US { 100, 500, 1000, 5000, 20000 }
+
+/**
+ * @brief Per-frame latency histogram
+ */
+typedef struct {
+    uint32_t buckets[NETIF_UART_TUNNEL_LATENCY_BUCKETS]; ///< Frame counts per bucket
+    uint32_t max_us;                    ///< Highest latency seen
+    uint64_t total_us;                  ///< Sum of all latencies (for averages)
+} netif_uart_tunnel_latency_t;
+
+/**
+ * @brief Tunnel traffic statistics since initialization
+ *
+ * Counters are updated lock-free by the RX task and tcpip_thread, so a
+ * snapshot taken under load may be off by the frame in flight.
+ */
+typedef struct {
+    uint32_t rx_frames;                 ///< Frames handed to lwIP
+    uint32_t rx_bytes;                  ///< Ethernet bytes handed to lwIP
+    uint32_t tx_frames;                 ///< Frames written to UART
+    uint32_t tx_bytes;                  ///< Ethernet bytes written to UART
+    uint32_t rx_drop_oversized;         ///< Length header of 0 or above max frame
+    uint32_t rx_drop_short_read;        ///< Frame truncated by a gap on the line
+    uint32_t rx_drop_crc;               ///< CRC mismatch
+    uint32_t rx_drop_no_buffer;         ///< RX pool stayed exhausted
+    uint32_t rx_drop_netif;             ///< netif missing or lwIP input rejected the frame
+    uint32_t rx_sync_bytes_skipped;     ///< Bytes discarded while hunting for a sync marker
+    uint32_t tx_drop_oversized;         ///< Frames larger than the max frame size
+    uint32_t tx_errors;                 ///< UART driver accepted fewer bytes than requested
+    uint32_t uart_overruns;             ///< UART FIFO overflow / ring buffer full events
+    uint32_t rx_task_stack_free;        ///< RX task stack high-water mark (bytes never used)
+    netif_uart_tunnel_latency_t rx_latency; ///< Sync marker seen until frame handed to lwIP
+    netif_uart_tunnel_latency_t tx_latency; ///< linkoutput entry until UART driver accepted frame
+} netif_uart_tunnel_stats_t;
+
 /**
  * @brief Initialize UART tunnel network interface
  * 
@@ -68,6 +119,15 @@ esp_err_t netif_uart_tunnel_deinit(void);
  */
 esp_netif_t* netif_uart_tunnel_get_handle(void);
 
+/**
+ * @brief Get a snapshot of the tunnel traffic statistics
+ * 
+ * @param stats Output statistics
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if stats is NULL,
+ *         ESP_ERR_INVALID_STATE if the tunnel was never initialized
+ */
+esp_err_t netif_uart_tunnel_get_stats(netif_uart_tunnel_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
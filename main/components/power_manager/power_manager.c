@@ -0,0 +1,232 @@
+/**
+ * @file power_manager.c
+ * @brief Power management implementation
+ *
+ * Two PM locks back every hold: ESP_PM_CPU_FREQ_MAX so a request is served
+ * at full speed, and ESP_PM_NO_LIGHT_SLEEP so the device does not sleep
+ * between the TCP segments of a response. esp_pm locks are reference counted
+ * themselves; the in-flight counter here only drives the statistics.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "power_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+#include "esp_pm.h"
+#endif
+
+static const char *TAG = "power_manager";
+
+// Average supply current of each state, used for the current estimate
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+#define ACTIVE_CURRENT_UA CONFIG_POWER_MANAGER_ACTIVE_CURRENT_UA
+#define IDLE_CURRENT_UA   CONFIG_POWER_MANAGER_IDLE_CURRENT_UA
+#define SLEEP_CURRENT_UA  CONFIG_POWER_MANAGER_SLEEP_CURRENT_UA
+#else
+#define ACTIVE_CURRENT_UA 0
+#define IDLE_CURRENT_UA   0
+#define SLEEP_CURRENT_UA  0
+#endif
+
+// =============================================================================
+// State
+// =============================================================================
+
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+static esp_pm_lock_handle_t cpu_lock = NULL;
+static esp_pm_lock_handle_t sleep_lock = NULL;
+#endif
+static bool pm_enabled = false;
+static int64_t init_us = 0;
+
+// Hold and request accounting, guarded by stats_lock
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t in_flight = 0;
+static int64_t awake_since_us = 0;
+static uint64_t awake_us = 0;
+static uint32_t requests = 0;
+static uint64_t request_time_us = 0;
+static uint32_t request_max_us = 0;
+
+// Written by the light sleep exit callback (interrupts disabled, no locking)
+static volatile uint32_t light_sleeps = 0;
+static volatile uint64_t light_sleep_us = 0;
+
+// =============================================================================
+// Light Sleep Accounting
+// =============================================================================
+
+#ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+/**
+ * @brief Light sleep exit callback, runs in IRAM right after wakeup
+ *
+ * @param sleep_time_us Time actually spent in light sleep
+ */
+static IRAM_ATTR esp_err_t light_sleep_exit_cb(int64_t sleep_time_us, void *arg)
+{
+    light_sleeps++;
+    light_sleep_us += sleep_time_us;
+    return ESP_OK;
+}
+#endif
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+esp_err_t power_manager_init(void)
+{
+    init_us = esp_timer_get_time();
+
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+    esp_err_t ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "request_cpu", &cpu_lock);
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "request_awake", &sleep_lock);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create PM locks: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_POWER_MANAGER_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_POWER_MANAGER_MIN_CPU_FREQ_MHZ,
+#ifdef CONFIG_POWER_MANAGER_LIGHT_SLEEP
+        .light_sleep_enable = true,
+#else
+        .light_sleep_enable = false,
+#endif
+    };
+    ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s - running at full power", esp_err_to_name(ret));
+        return ret;
+    }
+
+#ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = light_sleep_exit_cb,
+    };
+    if (esp_pm_light_sleep_register_cbs(&cbs) != ESP_OK) {
+        ESP_LOGW(TAG, "Light sleep time will not be reported");
+    }
+#endif
+
+    pm_enabled = true;
+    ESP_LOGI(TAG, "Power management: CPU %d-%d MHz, light sleep %s",
+             pm_config.min_freq_mhz, pm_config.max_freq_mhz,
+             pm_config.light_sleep_enable ? "enabled" : "disabled");
+#else
+    ESP_LOGD(TAG, "Power management disabled (CONFIG_POWER_MANAGER_ENABLE)");
+#endif
+    return ESP_OK;
+}
+
+void power_manager_acquire(void)
+{
+    if (!pm_enabled) {
+        return;
+    }
+
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+    esp_pm_lock_acquire(cpu_lock);
+    esp_pm_lock_acquire(sleep_lock);
+#endif
+
+    taskENTER_CRITICAL(&stats_lock);
+    if (in_flight++ == 0) {
+        awake_since_us = esp_timer_get_time();
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+void power_manager_release(void)
+{
+    if (!pm_enabled) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&stats_lock);
+    if (in_flight > 0 && --in_flight == 0) {
+        awake_us += esp_timer_get_time() - awake_since_us;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+    esp_pm_lock_release(sleep_lock);
+    esp_pm_lock_release(cpu_lock);
+#endif
+}
+
+int64_t power_manager_request_begin(void)
+{
+    power_manager_acquire();
+    return esp_timer_get_time();
+}
+
+void power_manager_request_end(int64_t start_us)
+{
+    uint32_t duration_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    taskENTER_CRITICAL(&stats_lock);
+    requests++;
+    request_time_us += duration_us;
+    if (duration_us > request_max_us) {
+        request_max_us = duration_us;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+
+    power_manager_release();
+}
+
+esp_err_t power_manager_get_stats(power_manager_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&stats_lock);
+    stats->in_flight = in_flight;
+    stats->requests = requests;
+    stats->request_time_us = request_time_us;
+    stats->request_max_us = request_max_us;
+    stats->awake_us = awake_us + (in_flight > 0 ? (uint64_t)(now - awake_since_us) : 0);
+    taskEXIT_CRITICAL(&stats_lock);
+
+    stats->enabled = pm_enabled;
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+    stats->max_freq_mhz = CONFIG_POWER_MANAGER_MAX_CPU_FREQ_MHZ;
+    stats->min_freq_mhz = pm_enabled ? CONFIG_POWER_MANAGER_MIN_CPU_FREQ_MHZ : CONFIG_POWER_MANAGER_MAX_CPU_FREQ_MHZ;
+#else
+    stats->max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    stats->min_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+#endif
+#ifdef CONFIG_POWER_MANAGER_LIGHT_SLEEP
+    stats->light_sleep = pm_enabled;
+#else
+    stats->light_sleep = false;
+#endif
+    stats->light_sleeps = light_sleeps;
+    stats->light_sleep_us = light_sleep_us;
+    stats->elapsed_us = (uint64_t)(now - init_us);
+
+    // Time neither held awake nor asleep is spent idle at the minimum frequency
+    stats->estimated_current_ua = 0;
+    if (pm_enabled && stats->elapsed_us > 0) {
+        uint64_t sleep = stats->light_sleep_us;
+        uint64_t busy = stats->awake_us;
+        uint64_t idle = stats->elapsed_us > busy + sleep ? stats->elapsed_us - busy - sleep : 0;
+        uint64_t charge = busy * ACTIVE_CURRENT_UA + idle * IDLE_CURRENT_UA + sleep * SLEEP_CURRENT_UA;
+        stats->estimated_current_ua = (uint32_t)(charge / (busy + idle + sleep));
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file power_manager.h
+ * @brief Dynamic frequency scaling and automatic light sleep with request holds
+ *
+ * With CONFIG_POWER_MANAGER_ENABLE the CPU runs at the minimum frequency and
+ * enters light sleep whenever every task is blocked. Code that must not be
+ * slowed down or put to sleep - an HTTP request being served - brackets the
+ * work with power_manager_request_begin()/power_manager_request_end(), which
+ * hold a maximum-CPU-frequency and a no-light-sleep PM lock while at least one
+ * request is in flight. Incoming WiFi traffic wakes the device as usual, so
+ * an idle server costs light-sleep current between requests.
+ *
+ * FEATURES:
+ * - esp_pm_configure() from Kconfig (max/min CPU frequency, light sleep)
+ * - Reference-counted holds usable from any task
+ * - Request latency, time held awake and time spent in light sleep
+ * - Average current estimate from the time spent in each state
+ *
+ * Without CONFIG_POWER_MANAGER_ENABLE every function is a cheap no-op and the
+ * statistics report the power manager as disabled.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Power management statistics since power_manager_init()
+ */
+typedef struct {
+    bool enabled;                   ///< DFS/light sleep configured successfully
+    bool light_sleep;               ///< Automatic light sleep enabled
+    uint16_t max_freq_mhz;          ///< CPU frequency while a hold is active
+    uint16_t min_freq_mhz;          ///< CPU frequency when idle
+    uint32_t in_flight;             ///< Holds currently active
+    uint32_t requests;              ///< Requests completed
+    uint64_t request_time_us;       ///< Sum of request durations
+    uint32_t request_max_us;        ///< Longest request
+    uint64_t awake_us;              ///< Time with at least one hold active
+    uint32_t light_sleeps;          ///< Light sleep periods (needs CONFIG_PM_LIGHT_SLEEP_CALLBACKS)
+    uint64_t light_sleep_us;        ///< Time spent in light sleep
+    uint64_t elapsed_us;            ///< Time since power_manager_init()
+    uint32_t estimated_current_ua;  ///< Average current estimated from the time in each state
+} power_manager_stats_t;
+
+/**
+ * @brief Configure power management and create the PM locks
+ *
+ * @return ESP_OK on success (also when disabled in Kconfig), otherwise the
+ *         error of esp_pm_configure() or esp_pm_lock_create(); the device
+ *         then keeps running at full power
+ */
+esp_err_t power_manager_init(void);
+
+/**
+ * @brief Keep the CPU at full speed and out of light sleep
+ *
+ * Reference counted: every call must be paired with power_manager_release().
+ */
+void power_manager_acquire(void);
+
+/**
+ * @brief Drop a hold taken with power_manager_acquire()
+ */
+void power_manager_release(void);
+
+/**
+ * @brief Start serving a request (acquires a hold)
+ *
+ * @return Start timestamp to pass to power_manager_request_end()
+ */
+int64_t power_manager_request_begin(void);
+
+/**
+ * @brief Finish serving a request (releases the hold, records the latency)
+ *
+ * @param start_us Value returned by power_manager_request_begin()
+ */
+void power_manager_request_end(int64_t start_us);
+
+/**
+ * @brief Get power management statistics
+ *
+ * @param[out] stats Statistics
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t power_manager_get_stats(power_manager_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file async_handler.c
+ * @brief Worker pool for slow HTTP handlers
+ *
+ * A counting semaphore tracks idle workers so a submit never blocks the
+ * httpd task: if no worker is idle the request is handled inline instead.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "async_handler.h"
+#include "request_arena.h"
+#include "power_manager.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+
+static const char *TAG = "async_handler";
+
+/**
+ * @brief Detached request waiting for a worker
+ */
+typedef struct {
+    httpd_req_t *req;                       ///< Copy from httpd_req_async_handler_begin()
+    esp_err_t (*handler)(httpd_req_t *req);
+} async_request_t;
+
+static QueueHandle_t s_queue = NULL;
+static SemaphoreHandle_t s_idle_workers = NULL;
+static TaskHandle_t s_workers[ASYNC_HANDLER_MAX_WORKERS];
+static size_t s_worker_count = 0;
+
+static bool on_worker_task(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < s_worker_count; i++)
+    {
+        if (s_workers[i] == self)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void worker_task(void *arg)
+{
+    async_request_t request;
+
+    while (1)
+    {
+        xSemaphoreGive(s_idle_workers);
+        if (xQueueReceive(s_queue, &request, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        ESP_LOGD(TAG, "Handling %s on worker", request.req->uri);
+        // The httpd task released its hold when the handler was handed over
+        power_manager_acquire();
+        // The copy needs its own arena; without one its allocations fail and the handler answers 503
+        request_arena_acquire(request.req);
+        if (request.handler(request.req) != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Async handler for %s failed", request.req->uri);
+        }
+        request_arena_release(request.req);
+        httpd_req_async_handler_complete(request.req);
+        power_manager_release();
+    }
+}
+
+esp_err_t async_handler_init(size_t workers, size_t stack_size, unsigned priority, BaseType_t core_id)
+{
+    if (workers > ASYNC_HANDLER_MAX_WORKERS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_queue != NULL || workers == 0)
+    {
+        return ESP_OK;
+    }
+
+    s_queue = xQueueCreate(workers, sizeof(async_request_t));
+    s_idle_workers = xSemaphoreCreateCounting(workers, 0);
+    if (s_queue == NULL || s_idle_workers == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create worker queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (size_t i = 0; i < workers; i++)
+    {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "httpd_async%u", (unsigned)i);
+        if (xTaskCreatePinnedToCore(worker_task, name, stack_size, NULL, priority,
+                                    &s_workers[s_worker_count], core_id) != pdPASS)
+        {
+            ESP_LOGE(TAG, "Failed to create worker %u", (unsigned)i);
+            return s_worker_count > 0 ? ESP_OK : ESP_ERR_NO_MEM;
+        }
+        s_worker_count++;
+    }
+
+    ESP_LOGI(TAG, "Started %u async HTTP workers", (unsigned)s_worker_count);
+    return ESP_OK;
+}
+
+bool async_handler_submit(httpd_req_t *req, esp_err_t (*handler)(httpd_req_t *req))
+{
+    if (s_worker_count == 0 || on_worker_task())
+    {
+        return false;
+    }
+
+    // Never wait on the httpd task: without an idle worker handle it inline
+    if (xSemaphoreTake(s_idle_workers, 0) != pdTRUE)
+    {
+        ESP_LOGD(TAG, "No idle worker for %s - handling inline", req->uri);
+        return false;
+    }
+
+    async_request_t request = {
+        .req = NULL,
+        .handler = handler};
+    if (httpd_req_async_handler_begin(req, &request.req) != ESP_OK)
+    {
+        xSemaphoreGive(s_idle_workers);
+        return false;
+    }
+
+    if (xQueueSend(s_queue, &request, 0) != pdTRUE)
+    {
+        // Cannot happen while the semaphore counts idle workers
+        httpd_req_async_handler_complete(request.req);
+        xSemaphoreGive(s_idle_workers);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file async_handler.h
+ * @brief Worker pool for slow HTTP handlers
+ *
+ * The httpd server runs every handler on its single task, so a handler that
+ * writes NVS or touches the WiFi driver delays every other client. Slow
+ * handlers hand themselves to this pool at the top of the handler:
+ *
+ *     if (async_handler_submit(req, config_set_handler))
+ *     {
+ *         return ESP_OK;
+ *     }
+ *
+ * The request is detached with httpd_req_async_handler_begin() and the same
+ * handler runs again on a worker task, where async_handler_submit() returns
+ * false. When the pool is disabled or every worker is busy the handler simply
+ * runs inline on the httpd task, so requests are never rejected.
+ *
+ * Each in-flight async request keeps its socket open, so the pool should be
+ * smaller than the server's max_open_sockets. The worker binds a request
+ * arena (request_arena.h) to the detached copy while the handler runs.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ASYNC_HANDLER_MAX_WORKERS 4     ///< Upper limit for the worker count
+
+/**
+ * @brief Start the worker tasks
+ *
+ * Workers are created once and survive server restarts; later calls are
+ * no-ops.
+ *
+ * @param workers Number of worker tasks (0 disables the pool)
+ * @param stack_size Stack size per worker in bytes
+ * @param priority FreeRTOS priority of the workers
+ * @param core_id Core affinity (tskNO_AFFINITY for any core)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if workers exceeds
+ *         ASYNC_HANDLER_MAX_WORKERS, ESP_ERR_NO_MEM if tasks or queues
+ *         cannot be created
+ */
+esp_err_t async_handler_init(size_t workers, size_t stack_size, unsigned priority, BaseType_t core_id);
+
+/**
+ * @brief Hand a request to a worker task
+ *
+ * @param req Request received on the httpd task
+ * @param handler Handler to run on the worker (usually the calling handler)
+ * @return true if the request was queued (caller returns ESP_OK at once),
+ *         false if the caller should handle it inline
+ */
+bool async_handler_submit(httpd_req_t *req, esp_err_t (*handler)(httpd_req_t *req));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,343 @@
+/**
+ * @file http_metrics.c
+ * @brief Per-endpoint request counters and latency histograms
+ *
+ * Each core has its own copy of every endpoint's counters. A request is
+ * recorded in the shard of the core the recording task runs on; the atomic
+ * adds keep a count correct even if the task migrates or is preempted by
+ * another recorder on the same core. The scrape sums the shards, so two
+ * counters of one endpoint may be a request apart, which Prometheus
+ * tolerates.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "http_metrics.h"
+#include "request_arena.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "http_metrics";
+
+// Output is flushed to the client in pieces of this size
+#define HTTP_METRICS_CHUNK_SIZE 1024
+
+// Upper bucket bounds of the latency histogram; one more bucket catches the rest
+static const uint32_t bucket_bounds_us[] = {
+    1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000,
+};
+static const char *const bucket_labels[] = {
+    "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "0.25", "1", "+Inf",
+};
+#define HTTP_METRICS_BUCKET_COUNT (sizeof(bucket_bounds_us) / sizeof(bucket_bounds_us[0]) + 1)
+
+// Status codes counted individually; anything else is counted as "other"
+static const uint16_t status_codes[] = {
+    101, 200, 204, 302, 304, 400, 404, 405, 408, 413, 500, 503,
+};
+#define HTTP_METRICS_STATUS_COUNT (sizeof(status_codes) / sizeof(status_codes[0]) + 1)
+
+/**
+ * @brief Counters of one endpoint in one shard
+ */
+typedef struct {
+    uint32_t requests;
+    uint32_t body_bytes;
+    uint32_t response_bytes;
+    uint32_t duration_ms;           ///< Latency sum, whole milliseconds
+    int32_t duration_us;            ///< Latency sum, remainder in microseconds (may be negative)
+    uint32_t status[HTTP_METRICS_STATUS_COUNT];
+    uint32_t buckets[HTTP_METRICS_BUCKET_COUNT];
+} endpoint_counters_t;
+
+/**
+ * @brief Tracked URI handler
+ */
+typedef struct {
+    const char *uri;
+    httpd_method_t method;
+} endpoint_t;
+
+static endpoint_t endpoints[HTTP_METRICS_MAX_ENDPOINTS];
+static size_t endpoint_count = 0;
+static endpoint_counters_t shards[portNUM_PROCESSORS][HTTP_METRICS_MAX_ENDPOINTS];
+
+// =============================================================================
+// Recording
+// =============================================================================
+
+static inline void counter_add(uint32_t *counter, uint32_t value)
+{
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t counter_read(const uint32_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static inline endpoint_counters_t *local_counters(int endpoint)
+{
+    return &shards[xPortGetCoreID()][endpoint];
+}
+
+int http_metrics_register(const char *uri, httpd_method_t method)
+{
+    for (size_t i = 0; i < endpoint_count; i++)
+    {
+        if (endpoints[i].method == method && strcmp(endpoints[i].uri, uri) == 0)
+        {
+            return (int)i;
+        }
+    }
+    if (endpoint_count >= HTTP_METRICS_MAX_ENDPOINTS)
+    {
+        ESP_LOGW(TAG, "Endpoint table full, %s %s not tracked", http_method_str(method), uri);
+        return HTTP_METRICS_NO_ENDPOINT;
+    }
+
+    endpoints[endpoint_count].uri = uri;
+    endpoints[endpoint_count].method = method;
+    return (int)endpoint_count++;
+}
+
+void http_metrics_record_request(int endpoint, size_t body_bytes, uint32_t duration_us)
+{
+    if (endpoint < 0 || (size_t)endpoint >= endpoint_count)
+    {
+        return;
+    }
+
+    size_t bucket = 0;
+    while (bucket < HTTP_METRICS_BUCKET_COUNT - 1 && duration_us > bucket_bounds_us[bucket])
+    {
+        bucket++;
+    }
+
+    endpoint_counters_t *counters = local_counters(endpoint);
+    counter_add(&counters->requests, 1);
+    counter_add(&counters->body_bytes, body_bytes);
+    counter_add(&counters->duration_ms, duration_us / 1000);
+    // Carry whole milliseconds out of the remainder so neither part wraps.
+    // Concurrent carries may overshoot; the sum stays exact either way
+    if (__atomic_add_fetch(&counters->duration_us, (int32_t)(duration_us % 1000), __ATOMIC_RELAXED) >= 1000)
+    {
+        __atomic_fetch_sub(&counters->duration_us, 1000, __ATOMIC_RELAXED);
+        counter_add(&counters->duration_ms, 1);
+    }
+    counter_add(&counters->buckets[bucket], 1);
+}
+
+void http_metrics_record_response(int endpoint, int status, size_t bytes)
+{
+    if (endpoint < 0 || (size_t)endpoint >= endpoint_count)
+    {
+        return;
+    }
+
+    endpoint_counters_t *counters = local_counters(endpoint);
+    counter_add(&counters->response_bytes, bytes);
+    if (status != 0)
+    {
+        size_t index = 0;
+        while (index < HTTP_METRICS_STATUS_COUNT - 1 && status_codes[index] != status)
+        {
+            index++;
+        }
+        counter_add(&counters->status[index], 1);
+    }
+}
+
+// =============================================================================
+// Exposition
+// =============================================================================
+
+/**
+ * @brief Buffered text output to one response
+ */
+typedef struct {
+    httpd_req_t *req;
+    char *buf;                  ///< HTTP_METRICS_CHUNK_SIZE bytes from the request arena
+    size_t len;
+    bool chunked;               ///< At least one chunk has been sent
+    esp_err_t error;            ///< First send error, later output is dropped
+} metrics_output_t;
+
+static void output_flush(metrics_output_t *out)
+{
+    if (out->error == ESP_OK && out->len > 0)
+    {
+        out->error = httpd_resp_send_chunk(out->req, out->buf, out->len);
+        out->chunked = true;
+    }
+    out->len = 0;
+}
+
+static void output_printf(metrics_output_t *out, const char *format, ...)
+{
+    for (int attempt = 0; attempt < 2 && out->error == ESP_OK; attempt++)
+    {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(out->buf + out->len, HTTP_METRICS_CHUNK_SIZE - out->len, format, args);
+        va_end(args);
+
+        if (written >= 0 && (size_t)written < HTTP_METRICS_CHUNK_SIZE - out->len)
+        {
+            out->len += written;
+            return;
+        }
+        // Line did not fit: send what we have and retry in the empty buffer
+        output_flush(out);
+    }
+}
+
+/**
+ * @brief Sum the shards of one endpoint
+ */
+static void endpoint_totals(size_t endpoint, endpoint_counters_t *totals)
+{
+    memset(totals, 0, sizeof(*totals));
+    for (size_t core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        const endpoint_counters_t *shard = &shards[core][endpoint];
+        totals->requests += counter_read(&shard->requests);
+        totals->body_bytes += counter_read(&shard->body_bytes);
+        totals->response_bytes += counter_read(&shard->response_bytes);
+        totals->duration_ms += counter_read(&shard->duration_ms);
+        totals->duration_us += __atomic_load_n(&shard->duration_us, __ATOMIC_RELAXED);
+        for (size_t i = 0; i < HTTP_METRICS_STATUS_COUNT; i++)
+        {
+            totals->status[i] += counter_read(&shard->status[i]);
+        }
+        for (size_t i = 0; i < HTTP_METRICS_BUCKET_COUNT; i++)
+        {
+            totals->buckets[i] += counter_read(&shard->buckets[i]);
+        }
+    }
+}
+
+// Labels identifying the endpoint of a series
+#define ENDPOINT_LABELS "handler=\"%s\",method=\"%s\""
+#define ENDPOINT_LABEL_ARGS(i) endpoints[i].uri, http_method_str(endpoints[i].method)
+
+esp_err_t http_metrics_write(httpd_req_t *req)
+{
+    // The chunk buffer would not fit on the httpd stack next to vsnprintf()
+    metrics_output_t out = {
+        .req = req,
+        .buf = request_arena_alloc(req, HTTP_METRICS_CHUNK_SIZE),
+        .error = ESP_OK,
+    };
+    if (out.buf == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    endpoint_counters_t totals;
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
+
+    output_printf(&out, "# TYPE http_requests_total counter\n");
+    for (size_t i = 0; i < endpoint_count; i++)
+    {
+        endpoint_totals(i, &totals);
+        if (totals.requests > 0)
+        {
+            output_printf(&out, "http_requests_total{" ENDPOINT_LABELS "} %lu\n",
+                          ENDPOINT_LABEL_ARGS(i), (unsigned long)totals.requests);
+        }
+    }
+
+#ifndef CONFIG_WEB_SERVER_HTTPS
+    output_printf(&out, "# TYPE http_responses_total counter\n");
+    for (size_t i = 0; i < endpoint_count; i++)
+    {
+        endpoint_totals(i, &totals);
+        for (size_t s = 0; s < HTTP_METRICS_STATUS_COUNT; s++)
+        {
+            if (totals.status[s] == 0)
+            {
+                continue;
+            }
+            char code[8];
+            if (s < HTTP_METRICS_STATUS_COUNT - 1)
+            {
+                snprintf(code, sizeof(code), "%u", status_codes[s]);
+            }
+            else
+            {
+                strcpy(code, "other");
+            }
+            output_printf(&out, "http_responses_total{" ENDPOINT_LABELS ",code=\"%s\"} %lu\n",
+                          ENDPOINT_LABEL_ARGS(i), code, (unsigned long)totals.status[s]);
+        }
+    }
+
+    output_printf(&out, "# TYPE http_response_bytes_total counter\n");
+    for (size_t i = 0; i < endpoint_count; i++)
+    {
+        endpoint_totals(i, &totals);
+        if (totals.requests > 0)
+        {
+            output_printf(&out, "http_response_bytes_total{" ENDPOINT_LABELS "} %lu\n",
+                          ENDPOINT_LABEL_ARGS(i), (unsigned long)totals.response_bytes);
+        }
+    }
+#endif
+
+    output_printf(&out, "# TYPE http_request_body_bytes_total counter\n");
+    for (size_t i = 0; i < endpoint_count; i++)
+    {
+        endpoint_totals(i, &totals);
+        if (totals.requests > 0)
+        {
+            output_printf(&out, "http_request_body_bytes_total{" ENDPOINT_LABELS "} %lu\n",
+                          ENDPOINT_LABEL_ARGS(i), (unsigned long)totals.body_bytes);
+        }
+    }
+
+    output_printf(&out, "# TYPE http_request_duration_seconds histogram\n");
+    for (size_t i = 0; i < endpoint_count; i++)
+    {
+        endpoint_totals(i, &totals);
+        if (totals.requests == 0)
+        {
+            continue;
+        }
+        uint32_t cumulative = 0;
+        for (size_t b = 0; b < HTTP_METRICS_BUCKET_COUNT; b++)
+        {
+            cumulative += totals.buckets[b];
+            output_printf(&out, "http_request_duration_seconds_bucket{" ENDPOINT_LABELS ",le=\"%s\"} %lu\n",
+                          ENDPOINT_LABEL_ARGS(i), bucket_labels[b], (unsigned long)cumulative);
+        }
+        double sum_s = totals.duration_ms / 1000.0 + totals.duration_us / 1000000.0;
+        output_printf(&out, "http_request_duration_seconds_sum{" ENDPOINT_LABELS "} %.6f\n",
+                      ENDPOINT_LABEL_ARGS(i), sum_s);
+        output_printf(&out, "http_request_duration_seconds_count{" ENDPOINT_LABELS "} %lu\n",
+                      ENDPOINT_LABEL_ARGS(i), (unsigned long)cumulative);
+    }
+
+    if (out.error != ESP_OK)
+    {
+        return out.error;
+    }
+    if (!out.chunked)
+    {
+        // Everything fit into one buffer: send it with a Content-Length
+        return httpd_resp_send(req, out.buf, out.len);
+    }
+    output_flush(&out);
+    if (out.error == ESP_OK)
+    {
+        out.error = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return out.error;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file http_metrics.h
+ * @brief Per-endpoint request counters and latency histograms
+ *
+ * Every URI handler registered by the web server is counted as one endpoint
+ * (URI and method). For each endpoint the module keeps the number of
+ * requests, responses per status code, request body and response bytes and
+ * a latency histogram with fixed buckets. http_metrics_write() renders
+ * everything in the Prometheus text exposition format for GET /metrics.
+ *
+ * Counters are sharded per CPU core and updated with relaxed atomic adds, so
+ * recording never takes a lock or disables interrupts; the shards are only
+ * summed when the metrics are scraped. Endpoints without requests are left
+ * out of the output to keep scrapes small.
+ *
+ * Status codes and response bytes are taken from the response as it is sent
+ * (see the socket send hook in web_server.c). With CONFIG_WEB_SERVER_HTTPS
+ * the TLS layer owns the socket hooks and only requests, body bytes and
+ * latency are reported.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_METRICS_MAX_ENDPOINTS 24   ///< Endpoints that can be tracked
+#define HTTP_METRICS_NO_ENDPOINT   (-1) ///< Returned when the endpoint table is full
+
+/**
+ * @brief Get the endpoint index of a URI handler, adding it if new
+ *
+ * Registering the same URI and method again (e.g. after a server restart)
+ * returns the existing index, so counters survive restarts.
+ *
+ * @param uri URI as registered with the httpd (must outlive the application)
+ * @param method HTTP method
+ * @return Endpoint index, or HTTP_METRICS_NO_ENDPOINT if the table is full
+ */
+int http_metrics_register(const char *uri, httpd_method_t method);
+
+/**
+ * @brief Record a handled request
+ *
+ * @param endpoint Index from http_metrics_register() (ignored if negative)
+ * @param body_bytes Request body length
+ * @param duration_us Time spent in the handler
+ */
+void http_metrics_record_request(int endpoint, size_t body_bytes, uint32_t duration_us);
+
+/**
+ * @brief Record response data sent for an endpoint
+ *
+ * @param endpoint Index from http_metrics_register() (ignored if negative)
+ * @param status HTTP status code of a new response, 0 for further data of
+ *               the current one
+ * @param bytes Bytes sent, including the status line and headers
+ */
+void http_metrics_record_response(int endpoint, int status, size_t bytes);
+
+/**
+ * @brief Send all metrics as the response to @p req
+ *
+ * Sets the Prometheus text content type. Output that does not fit into one
+ * chunk buffer is sent with chunked transfer encoding.
+ *
+ * @param req Request to respond to, holding a request arena
+ * @return ESP_OK, ESP_ERR_NO_MEM if the arena has no room for the chunk
+ *         buffer (nothing has been sent), or the error of the failed send
+ */
+esp_err_t http_metrics_write(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
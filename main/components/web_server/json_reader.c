@@ -0,0 +1,504 @@
+/**
+ * @file json_reader.c
+ * @brief Incremental, bounded-memory JSON parser for HTTP request bodies
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "json_reader.h"
+#include <string.h>
+
+// Parser states
+enum {
+    STATE_VALUE,            ///< Expecting a value
+    STATE_KEY_OR_END,       ///< After '{': expecting a key or '}'
+    STATE_KEY,              ///< After ',' in an object: expecting a key
+    STATE_COLON,            ///< After a key: expecting ':'
+    STATE_VALUE_OR_END,     ///< After '[': expecting a value or ']'
+    STATE_AFTER_VALUE,      ///< Expecting ',' or the end of the container
+    STATE_STRING,           ///< Inside a string
+    STATE_ESCAPE,           ///< After a backslash inside a string
+    STATE_UNICODE,          ///< Inside a \uXXXX escape
+    STATE_LITERAL,          ///< Inside true/false/null
+    STATE_NUMBER,           ///< Inside a number
+    STATE_DONE,             ///< Top-level value complete
+};
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static esp_err_t fail(json_reader_t *r, esp_err_t err)
+{
+    r->err = err;
+    return err;
+}
+
+static esp_err_t append_value(json_reader_t *r, const char *data, size_t len)
+{
+    if (r->value_len + len >= sizeof(r->value))
+    {
+        return fail(r, ESP_ERR_INVALID_SIZE);
+    }
+    memcpy(r->value + r->value_len, data, len);
+    r->value_len += len;
+    return ESP_OK;
+}
+
+static esp_err_t append_utf8(json_reader_t *r, uint32_t cp)
+{
+    char out[4];
+    size_t len;
+    if (cp < 0x80)
+    {
+        out[0] = (char)cp;
+        len = 1;
+    }
+    else if (cp < 0x800)
+    {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        len = 2;
+    }
+    else if (cp < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        len = 3;
+    }
+    else
+    {
+        out[0] = (char)(0xF0 | (cp >> 18));
+        out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (cp & 0x3F));
+        len = 4;
+    }
+    return append_value(r, out, len);
+}
+
+/**
+ * @brief Value finished: report it and move on
+ */
+static esp_err_t emit_value(json_reader_t *r, json_reader_type_t type)
+{
+    r->value[r->value_len] = '\0';
+    if (r->cb != NULL)
+    {
+        esp_err_t ret = r->cb(r->ctx, r->path, type, r->value, r->value_len);
+        if (ret != ESP_OK)
+        {
+            return fail(r, ret);
+        }
+    }
+    r->value_len = 0;
+    r->state = (r->depth == 0) ? STATE_DONE : STATE_AFTER_VALUE;
+    return ESP_OK;
+}
+
+/**
+ * @brief Key finished: extend the path with it
+ */
+static esp_err_t set_key(json_reader_t *r)
+{
+    size_t base = r->path_len[r->depth];
+    size_t sep = (base > 0) ? 1 : 0;
+    if (base + sep + r->value_len >= sizeof(r->path))
+    {
+        return fail(r, ESP_ERR_INVALID_SIZE);
+    }
+    if (sep)
+    {
+        r->path[base] = '.';
+    }
+    memcpy(r->path + base + sep, r->value, r->value_len);
+    r->path[base + sep + r->value_len] = '\0';
+    r->value_len = 0;
+    r->state = STATE_COLON;
+    return ESP_OK;
+}
+
+static esp_err_t open_container(json_reader_t *r, bool is_array)
+{
+    if (r->depth >= JSON_READER_MAX_DEPTH)
+    {
+        return fail(r, ESP_ERR_INVALID_SIZE);
+    }
+    r->depth++;
+    r->is_array[r->depth] = is_array;
+    r->path_len[r->depth] = (uint8_t)strlen(r->path);
+    r->state = is_array ? STATE_VALUE_OR_END : STATE_KEY_OR_END;
+    return ESP_OK;
+}
+
+static esp_err_t close_container(json_reader_t *r, bool is_array)
+{
+    if (r->depth == 0 || r->is_array[r->depth] != is_array)
+    {
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+    r->depth--;
+    // Restore the path of the enclosing member
+    r->path[r->path_len[r->depth + 1]] = '\0';
+    r->state = (r->depth == 0) ? STATE_DONE : STATE_AFTER_VALUE;
+    return ESP_OK;
+}
+
+/**
+ * @brief Begin a value at the current position
+ */
+static esp_err_t begin_value(json_reader_t *r, char c)
+{
+    switch (c)
+    {
+    case '{':
+        return open_container(r, false);
+    case '[':
+        return open_container(r, true);
+    case '"':
+        r->string_is_key = false;
+        r->state = STATE_STRING;
+        return ESP_OK;
+    case 't':
+    case 'f':
+    case 'n':
+        r->state = STATE_LITERAL;
+        return append_value(r, &c, 1);
+    default:
+        if (c == '-' || (c >= '0' && c <= '9'))
+        {
+            r->state = STATE_NUMBER;
+            return append_value(r, &c, 1);
+        }
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+}
+
+static esp_err_t finish_literal(json_reader_t *r)
+{
+    r->value[r->value_len] = '\0';
+    if (strcmp(r->value, "true") == 0 || strcmp(r->value, "false") == 0)
+    {
+        return emit_value(r, JSON_READER_BOOL);
+    }
+    if (strcmp(r->value, "null") == 0)
+    {
+        return emit_value(r, JSON_READER_NULL);
+    }
+    return fail(r, ESP_ERR_INVALID_ARG);
+}
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief Check a number against the JSON grammar
+ *
+ * -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ */
+static bool is_json_number(const char *s, size_t len)
+{
+    size_t i = 0;
+    if (i < len && s[i] == '-')
+    {
+        i++;
+    }
+    if (i < len && s[i] == '0')
+    {
+        i++;
+    }
+    else if (i < len && s[i] >= '1' && s[i] <= '9')
+    {
+        while (i < len && is_digit(s[i]))
+        {
+            i++;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    if (i < len && s[i] == '.')
+    {
+        i++;
+        if (i >= len || !is_digit(s[i]))
+        {
+            return false;
+        }
+        while (i < len && is_digit(s[i]))
+        {
+            i++;
+        }
+    }
+    if (i < len && (s[i] == 'e' || s[i] == 'E'))
+    {
+        i++;
+        if (i < len && (s[i] == '+' || s[i] == '-'))
+        {
+            i++;
+        }
+        if (i >= len || !is_digit(s[i]))
+        {
+            return false;
+        }
+        while (i < len && is_digit(s[i]))
+        {
+            i++;
+        }
+    }
+    return i == len;
+}
+
+static esp_err_t finish_number(json_reader_t *r)
+{
+    if (!is_json_number(r->value, r->value_len))
+    {
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+    return emit_value(r, JSON_READER_NUMBER);
+}
+
+static esp_err_t handle_escape(json_reader_t *r, char c)
+{
+    char out;
+    switch (c)
+    {
+    case '"':  out = '"';  break;
+    case '\\': out = '\\'; break;
+    case '/':  out = '/';  break;
+    case 'b':  out = '\b'; break;
+    case 'f':  out = '\f'; break;
+    case 'n':  out = '\n'; break;
+    case 'r':  out = '\r'; break;
+    case 't':  out = '\t'; break;
+    case 'u':
+        r->unicode = 0;
+        r->unicode_digits = 0;
+        r->state = STATE_UNICODE;
+        return ESP_OK;
+    default:
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+    if (r->high_surrogate != 0)
+    {
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+    r->state = STATE_STRING;
+    return append_value(r, &out, 1);
+}
+
+static esp_err_t handle_unicode(json_reader_t *r, char c)
+{
+    uint32_t digit;
+    if (c >= '0' && c <= '9')
+    {
+        digit = c - '0';
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+        digit = c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+        digit = c - 'A' + 10;
+    }
+    else
+    {
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+
+    r->unicode = (r->unicode << 4) | digit;
+    if (++r->unicode_digits < 4)
+    {
+        return ESP_OK;
+    }
+
+    r->state = STATE_STRING;
+    uint32_t cp = r->unicode;
+    if (cp >= 0xD800 && cp <= 0xDBFF)
+    {
+        // High surrogate, must be followed by \uDC00-\uDFFF
+        if (r->high_surrogate != 0)
+        {
+            return fail(r, ESP_ERR_INVALID_ARG);
+        }
+        r->high_surrogate = cp;
+        return ESP_OK;
+    }
+    if (cp >= 0xDC00 && cp <= 0xDFFF)
+    {
+        if (r->high_surrogate == 0)
+        {
+            return fail(r, ESP_ERR_INVALID_ARG);
+        }
+        cp = 0x10000 + ((r->high_surrogate - 0xD800) << 10) + (cp - 0xDC00);
+        r->high_surrogate = 0;
+    }
+    else if (r->high_surrogate != 0)
+    {
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+    return append_utf8(r, cp);
+}
+
+static esp_err_t feed_char(json_reader_t *r, char c)
+{
+    switch (r->state)
+    {
+    case STATE_STRING:
+        if (r->high_surrogate != 0 && c != '\\')
+        {
+            return fail(r, ESP_ERR_INVALID_ARG);
+        }
+        if (c == '"')
+        {
+            return r->string_is_key ? set_key(r) : emit_value(r, JSON_READER_STRING);
+        }
+        if (c == '\\')
+        {
+            r->state = STATE_ESCAPE;
+            return ESP_OK;
+        }
+        if ((unsigned char)c < 0x20)
+        {
+            return fail(r, ESP_ERR_INVALID_ARG);
+        }
+        return append_value(r, &c, 1);
+
+    case STATE_ESCAPE:
+        return handle_escape(r, c);
+
+    case STATE_UNICODE:
+        return handle_unicode(r, c);
+
+    case STATE_LITERAL:
+        if (c >= 'a' && c <= 'z')
+        {
+            return append_value(r, &c, 1);
+        }
+        if (finish_literal(r) != ESP_OK)
+        {
+            return r->err;
+        }
+        return feed_char(r, c);
+
+    case STATE_NUMBER:
+        if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')
+        {
+            return append_value(r, &c, 1);
+        }
+        if (finish_number(r) != ESP_OK)
+        {
+            return r->err;
+        }
+        return feed_char(r, c);
+
+    default:
+        break;
+    }
+
+    if (is_space(c))
+    {
+        return ESP_OK;
+    }
+
+    switch (r->state)
+    {
+    case STATE_VALUE:
+        if (r->depth == 0 && c != '{' && c != '[')
+        {
+            // Only objects and arrays are accepted as request bodies
+            return fail(r, ESP_ERR_INVALID_ARG);
+        }
+        return begin_value(r, c);
+
+    case STATE_VALUE_OR_END:
+        if (c == ']')
+        {
+            return close_container(r, true);
+        }
+        return begin_value(r, c);
+
+    case STATE_KEY_OR_END:
+        if (c == '}')
+        {
+            return close_container(r, false);
+        }
+        /* fall through */
+    case STATE_KEY:
+        if (c != '"')
+        {
+            return fail(r, ESP_ERR_INVALID_ARG);
+        }
+        r->string_is_key = true;
+        r->state = STATE_STRING;
+        return ESP_OK;
+
+    case STATE_COLON:
+        if (c != ':')
+        {
+            return fail(r, ESP_ERR_INVALID_ARG);
+        }
+        r->state = STATE_VALUE;
+        return ESP_OK;
+
+    case STATE_AFTER_VALUE:
+        if (c == ',')
+        {
+            if (r->is_array[r->depth])
+            {
+                r->state = STATE_VALUE;
+            }
+            else
+            {
+                r->path[r->path_len[r->depth]] = '\0';
+                r->state = STATE_KEY;
+            }
+            return ESP_OK;
+        }
+        if (c == '}' || c == ']')
+        {
+            if (!r->is_array[r->depth])
+            {
+                r->path[r->path_len[r->depth]] = '\0';
+            }
+            return close_container(r, c == ']');
+        }
+        return fail(r, ESP_ERR_INVALID_ARG);
+
+    default:
+        // STATE_DONE: only trailing whitespace is allowed
+        return fail(r, ESP_ERR_INVALID_ARG);
+    }
+}
+
+void json_reader_init(json_reader_t *reader, json_reader_cb_t cb, void *ctx)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->cb = cb;
+    reader->ctx = ctx;
+    reader->state = STATE_VALUE;
+}
+
+esp_err_t json_reader_feed(json_reader_t *reader, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len && reader->err == ESP_OK; i++)
+    {
+        feed_char(reader, data[i]);
+    }
+    return reader->err;
+}
+
+esp_err_t json_reader_finish(json_reader_t *reader)
+{
+    if (reader->err != ESP_OK)
+    {
+        return reader->err;
+    }
+    return (reader->state == STATE_DONE) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
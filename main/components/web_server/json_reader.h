@@ -0,0 +1,105 @@
+/**
+ * @file json_reader.h
+ * @brief Incremental, bounded-memory JSON parser for HTTP request bodies
+ *
+ * Bytes are fed as they arrive from httpd_req_recv(); no tree is built and no
+ * heap is used. Every scalar value is reported to a callback together with
+ * its dotted member path, e.g. {"wifi":{"ssid":"x"}} yields "wifi.ssid".
+ * Array elements are reported with the path of the array itself.
+ *
+ * String values are unescaped (including \\uXXXX to UTF-8) into a fixed
+ * buffer; longer strings, deeper nesting or longer paths fail the parse with
+ * ESP_ERR_INVALID_SIZE instead of consuming more memory.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JSON_READER_MAX_DEPTH 8         ///< Maximum nesting of objects/arrays
+#define JSON_READER_MAX_PATH 48         ///< Maximum dotted path length
+#define JSON_READER_MAX_VALUE 96        ///< Maximum scalar length (unescaped)
+
+/**
+ * @brief Type of a reported value
+ */
+typedef enum {
+    JSON_READER_STRING,     ///< String, value holds the unescaped text
+    JSON_READER_NUMBER,     ///< Number, value holds the number text
+    JSON_READER_BOOL,       ///< Boolean, value is "true" or "false"
+    JSON_READER_NULL,       ///< null
+} json_reader_type_t;
+
+/**
+ * @brief Value callback
+ *
+ * @param ctx User context passed to json_reader_init()
+ * @param path Dotted member path of the value
+ * @param type Value type
+ * @param value NUL-terminated value text
+ * @param len Length of value in bytes
+ * @return ESP_OK to continue, any other code aborts parsing with that error
+ */
+typedef esp_err_t (*json_reader_cb_t)(void *ctx, const char *path, json_reader_type_t type,
+                                      const char *value, size_t len);
+
+/**
+ * @brief Parser state (opaque, lives on the caller's stack)
+ */
+typedef struct {
+    json_reader_cb_t cb;
+    void *ctx;
+    esp_err_t err;
+    uint8_t state;
+    uint8_t depth;
+    bool is_array[JSON_READER_MAX_DEPTH + 1];
+    uint8_t path_len[JSON_READER_MAX_DEPTH + 1];
+    char path[JSON_READER_MAX_PATH];
+    char value[JSON_READER_MAX_VALUE];
+    size_t value_len;
+    bool string_is_key;
+    uint8_t unicode_digits;
+    uint32_t unicode;
+    uint32_t high_surrogate;
+} json_reader_t;
+
+/**
+ * @brief Initialize a parser
+ *
+ * @param reader Parser to initialize
+ * @param cb Callback for every scalar value
+ * @param ctx User context for the callback
+ */
+void json_reader_init(json_reader_t *reader, json_reader_cb_t cb, void *ctx);
+
+/**
+ * @brief Feed the next part of the document
+ *
+ * @param reader Parser
+ * @param data Bytes to parse
+ * @param len Number of bytes
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a syntax error,
+ *         ESP_ERR_INVALID_SIZE if a limit was exceeded, or a callback error
+ */
+esp_err_t json_reader_feed(json_reader_t *reader, const char *data, size_t len);
+
+/**
+ * @brief Check that the document is complete
+ *
+ * @return ESP_OK if a complete top-level object or array was parsed
+ */
+esp_err_t json_reader_finish(json_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,303 @@
+/**
+ * @file json_writer.c
+ * @brief Allocation-free streaming JSON writer for HTTP responses
+ *
+ * Formatting mirrors cJSON_Print() (cJSON 1.7.x), see json_writer.h.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "json_writer.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Output Helpers
+// ============================================================================
+
+static void flush(json_writer_t *w)
+{
+    if (w->len == 0)
+    {
+        return;
+    }
+    if (w->req == NULL)
+    {
+        w->err = ESP_ERR_NO_MEM;
+        return;
+    }
+    esp_err_t ret = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    if (ret != ESP_OK)
+    {
+        w->err = ret;
+        return;
+    }
+    w->chunked = true;
+    w->len = 0;
+}
+
+static void put(json_writer_t *w, const char *data, size_t len)
+{
+    while (len > 0 && w->err == ESP_OK)
+    {
+        // Keep one byte for the NUL terminator in buffer-only mode
+        size_t space = w->size - w->len - 1;
+        if (space == 0)
+        {
+            flush(w);
+            continue;
+        }
+        size_t n = len < space ? len : space;
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void put_char(json_writer_t *w, char c)
+{
+    put(w, &c, 1);
+}
+
+static void put_tabs(json_writer_t *w, size_t count)
+{
+    while (count-- > 0)
+    {
+        put_char(w, '\t');
+    }
+}
+
+static void put_string(json_writer_t *w, const char *str)
+{
+    if (str == NULL)
+    {
+        put(w, "\"\"", 2);
+        return;
+    }
+
+    put_char(w, '"');
+    const char *run = str;
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++)
+    {
+        char escape = 0;
+        switch (*p)
+        {
+        case '"':  escape = '"';  break;
+        case '\\': escape = '\\'; break;
+        case '\b': escape = 'b';  break;
+        case '\f': escape = 'f';  break;
+        case '\n': escape = 'n';  break;
+        case '\r': escape = 'r';  break;
+        case '\t': escape = 't';  break;
+        default:
+            if (*p >= 32)
+            {
+                continue;
+            }
+            break;
+        }
+
+        // Emit the unescaped run before this character
+        put(w, run, (const char *)p - run);
+        run = (const char *)p + 1;
+        if (escape != 0)
+        {
+            char seq[2] = {'\\', escape};
+            put(w, seq, sizeof(seq));
+        }
+        else
+        {
+            char seq[7];
+            snprintf(seq, sizeof(seq), "\\u%04x", *p);
+            put(w, seq, 6);
+        }
+    }
+    put(w, run, strlen(run));
+    put_char(w, '"');
+}
+
+/**
+ * @brief Emit separator, indentation and key before a value
+ */
+static void begin_value(json_writer_t *w, const char *key)
+{
+    if (w->depth == 0)
+    {
+        return;
+    }
+
+    bool first = !w->has_items[w->depth];
+    w->has_items[w->depth] = true;
+
+    if (w->is_array[w->depth])
+    {
+        if (!first)
+        {
+            put(w, ", ", 2);
+        }
+        return;
+    }
+
+    if (!first)
+    {
+        put(w, ",\n", 2);
+    }
+    put_tabs(w, w->depth);
+    put_string(w, key);
+    put(w, ":\t", 2);
+}
+
+static void begin_container(json_writer_t *w, const char *key, bool is_array)
+{
+    begin_value(w, key);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH)
+    {
+        w->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    put(w, is_array ? "[" : "{\n", is_array ? 1 : 2);
+    w->depth++;
+    w->has_items[w->depth] = false;
+    w->is_array[w->depth] = is_array;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void json_writer_init(json_writer_t *writer, httpd_req_t *req, char *buf, size_t size)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->req = req;
+    writer->buf = buf;
+    writer->size = size;
+    writer->err = (buf == NULL || size < 2) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+void json_writer_object_begin(json_writer_t *writer, const char *key)
+{
+    begin_container(writer, key, false);
+}
+
+void json_writer_object_end(json_writer_t *writer)
+{
+    if (writer->depth == 0 || writer->is_array[writer->depth])
+    {
+        writer->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    if (writer->has_items[writer->depth])
+    {
+        put_char(writer, '\n');
+    }
+    put_tabs(writer, writer->depth - 1);
+    put_char(writer, '}');
+    writer->depth--;
+}
+
+void json_writer_array_begin(json_writer_t *writer, const char *key)
+{
+    begin_container(writer, key, true);
+}
+
+void json_writer_array_end(json_writer_t *writer)
+{
+    if (writer->depth == 0 || !writer->is_array[writer->depth])
+    {
+        writer->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    put_char(writer, ']');
+    writer->depth--;
+}
+
+void json_writer_string(json_writer_t *writer, const char *key, const char *value)
+{
+    begin_value(writer, key);
+    put_string(writer, value);
+}
+
+void json_writer_number(json_writer_t *writer, const char *key, double value)
+{
+    char number[26];
+    int length;
+
+    // Same rules as cJSON print_number(): integers via valueint, otherwise
+    // 15 significant digits unless that does not round-trip
+    int valueint;
+    if (value >= INT_MAX)
+    {
+        valueint = INT_MAX;
+    }
+    else if (value <= (double)INT_MIN)
+    {
+        valueint = INT_MIN;
+    }
+    else
+    {
+        valueint = (int)value;
+    }
+
+    if (isnan(value) || isinf(value))
+    {
+        length = snprintf(number, sizeof(number), "null");
+    }
+    else if (value == (double)valueint)
+    {
+        length = snprintf(number, sizeof(number), "%d", valueint);
+    }
+    else
+    {
+        double test = 0.0;
+        length = snprintf(number, sizeof(number), "%1.15g", value);
+        if (sscanf(number, "%lg", &test) != 1 ||
+            fabs(test - value) > fmax(fabs(test), fabs(value)) * DBL_EPSILON)
+        {
+            length = snprintf(number, sizeof(number), "%1.17g", value);
+        }
+    }
+
+    begin_value(writer, key);
+    put(writer, number, (size_t)length);
+}
+
+void json_writer_bool(json_writer_t *writer, const char *key, bool value)
+{
+    begin_value(writer, key);
+    put(writer, value ? "true" : "false", value ? 4 : 5);
+}
+
+esp_err_t json_writer_finish(json_writer_t *writer)
+{
+    if (writer->err == ESP_OK && writer->depth != 0)
+    {
+        writer->err = ESP_ERR_INVALID_STATE;
+    }
+    if (writer->err != ESP_OK)
+    {
+        return writer->err;
+    }
+
+    if (writer->req == NULL)
+    {
+        writer->buf[writer->len] = '\0';
+        return ESP_OK;
+    }
+
+    if (!writer->chunked)
+    {
+        return httpd_resp_send(writer->req, writer->buf, writer->len);
+    }
+
+    flush(writer);
+    if (writer->err != ESP_OK)
+    {
+        return writer->err;
+    }
+    return httpd_resp_send_chunk(writer->req, NULL, 0);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file json_writer.h
+ * @brief Allocation-free streaming JSON writer for HTTP responses
+ *
+ * Writes JSON directly into a caller-provided buffer (typically on the
+ * handler's stack). When the buffer fills up it is flushed to the client with
+ * httpd_resp_send_chunk(); a response that fits completely is sent with a
+ * single httpd_resp_send() so it keeps its Content-Length.
+ *
+ * The output is byte-for-byte identical to cJSON_Print() for the same
+ * document: tab indentation, "key":<TAB>value members, ", " separated arrays
+ * and cJSON's number formatting.
+ *
+ * Errors are sticky: once a call fails all further calls are ignored and the
+ * error is reported by json_writer_finish().
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum nesting depth of objects and arrays
+ */
+#define JSON_WRITER_MAX_DEPTH 8
+
+/**
+ * @brief Suggested size for a per-request stack buffer
+ */
+#define JSON_WRITER_BUFFER_SIZE 512
+
+/**
+ * @brief JSON writer state
+ */
+typedef struct {
+    httpd_req_t *req;                           ///< Target request, NULL for buffer-only mode
+    char *buf;                                  ///< Output buffer
+    size_t size;                                ///< Output buffer size
+    size_t len;                                 ///< Bytes currently in the buffer
+    bool chunked;                               ///< Part of the output was already sent as chunk
+    esp_err_t err;                              ///< First error encountered
+    uint8_t depth;                              ///< Current nesting depth
+    bool has_items[JSON_WRITER_MAX_DEPTH + 1];  ///< Container at depth already has members
+    bool is_array[JSON_WRITER_MAX_DEPTH + 1];   ///< Container at depth is an array
+} json_writer_t;
+
+/**
+ * @brief Initialize a writer
+ *
+ * @param writer Writer to initialize
+ * @param req HTTP request to send the document to, or NULL to only fill the
+ *            buffer (overflow is then reported as ESP_ERR_NO_MEM)
+ * @param buf Output buffer
+ * @param size Size of the output buffer
+ */
+void json_writer_init(json_writer_t *writer, httpd_req_t *req, char *buf, size_t size);
+
+/**
+ * @brief Begin an object
+ *
+ * @param writer Writer
+ * @param key Member name when inside an object, NULL at top level or in arrays
+ */
+void json_writer_object_begin(json_writer_t *writer, const char *key);
+
+/**
+ * @brief End the current object
+ */
+void json_writer_object_end(json_writer_t *writer);
+
+/**
+ * @brief Begin an array
+ *
+ * @param writer Writer
+ * @param key Member name when inside an object, NULL at top level or in arrays
+ */
+void json_writer_array_begin(json_writer_t *writer, const char *key);
+
+/**
+ * @brief End the current array
+ */
+void json_writer_array_end(json_writer_t *writer);
+
+/**
+ * @brief Write a string value (NULL is written as "")
+ */
+void json_writer_string(json_writer_t *writer, const char *key, const char *value);
+
+/**
+ * @brief Write a number value, formatted like cJSON
+ */
+void json_writer_number(json_writer_t *writer, const char *key, double value);
+
+/**
+ * @brief Write a boolean value
+ */
+void json_writer_bool(json_writer_t *writer, const char *key, bool value);
+
+/**
+ * @brief Complete the document
+ *
+ * With a request, sends the buffered output (or the final chunks). In
+ * buffer-only mode, NUL-terminates the buffer.
+ *
+ * @param writer Writer
+ * @return ESP_OK on success, first error encountered otherwise
+ */
+esp_err_t json_writer_finish(json_writer_t *writer);
+
+/**
+ * @brief Get the number of bytes written to the buffer (buffer-only mode)
+ */
+static inline size_t json_writer_length(const json_writer_t *writer)
+{
+    return writer->len;
+}
+
+#ifdef __cplusplus
+}
+#endif
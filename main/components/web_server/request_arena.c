@@ -0,0 +1,168 @@
+/**
+ * @file request_arena.c
+ * @brief Fixed pool of per-request memory arenas
+ *
+ * All arenas live in one block allocated at startup. An arena is a bump
+ * pointer over its slice of that block; binding it to a request and
+ * resetting it are a slot update under a short critical section.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "request_arena.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <stdbool.h>
+
+static const char *TAG = "request_arena";
+
+#define REQUEST_ARENA_ALIGN 8
+
+/**
+ * @brief One arena of the pool
+ */
+typedef struct {
+    httpd_req_t *owner;         ///< Request holding the arena, NULL when free
+    size_t used;                ///< Bytes handed out since the last reset
+} arena_slot_t;
+
+static uint8_t *s_pool = NULL;
+static size_t s_arena_size = 0;
+static arena_slot_t s_slots[REQUEST_ARENA_MAX_COUNT];
+static size_t s_slot_count = 0;
+static request_arena_stats_t s_stats;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static arena_slot_t *find_slot(httpd_req_t *owner)
+{
+    for (size_t i = 0; i < s_slot_count; i++)
+    {
+        if (s_slots[i].owner == owner)
+        {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t request_arena_init(size_t count, size_t size)
+{
+    if (count == 0 || count > REQUEST_ARENA_MAX_COUNT)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_pool != NULL)
+    {
+        return ESP_OK;
+    }
+
+    size = (size + REQUEST_ARENA_ALIGN - 1) & ~(size_t)(REQUEST_ARENA_ALIGN - 1);
+    s_pool = heap_caps_malloc(count * size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s_pool == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate %u arenas of %u bytes", (unsigned)count, (unsigned)size);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_arena_size = size;
+    s_slot_count = count;
+    s_stats.count = count;
+    s_stats.size = size;
+
+    ESP_LOGI(TAG, "Allocated %u request arenas of %u bytes", (unsigned)count, (unsigned)size);
+    return ESP_OK;
+}
+
+esp_err_t request_arena_acquire(httpd_req_t *req)
+{
+    if (s_pool == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    arena_slot_t *slot = find_slot(NULL);
+    if (slot != NULL)
+    {
+        slot->owner = req;
+        slot->used = 0;
+        if (++s_stats.in_use > s_stats.peak_in_use)
+        {
+            s_stats.peak_in_use = s_stats.in_use;
+        }
+    }
+    else
+    {
+        s_stats.exhausted++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (slot == NULL)
+    {
+        ESP_LOGW(TAG, "No free arena for %s", req->uri);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+void request_arena_release(httpd_req_t *req)
+{
+    if (req == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    arena_slot_t *slot = find_slot(req);
+    if (slot != NULL)
+    {
+        if (slot->used > s_stats.peak_bytes)
+        {
+            s_stats.peak_bytes = slot->used;
+        }
+        slot->owner = NULL;
+        slot->used = 0;
+        s_stats.in_use--;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void *request_arena_alloc(httpd_req_t *req, size_t size)
+{
+    if (req == NULL)
+    {
+        return NULL;
+    }
+
+    void *ptr = NULL;
+    size = (size + REQUEST_ARENA_ALIGN - 1) & ~(size_t)(REQUEST_ARENA_ALIGN - 1);
+
+    taskENTER_CRITICAL(&s_lock);
+    arena_slot_t *slot = find_slot(req);
+    if (slot != NULL && size <= s_arena_size - slot->used)
+    {
+        ptr = s_pool + (size_t)(slot - s_slots) * s_arena_size + slot->used;
+        slot->used += size;
+    }
+    else if (slot != NULL)
+    {
+        s_stats.failed_allocs++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (ptr == NULL)
+    {
+        ESP_LOGW(TAG, "Arena allocation of %u bytes failed for %s", (unsigned)size, req->uri);
+    }
+    return ptr;
+}
+
+void request_arena_get_stats(request_arena_stats_t *stats)
+{
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file request_arena.h
+ * @brief Fixed pool of per-request memory arenas for HTTP handlers
+ *
+ * Handler scratch memory (JSON output buffers, request body parser state,
+ * scan result copies) comes from an arena that is bound to the request for
+ * the duration of the handler and reset when it returns. The pool is
+ * allocated once when the server starts, so serving requests never touches
+ * the heap and heap use stays flat however many requests arrive:
+ *
+ *     char *buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+ *     if (buf == NULL)
+ *     {
+ *         // arena exhausted, answer 503
+ *     }
+ *
+ * Allocations are bump allocations and cannot be freed individually; they
+ * all go away with request_arena_release(). The web server acquires the
+ * arena around every handler and async_handler.c does the same for requests
+ * it moves to a worker, so handlers only call request_arena_alloc().
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REQUEST_ARENA_MAX_COUNT 8       ///< Upper limit for the pool size
+
+/**
+ * @brief Arena pool statistics
+ */
+typedef struct {
+    size_t count;               ///< Arenas in the pool
+    size_t size;                ///< Bytes per arena
+    size_t in_use;              ///< Arenas bound to a request now
+    size_t peak_in_use;         ///< Most arenas bound at the same time
+    size_t peak_bytes;          ///< Most bytes one request has allocated
+    uint32_t exhausted;         ///< Requests that found no free arena
+    uint32_t failed_allocs;     ///< Allocations that did not fit their arena
+} request_arena_stats_t;
+
+/**
+ * @brief Allocate the arena pool
+ *
+ * The pool is allocated once and survives server restarts; later calls are
+ * no-ops.
+ *
+ * @param count Number of arenas (requests that can be served at the same time)
+ * @param size Bytes per arena
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if count is 0 or exceeds
+ *         REQUEST_ARENA_MAX_COUNT, ESP_ERR_NO_MEM if the pool cannot be
+ *         allocated
+ */
+esp_err_t request_arena_init(size_t count, size_t size);
+
+/**
+ * @brief Bind a free arena to a request
+ *
+ * @param req Request that owns the arena until request_arena_release()
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the pool is not initialized,
+ *         ESP_ERR_NOT_FOUND if every arena is in use
+ */
+esp_err_t request_arena_acquire(httpd_req_t *req);
+
+/**
+ * @brief Reset the arena of a request and return it to the pool
+ *
+ * Does nothing if the request holds no arena.
+ */
+void request_arena_release(httpd_req_t *req);
+
+/**
+ * @brief Allocate memory from the arena of a request
+ *
+ * The memory is 8-byte aligned, uninitialized and valid until the request's
+ * arena is released.
+ *
+ * @param req Request holding an arena
+ * @param size Bytes to allocate
+ * @return Pointer to the memory, or NULL if the request holds no arena or
+ *         the arena is full
+ */
+void *request_arena_alloc(httpd_req_t *req, size_t size);
+
+/**
+ * @brief Get pool statistics
+ */
+void request_arena_get_stats(request_arena_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
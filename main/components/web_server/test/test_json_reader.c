@@ -0,0 +1,87 @@
+/**
+ * @file test_json_reader.c
+ * @brief Unity tests for the request body JSON reader
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "json_reader.h"
+#include "unity.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Last number reported by the reader
+ */
+typedef struct {
+    char value[JSON_READER_MAX_VALUE];
+    int count;
+} number_capture_t;
+
+static esp_err_t capture_number(void *ctx, const char *path, json_reader_type_t type,
+                                const char *value, size_t len)
+{
+    number_capture_t *capture = ctx;
+    if (type == JSON_READER_NUMBER) {
+        memcpy(capture->value, value, len + 1);
+        capture->count++;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Parse {"n":<number>} in one piece and return the first error
+ */
+static esp_err_t parse_number(const char *number, number_capture_t *capture)
+{
+    char doc[64];
+    snprintf(doc, sizeof(doc), "{\"n\":%s}", number);
+    memset(capture, 0, sizeof(*capture));
+
+    json_reader_t reader;
+    json_reader_init(&reader, capture_number, capture);
+    esp_err_t ret = json_reader_feed(&reader, doc, strlen(doc));
+    return ret != ESP_OK ? ret : json_reader_finish(&reader);
+}
+
+TEST_CASE("json_reader accepts valid numbers", "[json_reader]")
+{
+    static const char *const valid[] = {
+        "0", "-0", "7", "-12", "120", "0.5", "-3.25", "1e3", "1E+3", "2.5e-10", "0e0",
+    };
+    number_capture_t capture;
+    for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+        TEST_ASSERT_EQUAL_MESSAGE(ESP_OK, parse_number(valid[i], &capture), valid[i]);
+        TEST_ASSERT_EQUAL_INT(1, capture.count);
+        TEST_ASSERT_EQUAL_STRING(valid[i], capture.value);
+    }
+}
+
+TEST_CASE("json_reader rejects malformed numbers", "[json_reader]")
+{
+    static const char *const malformed[] = {
+        "--1", "1e", "01", "1-2", "-", "1.", ".5", "1.e3", "1e+", "+1", "-01", "1.2.3", "1e2e3",
+    };
+    number_capture_t capture;
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        TEST_ASSERT_EQUAL_MESSAGE(ESP_ERR_INVALID_ARG, parse_number(malformed[i], &capture), malformed[i]);
+        TEST_ASSERT_EQUAL_INT(0, capture.count);
+    }
+}
+
+TEST_CASE("json_reader checks numbers split across chunks", "[json_reader]")
+{
+    number_capture_t capture = { 0 };
+    json_reader_t reader;
+    json_reader_init(&reader, capture_number, &capture);
+    TEST_ASSERT_EQUAL(ESP_OK, json_reader_feed(&reader, "{\"n\":1", 6));
+    TEST_ASSERT_EQUAL(ESP_OK, json_reader_feed(&reader, "2.5e", 4));
+    TEST_ASSERT_EQUAL(ESP_OK, json_reader_feed(&reader, "1}", 2));
+    TEST_ASSERT_EQUAL(ESP_OK, json_reader_finish(&reader));
+    TEST_ASSERT_EQUAL_STRING("12.5e1", capture.value);
+
+    json_reader_init(&reader, capture_number, &capture);
+    TEST_ASSERT_EQUAL(ESP_OK, json_reader_feed(&reader, "{\"n\":1", 6));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, json_reader_feed(&reader, "e,\"m\":2}", 8));
+}
@@ -0,0 +1,35 @@
+/**
+ * @file web_assets.c
+ * @brief Lookup in the generated static asset table
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "web_assets.h"
+#include <string.h>
+
+const web_asset_t *web_assets_find(const char *path)
+{
+    size_t low = 0;
+    size_t high = web_assets_count;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        int cmp = strcmp(path, web_assets[mid].path);
+        if (cmp == 0)
+        {
+            return &web_assets[mid];
+        }
+        if (cmp < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file web_assets.h
+ * @brief Embedded static web assets generated at build time
+ *
+ * The asset table is generated from the www/ directory by
+ * tools/build_web_assets.py. Every entry holds the minified plain file, its
+ * precompressed gzip variant, the MIME type and a strong ETag per
+ * representation. Entries are sorted by URI path so lookups use binary search.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Embedded static asset
+ */
+typedef struct {
+    const char *path;           ///< URI path, e.g. "/css/style.css"
+    const char *mime_type;      ///< Content-Type of the asset
+    const char *etag;           ///< Strong ETag (quoted) of the plain representation
+    const char *gz_etag;        ///< Strong ETag (quoted) of the gzip representation
+    const uint8_t *data;        ///< Minified plain contents
+    const uint8_t *gz_data;     ///< Gzip-compressed contents
+    size_t size;                ///< Plain size in bytes
+    size_t gz_size;             ///< Gzip size in bytes
+} web_asset_t;
+
+/**
+ * @brief Generated asset table, sorted by path (strcmp order)
+ */
+extern const web_asset_t web_assets[];
+
+/**
+ * @brief Number of entries in web_assets
+ */
+extern const size_t web_assets_count;
+
+/**
+ * @brief Find an embedded asset by URI path
+ *
+ * @param path URI path without query string (e.g. "/index.html")
+ * @return Asset entry, or NULL if no asset matches
+ */
+const web_asset_t *web_assets_find(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -16,23 +16,90 @@
 #include "web_server.h"
 #include "wifi_manager.h"
 #include "config_manager.h"
+#include "web_assets.h"
+#include "json_writer.h"
+#include "json_reader.h"
+#include "ws_push.h"
+#include "async_handler.h"
+#include "netif_uart_tunnel_sim.h"
+#include "cert_handler.h"
+#include "boot_manager.h"
+#include "power_manager.h"
+#include "http_metrics.h"
+#include "measurement.h"
+#include "measurement_history.h"
+#include "request_arena.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_heap_caps.h"
 #include "esp_timer.h"
 #include "esp_http_server.h"
+#ifdef CONFIG_WEB_SERVER_HTTPS
+#include "esp_https_server.h"
+#ifndef CONFIG_ESP_TLS_SERVER_CERT_SELECT_HOOK
+#error "CONFIG_WEB_SERVER_HTTPS needs CONFIG_ESP_TLS_SERVER_CERT_SELECT_HOOK (selected by Kconfig)"
+#endif
+#include "mbedtls/ssl_ciphersuites.h"
+#endif
 #include "esp_wifi.h"
 #include "esp_timer.h"
-#include "cJSON.h"
+#include <errno.h>
+#include <math.h>
 #include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lwip/sockets.h"
 
 static const char *TAG = "web_server";
 
+// Static responses are sent in pieces no larger than the TCP send buffer
+#define WEB_SERVER_STATIC_CHUNK_SIZE CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+
+// Request bodies are parsed while received, in pieces of this size
+#define WEB_SERVER_MAX_BODY_SIZE 2048   ///< Larger bodies are rejected with 413
+#define WEB_SERVER_RECV_CHUNK_SIZE 128  ///< Arena buffer per httpd_req_recv()
+#define WEB_SERVER_RECV_RETRIES 3       ///< Socket timeouts tolerated per body
+
+// Scratch memory bound to each request while its handler runs
+#ifdef CONFIG_WEB_SERVER_REQUEST_ARENA_SIZE
+#define WEB_SERVER_REQUEST_ARENA_SIZE CONFIG_WEB_SERVER_REQUEST_ARENA_SIZE
+#else
+#define WEB_SERVER_REQUEST_ARENA_SIZE 2048
+#endif
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+// Period at which subscribed WebSocket topics are refreshed
+#define WEB_SERVER_PUSH_INTERVAL_MS 1000
+static esp_timer_handle_t push_timer = NULL;
+
+// The "measurement" topic is refreshed faster, from its own timer
+#ifdef CONFIG_MEASUREMENT_PUSH_INTERVAL_MS
+#define WEB_SERVER_MEASUREMENT_PUSH_INTERVAL_MS CONFIG_MEASUREMENT_PUSH_INTERVAL_MS
+#else
+#define WEB_SERVER_MEASUREMENT_PUSH_INTERVAL_MS 100
+#endif
+#define WEB_SERVER_MEASUREMENT_READ_BATCH 16
+static esp_timer_handle_t measurement_push_timer = NULL;
+static measurement_reader_t measurement_push_reader;
+static bool measurement_push_active = false;
+#endif
+
+// GET /api/distance/history: binary responses are staged in chunks of this size
+#define WEB_SERVER_HISTORY_CHUNK_BYTES  512
+#define WEB_SERVER_HISTORY_HEADER_BYTES 16
+
 // Restart timer handle for safe device restart after configuration save
 static esp_timer_handle_t restart_timer = NULL;
 
 // Timer callback for delayed restart
 static void restart_timer_callback(void* arg)
 {
+    // Make sure a debounced configuration save reaches NVS first
+    esp_err_t flush_ret = config_flush();
+    if (flush_ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to flush configuration before restart: %s", esp_err_to_name(flush_ret));
+    }
     ESP_LOGI(TAG, "Restarting device now...");
     esp_restart();
 }
@@ -60,149 +127,352 @@ static esp_err_t config_reset_handler(httpd_req_t *req);
 // System health and diagnostics (REQ-CFG-11)
 static esp_err_t system_health_handler(httpd_req_t *req);
 
-// Distance sensor data endpoint - DISABLED in template
-// static esp_err_t distance_data_handler(httpd_req_t *req);
+// Combined status, health and configuration for a single round trip
+static esp_err_t batch_handler(httpd_req_t *req);
 
-// CORS support for API endpoints
-static esp_err_t cors_preflight_handler(httpd_req_t *req);
+// Latest sample of the measurement pipeline
+static esp_err_t distance_data_handler(httpd_req_t *req);
 
-// Static file serving declarations
-extern const uint8_t index_html_start[] asm("_binary_index_html_start");
-extern const uint8_t index_html_end[] asm("_binary_index_html_end");
-extern const uint8_t wifi_setup_html_start[] asm("_binary_wifi_setup_html_start");
-extern const uint8_t wifi_setup_html_end[] asm("_binary_wifi_setup_html_end");
-extern const uint8_t settings_html_start[] asm("_binary_settings_html_start");
-extern const uint8_t settings_html_end[] asm("_binary_settings_html_end");
-extern const uint8_t style_css_start[] asm("_binary_style_css_start");
-extern const uint8_t style_css_end[] asm("_binary_style_css_end");
-extern const uint8_t app_js_start[] asm("_binary_app_js_start");
-extern const uint8_t app_js_end[] asm("_binary_app_js_end");
-
-// Helper functions for static file serving
-static const char *get_mime_type(const char *filename);
-static esp_err_t get_embedded_file(const char *filename, const uint8_t **data, size_t *size);
+// Downsampled measurement history
+static esp_err_t distance_history_handler(httpd_req_t *req);
 
-// HTTP request handlers
-static esp_err_t root_handler(httpd_req_t *req)
-{
-    ESP_LOGI(TAG, "Root request - serving main dashboard");
+// CORS support for API endpoints
+static esp_err_t cors_preflight_handler(httpd_req_t *req);
 
-    // Modify the request URI to serve index.html
-    char original_uri[64];
-    strncpy(original_uri, req->uri, sizeof(original_uri) - 1);
-    strcpy((char *)req->uri, "/index.html");
+/**
+ * @brief Parsed body of POST /connect
+ */
+typedef struct {
+    wifi_credentials_t credentials;     ///< Requested credentials
+    bool has_ssid;                      ///< "ssid" member was present
+} connect_request_t;
 
-    esp_err_t result = static_file_handler(req);
+/**
+ * @brief Parse state for POST /api/config
+ */
+typedef struct {
+    system_config_t config;             ///< Configuration being updated
+    const char *invalid_field;          ///< First field with an out-of-range value
+} config_request_t;
 
-    // Restore original URI
-    strcpy((char *)req->uri, original_uri);
+/**
+ * @brief Who renders a health document
+ *
+ * Task CPU figures cover the time since the same caller's previous document,
+ * so rendering from the benchmark stage does not reset the window seen by
+ * HTTP clients.
+ */
+typedef enum {
+    HEALTH_CALLER_HTTP = 0,             ///< Health and batch requests (httpd task)
+    HEALTH_CALLER_RENDER,               ///< web_server_render_document()
+    HEALTH_CALLER_COUNT
+} health_caller_t;
+
+// Shared JSON documents
+static void write_status_json(json_writer_t *json, const char *key, const wifi_status_t *status);
+static void write_health_json(json_writer_t *json, const char *key, health_caller_t caller);
+static void write_config_document(json_writer_t *json, const char *key, const system_config_t *config);
+static void write_batch_json(json_writer_t *json, health_caller_t caller);
+static void write_measurement_fields(json_writer_t *json, const measurement_t *sample);
+
+// Request arena helpers
+static esp_err_t send_arena_exhausted(httpd_req_t *req);
+
+// Request body parsing helpers
+static esp_err_t read_json_body(httpd_req_t *req, json_reader_cb_t cb, void *ctx);
+static esp_err_t connect_field_cb(void *ctx, const char *path, json_reader_type_t type,
+                                  const char *value, size_t len);
+static esp_err_t config_field_cb(void *ctx, const char *path, json_reader_type_t type,
+                                 const char *value, size_t len);
+
+// Static file serving helpers (assets come from the generated web_assets table)
+static esp_err_t send_static_asset(httpd_req_t *req, const char *path);
+static bool client_accepts_gzip(httpd_req_t *req);
+static bool etag_matches(httpd_req_t *req, const char *etag);
+static esp_err_t get_requested_range(httpd_req_t *req, const char *etag, size_t total,
+                                     size_t *start, size_t *end);
+static esp_err_t send_body_chunked(httpd_req_t *req, const uint8_t *data, size_t size);
+
+#ifdef CONFIG_WEB_SERVER_HTTPS
+// TLS handshake power hold (see HTTPS section)
+static void https_release_handshake_hold(void);
+#endif
+
+// ============================================================================
+// Request Arena
+// ============================================================================
 
-    return result;
+/**
+ * @brief Answer a request whose arena is missing or full
+ *
+ * Only happens when more requests are in flight than arenas exist or a
+ * handler needs more scratch memory than CONFIG_WEB_SERVER_REQUEST_ARENA_SIZE;
+ * the client may simply retry.
+ */
+static esp_err_t send_arena_exhausted(httpd_req_t *req)
+{
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    return httpd_resp_send(req, "{\"error\":\"Server busy\"}", HTTPD_RESP_USE_STRLEN);
 }
 
-static esp_err_t config_handler(httpd_req_t *req)
+// ============================================================================
+// Request Body Parsing
+// ============================================================================
+
+/**
+ * @brief Receive a request body and feed it to a streaming JSON parser
+ *
+ * The body is read in small pieces into the request arena, so memory use does
+ * not depend on the body size. Bodies that arrive in several TCP segments are handled
+ * and short socket timeouts are retried.
+ *
+ * @param req HTTP request
+ * @param cb Callback receiving every JSON value with its dotted path
+ * @param ctx Context for the callback
+ * @return ESP_OK on success,
+ *         ESP_ERR_INVALID_SIZE if the body or a value exceeds the limits,
+ *         ESP_ERR_INVALID_ARG if the body is not valid JSON,
+ *         ESP_ERR_TIMEOUT if the client stopped sending,
+ *         ESP_FAIL if the connection was closed before the body was complete,
+ *         ESP_ERR_NO_MEM if the request arena is exhausted,
+ *         or an error returned by the callback
+ */
+static esp_err_t read_json_body(httpd_req_t *req, json_reader_cb_t cb, void *ctx)
 {
-    ESP_LOGI(TAG, "Config request - serving WiFi setup page");
+    if (req->content_len > WEB_SERVER_MAX_BODY_SIZE)
+    {
+        ESP_LOGW(TAG, "Request body too large: %zu bytes", req->content_len);
+        return ESP_ERR_INVALID_SIZE;
+    }
 
-    // Modify the request URI to serve the WiFi setup page
-    char original_uri[64];
-    strncpy(original_uri, req->uri, sizeof(original_uri) - 1);
-    strcpy((char *)req->uri, "/wifi-setup.html");
+    json_reader_t *reader = request_arena_alloc(req, sizeof(json_reader_t));
+    char *chunk = request_arena_alloc(req, WEB_SERVER_RECV_CHUNK_SIZE);
+    if (reader == NULL || chunk == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    json_reader_init(reader, cb, ctx);
 
-    esp_err_t result = static_file_handler(req);
+    size_t remaining = req->content_len;
+    int timeouts = 0;
+    while (remaining > 0)
+    {
+        int received = httpd_req_recv(req, chunk,
+                                      remaining < WEB_SERVER_RECV_CHUNK_SIZE ? remaining : WEB_SERVER_RECV_CHUNK_SIZE);
+        if (received == HTTPD_SOCK_ERR_TIMEOUT)
+        {
+            if (++timeouts > WEB_SERVER_RECV_RETRIES)
+            {
+                return ESP_ERR_TIMEOUT;
+            }
+            continue;
+        }
+        if (received <= 0)
+        {
+            ESP_LOGW(TAG, "Request body incomplete, %zu bytes missing", remaining);
+            return ESP_FAIL;
+        }
+        timeouts = 0;
+        remaining -= received;
 
-    // Restore original URI
-    strcpy((char *)req->uri, original_uri);
+        esp_err_t ret = json_reader_feed(reader, chunk, received);
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+    }
 
-    return result;
+    return json_reader_finish(reader);
 }
 
-static esp_err_t scan_handler(httpd_req_t *req)
+/**
+ * @brief Copy a parsed string value into a fixed-size field
+ *
+ * @return ESP_ERR_INVALID_SIZE if the value does not fit (instead of truncating)
+ */
+static esp_err_t copy_string_field(char *dst, size_t dst_size, const char *value, size_t len)
 {
-    ESP_LOGI(TAG, "WiFi scan request");
+    if (len >= dst_size)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, value, len + 1);
+    return ESP_OK;
+}
 
-    httpd_resp_set_type(req, "application/json");
-    // CORS: Commented out broad origin for security. Can be re-enabled with specific URL for hybrid GitHub Pages approach
-    // httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    // httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "https://yourusername.github.io");  // For future hybrid approach
+/**
+ * @brief json_reader callback for POST /connect
+ */
+static esp_err_t connect_field_cb(void *ctx, const char *path, json_reader_type_t type,
+                                  const char *value, size_t len)
+{
+    connect_request_t *request = (connect_request_t *)ctx;
+    if (type != JSON_READER_STRING)
+    {
+        return ESP_OK;
+    }
 
-    // Start WiFi scan
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = false,
-        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-        .scan_time.active.min = 100,
-        .scan_time.active.max = 300,
-    };
+    if (strcmp(path, "ssid") == 0)
+    {
+        request->has_ssid = true;
+        return copy_string_field(request->credentials.ssid, sizeof(request->credentials.ssid), value, len);
+    }
+    if (strcmp(path, "password") == 0)
+    {
+        return copy_string_field(request->credentials.password, sizeof(request->credentials.password), value, len);
+    }
+    return ESP_OK;
+}
 
-    esp_err_t ret = esp_wifi_scan_start(&scan_config, true);
-    if (ret != ESP_OK)
+/**
+ * @brief json_reader callback for POST /api/config
+ *
+ * Maps members to fields through the config_manager descriptor table and
+ * updates the configuration in place. Unknown members are ignored and members
+ * of the wrong type are skipped, as before. Out-of-range numbers are recorded
+ * and reported as a validation failure once the body has been parsed.
+ */
+static esp_err_t config_field_cb(void *ctx, const char *path, json_reader_type_t type,
+                                 const char *value, size_t len)
+{
+    config_request_t *request = (config_request_t *)ctx;
+    const config_descriptor_t *desc = config_find_descriptor(path);
+    if (desc == NULL)
     {
-        ESP_LOGE(TAG, "WiFi scan failed: %s", esp_err_to_name(ret));
+        return ESP_OK;
+    }
 
-        // If we're in AP mode, we might need to switch to APSTA mode for scanning
-        wifi_mode_t current_mode;
-        if (esp_wifi_get_mode(&current_mode) == ESP_OK && current_mode == WIFI_MODE_AP)
+    if (desc->type == CONFIG_TYPE_STRING)
+    {
+        if (type != JSON_READER_STRING || ((desc->flags & CONFIG_DESC_SECRET) && len == 0))
         {
-            ESP_LOGW(TAG, "Switching to APSTA mode for WiFi scanning");
-            esp_wifi_set_mode(WIFI_MODE_APSTA);
-            vTaskDelay(pdMS_TO_TICKS(100)); // Give time for mode switch
-            ret = esp_wifi_scan_start(&scan_config, true);
+            return ESP_OK; // Secrets are only updated if a new value is provided
         }
+        return config_set_field_string(&request->config, desc, value, len);
+    }
 
-        if (ret != ESP_OK)
+    if (type != JSON_READER_NUMBER)
+    {
+        return ESP_OK;
+    }
+
+    // Convert from JSON units (e.g. cm) to stored units (e.g. mm)
+    char *end;
+    double number = strtod(value, &end);
+    if (end != value + len)
+    {
+        return ESP_ERR_INVALID_ARG; // Rejected like malformed JSON
+    }
+    number *= desc->json_scale;
+    bool representable = number > (double)INT32_MIN && number < (double)INT32_MAX;
+    int32_t rounded = representable ? (int32_t)(number + ((number < 0) ? -0.5 : 0.5)) : 0;
+    if (!representable || config_set_field_value(&request->config, desc, rounded) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Configuration value for '%s' out of range: %.*s", path, (int)len, value);
+        if (request->invalid_field == NULL)
         {
-            return httpd_resp_send(req, "{\"error\":\"Scan failed\"}", HTTPD_RESP_USE_STRLEN);
+            request->invalid_field = desc->name;
         }
     }
+    return ESP_OK;
+}
+
+// HTTP request handlers
+static esp_err_t root_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "Root request - serving main dashboard");
+    return send_static_asset(req, "/index.html");
+}
 
-    // Get scan results
-    uint16_t ap_count = 0;
-    esp_wifi_scan_get_ap_num(&ap_count);
+static esp_err_t config_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "Config request - serving WiFi setup page");
+    return send_static_asset(req, "/wifi-setup.html");
+}
 
-    if (ap_count == 0)
+/**
+ * @brief Check whether the request query asks for a fresh scan (?refresh=1)
+ */
+static bool scan_refresh_requested(httpd_req_t *req)
+{
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK)
+    {
+        return false;
+    }
+    if (httpd_query_key_value(query, "refresh", value, sizeof(value)) != ESP_OK)
     {
-        return httpd_resp_send(req, "{\"networks\":[]}", HTTPD_RESP_USE_STRLEN);
+        return false;
     }
+    return strcmp(value, "0") != 0 && strcmp(value, "false") != 0;
+}
 
-    wifi_ap_record_t *ap_records = malloc(sizeof(wifi_ap_record_t) * ap_count);
-    if (ap_records == NULL)
+static esp_err_t scan_handler(httpd_req_t *req)
+{
+    if (async_handler_submit(req, scan_handler))
     {
-        ESP_LOGE(TAG, "Failed to allocate memory for scan results");
-        return httpd_resp_send(req, "{\"error\":\"Memory allocation failed\"}", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
     }
 
-    esp_wifi_scan_get_ap_records(&ap_count, ap_records);
+    ESP_LOGD(TAG, "WiFi scan request");
+
+    httpd_resp_set_type(req, "application/json");
+    // CORS: Commented out broad origin for security. Can be re-enabled with specific URL for hybrid GitHub Pages approach
+    // httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    // httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "https://yourusername.github.io");  // For future hybrid approach
 
-    // Build JSON response
-    cJSON *root = cJSON_CreateObject();
-    cJSON *networks = cJSON_CreateArray();
+    // Results come from the background scan cache; scanning never blocks the server task
+    wifi_scan_entry_t *entries = request_arena_alloc(req, WIFI_SCAN_CACHE_SIZE * sizeof(wifi_scan_entry_t));
+    char *json_buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+    if (entries == NULL || json_buf == NULL)
+    {
+        return send_arena_exhausted(req);
+    }
+    wifi_scan_info_t info;
+    size_t count = wifi_manager_get_scan_results(entries, WIFI_SCAN_CACHE_SIZE, &info);
 
-    for (int i = 0; i < ap_count; i++)
+    if (scan_refresh_requested(req) || (info.age_ms == UINT32_MAX && !info.scanning))
     {
-        cJSON *network = cJSON_CreateObject();
-        cJSON_AddStringToObject(network, "ssid", (char *)ap_records[i].ssid);
-        cJSON_AddNumberToObject(network, "rssi", ap_records[i].rssi);
-        cJSON_AddNumberToObject(network, "authmode", ap_records[i].authmode);
-        cJSON_AddItemToArray(networks, network);
+        if (wifi_manager_scan_start() == ESP_OK)
+        {
+            info.scanning = true;
+        }
     }
 
-    cJSON_AddItemToObject(root, "networks", networks);
+    json_writer_t json;
+    json_writer_init(&json, req, json_buf, JSON_WRITER_BUFFER_SIZE);
+    json_writer_object_begin(&json, NULL);
+    json_writer_array_begin(&json, "networks");
 
-    char *json_string = cJSON_Print(root);
-    httpd_resp_send(req, json_string, HTTPD_RESP_USE_STRLEN);
+    for (size_t i = 0; i < count; i++)
+    {
+        json_writer_object_begin(&json, NULL);
+        json_writer_string(&json, "ssid", entries[i].ssid);
+        json_writer_number(&json, "rssi", entries[i].rssi);
+        json_writer_number(&json, "authmode", entries[i].authmode);
+        json_writer_number(&json, "channel", entries[i].channel);
+        json_writer_number(&json, "age_ms", entries[i].age_ms);
+        json_writer_object_end(&json);
+    }
 
-    free(json_string);
-    cJSON_Delete(root);
-    free(ap_records);
+    json_writer_array_end(&json);
+    json_writer_number(&json, "age_ms", info.age_ms == UINT32_MAX ? -1 : (double)info.age_ms);
+    json_writer_bool(&json, "scanning", info.scanning);
+    json_writer_object_end(&json);
 
-    return ESP_OK;
+    return json_writer_finish(&json);
 }
 
 static esp_err_t connect_handler(httpd_req_t *req)
 {
+    if (async_handler_submit(req, connect_handler))
+    {
+        return ESP_OK;
+    }
+
     ESP_LOGI(TAG, "WiFi connect request");
 
     httpd_resp_set_type(req, "application/json");
@@ -210,48 +480,32 @@ static esp_err_t connect_handler(httpd_req_t *req)
     // httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     // httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "https://yourusername.github.io");  // For future hybrid approach
 
-    // Read POST data
-    char *buf = malloc(req->content_len + 1);
-    if (buf == NULL)
+    // Parse POST data as it arrives
+    connect_request_t request = {0};
+    esp_err_t parse_ret = read_json_body(req, connect_field_cb, &request);
+    if (parse_ret == ESP_ERR_INVALID_SIZE)
     {
-        return httpd_resp_send(req, "{\"success\":false,\"error\":\"Memory allocation failed\"}", HTTPD_RESP_USE_STRLEN);
+        httpd_resp_set_status(req, "413 Payload Too Large");
+        return httpd_resp_send(req, "{\"success\":false,\"error\":\"Request too large\"}", HTTPD_RESP_USE_STRLEN);
     }
-
-    int ret = httpd_req_recv(req, buf, req->content_len);
-    if (ret <= 0)
+    if (parse_ret == ESP_ERR_INVALID_ARG)
     {
-        free(buf);
-        return httpd_resp_send(req, "{\"success\":false,\"error\":\"Failed to read request\"}", HTTPD_RESP_USE_STRLEN);
+        return httpd_resp_send(req, "{\"success\":false,\"error\":\"Invalid JSON\"}", HTTPD_RESP_USE_STRLEN);
     }
-    buf[ret] = '\0';
-
-    // Parse JSON
-    cJSON *root = cJSON_Parse(buf);
-    free(buf);
-
-    if (root == NULL)
+    if (parse_ret == ESP_ERR_NO_MEM)
     {
-        return httpd_resp_send(req, "{\"success\":false,\"error\":\"Invalid JSON\"}", HTTPD_RESP_USE_STRLEN);
+        return send_arena_exhausted(req);
     }
-
-    cJSON *ssid_json = cJSON_GetObjectItem(root, "ssid");
-    cJSON *password_json = cJSON_GetObjectItem(root, "password");
-
-    if (!cJSON_IsString(ssid_json))
+    if (parse_ret != ESP_OK)
     {
-        cJSON_Delete(root);
-        return httpd_resp_send(req, "{\"success\":false,\"error\":\"SSID required\"}", HTTPD_RESP_USE_STRLEN);
+        return httpd_resp_send(req, "{\"success\":false,\"error\":\"Failed to read request\"}", HTTPD_RESP_USE_STRLEN);
     }
 
-    wifi_credentials_t credentials = {0};
-    strncpy(credentials.ssid, ssid_json->valuestring, sizeof(credentials.ssid) - 1);
-
-    if (cJSON_IsString(password_json))
+    if (!request.has_ssid)
     {
-        strncpy(credentials.password, password_json->valuestring, sizeof(credentials.password) - 1);
+        return httpd_resp_send(req, "{\"success\":false,\"error\":\"SSID required\"}", HTTPD_RESP_USE_STRLEN);
     }
-
-    cJSON_Delete(root);
+    wifi_credentials_t credentials = request.credentials;
 
     ESP_LOGI(TAG, "Attempting to connect to SSID: %s", credentials.ssid);
     ESP_LOGI(TAG, "Password: '%s' (length: %d)", credentials.password, strlen(credentials.password));
@@ -281,29 +535,51 @@ static esp_err_t status_handler(httpd_req_t *req)
         return httpd_resp_send(req, "{\"error\":\"Failed to get status\"}", HTTPD_RESP_USE_STRLEN);
     }
 
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "mode", status.mode);
-    cJSON_AddStringToObject(root, "ssid", status.connected_ssid);
-    cJSON_AddNumberToObject(root, "rssi", status.rssi);
-    cJSON_AddBoolToObject(root, "has_credentials", status.has_credentials);
-
-    char ip_str[16];
-    if (wifi_manager_get_ip_address(ip_str, sizeof(ip_str)) == ESP_OK)
+    char *json_buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+    if (json_buf == NULL)
     {
-        cJSON_AddStringToObject(root, "ip", ip_str);
+        return send_arena_exhausted(req);
     }
+    json_writer_t json;
+    json_writer_init(&json, req, json_buf, JSON_WRITER_BUFFER_SIZE);
+    write_status_json(&json, NULL, &status);
 
-    char *json_string = cJSON_Print(root);
-    httpd_resp_send(req, json_string, HTTPD_RESP_USE_STRLEN);
+    return json_writer_finish(&json);
+}
 
-    free(json_string);
-    cJSON_Delete(root);
+/**
+ * @brief Write the WiFi status document (GET /status and the "status" push topic)
+ *
+ * @param key Member name when nested in another object, NULL for a top-level document
+ */
+static void write_status_json(json_writer_t *json, const char *key, const wifi_status_t *status)
+{
+    json_writer_object_begin(json, key);
+    json_writer_number(json, "mode", status->mode);
+    json_writer_string(json, "ssid", status->connected_ssid);
+    json_writer_number(json, "rssi", status->rssi);
+    json_writer_bool(json, "has_credentials", status->has_credentials);
+    if (status->mode == WIFI_MODE_STA_CONNECTED)
+    {
+        json_writer_number(json, "connect_time_ms", status->connect_time_ms);
+        json_writer_bool(json, "fast_connect", status->fast_connect);
+    }
 
-    return ESP_OK;
+    char ip_str[16];
+    if (wifi_manager_get_ip_address(ip_str, sizeof(ip_str)) == ESP_OK)
+    {
+        json_writer_string(json, "ip", ip_str);
+    }
+    json_writer_object_end(json);
 }
 
 static esp_err_t reset_handler(httpd_req_t *req)
 {
+    if (async_handler_submit(req, reset_handler))
+    {
+        return ESP_OK;
+    }
+
     ESP_LOGI(TAG, "WiFi reset request");
 
     httpd_resp_set_type(req, "application/json");
@@ -342,669 +618,2667 @@ static esp_err_t reset_handler(httpd_req_t *req)
 }
 
 // Static file serving functions
-static const char *get_mime_type(const char *filename)
+/**
+ * @brief Check whether the client accepts gzip content encoding
+ *
+ * Looks for a "gzip" token in the Accept-Encoding header. A token explicitly
+ * disabled with "q=0" is treated as not accepted.
+ */
+static bool client_accepts_gzip(httpd_req_t *req)
 {
-    const char *ext = strrchr(filename, '.');
-    if (ext == NULL)
+    char accept_encoding[128];
+    size_t len = httpd_req_get_hdr_value_len(req, "Accept-Encoding");
+    if (len == 0)
     {
-        return "text/plain";
+        return false;
     }
 
-    if (strcmp(ext, ".html") == 0)
+    // A truncated header value is still good enough for token matching
+    if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept_encoding, sizeof(accept_encoding)) != ESP_OK &&
+        len < sizeof(accept_encoding))
     {
-        return "text/html";
+        return false;
     }
-    else if (strcmp(ext, ".css") == 0)
+    accept_encoding[sizeof(accept_encoding) - 1] = '\0';
+
+    const char *token = strstr(accept_encoding, "gzip");
+    if (token == NULL)
     {
-        return "text/css";
+        return false;
     }
-    else if (strcmp(ext, ".js") == 0)
+
+    // Reject "gzip;q=0" (or "q=0.0"), everything else counts as accepted
+    const char *params = token + strlen("gzip");
+    while (*params == ' ')
     {
-        return "application/javascript";
+        params++;
     }
-    else if (strcmp(ext, ".json") == 0)
+    if (*params == ';')
     {
-        return "application/json";
+        const char *q = strstr(params, "q=");
+        const char *next = strchr(params, ',');
+        if (q != NULL && (next == NULL || q < next) && strtod(q + 2, NULL) == 0.0)
+        {
+            return false;
+        }
     }
-    else
+    return true;
+}
+
+/**
+ * @brief Check whether If-None-Match names the given entity tag
+ *
+ * Uses the weak comparison required for If-None-Match, so a "W/" prefix on
+ * the client's tag is ignored. "*" matches any representation.
+ */
+static bool etag_matches(httpd_req_t *req, const char *etag)
+{
+    char if_none_match[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) != ESP_OK)
+    {
+        return false;
+    }
+
+    size_t etag_len = strlen(etag);
+    const char *p = if_none_match;
+    while (*p != '\0')
     {
-        return "text/plain";
+        while (*p == ' ' || *p == ',')
+        {
+            p++;
+        }
+        if (*p == '*')
+        {
+            return true;
+        }
+        if (strncmp(p, "W/", 2) == 0)
+        {
+            p += 2;
+        }
+
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        while (len > 0 && p[len - 1] == ' ')
+        {
+            len--;
+        }
+        if (len == etag_len && strncmp(p, etag, len) == 0)
+        {
+            return true;
+        }
+        if (end == NULL)
+        {
+            break;
+        }
+        p = end + 1;
     }
+    return false;
 }
 
-static esp_err_t get_embedded_file(const char *filename, const uint8_t **data, size_t *size)
+/**
+ * @brief Parse a single byte range from the Range header
+ *
+ * Supports "bytes=first-last", "bytes=first-" and "bytes=-suffix". Multiple
+ * ranges are not supported and result in the full body being sent, which is
+ * allowed by RFC 9110. If-Range is honoured: when it does not match the
+ * current ETag the Range header is ignored.
+ *
+ * @return ESP_OK if a valid range was requested,
+ *         ESP_ERR_NOT_FOUND if the full body should be sent,
+ *         ESP_ERR_INVALID_SIZE if the range cannot be satisfied
+ */
+static esp_err_t get_requested_range(httpd_req_t *req, const char *etag, size_t total,
+                                     size_t *start, size_t *end)
 {
-    ESP_LOGI(TAG, "Getting embedded file: %s", filename);
-
-    if (strcmp(filename, "/index.html") == 0 || strcmp(filename, "/") == 0)
+    char range[48];
+    if (httpd_req_get_hdr_value_str(req, "Range", range, sizeof(range)) != ESP_OK)
     {
-        *data = index_html_start;
-        *size = index_html_end - index_html_start;
-        ESP_LOGI(TAG, "Found index.html, size: %zu", *size);
+        return ESP_ERR_NOT_FOUND;
     }
-    else if (strcmp(filename, "/wifi-setup.html") == 0)
+
+    char if_range[48];
+    if (httpd_req_get_hdr_value_str(req, "If-Range", if_range, sizeof(if_range)) == ESP_OK &&
+        strcmp(if_range, etag) != 0)
     {
-        *data = wifi_setup_html_start;
-        *size = wifi_setup_html_end - wifi_setup_html_start;
-        ESP_LOGI(TAG, "Found wifi-setup.html, size: %zu", *size);
+        return ESP_ERR_NOT_FOUND;
     }
-    else if (strcmp(filename, "/settings.html") == 0)
+
+    if (strncmp(range, "bytes=", 6) != 0 || strchr(range, ',') != NULL)
     {
-        *data = settings_html_start;
-        *size = settings_html_end - settings_html_start;
-        ESP_LOGI(TAG, "Found settings.html, size: %zu", *size);
+        return ESP_ERR_NOT_FOUND;
     }
-    else if (strcmp(filename, "/css/style.css") == 0)
+
+    const char *spec = range + 6;
+    const char *dash = strchr(spec, '-');
+    if (dash == NULL || total == 0)
     {
-        *data = style_css_start;
-        *size = style_css_end - style_css_start;
-        ESP_LOGI(TAG, "Found style.css, size: %zu", *size);
+        return ESP_ERR_NOT_FOUND;
     }
-    else if (strcmp(filename, "/js/app.js") == 0)
+
+    char *parse_end;
+    if (dash == spec)
     {
-        *data = app_js_start;
-        *size = app_js_end - app_js_start;
-        ESP_LOGI(TAG, "Found app.js, size: %zu", *size);
+        // Suffix range: last N bytes
+        unsigned long suffix = strtoul(dash + 1, &parse_end, 10);
+        if (parse_end == dash + 1 || *parse_end != '\0')
+        {
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (suffix == 0)
+        {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        *start = suffix >= total ? 0 : total - suffix;
+        *end = total - 1;
+        return ESP_OK;
     }
-    else
+
+    unsigned long first = strtoul(spec, &parse_end, 10);
+    if (parse_end != dash)
     {
-        ESP_LOGW(TAG, "File not found in embedded files: %s", filename);
         return ESP_ERR_NOT_FOUND;
     }
+    unsigned long last = total - 1;
+    if (dash[1] != '\0')
+    {
+        last = strtoul(dash + 1, &parse_end, 10);
+        if (*parse_end != '\0' || last < first)
+        {
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+    if (first >= total)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *start = first;
+    *end = last >= total ? total - 1 : last;
     return ESP_OK;
 }
 
-esp_err_t static_file_handler(httpd_req_t *req)
+/**
+ * @brief Send a response body in pieces sized to the lwIP send buffer
+ *
+ * Small bodies go out with a single httpd_resp_send() so they keep their
+ * Content-Length. Larger ones are split into WEB_SERVER_STATIC_CHUNK_SIZE
+ * chunks so a single send never queues more than the socket can buffer.
+ */
+static esp_err_t send_body_chunked(httpd_req_t *req, const uint8_t *data, size_t size)
 {
-    const char *uri = req->uri;
-    const uint8_t *data;
-    size_t size;
+    if (size <= WEB_SERVER_STATIC_CHUNK_SIZE)
+    {
+        return httpd_resp_send(req, (const char *)data, size);
+    }
 
-    ESP_LOGI(TAG, "Serving static file: %s", uri);
+    size_t offset = 0;
+    while (offset < size)
+    {
+        size_t chunk = size - offset;
+        if (chunk > WEB_SERVER_STATIC_CHUNK_SIZE)
+        {
+            chunk = WEB_SERVER_STATIC_CHUNK_SIZE;
+        }
+        esp_err_t ret = httpd_resp_send_chunk(req, (const char *)data + offset, chunk);
+        if (ret != ESP_OK)
+        {
+            // Client went away mid-transfer, it may resume with a Range request
+            ESP_LOGW(TAG, "Static transfer aborted at %zu/%zu bytes: %s", offset, size, esp_err_to_name(ret));
+            return ret;
+        }
+        offset += chunk;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
 
-    esp_err_t ret = get_embedded_file(uri, &data, &size);
-    if (ret != ESP_OK)
+/**
+ * @brief Send an embedded asset, honouring Accept-Encoding and If-None-Match
+ */
+static esp_err_t send_static_asset(httpd_req_t *req, const char *path)
+{
+    const web_asset_t *asset = web_assets_find(path);
+    if (asset == NULL)
     {
-        ESP_LOGW(TAG, "File not found: %s", uri);
+        ESP_LOGW(TAG, "File not found: %s", path);
         httpd_resp_send_404(req);
         return ESP_FAIL;
     }
+    ESP_LOGD(TAG, "Serving static file: %s", path);
 
-    // Set appropriate content type
-    const char *mime_type = get_mime_type(uri);
-    httpd_resp_set_type(req, mime_type);
+    // Prefer the precompressed blob, fall back to the plain file
+    bool use_gzip = asset->gz_size > 0 && client_accepts_gzip(req);
+    const char *etag = use_gzip ? asset->gz_etag : asset->etag;
 
-    // Set cache headers for static assets
-    if (strstr(uri, ".css") || strstr(uri, ".js"))
+    httpd_resp_set_type(req, asset->mime_type);
+
+    // CSS/JS may be cached briefly, pages are always revalidated via ETag
+    if (strcmp(asset->mime_type, "text/html") == 0)
     {
-        httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=3600");
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
     }
     else
     {
-        httpd_resp_set_hdr(req, "Cache-Control", "no-cache, no-store, must-revalidate");
-        httpd_resp_set_hdr(req, "Pragma", "no-cache");
-        httpd_resp_set_hdr(req, "Expires", "0");
+        httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=3600");
     }
 
-    return httpd_resp_send(req, (const char *)data, size);
-}
+    // Response depends on Accept-Encoding, tell caches to key on it
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    httpd_resp_set_hdr(req, "ETag", etag);
 
-// Public functions
-esp_err_t web_server_init(const web_server_config_t *config)
-{
-    if (server != NULL)
+    if (etag_matches(req, etag))
     {
-        ESP_LOGW(TAG, "Web server already initialized");
-        return ESP_ERR_INVALID_STATE;
+        ESP_LOGD(TAG, "Not modified: %s", path);
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
 
-    if (config != NULL)
+    const uint8_t *body = asset->data;
+    size_t body_size = asset->size;
+    if (use_gzip)
     {
-        current_config = *config;
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        body = asset->gz_data;
+        body_size = asset->gz_size;
     }
-    else
+    httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+
+    // Partial content for resumed downloads (byte offsets of the selected representation)
+    size_t range_start = 0;
+    size_t range_end = body_size - 1;
+    char content_range[48];
+    esp_err_t range = get_requested_range(req, etag, body_size, &range_start, &range_end);
+    if (range == ESP_ERR_INVALID_SIZE)
     {
-        web_server_config_t default_config = WEB_SERVER_DEFAULT_CONFIG();
-        current_config = default_config;
+        snprintf(content_range, sizeof(content_range), "bytes */%zu", body_size);
+        httpd_resp_set_hdr(req, "Content-Range", content_range);
+        httpd_resp_set_status(req, "416 Range Not Satisfiable");
+        return httpd_resp_send(req, NULL, 0);
+    }
+    if (range == ESP_OK)
+    {
+        snprintf(content_range, sizeof(content_range), "bytes %zu-%zu/%zu", range_start, range_end, body_size);
+        httpd_resp_set_hdr(req, "Content-Range", content_range);
+        httpd_resp_set_status(req, "206 Partial Content");
+        ESP_LOGD(TAG, "Range %s for %s", content_range, path);
     }
 
-    ESP_LOGI(TAG, "Initializing web server on port %d", current_config.port);
-
-    httpd_config_t httpd_config = HTTPD_DEFAULT_CONFIG();
-    httpd_config.server_port = current_config.port;
-    httpd_config.max_open_sockets = current_config.max_open_sockets;
-    httpd_config.max_uri_handlers = 32; // Increase to 32 to ensure we have plenty of slots
-    httpd_config.lru_purge_enable = true;
-
-    ESP_LOGI(TAG, "HTTP config: port=%d, max_sockets=%d, max_handlers=%d",
-             httpd_config.server_port, httpd_config.max_open_sockets, httpd_config.max_uri_handlers);
+    return send_body_chunked(req, body + range_start, range_end - range_start + 1);
+}
 
-    if (httpd_start(&server, &httpd_config) != ESP_OK)
+esp_err_t static_file_handler(httpd_req_t *req)
+{
+    // Look up the path without any query string
+    char path[64];
+    size_t len = strcspn(req->uri, "?#");
+    if (len >= sizeof(path))
     {
-        ESP_LOGE(TAG, "Failed to start HTTP server");
+        httpd_resp_send_404(req);
         return ESP_FAIL;
     }
+    memcpy(path, req->uri, len);
+    path[len] = '\0';
 
-    // Register URI handlers with error checking
-    httpd_uri_t root_uri = {
-        .uri = "/",
-        .method = HTTP_GET,
-        .handler = root_handler,
-        .user_ctx = NULL};
-    esp_err_t ret = httpd_register_uri_handler(server, &root_uri);
-    ESP_LOGI(TAG, "Registered handler for '/' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    return send_static_asset(req, path);
+}
 
-    httpd_uri_t config_uri = {
-        .uri = "/config",
-        .method = HTTP_GET,
-        .handler = config_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &config_uri);
-    ESP_LOGI(TAG, "Registered handler for '/config' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+// ============================================================================
+// WebSocket Push
+// ============================================================================
 
-    httpd_uri_t scan_uri = {
-        .uri = "/scan",
-        .method = HTTP_GET,
-        .handler = scan_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &scan_uri);
-    ESP_LOGI(TAG, "Registered handler for '/scan' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+/**
+ * @brief Publish the current state of all subscribed topics
+ *
+ * Runs periodically in the esp_timer task. ws_push only sends a topic when its
+ * document changed since the last tick.
+ */
+static void push_timer_callback(void *arg)
+{
+    uint32_t topics = ws_push_subscribed_topics();
+    if (topics == 0)
+    {
+        return;
+    }
 
-    httpd_uri_t connect_uri = {
-        .uri = "/connect",
-        .method = HTTP_POST,
-        .handler = connect_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &connect_uri);
-    ESP_LOGI(TAG, "Registered handler for '/connect' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    char json_buf[JSON_WRITER_BUFFER_SIZE];
+    json_writer_t json;
 
-    httpd_uri_t status_uri = {
-        .uri = "/status",
-        .method = HTTP_GET,
-        .handler = status_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &status_uri);
-    ESP_LOGI(TAG, "Registered handler for '/status' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    if (topics & (1U << WS_TOPIC_STATUS))
+    {
+        wifi_status_t status;
+        if (wifi_manager_get_status(&status) == ESP_OK)
+        {
+            json_writer_init(&json, NULL, json_buf, sizeof(json_buf));
+            write_status_json(&json, NULL, &status);
+            if (json_writer_finish(&json) == ESP_OK)
+            {
+                ws_push_publish(WS_TOPIC_STATUS, json_buf, json_writer_length(&json));
+            }
+        }
+    }
 
-    httpd_uri_t reset_uri = {
-        .uri = "/reset",
-        .method = HTTP_POST,
-        .handler = reset_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &reset_uri);
-    ESP_LOGI(TAG, "Registered handler for '/reset' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    if (topics & (1U << WS_TOPIC_HEALTH))
+    {
+        // Summary only; uptime is left out so unchanged health is not re-sent
+        json_writer_init(&json, NULL, json_buf, sizeof(json_buf));
+        json_writer_object_begin(&json, NULL);
+        json_writer_number(&json, "free_heap_bytes", esp_get_free_heap_size());
+        json_writer_number(&json, "minimum_free_heap_bytes", esp_get_minimum_free_heap_size());
+        json_writer_number(&json, "ws_clients", ws_push_client_count());
+        json_writer_object_end(&json);
+        if (json_writer_finish(&json) == ESP_OK)
+        {
+            ws_push_publish(WS_TOPIC_HEALTH, json_buf, json_writer_length(&json));
+        }
+    }
 
-    // Register configuration management API handlers (REQ-CFG-7)
-    httpd_uri_t config_get_uri = {
-        .uri = "/api/config",
-        .method = HTTP_GET,
-        .handler = config_get_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &config_get_uri);
-    ESP_LOGI(TAG, "Registered handler for '/api/config' GET - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    // Retry clients that were not writable on the previous attempt
+    ws_push_kick();
+}
 
-    httpd_uri_t config_set_uri = {
-        .uri = "/api/config",
-        .method = HTTP_POST,
-        .handler = config_set_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &config_set_uri);
-    ESP_LOGI(TAG, "Registered handler for '/api/config' POST - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+/**
+ * @brief Publish the newest measurement with a summary of the samples since the last push
+ *
+ * Runs periodically in the esp_timer task and reads every sample of the
+ * pipeline while a client is subscribed, so "samples" and "dropped" show how
+ * much of the sample stream reaches the dashboard path.
+ */
+static void measurement_push_callback(void *arg)
+{
+    if ((ws_push_subscribed_topics() & (1U << WS_TOPIC_MEASUREMENT)) == 0)
+    {
+        measurement_push_active = false;
+        return;
+    }
+    if (!measurement_push_active)
+    {
+        measurement_reader_init(&measurement_push_reader);
+        measurement_push_active = true;
+    }
 
-    httpd_uri_t config_reset_uri = {
-        .uri = "/api/config/reset",
-        .method = HTTP_POST,
-        .handler = config_reset_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &config_reset_uri);
-    ESP_LOGI(TAG, "Registered handler for '/api/config/reset' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    measurement_t batch[WEB_SERVER_MEASUREMENT_READ_BATCH];
+    measurement_t latest = {0};
+    size_t samples = 0;
+    uint16_t min_mm = UINT16_MAX;
+    uint16_t max_mm = 0;
+    uint32_t dropped = measurement_push_reader.dropped;
+    size_t count;
+    while ((count = measurement_read(&measurement_push_reader, batch, WEB_SERVER_MEASUREMENT_READ_BATCH)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i].status == MEASUREMENT_OK)
+            {
+                min_mm = batch[i].filtered_mm < min_mm ? batch[i].filtered_mm : min_mm;
+                max_mm = batch[i].filtered_mm > max_mm ? batch[i].filtered_mm : max_mm;
+            }
+        }
+        latest = batch[count - 1];
+        samples += count;
+    }
+    dropped = measurement_push_reader.dropped - dropped;
+    if (samples == 0)
+    {
+        return;
+    }
 
-    // Register system health endpoint (REQ-CFG-11)
-    httpd_uri_t system_health_uri = {
-        .uri = "/api/system/health",
-        .method = HTTP_GET,
-        .handler = system_health_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &system_health_uri);
-    ESP_LOGI(TAG, "Registered handler for '/api/system/health' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    char json_buf[JSON_WRITER_BUFFER_SIZE];
+    json_writer_t json;
+    json_writer_init(&json, NULL, json_buf, sizeof(json_buf));
+    json_writer_object_begin(&json, NULL);
+    write_measurement_fields(&json, &latest);
+    json_writer_number(&json, "samples", samples);
+    json_writer_number(&json, "dropped", dropped);
+    if (max_mm >= min_mm)
+    {
+        json_writer_number(&json, "min_cm", min_mm / 10.0);
+        json_writer_number(&json, "max_cm", max_mm / 10.0);
+    }
+    json_writer_object_end(&json);
+    if (json_writer_finish(&json) == ESP_OK)
+    {
+        ws_push_publish(WS_TOPIC_MEASUREMENT, json_buf, json_writer_length(&json));
+    }
+}
 
-    // Distance data endpoint disabled in template - users should implement their own sensor endpoints
-    // Example code available in git history for reference
+/**
+ * @brief Notify WebSocket clients that new scan results are available
+ *
+ * Runs in the WiFi event task. Only a short summary is pushed; clients fetch
+ * the full list from /api/scan.
+ */
+static void scan_done_callback(void *arg)
+{
+    static uint32_t scan_id = 0;
+    wifi_scan_info_t info;
+    wifi_manager_get_scan_results(NULL, 0, &info);
+
+    char json_buf[64];
+    json_writer_t json;
+    json_writer_init(&json, NULL, json_buf, sizeof(json_buf));
+    json_writer_object_begin(&json, NULL);
+    json_writer_number(&json, "scan_id", ++scan_id);
+    json_writer_number(&json, "count", info.count);
+    json_writer_object_end(&json);
+    if (json_writer_finish(&json) == ESP_OK)
+    {
+        ws_push_publish(WS_TOPIC_SCAN, json_buf, json_writer_length(&json));
+        ws_push_kick();
+    }
+}
+#endif // CONFIG_HTTPD_WS_SUPPORT
 
-    // Register CORS preflight handler for all API endpoints
-    httpd_uri_t options_uri = {
-        .uri = "/api/*",
-        .method = HTTP_OPTIONS,
-        .handler = cors_preflight_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &options_uri);
-    ESP_LOGI(TAG, "Registered CORS preflight handler - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+// ============================================================================
+// Connection Management
+// ============================================================================
 
-    // Register static file handlers
-    httpd_uri_t index_uri = {
-        .uri = "/index.html",
-        .method = HTTP_GET,
-        .handler = static_file_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &index_uri);
-    ESP_LOGI(TAG, "Registered handler for '/index.html' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+/**
+ * @brief Open client connection as seen by the session hooks
+ *
+ * The httpd only knows sockets. The peer address and the time data was last
+ * received let persistent connections be closed when idle and keep one client
+ * from holding every socket (with lru_purge_enable, clients would otherwise
+ * keep evicting each other's connections).
+ */
+typedef struct {
+    int fd;                     ///< Socket descriptor, -1 when the slot is free
+    uint32_t peer;              ///< Peer IPv4 address (network byte order)
+    int64_t last_active_us;     ///< esp_timer time of the last received data
+    int metrics_endpoint;       ///< Endpoint the data being sent belongs to (http_metrics)
+    bool awaiting_status;       ///< Next send starts a response with a status line
+} web_session_t;
+
+// The httpd can never hold more client sockets than lwIP provides
+#define WEB_SERVER_MAX_SESSIONS CONFIG_LWIP_MAX_SOCKETS
+// Period of the idle connection sweep
+#define WEB_SERVER_IDLE_SWEEP_MS 5000
+
+static web_session_t sessions[WEB_SERVER_MAX_SESSIONS];
+static portMUX_TYPE sessions_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t idle_timer = NULL;
 
-    httpd_uri_t wifi_setup_uri = {
-        .uri = "/wifi-setup.html",
-        .method = HTTP_GET,
-        .handler = static_file_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &wifi_setup_uri);
-    ESP_LOGI(TAG, "Registered handler for '/wifi-setup.html' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+/**
+ * @brief Check whether a session has been upgraded to a WebSocket
+ *
+ * WebSocket sessions are long-lived by design and exempt from the idle
+ * timeout and from eviction.
+ */
+static bool session_is_websocket(httpd_handle_t hd, int sockfd)
+{
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    return httpd_ws_get_fd_info(hd, sockfd) == HTTPD_WS_CLIENT_WEBSOCKET;
+#else
+    return false;
+#endif
+}
 
-    httpd_uri_t settings_uri = {
-        .uri = "/settings.html",
-        .method = HTTP_GET,
-        .handler = static_file_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &settings_uri);
-    ESP_LOGI(TAG, "Registered handler for '/settings.html' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+/**
+ * @brief Get the IPv4 address of the peer of a socket (0 if unknown)
+ */
+static uint32_t session_peer_address(int sockfd)
+{
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    if (getpeername(sockfd, (struct sockaddr *)&addr, &addr_len) != 0)
+    {
+        return 0;
+    }
+    if (addr.ss_family == AF_INET)
+    {
+        return ((struct sockaddr_in *)&addr)->sin_addr.s_addr;
+    }
+#if CONFIG_LWIP_IPV6
+    if (addr.ss_family == AF_INET6)
+    {
+        // IPv4-mapped addresses carry the IPv4 address in the last word
+        return ((struct sockaddr_in6 *)&addr)->sin6_addr.un.u32_addr[3];
+    }
+#endif
+    return 0;
+}
 
-    httpd_uri_t css_uri = {
-        .uri = "/css/style.css",
-        .method = HTTP_GET,
-        .handler = static_file_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &css_uri);
-    ESP_LOGI(TAG, "Registered handler for '/css/style.css' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+/**
+ * @brief Socket receive hook, records activity for the idle timeout
+ */
+static int session_recv(httpd_handle_t hd, int sockfd, char *buf, size_t buf_len, int flags)
+{
+    int ret = recv(sockfd, buf, buf_len, flags);
+    if (ret < 0)
+    {
+        return (errno == EAGAIN) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
 
-    httpd_uri_t js_uri = {
-        .uri = "/js/app.js",
-        .method = HTTP_GET,
-        .handler = static_file_handler,
-        .user_ctx = NULL};
-    ret = httpd_register_uri_handler(server, &js_uri);
-    ESP_LOGI(TAG, "Registered handler for '/js/app.js' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&sessions_lock);
+    for (size_t i = 0; i < WEB_SERVER_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].fd == sockfd)
+        {
+            sessions[i].last_active_us = now;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&sessions_lock);
+    return ret;
+}
 
-    ESP_LOGI(TAG, "Web server initialized successfully");
-    return ESP_OK;
+#ifndef CONFIG_WEB_SERVER_HTTPS
+/**
+ * @brief Socket send hook, counts status codes and response bytes per endpoint
+ *
+ * Runs on the httpd task or on an async worker. The httpd sends the status
+ * line at the start of the first send of every response.
+ */
+static int session_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    int ret = send(sockfd, buf, buf_len, flags);
+    if (ret < 0)
+    {
+        return (errno == EAGAIN) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+
+    int endpoint = HTTP_METRICS_NO_ENDPOINT;
+    int status = 0;
+    taskENTER_CRITICAL(&sessions_lock);
+    for (size_t i = 0; i < WEB_SERVER_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].fd == sockfd)
+        {
+            endpoint = sessions[i].metrics_endpoint;
+            if (sessions[i].awaiting_status && buf_len >= 12 && memcmp(buf, "HTTP/1.", 7) == 0)
+            {
+                status = (buf[9] - '0') * 100 + (buf[10] - '0') * 10 + (buf[11] - '0');
+                sessions[i].awaiting_status = false;
+            }
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&sessions_lock);
+
+    http_metrics_record_response(endpoint, status, ret);
+    return ret;
 }
 
-esp_err_t web_server_start(void)
+/**
+ * @brief Attribute the next response on a socket to an endpoint
+ */
+static void session_begin_response(int sockfd, int endpoint)
 {
-    if (server == NULL)
+    taskENTER_CRITICAL(&sessions_lock);
+    for (size_t i = 0; i < WEB_SERVER_MAX_SESSIONS; i++)
     {
-        ESP_LOGE(TAG, "Web server not initialized");
-        return ESP_ERR_INVALID_STATE;
+        if (sessions[i].fd == sockfd)
+        {
+            sessions[i].metrics_endpoint = endpoint;
+            sessions[i].awaiting_status = true;
+            break;
+        }
     }
+    taskEXIT_CRITICAL(&sessions_lock);
+}
+#endif
 
-    if (server_running)
+/**
+ * @brief Session open callback, enforces the per-client socket budget
+ *
+ * When the new connection takes a client over max_sockets_per_client, that
+ * client's least recently active HTTP connection is closed. Other clients'
+ * connections are never touched.
+ */
+static esp_err_t session_open_fn(httpd_handle_t hd, int sockfd)
+{
+    uint32_t peer = session_peer_address(sockfd);
+    int peer_fds[WEB_SERVER_MAX_SESSIONS];
+    int64_t peer_active[WEB_SERVER_MAX_SESSIONS];
+    size_t peer_count = 0;
+    bool tracked = false;
+
+    taskENTER_CRITICAL(&sessions_lock);
+    for (size_t i = 0; i < WEB_SERVER_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].fd < 0)
+        {
+            if (!tracked)
+            {
+                sessions[i].fd = sockfd;
+                sessions[i].peer = peer;
+                sessions[i].last_active_us = esp_timer_get_time();
+                sessions[i].metrics_endpoint = HTTP_METRICS_NO_ENDPOINT;
+                sessions[i].awaiting_status = false;
+                tracked = true;
+            }
+        }
+        else if (sessions[i].fd != sockfd && sessions[i].peer == peer)
+        {
+            peer_fds[peer_count] = sessions[i].fd;
+            peer_active[peer_count] = sessions[i].last_active_us;
+            peer_count++;
+        }
+    }
+    taskEXIT_CRITICAL(&sessions_lock);
+
+    if (!tracked)
+    {
+        ESP_LOGW(TAG, "Session table full, socket %d not tracked", sockfd);
+    }
+#ifndef CONFIG_WEB_SERVER_HTTPS
+    httpd_sess_set_recv_override(hd, sockfd, session_recv);
+    httpd_sess_set_send_override(hd, sockfd, session_send);
+#else
+    // The TLS layer owns the socket hooks; the idle timeout then counts from
+    // the handshake, and session tickets keep the reconnect cheap. Status
+    // codes and response bytes are not counted
+#endif
+
+    size_t budget = current_config.max_sockets_per_client;
+    if (budget == 0 || peer_count < budget)
     {
-        ESP_LOGW(TAG, "Web server already running");
         return ESP_OK;
     }
 
-    ESP_LOGI(TAG, "Starting web server");
+    // Over budget: close this client's least recently active HTTP connection
+    int evict_fd = -1;
+    int64_t evict_active = 0;
+    for (size_t i = 0; i < peer_count; i++)
+    {
+        if (session_is_websocket(hd, peer_fds[i]))
+        {
+            continue;
+        }
+        if (evict_fd < 0 || peer_active[i] < evict_active)
+        {
+            evict_fd = peer_fds[i];
+            evict_active = peer_active[i];
+        }
+    }
+    if (evict_fd >= 0)
+    {
+        ESP_LOGD(TAG, "Client holds %d sockets, closing socket %d", (int)peer_count + 1, evict_fd);
+        httpd_sess_trigger_close(hd, evict_fd);
+    }
+    return ESP_OK;
+}
 
-    // Start DNS server for captive portal if we're in AP mode
-    wifi_mode_t wifi_mode;
-    if (esp_wifi_get_mode(&wifi_mode) == ESP_OK &&
-        (wifi_mode == WIFI_MODE_AP || wifi_mode == WIFI_MODE_APSTA))
+/**
+ * @brief Session close callback, keeps the session and WebSocket tables in sync
+ */
+static void session_close_fn(httpd_handle_t hd, int sockfd)
+{
+    taskENTER_CRITICAL(&sessions_lock);
+    for (size_t i = 0; i < WEB_SERVER_MAX_SESSIONS; i++)
     {
-        ESP_LOGI(TAG, "AP mode detected - captive portal available at device IP");
-        // Note: Users can navigate directly to device IP (e.g., 192.168.4.1)
-        // DNS server removed for simplicity - manual navigation still works
+        if (sessions[i].fd == sockfd)
+        {
+            sessions[i].fd = -1;
+            break;
+        }
     }
-    else
+    taskEXIT_CRITICAL(&sessions_lock);
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    ws_push_client_closed(sockfd);
+#endif
+    close(sockfd);
+}
+
+/**
+ * @brief Close HTTP connections that have been idle longer than idle_timeout_s
+ *
+ * Runs on the httpd task (queued by idle_timer_callback).
+ */
+static void session_idle_sweep(void *arg)
+{
+#ifdef CONFIG_WEB_SERVER_HTTPS
+    https_release_handshake_hold();
+#endif
+    int64_t deadline = esp_timer_get_time() - (int64_t)current_config.idle_timeout_s * 1000000LL;
+    int idle_fds[WEB_SERVER_MAX_SESSIONS];
+    size_t idle_count = 0;
+
+    taskENTER_CRITICAL(&sessions_lock);
+    for (size_t i = 0; i < WEB_SERVER_MAX_SESSIONS; i++)
     {
-        ESP_LOGI(TAG, "STA mode - web interface available at assigned IP");
+        if (sessions[i].fd >= 0 && sessions[i].last_active_us < deadline)
+        {
+            idle_fds[idle_count++] = sessions[i].fd;
+        }
     }
+    taskEXIT_CRITICAL(&sessions_lock);
 
-    server_running = true;
-    ESP_LOGI(TAG, "Web server started successfully");
+    for (size_t i = 0; i < idle_count; i++)
+    {
+        if (server != NULL && !session_is_websocket(server, idle_fds[i]))
+        {
+            ESP_LOGD(TAG, "Closing idle socket %d", idle_fds[i]);
+            httpd_sess_trigger_close(server, idle_fds[i]);
+        }
+    }
+}
 
-    return ESP_OK;
+/**
+ * @brief Idle timer callback, moves the sweep onto the httpd task
+ */
+static void idle_timer_callback(void *arg)
+{
+    if (server != NULL)
+    {
+        httpd_queue_work(server, session_idle_sweep, NULL);
+    }
+}
+
+// ============================================================================
+// Request Instrumentation
+// ============================================================================
+
+/**
+ * @brief Registered URI handler and its metrics endpoint
+ */
+typedef struct {
+    esp_err_t (*handler)(httpd_req_t *req);
+    int metrics_endpoint;
+} uri_route_t;
+
+// Filled by web_server_init() before the handlers can run
+static uri_route_t uri_routes[HTTP_METRICS_MAX_ENDPOINTS];
+static size_t uri_route_count = 0;
+
+/**
+ * @brief Serve a request with the CPU at full speed, recording its metrics
+ *
+ * The route travels in user_ctx (see register_uri_handler()). The handler
+ * gets a request arena for its scratch memory; if none is free its
+ * allocations fail and it answers 503. For handlers that move to an async
+ * worker the measured latency covers the hand-off; the worker holds the
+ * device awake and binds an arena on its own until it is done, and its
+ * response is still counted by the socket send hook.
+ */
+static esp_err_t route_handler(httpd_req_t *req)
+{
+    const uri_route_t *route = (const uri_route_t *)req->user_ctx;
+
+#ifndef CONFIG_WEB_SERVER_HTTPS
+    session_begin_response(httpd_req_to_sockfd(req), route->metrics_endpoint);
+#endif
+    int64_t start_us = power_manager_request_begin();
+    request_arena_acquire(req);
+    esp_err_t ret = route->handler(req);
+    request_arena_release(req);
+    uint32_t duration_us = (uint32_t)(esp_timer_get_time() - start_us);
+    power_manager_request_end(start_us);
+
+    http_metrics_record_request(route->metrics_endpoint, req->content_len, duration_us);
+    return ret;
+}
+
+/**
+ * @brief Register a URI handler wrapped in route_handler()
+ */
+static esp_err_t register_uri_handler(const httpd_uri_t *uri)
+{
+    if (uri_route_count >= HTTP_METRICS_MAX_ENDPOINTS)
+    {
+        ESP_LOGE(TAG, "No route slot left for '%s'", uri->uri);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uri_route_t *route = &uri_routes[uri_route_count];
+    route->handler = uri->handler;
+    route->metrics_endpoint = http_metrics_register(uri->uri, uri->method);
+
+    httpd_uri_t wrapped = *uri;
+    wrapped.handler = route_handler;
+    wrapped.user_ctx = route;
+    esp_err_t ret = httpd_register_uri_handler(server, &wrapped);
+    if (ret == ESP_OK)
+    {
+        uri_route_count++;
+    }
+    return ret;
+}
+
+/**
+ * @brief GET /metrics - Request counters and latency histograms (Prometheus text format)
+ */
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    esp_err_t ret = http_metrics_write(req);
+    if (ret == ESP_ERR_NO_MEM)
+    {
+        return send_arena_exhausted(req);
+    }
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to send metrics: %s", esp_err_to_name(ret));
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// Power Management
+// ============================================================================
+
+/**
+ * @brief Write power management state, request latency and current estimate
+ */
+static void write_power_json(json_writer_t *json)
+{
+    power_manager_stats_t stats;
+    if (power_manager_get_stats(&stats) != ESP_OK)
+    {
+        return;
+    }
+
+    json_writer_object_begin(json, "power");
+    json_writer_bool(json, "enabled", stats.enabled);
+    json_writer_bool(json, "light_sleep", stats.light_sleep);
+    json_writer_number(json, "cpu_max_mhz", stats.max_freq_mhz);
+    json_writer_number(json, "cpu_min_mhz", stats.min_freq_mhz);
+
+    wifi_ps_type_t ps_type;
+    if (esp_wifi_get_ps(&ps_type) == ESP_OK)
+    {
+        json_writer_string(json, "wifi_ps",
+                           ps_type == WIFI_PS_MAX_MODEM ? "max_modem" :
+                           ps_type == WIFI_PS_MIN_MODEM ? "min_modem" : "none");
+    }
+
+    json_writer_number(json, "requests", stats.requests);
+    json_writer_number(json, "requests_in_flight", stats.in_flight);
+    json_writer_number(json, "avg_request_ms",
+                       stats.requests ? (double)stats.request_time_us / stats.requests / 1000.0 : 0);
+    json_writer_number(json, "max_request_ms", stats.request_max_us / 1000.0);
+    if (stats.elapsed_us > 0)
+    {
+        json_writer_number(json, "awake_percent", (double)stats.awake_us * 100.0 / stats.elapsed_us);
+        json_writer_number(json, "light_sleep_percent", (double)stats.light_sleep_us * 100.0 / stats.elapsed_us);
+    }
+    json_writer_number(json, "light_sleeps", stats.light_sleeps);
+    if (stats.enabled)
+    {
+        json_writer_number(json, "estimated_current_ma", stats.estimated_current_ua / 1000.0);
+    }
+    json_writer_object_end(json);
+}
+
+#ifdef CONFIG_WEB_SERVER_HTTPS
+// ============================================================================
+// HTTPS
+// ============================================================================
+
+// Handshakes per second are measured over windows of this length
+#define WEB_SERVER_HANDSHAKE_RATE_WINDOW_US (10 * 1000000LL)
+
+/**
+ * @brief TLS handshake statistics reported by the health endpoint
+ */
+typedef struct {
+    uint32_t started;           ///< Handshakes that reached certificate selection
+    uint32_t completed;         ///< Handshakes that established a session
+    uint64_t total_us;          ///< Sum of completed handshake times
+    uint32_t last_us;           ///< Duration of the latest handshake
+    uint32_t max_us;            ///< Longest handshake
+    int64_t window_start_us;    ///< Start of the current rate window
+    uint32_t window_count;      ///< Handshakes completed in the current window
+    float rate;                 ///< Handshakes per second over the last full window
+} https_stats_t;
+
+static https_stats_t https_stats;
+static portMUX_TYPE https_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Handshakes run one at a time on the httpd task, so one start time suffices
+static int64_t handshake_start_us;
+// Power hold taken for the handshake in progress (httpd task only)
+static bool handshake_hold = false;
+
+#ifdef CONFIG_WEB_SERVER_HTTPS_HW_CIPHERSUITES
+/**
+ * Cipher suites served by the ESP32 accelerators: AES (GCM/CBC), SHA-256/384
+ * and MPI for the ECDHE and signature arithmetic. Only suites matching the
+ * certificate key type are listed; preferred first, zero terminated.
+ */
+static const int https_ciphersuites[] = {
+#ifdef CONFIG_WEB_SERVER_HTTPS_KEY_ECDSA
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_CBC_SHA384,
+#else
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_256_CBC_SHA384,
+#endif
+    0
+};
+#endif
+
+/**
+ * @brief Certificate selection hook, called once the ClientHello is parsed
+ *
+ * Hands the credentials parsed by cert_handler_init() to the handshake and
+ * marks its start for the handshake time.
+ */
+static int https_cert_select_cb(mbedtls_ssl_context *ssl)
+{
+    handshake_start_us = esp_timer_get_time();
+    if (!handshake_hold)
+    {
+        // The handshake arithmetic runs outside any URI handler
+        power_manager_acquire();
+        handshake_hold = true;
+    }
+    taskENTER_CRITICAL(&https_stats_lock);
+    https_stats.started++;
+    taskEXIT_CRITICAL(&https_stats_lock);
+
+    return cert_handler_select_cert(ssl);
+}
+
+/**
+ * @brief Drop the power hold of the last handshake
+ *
+ * Called when a handshake completes and from the idle sweep, which also runs
+ * on the httpd task and so never overlaps a handshake; a failed handshake
+ * keeps the device awake until then at most.
+ */
+static void https_release_handshake_hold(void)
+{
+    if (handshake_hold)
+    {
+        handshake_hold = false;
+        power_manager_release();
+    }
+}
+
+/**
+ * @brief esp_https_server session callback, records completed handshakes
+ */
+static void https_session_cb(esp_https_server_user_cb_arg_t *arg)
+{
+    if (arg->user_cb_state != HTTPD_SSL_USER_CB_SESS_CREATE)
+    {
+        return;
+    }
+    https_release_handshake_hold();
+
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed_us = (uint32_t)(now - handshake_start_us);
+
+    taskENTER_CRITICAL(&https_stats_lock);
+    https_stats.completed++;
+    https_stats.total_us += elapsed_us;
+    https_stats.last_us = elapsed_us;
+    if (elapsed_us > https_stats.max_us)
+    {
+        https_stats.max_us = elapsed_us;
+    }
+    int64_t window_us = now - https_stats.window_start_us;
+    if (window_us >= WEB_SERVER_HANDSHAKE_RATE_WINDOW_US)
+    {
+        https_stats.rate = https_stats.window_count * 1000000.0f / window_us;
+        https_stats.window_start_us = now;
+        https_stats.window_count = 0;
+    }
+    https_stats.window_count++;
+    taskEXIT_CRITICAL(&https_stats_lock);
+}
+
+/**
+ * @brief Start the server through esp_https_server
+ *
+ * The certificate selection hook hands each handshake the pre-parsed
+ * certificate and key. The PEM buffers are passed as well, so the server
+ * still has credentials if the hook declines a handshake.
+ */
+static esp_err_t https_server_start(const httpd_config_t *httpd_config)
+{
+    esp_err_t ret = cert_handler_init();
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Server certificate unavailable: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    const char *cert_pem;
+    const char *key_pem;
+    size_t cert_len;
+    size_t key_len;
+    ret = cert_handler_get_server_cert(&cert_pem, &cert_len);
+    if (ret == ESP_OK)
+    {
+        ret = cert_handler_get_server_key(&key_pem, &key_len);
+    }
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Server certificate unavailable: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    httpd_ssl_config_t ssl_config = HTTPD_SSL_CONFIG_DEFAULT();
+    ssl_config.httpd = *httpd_config;
+    ssl_config.transport_mode = HTTPD_SSL_TRANSPORT_SECURE;
+    ssl_config.port_secure = current_config.port;
+    ssl_config.servercert = (const uint8_t *)cert_pem;
+    ssl_config.servercert_len = cert_len;
+    ssl_config.prvtkey_pem = (const uint8_t *)key_pem;
+    ssl_config.prvtkey_len = key_len;
+    ssl_config.cert_select_cb = https_cert_select_cb;
+    ssl_config.user_cb = https_session_cb;
+#ifdef CONFIG_WEB_SERVER_HTTPS_SESSION_TICKETS
+    ssl_config.session_tickets = true;
+#endif
+#ifdef CONFIG_WEB_SERVER_HTTPS_HW_CIPHERSUITES
+    ssl_config.ciphersuites_list = https_ciphersuites;
+#endif
+
+    memset(&https_stats, 0, sizeof(https_stats));
+    https_stats.window_start_us = esp_timer_get_time();
+
+    return httpd_ssl_start(&server, &ssl_config);
+}
+
+/**
+ * @brief Write TLS handshake statistics
+ */
+static void write_https_json(json_writer_t *json)
+{
+    taskENTER_CRITICAL(&https_stats_lock);
+    https_stats_t stats = https_stats;
+    taskEXIT_CRITICAL(&https_stats_lock);
+
+    // A window that ran past its length without new handshakes is reported as is
+    int64_t window_us = esp_timer_get_time() - stats.window_start_us;
+    float rate = stats.rate;
+    if (window_us >= WEB_SERVER_HANDSHAKE_RATE_WINDOW_US)
+    {
+        rate = stats.window_count * 1000000.0f / window_us;
+    }
+
+    json_writer_object_begin(json, "https");
+    const char *key_type;
+    size_t key_bits;
+    if (cert_handler_get_key_type(&key_type, &key_bits) == ESP_OK)
+    {
+        json_writer_string(json, "key_type", key_type);
+        json_writer_number(json, "key_bits", key_bits);
+    }
+#ifdef CONFIG_WEB_SERVER_HTTPS_SESSION_TICKETS
+    json_writer_bool(json, "session_tickets", true);
+#else
+    json_writer_bool(json, "session_tickets", false);
+#endif
+#ifdef CONFIG_WEB_SERVER_HTTPS_HW_CIPHERSUITES
+    json_writer_bool(json, "hw_ciphersuites_only", true);
+#else
+    json_writer_bool(json, "hw_ciphersuites_only", false);
+#endif
+    json_writer_number(json, "handshakes", stats.completed);
+    json_writer_number(json, "handshakes_failed", stats.started - stats.completed);
+    json_writer_number(json, "handshakes_per_second", rate);
+    json_writer_number(json, "last_handshake_ms", stats.last_us / 1000.0);
+    json_writer_number(json, "avg_handshake_ms",
+                       stats.completed ? (double)stats.total_us / stats.completed / 1000.0 : 0);
+    json_writer_number(json, "max_handshake_ms", stats.max_us / 1000.0);
+    json_writer_object_end(json);
+}
+#endif // CONFIG_WEB_SERVER_HTTPS
+
+// Public functions
+esp_err_t web_server_init(const web_server_config_t *config)
+{
+    if (server != NULL)
+    {
+        ESP_LOGW(TAG, "Web server already initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (config != NULL)
+    {
+        current_config = *config;
+    }
+    else
+    {
+        web_server_config_t default_config = WEB_SERVER_DEFAULT_CONFIG();
+        current_config = default_config;
+    }
+
+    ESP_LOGI(TAG, "Initializing web server on port %d", current_config.port);
+
+    httpd_config_t httpd_config = HTTPD_DEFAULT_CONFIG();
+    httpd_config.server_port = current_config.port;
+    httpd_config.max_open_sockets = current_config.max_open_sockets;
+    httpd_config.max_uri_handlers = current_config.max_uri_handlers;
+    httpd_config.backlog_conn = current_config.backlog_conn;
+    httpd_config.stack_size = current_config.stack_size;
+    httpd_config.task_priority = current_config.task_priority;
+    httpd_config.core_id = current_config.core_id;
+    httpd_config.recv_wait_timeout = current_config.recv_timeout_s;
+    httpd_config.send_wait_timeout = current_config.send_timeout_s;
+    httpd_config.lru_purge_enable = current_config.lru_purge_enable;
+    httpd_config.keep_alive_enable = current_config.keep_alive_enable;
+    httpd_config.keep_alive_idle = current_config.keep_alive_idle_s;
+    httpd_config.keep_alive_interval = current_config.keep_alive_interval_s;
+    httpd_config.keep_alive_count = current_config.keep_alive_count;
+    httpd_config.open_fn = session_open_fn;
+    httpd_config.close_fn = session_close_fn;
+
+    for (size_t i = 0; i < WEB_SERVER_MAX_SESSIONS; i++)
+    {
+        sessions[i].fd = -1;
+    }
+    uri_route_count = 0;
+
+    ESP_LOGI(TAG, "HTTP config: port=%d, max_sockets=%d, max_handlers=%d, stack=%d, priority=%d, async_workers=%d",
+             httpd_config.server_port, httpd_config.max_open_sockets, httpd_config.max_uri_handlers,
+             (int)httpd_config.stack_size, httpd_config.task_priority, (int)current_config.async_workers);
+    ESP_LOGI(TAG, "Connections: idle_timeout=%ds, max_sockets_per_client=%d",
+             current_config.idle_timeout_s, (int)current_config.max_sockets_per_client);
+
+    // Every in-flight async request holds a socket; keep some for fast requests
+    if (current_config.async_workers >= current_config.max_open_sockets)
+    {
+        ESP_LOGW(TAG, "async_workers (%d) should be below max_open_sockets (%d)",
+                 (int)current_config.async_workers, (int)current_config.max_open_sockets);
+    }
+    esp_err_t async_ret = async_handler_init(current_config.async_workers, current_config.async_stack_size,
+                                             current_config.task_priority, current_config.core_id);
+    if (async_ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Async workers unavailable (%s) - slow handlers run inline", esp_err_to_name(async_ret));
+    }
+
+    // One arena for the httpd task and one per async worker; no more requests
+    // than open sockets can be in flight
+    size_t arena_count = 1 + current_config.async_workers;
+    if (arena_count > current_config.max_open_sockets)
+    {
+        arena_count = current_config.max_open_sockets;
+    }
+    esp_err_t arena_ret = request_arena_init(arena_count, WEB_SERVER_REQUEST_ARENA_SIZE);
+    if (arena_ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to allocate request arenas: %s", esp_err_to_name(arena_ret));
+        return ESP_FAIL;
+    }
+
+#ifdef CONFIG_WEB_SERVER_HTTPS
+    esp_err_t start_ret = https_server_start(&httpd_config);
+#else
+    esp_err_t start_ret = httpd_start(&server, &httpd_config);
+#endif
+    if (start_ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start HTTP server");
+        return ESP_FAIL;
+    }
+
+    if (current_config.idle_timeout_s > 0 && idle_timer == NULL)
+    {
+        const esp_timer_create_args_t idle_timer_args = {
+            .callback = idle_timer_callback,
+            .name = "httpd_idle"};
+        if (esp_timer_create(&idle_timer_args, &idle_timer) == ESP_OK)
+        {
+            esp_timer_start_periodic(idle_timer, WEB_SERVER_IDLE_SWEEP_MS * 1000ULL);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "Failed to create idle connection timer");
+        }
+    }
+
+    // Register URI handlers with error checking
+    httpd_uri_t root_uri = {
+        .uri = "/",
+        .method = HTTP_GET,
+        .handler = root_handler,
+        .user_ctx = NULL};
+    esp_err_t ret = register_uri_handler(&root_uri);
+    ESP_LOGI(TAG, "Registered handler for '/' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t config_uri = {
+        .uri = "/config",
+        .method = HTTP_GET,
+        .handler = config_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&config_uri);
+    ESP_LOGI(TAG, "Registered handler for '/config' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t scan_uri = {
+        .uri = "/scan",
+        .method = HTTP_GET,
+        .handler = scan_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&scan_uri);
+    ESP_LOGI(TAG, "Registered handler for '/scan' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t api_scan_uri = {
+        .uri = "/api/scan",
+        .method = HTTP_GET,
+        .handler = scan_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&api_scan_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/scan' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t connect_uri = {
+        .uri = "/connect",
+        .method = HTTP_POST,
+        .handler = connect_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&connect_uri);
+    ESP_LOGI(TAG, "Registered handler for '/connect' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t status_uri = {
+        .uri = "/status",
+        .method = HTTP_GET,
+        .handler = status_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&status_uri);
+    ESP_LOGI(TAG, "Registered handler for '/status' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t reset_uri = {
+        .uri = "/reset",
+        .method = HTTP_POST,
+        .handler = reset_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&reset_uri);
+    ESP_LOGI(TAG, "Registered handler for '/reset' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    // Register configuration management API handlers (REQ-CFG-7)
+    httpd_uri_t config_get_uri = {
+        .uri = "/api/config",
+        .method = HTTP_GET,
+        .handler = config_get_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&config_get_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/config' GET - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t config_set_uri = {
+        .uri = "/api/config",
+        .method = HTTP_POST,
+        .handler = config_set_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&config_set_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/config' POST - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t config_reset_uri = {
+        .uri = "/api/config/reset",
+        .method = HTTP_POST,
+        .handler = config_reset_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&config_reset_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/config/reset' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    // Register system health endpoint (REQ-CFG-11)
+    httpd_uri_t system_health_uri = {
+        .uri = "/api/system/health",
+        .method = HTTP_GET,
+        .handler = system_health_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&system_health_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/system/health' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    // Register combined status/health/config endpoint
+    httpd_uri_t batch_uri = {
+        .uri = "/api/batch",
+        .method = HTTP_GET,
+        .handler = batch_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&batch_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/batch' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    // Register measurement pipeline endpoint
+    httpd_uri_t distance_uri = {
+        .uri = "/api/distance",
+        .method = HTTP_GET,
+        .handler = distance_data_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&distance_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/distance' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    // Register measurement history endpoint
+    httpd_uri_t distance_history_uri = {
+        .uri = "/api/distance/history",
+        .method = HTTP_GET,
+        .handler = distance_history_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&distance_history_uri);
+    ESP_LOGI(TAG, "Registered handler for '/api/distance/history' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    // Register request metrics endpoint for scrapers
+    httpd_uri_t metrics_uri = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&metrics_uri);
+    ESP_LOGI(TAG, "Registered handler for '/metrics' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    // Distance data endpoint disabled in template - users should implement their own sensor endpoints
+    // Example code available in git history for reference
+
+    // Register CORS preflight handler for all API endpoints
+    httpd_uri_t options_uri = {
+        .uri = "/api/*",
+        .method = HTTP_OPTIONS,
+        .handler = cors_preflight_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&options_uri);
+    ESP_LOGI(TAG, "Registered CORS preflight handler - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    // Register WebSocket push endpoint for live dashboard updates
+    ret = ws_push_init(server);
+    if (ret == ESP_OK)
+    {
+        httpd_uri_t ws_uri = {
+            .uri = "/ws",
+            .method = HTTP_GET,
+            .handler = ws_push_handler,
+            .user_ctx = NULL,
+            .is_websocket = true};
+        ret = register_uri_handler(&ws_uri);
+    }
+    ESP_LOGI(TAG, "Registered handler for '/ws' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    if (ret == ESP_OK && push_timer == NULL)
+    {
+        const esp_timer_create_args_t push_timer_args = {
+            .callback = push_timer_callback,
+            .name = "ws_push"};
+        if (esp_timer_create(&push_timer_args, &push_timer) == ESP_OK)
+        {
+            esp_timer_start_periodic(push_timer, WEB_SERVER_PUSH_INTERVAL_MS * 1000ULL);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "Failed to create WebSocket push timer");
+        }
+        wifi_manager_register_scan_callback(scan_done_callback, NULL);
+    }
+
+    if (ret == ESP_OK && measurement_push_timer == NULL)
+    {
+        const esp_timer_create_args_t measurement_push_timer_args = {
+            .callback = measurement_push_callback,
+            .name = "ws_measure"};
+        if (esp_timer_create(&measurement_push_timer_args, &measurement_push_timer) == ESP_OK)
+        {
+            measurement_push_active = false;
+            esp_timer_start_periodic(measurement_push_timer, WEB_SERVER_MEASUREMENT_PUSH_INTERVAL_MS * 1000ULL);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "Failed to create measurement push timer");
+        }
+    }
+#endif
+
+    // Register static file handlers
+    httpd_uri_t index_uri = {
+        .uri = "/index.html",
+        .method = HTTP_GET,
+        .handler = static_file_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&index_uri);
+    ESP_LOGI(TAG, "Registered handler for '/index.html' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t wifi_setup_uri = {
+        .uri = "/wifi-setup.html",
+        .method = HTTP_GET,
+        .handler = static_file_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&wifi_setup_uri);
+    ESP_LOGI(TAG, "Registered handler for '/wifi-setup.html' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t settings_uri = {
+        .uri = "/settings.html",
+        .method = HTTP_GET,
+        .handler = static_file_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&settings_uri);
+    ESP_LOGI(TAG, "Registered handler for '/settings.html' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t css_uri = {
+        .uri = "/css/style.css",
+        .method = HTTP_GET,
+        .handler = static_file_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&css_uri);
+    ESP_LOGI(TAG, "Registered handler for '/css/style.css' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    httpd_uri_t js_uri = {
+        .uri = "/js/app.js",
+        .method = HTTP_GET,
+        .handler = static_file_handler,
+        .user_ctx = NULL};
+    ret = register_uri_handler(&js_uri);
+    ESP_LOGI(TAG, "Registered handler for '/js/app.js' - %s", ret == ESP_OK ? "OK" : esp_err_to_name(ret));
+
+    ESP_LOGI(TAG, "Web server initialized successfully");
+    return ESP_OK;
+}
+
+esp_err_t web_server_start(void)
+{
+    if (server == NULL)
+    {
+        ESP_LOGE(TAG, "Web server not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (server_running)
+    {
+        ESP_LOGW(TAG, "Web server already running");
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Starting web server");
+
+    // Start DNS server for captive portal if we're in AP mode
+    wifi_mode_t wifi_mode;
+    if (esp_wifi_get_mode(&wifi_mode) == ESP_OK &&
+        (wifi_mode == WIFI_MODE_AP || wifi_mode == WIFI_MODE_APSTA))
+    {
+        ESP_LOGI(TAG, "AP mode detected - captive portal available at device IP");
+        // Note: Users can navigate directly to device IP (e.g., 192.168.4.1)
+        // DNS server removed for simplicity - manual navigation still works
+    }
+    else
+    {
+        ESP_LOGI(TAG, "STA mode - web interface available at assigned IP");
+    }
+
+    server_running = true;
+    ESP_LOGI(TAG, "Web server started successfully");
+    boot_manager_mark("httpd_ready");
+
+    return ESP_OK;
+}
+
+esp_err_t web_server_stop(void)
+{
+    if (!server_running)
+    {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Stopping web server");
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    // Stop pushing before the server handle goes away
+    if (push_timer != NULL)
+    {
+        esp_timer_stop(push_timer);
+        esp_timer_delete(push_timer);
+        push_timer = NULL;
+    }
+    if (measurement_push_timer != NULL)
+    {
+        esp_timer_stop(measurement_push_timer);
+        esp_timer_delete(measurement_push_timer);
+        measurement_push_timer = NULL;
+    }
+    ws_push_deinit();
+#endif
+
+    if (idle_timer != NULL)
+    {
+        esp_timer_stop(idle_timer);
+        esp_timer_delete(idle_timer);
+        idle_timer = NULL;
+    }
+
+    // Stop HTTP server
+    if (server != NULL)
+    {
+#ifdef CONFIG_WEB_SERVER_HTTPS
+        httpd_ssl_stop(server);
+#else
+        httpd_stop(server);
+#endif
+        server = NULL;
+    }
+
+    server_running = false;
+    ESP_LOGI(TAG, "Web server stopped");
+
+    return ESP_OK;
+}
+
+bool web_server_is_running(void)
+{
+    return server_running;
+}
+
+uint16_t web_server_get_port(void)
+{
+    return current_config.port;
+}
+
+esp_err_t web_server_render_document(web_server_document_t doc, char *buf, size_t size, size_t *length)
+{
+    if (buf == NULL || size == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    json_writer_t json;
+    json_writer_init(&json, NULL, buf, size);
+
+    switch (doc)
+    {
+        case WEB_SERVER_DOC_STATUS:
+        {
+            wifi_status_t status;
+            esp_err_t ret = wifi_manager_get_status(&status);
+            if (ret != ESP_OK)
+            {
+                return ret;
+            }
+            write_status_json(&json, NULL, &status);
+            break;
+        }
+        case WEB_SERVER_DOC_CONFIG:
+        {
+            system_config_t config;
+            esp_err_t ret = config_get_current(&config);
+            if (ret != ESP_OK)
+            {
+                return ret;
+            }
+            write_config_document(&json, NULL, &config);
+            break;
+        }
+        case WEB_SERVER_DOC_HEALTH:
+            write_health_json(&json, NULL, HEALTH_CALLER_RENDER);
+            break;
+        case WEB_SERVER_DOC_BATCH:
+            write_batch_json(&json, HEALTH_CALLER_RENDER);
+            break;
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = json_writer_finish(&json);
+    if (ret == ESP_OK && length != NULL)
+    {
+        *length = json_writer_length(&json);
+    }
+    return ret;
+}
+
+// =============================================================================
+// CONFIGURATION MANAGEMENT HANDLERS (REQ-CFG-7, REQ-CFG-8, REQ-CFG-9)
+// =============================================================================
+
+/**
+ * @brief Write the fields of a configuration as JSON members
+ *
+ * Walks the config_manager descriptor table. "section.member" paths become
+ * nested objects; consecutive descriptors of the same section share one
+ * object. Secret fields (password) are written as empty strings.
+ */
+static void write_config_json(json_writer_t *json, const system_config_t *config)
+{
+    size_t count;
+    const config_descriptor_t *descs = config_get_descriptors(&count);
+    const char *section = NULL;
+    size_t section_len = 0;
+    char section_key[24];
+
+    for (size_t i = 0; i < count; i++) {
+        const config_descriptor_t *desc = &descs[i];
+        if (desc->json_path == NULL) {
+            continue;
+        }
+
+        const char *dot = strchr(desc->json_path, '.');
+        const char *key = dot ? dot + 1 : desc->json_path;
+        size_t len = dot ? (size_t)(dot - desc->json_path) : 0;
+        if (section != NULL && (len != section_len || strncmp(section, desc->json_path, len) != 0)) {
+            json_writer_object_end(json);
+            section = NULL;
+        }
+        if (dot != NULL && section == NULL) {
+            if (len >= sizeof(section_key)) {
+                continue;
+            }
+            memcpy(section_key, desc->json_path, len);
+            section_key[len] = '\0';
+            json_writer_object_begin(json, section_key);
+            section = desc->json_path;
+            section_len = len;
+        }
+
+        if (desc->flags & CONFIG_DESC_SECRET) {
+            json_writer_string(json, key, ""); // Never expose secrets
+        } else if (desc->type == CONFIG_TYPE_STRING) {
+            json_writer_string(json, key, (const char *)config + desc->offset);
+        } else {
+            json_writer_number(json, key, (double)config_get_field_value(config, desc) / desc->json_scale);
+        }
+    }
+    if (section != NULL) {
+        json_writer_object_end(json);
+    }
+}
+
+/**
+ * @brief Write the GET /api/config document: metadata plus all exposed fields
+ *
+ * @param key Member name when nested in another object, NULL for a top-level document
+ */
+static void write_config_document(json_writer_t *json, const char *key, const system_config_t *config)
+{
+    json_writer_object_begin(json, key);
+
+    // Add configuration metadata
+    json_writer_number(json, "config_version", config->config_version);
+    json_writer_number(json, "save_count", config->save_count);
+
+    // Add all exposed fields, grouped by the first component of their JSON path
+    write_config_json(json, config);
+
+    json_writer_object_end(json);
+}
+
+/**
+ * @brief GET /api/config - Retrieve current configuration
+ */
+static esp_err_t config_get_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "Handling GET /api/config");
+
+    // Set CORS headers
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Content-Type", "application/json");
+
+    // Get current configuration
+    system_config_t config;
+    esp_err_t ret = config_get_current(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get current configuration: %s", esp_err_to_name(ret));
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to get configuration");
+        return ESP_FAIL;
+    }
+
+    // Create JSON response
+    char *json_buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+    if (json_buf == NULL) {
+        return send_arena_exhausted(req);
+    }
+    json_writer_t json;
+    json_writer_init(&json, req, json_buf, JSON_WRITER_BUFFER_SIZE);
+    write_config_document(&json, NULL, &config);
+    ret = json_writer_finish(&json);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send configuration: %s", esp_err_to_name(ret));
+        return ESP_FAIL;
+    }
+
+    ESP_LOGD(TAG, "Configuration sent successfully");
+    return ESP_OK;
+}
+
+/**
+ * @brief POST /api/config - Update and save configuration
+ */
+static esp_err_t config_set_handler(httpd_req_t *req)
+{
+    // NVS writes run on a worker so fast GETs do not queue behind them
+    if (async_handler_submit(req, config_set_handler)) {
+        return ESP_OK;
+    }
+
+    ESP_LOGD(TAG, "Handling POST /api/config");
+
+    // Set CORS headers
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Content-Type", "application/json");
+
+    // Get current configuration as base
+    config_request_t request = {0};
+    esp_err_t config_ret = config_get_current(&request.config);
+    if (config_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get current configuration");
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to get current configuration");
+        return ESP_FAIL;
+    }
+
+    // Update configuration field by field while the body is received
+    config_ret = read_json_body(req, config_field_cb, &request);
+    if (config_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to parse configuration: %s", esp_err_to_name(config_ret));
+        if (config_ret == ESP_ERR_INVALID_SIZE) {
+            httpd_resp_set_status(req, "413 Payload Too Large");
+            httpd_resp_send(req, "Request body or value too large", HTTPD_RESP_USE_STRLEN);
+        } else if (config_ret == ESP_ERR_TIMEOUT) {
+            httpd_resp_send_408(req);
+        } else if (config_ret == ESP_ERR_INVALID_ARG) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON format");
+        } else if (config_ret == ESP_ERR_NO_MEM) {
+            send_arena_exhausted(req);
+        } else {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to read request body");
+        }
+        return ESP_FAIL;
+    }
+
+    if (request.invalid_field != NULL) {
+        ESP_LOGE(TAG, "Configuration value for %s out of range", request.invalid_field);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Configuration validation failed");
+        return ESP_FAIL;
+    }
+
+    // Validate and save configuration
+    config_ret = config_save(&request.config);
+    if (config_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save configuration: %s", esp_err_to_name(config_ret));
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Configuration validation failed");
+        return ESP_FAIL;
+    }
+
+    // Send success response
+    const char *response = "{\"status\":\"success\",\"message\":\"Configuration saved successfully. Device will restart in 3 seconds.\"}";
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+
+    ESP_LOGI(TAG, "Configuration updated and saved successfully. Scheduling device restart...");
+    
+    // Schedule restart using a timer to avoid blocking the HTTP response
+    if (restart_timer == NULL) {
+        esp_timer_create_args_t timer_args = {
+            .callback = restart_timer_callback,
+            .name = "restart_timer"
+        };
+        esp_timer_create(&timer_args, &restart_timer);
+    }
+    
+    // Start the restart timer (3 seconds delay)
+    esp_timer_start_once(restart_timer, 3000000); // 3 seconds in microseconds
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief POST /api/config/reset - Reset to factory defaults (REQ-CFG-5)
+ */
+static esp_err_t config_reset_handler(httpd_req_t *req)
+{
+    if (async_handler_submit(req, config_reset_handler)) {
+        return ESP_OK;
+    }
+
+    ESP_LOGD(TAG, "Handling POST /api/config/reset");
+
+    // Set CORS headers
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Content-Type", "application/json");
+
+    // Perform factory reset
+    esp_err_t ret = config_factory_reset();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Factory reset failed: %s", esp_err_to_name(ret));
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Factory reset failed");
+        return ESP_FAIL;
+    }
+
+    // Send success response
+    const char *response = "{\"status\":\"success\",\"message\":\"Configuration reset to factory defaults\"}";
+    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+
+    ESP_LOGI(TAG, "Configuration reset to factory defaults");
+    return ESP_OK;
+}
+
+
+
+
+#ifdef CONFIG_TARGET_EMULATOR
+/**
+ * @brief Write a tunnel latency histogram as a JSON object
+ */
+static void write_latency_json(json_writer_t *json, const char *key,
+                               const netif_uart_tunnel_latency_t *latency, uint32_t frames)
+{
+    static const uint32_t bounds_us[] = NETIF_UART_TUNNEL_LATENCY_BOUNDS_US;
+
+    json_writer_object_begin(json, key);
+    json_writer_number(json, "avg_us", frames ? (double)(latency->total_us / frames) : 0);
+    json_writer_number(json, "max_us", latency->max_us);
+    json_writer_array_begin(json, "bucket_bounds_us");
+    for (size_t i = 0; i < sizeof(bounds_us) / sizeof(bounds_us[0]); i++) {
+        json_writer_number(json, NULL, bounds_us[i]);
+    }
+    json_writer_array_end(json);
+    json_writer_array_begin(json, "buckets");
+    for (size_t i = 0; i < NETIF_UART_TUNNEL_LATENCY_BUCKETS; i++) {
+        json_writer_number(json, NULL, latency->buckets[i]);
+    }
+    json_writer_array_end(json);
+    json_writer_object_end(json);
+}
+
+/**
+ * @brief Write UART tunnel statistics (emulator network link)
+ */
+static void write_tunnel_json(json_writer_t *json)
+{
+    netif_uart_tunnel_stats_t stats;
+    if (netif_uart_tunnel_get_stats(&stats) != ESP_OK) {
+        return;
+    }
+
+    json_writer_object_begin(json, "tunnel");
+    json_writer_number(json, "rx_frames", stats.rx_frames);
+    json_writer_number(json, "rx_bytes", stats.rx_bytes);
+    json_writer_number(json, "tx_frames", stats.tx_frames);
+    json_writer_number(json, "tx_bytes", stats.tx_bytes);
+    json_writer_object_begin(json, "rx_dropped");
+    json_writer_number(json, "oversized", stats.rx_drop_oversized);
+    json_writer_number(json, "short_read", stats.rx_drop_short_read);
+    json_writer_number(json, "crc", stats.rx_drop_crc);
+    json_writer_number(json, "no_buffer", stats.rx_drop_no_buffer);
+    json_writer_number(json, "netif_error", stats.rx_drop_netif);
+    json_writer_object_end(json);
+    json_writer_object_begin(json, "tx_dropped");
+    json_writer_number(json, "oversized", stats.tx_drop_oversized);
+    json_writer_number(json, "uart_error", stats.tx_errors);
+    json_writer_object_end(json);
+    json_writer_number(json, "rx_sync_bytes_skipped", stats.rx_sync_bytes_skipped);
+    json_writer_number(json, "uart_overruns", stats.uart_overruns);
+    json_writer_number(json, "rx_task_stack_free_bytes", stats.rx_task_stack_free);
+    write_latency_json(json, "rx_latency", &stats.rx_latency, stats.rx_frames);
+    write_latency_json(json, "tx_latency", &stats.tx_latency, stats.tx_frames);
+    json_writer_object_end(json);
+}
+#endif
+
+// ============================================================================
+// System Statistics
+// ============================================================================
+
+#ifdef CONFIG_WEB_SERVER_TASK_STATS
+// Tasks listed by the health endpoint; those using the least CPU are left out
+#define WEB_SERVER_MAX_TASKS 32
+// Spare slots for tasks created while the task list is read
+#define WEB_SERVER_TASK_SLACK 4
+
+/**
+ * @brief Run time counter of a task at the previous health request
+ */
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t runtime;
+} task_runtime_sample_t;
+
+/**
+ * @brief CPU window of one health_caller_t
+ *
+ * The buffers grow with the number of tasks and are never shrunk.
+ */
+typedef struct {
+    TaskStatus_t *status;               ///< Task list of the current call
+    task_runtime_sample_t *samples;     ///< Counters at the previous call
+    task_runtime_sample_t *next;        ///< Counters of the current call (swapped with samples)
+    UBaseType_t capacity;               ///< Entries of each buffer
+    UBaseType_t sample_count;           ///< Valid entries in samples
+    uint32_t total;                     ///< Total run time at the previous call
+} task_cpu_window_t;
+
+// Each window is only used by the task of its caller
+static task_cpu_window_t task_cpu_windows[HEALTH_CALLER_COUNT];
+
+/**
+ * @brief Grow the buffers of a CPU window to hold @p tasks entries
+ */
+static bool task_cpu_window_reserve(task_cpu_window_t *window, UBaseType_t tasks)
+{
+    if (tasks <= window->capacity)
+    {
+        return true;
+    }
+
+    TaskStatus_t *status = heap_caps_realloc(window->status, tasks * sizeof(*status), MALLOC_CAP_8BIT);
+    if (status == NULL)
+    {
+        return false;
+    }
+    window->status = status;
+    task_runtime_sample_t *samples = heap_caps_realloc(window->samples, tasks * sizeof(*samples), MALLOC_CAP_8BIT);
+    if (samples == NULL)
+    {
+        return false;
+    }
+    window->samples = samples;
+    task_runtime_sample_t *next = heap_caps_realloc(window->next, tasks * sizeof(*next), MALLOC_CAP_8BIT);
+    if (next == NULL)
+    {
+        return false;
+    }
+    window->next = next;
+    window->capacity = tasks;
+    return true;
+}
+
+/**
+ * @brief qsort() comparator: highest CPU time in the window first
+ */
+static int compare_task_runtime(const void *a, const void *b)
+{
+    uint32_t delta_a = ((const TaskStatus_t *)a)->ulRunTimeCounter;
+    uint32_t delta_b = ((const TaskStatus_t *)b)->ulRunTimeCounter;
+    return (delta_a < delta_b) - (delta_a > delta_b);
+}
+
+/**
+ * @brief Name of a FreeRTOS task state
+ */
+static const char *task_state_name(eTaskState state)
+{
+    switch (state)
+    {
+        case eRunning:   return "running";
+        case eReady:     return "ready";
+        case eBlocked:   return "blocked";
+        case eSuspended: return "suspended";
+        case eDeleted:   return "deleted";
+        default:         return "invalid";
+    }
+}
+
+/**
+ * @brief Write per-task CPU share and stack high-water marks plus per-core load
+ *
+ * The run time counters are 32-bit esp_timer microseconds, so CPU figures
+ * are computed from the difference to the previous call by the same caller
+ * (the first call covers the time since boot). Unsigned subtraction keeps the differences
+ * correct across one counter wrap, i.e. as long as health requests are less
+ * than about 71 minutes apart. Percentages are of one core, so on a
+ * dual-core chip the tasks add up to 200%.
+ */
+static void write_tasks_json(json_writer_t *json, health_caller_t caller)
+{
+    task_cpu_window_t *cpu = &task_cpu_windows[caller];
+    uint32_t total = 0;
+    UBaseType_t count = 0;
+
+    // uxTaskGetSystemState() returns 0 if the array is too small, which can
+    // only happen if tasks were created since counting them; retry once
+    for (int attempt = 0; attempt < 2 && count == 0; attempt++)
+    {
+        if (!task_cpu_window_reserve(cpu, uxTaskGetNumberOfTasks() + WEB_SERVER_TASK_SLACK))
+        {
+            ESP_LOGW(TAG, "No memory for the task list");
+            return;
+        }
+        count = uxTaskGetSystemState(cpu->status, cpu->capacity, &total);
+    }
+    if (count == 0)
+    {
+        ESP_LOGW(TAG, "Task list changed while reading it");
+        return;
+    }
+    uint32_t window = total - cpu->total;
+
+    // Replace every counter by its increase since the previous call, keeping
+    // the absolute values as the next baseline
+    TaskStatus_t *task_status = cpu->status;
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        uint32_t runtime = task_status[i].ulRunTimeCounter;
+        uint32_t previous = 0;
+        for (UBaseType_t j = 0; j < cpu->sample_count; j++)
+        {
+            if (cpu->samples[j].handle == task_status[i].xHandle)
+            {
+                previous = cpu->samples[j].runtime;
+                break;
+            }
+        }
+        cpu->next[i].handle = task_status[i].xHandle;
+        cpu->next[i].runtime = runtime;
+        task_status[i].ulRunTimeCounter = runtime - previous;
+    }
+    task_runtime_sample_t *previous_samples = cpu->samples;
+    cpu->samples = cpu->next;
+    cpu->next = previous_samples;
+    cpu->sample_count = count;
+    cpu->total = total;
+
+    if (window == 0)
+    {
+        return;
+    }
+
+    // A core is busy whenever its idle task is not running
+    json_writer_array_begin(json, "core_load_percent");
+    for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+        uint32_t idle_time = 0;
+        for (UBaseType_t i = 0; i < count; i++)
+        {
+            if (task_status[i].xHandle == idle)
+            {
+                idle_time = task_status[i].ulRunTimeCounter;
+                break;
+            }
+        }
+        double idle_percent = (double)idle_time * 100.0 / window;
+        json_writer_number(json, NULL, idle_percent < 100.0 ? 100.0 - idle_percent : 0);
+    }
+    json_writer_array_end(json);
+    json_writer_number(json, "cpu_window_seconds", (double)window / 1000000.0);
+
+    qsort(task_status, count, sizeof(task_status[0]), compare_task_runtime);
+
+    UBaseType_t listed = count < WEB_SERVER_MAX_TASKS ? count : WEB_SERVER_MAX_TASKS;
+    json_writer_array_begin(json, "tasks");
+    for (UBaseType_t i = 0; i < listed; i++)
+    {
+        const TaskStatus_t *task = &task_status[i];
+        json_writer_object_begin(json, NULL);
+        json_writer_string(json, "name", task->pcTaskName);
+        json_writer_number(json, "cpu_percent", (double)task->ulRunTimeCounter * 100.0 / window);
+        json_writer_number(json, "priority", task->uxCurrentPriority);
+        json_writer_string(json, "state", task_state_name(task->eCurrentState));
+        json_writer_number(json, "core", task->xCoreID == tskNO_AFFINITY ? -1 : task->xCoreID);
+        json_writer_number(json, "stack_free_min_bytes", task->usStackHighWaterMark);
+        json_writer_object_end(json);
+    }
+    json_writer_array_end(json);
+}
+#else
+/**
+ * @brief Write the stack high-water marks of the tasks most likely to overflow
+ *
+ * Without the FreeRTOS trace facility tasks cannot be enumerated, so only
+ * these well-known tasks are looked up by name.
+ */
+static void write_tasks_json(json_writer_t *json, health_caller_t caller)
+{
+    (void)caller;
+
+    static const char *const watched_tasks[] = {
+        "httpd", "uart_rx", "wifi", "tiT", "sys_evt",
+    };
+
+    json_writer_array_begin(json, "tasks");
+    for (size_t i = 0; i < sizeof(watched_tasks) / sizeof(watched_tasks[0]); i++)
+    {
+        TaskHandle_t handle = xTaskGetHandle(watched_tasks[i]);
+        if (handle == NULL)
+        {
+            continue;
+        }
+        json_writer_object_begin(json, NULL);
+        json_writer_string(json, "name", watched_tasks[i]);
+        json_writer_number(json, "stack_free_min_bytes", uxTaskGetStackHighWaterMark(handle));
+        json_writer_object_end(json);
+    }
+    json_writer_array_end(json);
+}
+#endif
+
+/**
+ * @brief Share of free heap that cannot be returned by a single allocation
+ *
+ * 0% means all free memory is one contiguous block; values near 100% mean
+ * large allocations fail although plenty of memory is free.
+ */
+static double heap_fragmentation_percent(const multi_heap_info_t *info)
+{
+    if (info->total_free_bytes == 0)
+    {
+        return 0;
+    }
+    return (1.0 - (double)info->largest_free_block / info->total_free_bytes) * 100.0;
+}
+
+/**
+ * @brief Write free, minimum free and largest free block of one heap capability
+ */
+static void write_heap_caps_json(json_writer_t *json, const char *key, uint32_t caps)
+{
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    if (info.total_free_bytes + info.total_allocated_bytes == 0)
+    {
+        return;
+    }
+
+    json_writer_object_begin(json, key);
+    json_writer_number(json, "total_bytes", info.total_free_bytes + info.total_allocated_bytes);
+    json_writer_number(json, "free_bytes", info.total_free_bytes);
+    json_writer_number(json, "minimum_free_bytes", info.minimum_free_bytes);
+    json_writer_number(json, "largest_free_block_bytes", info.largest_free_block);
+    json_writer_number(json, "fragmentation_percent", heap_fragmentation_percent(&info));
+    json_writer_object_end(json);
+}
+
+/**
+ * @brief Write heap usage per memory capability
+ */
+static void write_heap_json(json_writer_t *json)
+{
+    json_writer_object_begin(json, "heap");
+    write_heap_caps_json(json, "internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    write_heap_caps_json(json, "dma", MALLOC_CAP_DMA);
+#ifdef CONFIG_SPIRAM
+    write_heap_caps_json(json, "psram", MALLOC_CAP_SPIRAM);
+#endif
+    json_writer_object_end(json);
 }
 
-esp_err_t web_server_stop(void)
+/**
+ * @brief Write boot stage timings and milestones in milliseconds since reset
+ */
+static void write_boot_json(json_writer_t *json)
 {
-    if (!server_running)
-    {
-        return ESP_OK;
+    boot_report_t report;
+    if (boot_manager_get_report(&report) != ESP_OK || report.stage_count == 0) {
+        return;
     }
 
-    ESP_LOGI(TAG, "Stopping web server");
-
-    // Stop HTTP server
-    if (server != NULL)
-    {
-        httpd_stop(server);
-        server = NULL;
+    json_writer_object_begin(json, "boot");
+    json_writer_bool(json, "parallel", report.parallel);
+    json_writer_bool(json, "complete", report.complete);
+    json_writer_number(json, "stages_start_ms", (double)report.start_us / 1000.0);
+    if (report.complete) {
+        json_writer_number(json, "stages_done_ms", (double)report.end_us / 1000.0);
     }
-
-    server_running = false;
-    ESP_LOGI(TAG, "Web server stopped");
-
-    return ESP_OK;
+    json_writer_array_begin(json, "stages");
+    for (size_t i = 0; i < report.stage_count; i++) {
+        const boot_stage_record_t *stage = &report.stages[i];
+        json_writer_object_begin(json, NULL);
+        json_writer_string(json, "name", stage->name);
+        json_writer_string(json, "status", boot_manager_state_name(stage->state));
+        if (stage->state != BOOT_STAGE_PENDING) {
+            json_writer_number(json, "start_ms", (double)stage->start_us / 1000.0);
+        }
+        if (stage->state >= BOOT_STAGE_DONE) {
+            json_writer_number(json, "duration_ms", (double)(stage->end_us - stage->start_us) / 1000.0);
+        }
+        if (stage->state == BOOT_STAGE_FAILED) {
+            json_writer_string(json, "error", esp_err_to_name(stage->result));
+        }
+        json_writer_object_end(json);
+    }
+    json_writer_array_end(json);
+    json_writer_object_begin(json, "milestones_ms");
+    for (size_t i = 0; i < report.milestone_count; i++) {
+        json_writer_number(json, report.milestones[i].name, (double)report.milestones[i].at_us / 1000.0);
+    }
+    json_writer_object_end(json);
+    json_writer_object_end(json);
 }
 
-bool web_server_is_running(void)
+/**
+ * @brief Write measurement pipeline statistics
+ */
+static void write_measurement_stats_json(json_writer_t *json)
 {
-    return server_running;
+    measurement_stats_t stats;
+    measurement_get_stats(&stats);
+
+    json_writer_object_begin(json, "measurement");
+    json_writer_bool(json, "running", stats.running);
+    json_writer_string(json, "source", stats.source);
+    json_writer_number(json, "interval_us", stats.interval_us);
+    json_writer_number(json, "samples", stats.samples);
+    json_writer_number(json, "errors", stats.errors);
+    json_writer_number(json, "late_ticks", stats.late_ticks);
+    json_writer_number(json, "max_sample_us", stats.max_sample_us);
+    json_writer_object_end(json);
 }
 
-uint16_t web_server_get_port(void)
+/**
+ * @brief Write request arena pool usage
+ */
+static void write_request_arena_json(json_writer_t *json)
 {
-    return current_config.port;
+    request_arena_stats_t stats;
+    request_arena_get_stats(&stats);
+
+    json_writer_object_begin(json, "request_arena");
+    json_writer_number(json, "arenas", stats.count);
+    json_writer_number(json, "arena_size_bytes", stats.size);
+    json_writer_number(json, "in_use", stats.in_use);
+    json_writer_number(json, "peak_in_use", stats.peak_in_use);
+    json_writer_number(json, "peak_used_bytes", stats.peak_bytes);
+    json_writer_number(json, "exhausted", stats.exhausted);
+    json_writer_number(json, "failed_allocs", stats.failed_allocs);
+    json_writer_object_end(json);
 }
 
-// =============================================================================
-// CONFIGURATION MANAGEMENT HANDLERS (REQ-CFG-7, REQ-CFG-8, REQ-CFG-9)
-// =============================================================================
-
 /**
- * @brief GET /api/config - Retrieve current configuration
+ * @brief Write the system health document (GET /api/system/health)
+ *
+ * @param key Member name when nested in another object, NULL for a top-level document
  */
-static esp_err_t config_get_handler(httpd_req_t *req)
+static void write_health_json(json_writer_t *json, const char *key, health_caller_t caller)
 {
-    ESP_LOGD(TAG, "Handling GET /api/config");
+    json_writer_object_begin(json, key);
 
-    // Set CORS headers
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Content-Type", "application/json");
+    // System uptime
+    int64_t uptime_us = esp_timer_get_time();
+    json_writer_number(json, "uptime_seconds", (double)uptime_us / 1000000.0);
 
-    // Get current configuration
-    system_config_t config;
-    esp_err_t ret = config_get_current(&config);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get current configuration: %s", esp_err_to_name(ret));
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to get configuration");
-        return ESP_FAIL;
-    }
+    // Memory information
+    uint32_t free_heap = esp_get_free_heap_size();
+    uint32_t min_free_heap = esp_get_minimum_free_heap_size();
+    json_writer_number(json, "free_heap_bytes", free_heap);
+    json_writer_number(json, "minimum_free_heap_bytes", min_free_heap);
+    multi_heap_info_t heap_info;
+    heap_caps_get_info(&heap_info, MALLOC_CAP_DEFAULT);
+    json_writer_number(json, "largest_free_block_bytes", heap_info.largest_free_block);
+    json_writer_number(json, "heap_fragmentation_percent", heap_fragmentation_percent(&heap_info));
+    write_heap_json(json);
 
-    // Create JSON response
-    cJSON *json = cJSON_CreateObject();
-    if (json == NULL) {
-        ESP_LOGE(TAG, "Failed to create JSON object");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-        return ESP_FAIL;
+    // NVS health check
+    size_t nvs_free_entries, nvs_total_entries;
+    esp_err_t nvs_health = config_nvs_health_check(&nvs_free_entries, &nvs_total_entries);
+    
+    json_writer_object_begin(json, "nvs");
+    json_writer_string(json, "status",
+                       (nvs_health == ESP_OK) ? "healthy" :
+                       (nvs_health == ESP_ERR_INVALID_STATE) ? "corrupted" : "error");
+    json_writer_string(json, "status_message", esp_err_to_name(nvs_health));
+    json_writer_number(json, "free_entries", nvs_free_entries);
+    json_writer_number(json, "total_entries", nvs_total_entries);
+    json_writer_number(json, "used_entries", nvs_total_entries - nvs_free_entries);
+    json_writer_object_end(json);
+
+    // Configuration status
+    system_config_t current_config;
+    esp_err_t config_status = config_get_current(&current_config);
+    json_writer_object_begin(json, "configuration");
+    json_writer_string(json, "status",
+                       (config_status == ESP_OK) ? "healthy" : "error");
+    if (config_status == ESP_OK) {
+        json_writer_number(json, "version", current_config.config_version);
+        json_writer_number(json, "save_count", current_config.save_count);
     }
+    config_persist_status_t persist;
+    if (config_get_persist_status(&persist) == ESP_OK) {
+        json_writer_bool(json, "save_pending", persist.pending);
+        json_writer_number(json, "nvs_commits", persist.commits);
+        json_writer_number(json, "nvs_writes_skipped", persist.skipped);
+        json_writer_string(json, "last_save_status", esp_err_to_name(persist.last_error));
+    }
+    json_writer_object_end(json);
 
-    // Add configuration metadata
-    cJSON_AddNumberToObject(json, "config_version", config.config_version);
-    cJSON_AddNumberToObject(json, "save_count", config.save_count);
-
-    // Add WiFi configuration (exclude password for security)
-    cJSON *wifi = cJSON_CreateObject();
-    cJSON_AddStringToObject(wifi, "ssid", config.wifi_ssid);
-    cJSON_AddStringToObject(wifi, "password", ""); // Never expose password
-    cJSON_AddNumberToObject(wifi, "ap_channel", config.wifi_ap_channel);
-    cJSON_AddNumberToObject(wifi, "ap_max_conn", config.wifi_ap_max_conn);
-    cJSON_AddNumberToObject(wifi, "sta_max_retry", config.wifi_sta_max_retry);
-    cJSON_AddNumberToObject(wifi, "sta_timeout_ms", config.wifi_sta_timeout_ms);
-    cJSON_AddItemToObject(json, "wifi", wifi);
-
-    // Convert to string and send
-    char *json_string = cJSON_Print(json);
-    if (json_string == NULL) {
-        ESP_LOGE(TAG, "Failed to print JSON");
-        cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "JSON serialization failed");
-        return ESP_FAIL;
+    // WiFi status (basic info)
+    wifi_ap_record_t ap_info;
+    esp_err_t wifi_status = esp_wifi_sta_get_ap_info(&ap_info);
+    json_writer_object_begin(json, "wifi");
+    if (wifi_status == ESP_OK) {
+        json_writer_string(json, "status", "connected");
+        json_writer_string(json, "ssid", (char*)ap_info.ssid);
+        json_writer_number(json, "rssi", ap_info.rssi);
+    } else {
+        json_writer_string(json, "status", "disconnected");
     }
+    json_writer_object_end(json);
 
-    httpd_resp_send(req, json_string, HTTPD_RESP_USE_STRLEN);
+#ifdef CONFIG_TARGET_EMULATOR
+    // Emulator network link (UART tunnel)
+    write_tunnel_json(json);
+#endif
 
-    // Cleanup
-    free(json_string);
-    cJSON_Delete(json);
+#ifdef CONFIG_WEB_SERVER_HTTPS
+    // TLS handshake cost and rate
+    write_https_json(json);
+#endif
 
-    ESP_LOGD(TAG, "Configuration sent successfully");
-    return ESP_OK;
+    // Time-to-ready: init stage timeline and milestones
+    write_boot_json(json);
+
+    // Power mode, request latency and current estimate
+    write_power_json(json);
+
+    // Per-task CPU share and stack high-water marks
+    write_tasks_json(json, caller);
+
+    // Per-request scratch memory pool
+    write_request_arena_json(json);
+
+    // Sampler rate and losses of the measurement pipeline
+    write_measurement_stats_json(json);
+
+    // Overall system health assessment
+    bool system_healthy = (nvs_health == ESP_OK) && 
+                         (config_status == ESP_OK) && 
+                         (free_heap > 50000); // At least 50KB free
+
+    json_writer_string(json, "overall_status", system_healthy ? "healthy" : "degraded");
+    json_writer_string(json, "device_type", "ESP32 Distance Sensor");
+    json_writer_string(json, "firmware_version", "1.0.0");
+
+    json_writer_object_end(json);
 }
 
 /**
- * @brief POST /api/config - Update and save configuration
+ * @brief GET /api/system/health - System health and diagnostics (REQ-CFG-11)
  */
-static esp_err_t config_set_handler(httpd_req_t *req)
+static esp_err_t system_health_handler(httpd_req_t *req)
 {
-    ESP_LOGD(TAG, "Handling POST /api/config");
+    ESP_LOGD(TAG, "Handling GET /api/system/health");
 
     // Set CORS headers
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_hdr(req, "Content-Type", "application/json");
 
-    // Read request body
-    char content[1024];
-    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
-    if (ret <= 0) {
-        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
-            httpd_resp_send_408(req);
-        } else {
-            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to read request body");
-        }
-        return ESP_FAIL;
-    }
-    content[ret] = '\0';
-
-    ESP_LOGD(TAG, "Received configuration JSON: %s", content);
-
-    // Parse JSON
-    cJSON *json = cJSON_Parse(content);
-    if (json == NULL) {
-        ESP_LOGE(TAG, "Failed to parse JSON");
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON format");
-        return ESP_FAIL;
+    // Create JSON response
+    char *json_buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+    if (json_buf == NULL) {
+        return send_arena_exhausted(req);
     }
-
-    // Get current configuration as base
-    system_config_t new_config;
-    esp_err_t config_ret = config_get_current(&new_config);
-    if (config_ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get current configuration");
-        cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to get current configuration");
+    json_writer_t json;
+    json_writer_init(&json, req, json_buf, JSON_WRITER_BUFFER_SIZE);
+    write_health_json(&json, NULL, HEALTH_CALLER_HTTP);
+    esp_err_t send_ret = json_writer_finish(&json);
+    if (send_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send system health: %s", esp_err_to_name(send_ret));
         return ESP_FAIL;
     }
 
-    // Update configuration from JSON
-    cJSON *wifi = cJSON_GetObjectItem(json, "wifi");
-    if (wifi != NULL) {
-        cJSON *item;
-        if ((item = cJSON_GetObjectItem(wifi, "ssid")) != NULL && cJSON_IsString(item)) {
-            strncpy(new_config.wifi_ssid, cJSON_GetStringValue(item), CONFIG_WIFI_SSID_MAX_LEN - 1);
-            new_config.wifi_ssid[CONFIG_WIFI_SSID_MAX_LEN - 1] = '\0';
-        }
-        if ((item = cJSON_GetObjectItem(wifi, "password")) != NULL && cJSON_IsString(item)) {
-            const char *password = cJSON_GetStringValue(item);
-            if (strlen(password) > 0) { // Only update if password is provided
-                strncpy(new_config.wifi_password, password, CONFIG_WIFI_PASSWORD_MAX_LEN - 1);
-                new_config.wifi_password[CONFIG_WIFI_PASSWORD_MAX_LEN - 1] = '\0';
-            }
-        }
-        if ((item = cJSON_GetObjectItem(wifi, "ap_channel")) != NULL && cJSON_IsNumber(item)) {
-            new_config.wifi_ap_channel = (uint8_t)cJSON_GetNumberValue(item);
-        }
-        if ((item = cJSON_GetObjectItem(wifi, "ap_max_conn")) != NULL && cJSON_IsNumber(item)) {
-            new_config.wifi_ap_max_conn = (uint8_t)cJSON_GetNumberValue(item);
-        }
-        if ((item = cJSON_GetObjectItem(wifi, "sta_max_retry")) != NULL && cJSON_IsNumber(item)) {
-            new_config.wifi_sta_max_retry = (uint8_t)cJSON_GetNumberValue(item);
-        }
-        if ((item = cJSON_GetObjectItem(wifi, "sta_timeout_ms")) != NULL && cJSON_IsNumber(item)) {
-            new_config.wifi_sta_timeout_ms = (uint32_t)cJSON_GetNumberValue(item);
-        }
-    }
+    ESP_LOGD(TAG, "System health information sent successfully");
+    return ESP_OK;
+}
 
-    cJSON_Delete(json);
+/**
+ * @brief Write the combined status, health and configuration document
+ */
+static void write_batch_json(json_writer_t *json, health_caller_t caller)
+{
+    json_writer_object_begin(json, NULL);
 
-    // Validate and save configuration
-    config_ret = config_save(&new_config);
-    if (config_ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save configuration: %s", esp_err_to_name(config_ret));
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Configuration validation failed");
-        return ESP_FAIL;
+    wifi_status_t status;
+    if (wifi_manager_get_status(&status) == ESP_OK) {
+        write_status_json(json, "status", &status);
     }
 
-    // Send success response
-    const char *response = "{\"status\":\"success\",\"message\":\"Configuration saved successfully. Device will restart in 3 seconds.\"}";
-    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    write_health_json(json, "health", caller);
 
-    ESP_LOGI(TAG, "Configuration updated and saved successfully. Scheduling device restart...");
-    
-    // Schedule restart using a timer to avoid blocking the HTTP response
-    if (restart_timer == NULL) {
-        esp_timer_create_args_t timer_args = {
-            .callback = restart_timer_callback,
-            .name = "restart_timer"
-        };
-        esp_timer_create(&timer_args, &restart_timer);
+    system_config_t config;
+    if (config_get_current(&config) == ESP_OK) {
+        write_config_document(json, "config", &config);
     }
-    
-    // Start the restart timer (3 seconds delay)
-    esp_timer_start_once(restart_timer, 3000000); // 3 seconds in microseconds
-    
-    return ESP_OK;
+
+    json_writer_object_end(json);
 }
 
 /**
- * @brief POST /api/config/reset - Reset to factory defaults (REQ-CFG-5)
+ * @brief GET /api/batch - Status, health and configuration in one response
+ *
+ * Lets a page load fetch everything it needs over one connection in a single
+ * round trip: {"status": {...}, "health": {...}, "config": {...}}. Each member
+ * has the same layout as the response of its dedicated endpoint. Members whose
+ * data is unavailable are omitted.
  */
-static esp_err_t config_reset_handler(httpd_req_t *req)
+static esp_err_t batch_handler(httpd_req_t *req)
 {
-    ESP_LOGD(TAG, "Handling POST /api/config/reset");
+    ESP_LOGD(TAG, "Handling GET /api/batch");
 
     // Set CORS headers
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_hdr(req, "Content-Type", "application/json");
 
-    // Perform factory reset
-    esp_err_t ret = config_factory_reset();
+    char *json_buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+    if (json_buf == NULL) {
+        return send_arena_exhausted(req);
+    }
+    json_writer_t json;
+    json_writer_init(&json, req, json_buf, JSON_WRITER_BUFFER_SIZE);
+    write_batch_json(&json, HEALTH_CALLER_HTTP);
+    esp_err_t ret = json_writer_finish(&json);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Factory reset failed: %s", esp_err_to_name(ret));
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Factory reset failed");
+        ESP_LOGE(TAG, "Failed to send batch response: %s", esp_err_to_name(ret));
         return ESP_FAIL;
     }
-
-    // Send success response
-    const char *response = "{\"status\":\"success\",\"message\":\"Configuration reset to factory defaults\"}";
-    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
-
-    ESP_LOGI(TAG, "Configuration reset to factory defaults");
     return ESP_OK;
 }
 
-
-
-
 /**
- * @brief GET /api/system/health - System health and diagnostics (REQ-CFG-11)
+ * @brief Write the members describing one measurement sample
+ *
+ * distance_cm is the filtered distance; for samples whose status is not "ok"
+ * it is the last good value.
  */
-static esp_err_t system_health_handler(httpd_req_t *req)
+static void write_measurement_fields(json_writer_t *json, const measurement_t *sample)
 {
-    ESP_LOGD(TAG, "Handling GET /api/system/health");
+    json_writer_string(json, "status", measurement_status_str((measurement_status_t)sample->status));
+    json_writer_number(json, "distance_cm", sample->filtered_mm / 10.0);
+    json_writer_number(json, "raw_cm", sample->raw_mm / 10.0);
+    json_writer_number(json, "led_index", sample->led_index);
+    json_writer_number(json, "seq", sample->seq);
+    json_writer_number(json, "timestamp_ms", (double)(sample->timestamp_us / 1000));
+    json_writer_number(json, "age_ms", (double)((esp_timer_get_time() - sample->timestamp_us) / 1000));
+}
 
-    // Set CORS headers
+/**
+ * @brief GET /api/distance - Newest sample of the measurement pipeline
+ *
+ * Responds {"status":"unavailable"} until the first sample is produced (no
+ * distance source registered yet).
+ */
+static esp_err_t distance_data_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Content-Type", "application/json");
 
-    // Create JSON response
-    cJSON *json = cJSON_CreateObject();
-    if (json == NULL) {
-        ESP_LOGE(TAG, "Failed to create JSON object");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-        return ESP_FAIL;
+    measurement_t sample;
+    if (measurement_get_latest(&sample) != ESP_OK) {
+        return httpd_resp_send(req, "{\"status\":\"unavailable\"}", HTTPD_RESP_USE_STRLEN);
     }
 
-    // System uptime
-    int64_t uptime_us = esp_timer_get_time();
-    cJSON_AddNumberToObject(json, "uptime_seconds", (double)uptime_us / 1000000.0);
+    char *json_buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+    if (json_buf == NULL) {
+        return send_arena_exhausted(req);
+    }
+    json_writer_t json;
+    json_writer_init(&json, req, json_buf, JSON_WRITER_BUFFER_SIZE);
+    json_writer_object_begin(&json, NULL);
+    write_measurement_fields(&json, &sample);
+    json_writer_object_end(&json);
+    return json_writer_finish(&json);
+}
 
-    // Memory information
-    uint32_t free_heap = esp_get_free_heap_size();
-    uint32_t min_free_heap = esp_get_minimum_free_heap_size();
-    cJSON_AddNumberToObject(json, "free_heap_bytes", free_heap);
-    cJSON_AddNumberToObject(json, "minimum_free_heap_bytes", min_free_heap);
-    cJSON_AddNumberToObject(json, "heap_fragmentation_percent", 
-                           ((float)(free_heap - min_free_heap) / free_heap) * 100.0);
+/**
+ * @brief Parsed query of GET /api/distance/history
+ */
+typedef struct {
+    measurement_history_tier_t tier;
+    uint32_t window_s;                  ///< Newest seconds to return, 0 for the whole tier
+    bool binary;
+} history_query_t;
 
-    // NVS health check
-    size_t nvs_free_entries, nvs_total_entries;
-    esp_err_t nvs_health = config_nvs_health_check(&nvs_free_entries, &nvs_total_entries);
-    
-    cJSON *nvs_info = cJSON_CreateObject();
-    cJSON_AddStringToObject(nvs_info, "status", 
-                           (nvs_health == ESP_OK) ? "healthy" : 
-                           (nvs_health == ESP_ERR_INVALID_STATE) ? "corrupted" : "error");
-    cJSON_AddStringToObject(nvs_info, "status_message", esp_err_to_name(nvs_health));
-    cJSON_AddNumberToObject(nvs_info, "free_entries", nvs_free_entries);
-    cJSON_AddNumberToObject(nvs_info, "total_entries", nvs_total_entries);
-    cJSON_AddNumberToObject(nvs_info, "used_entries", nvs_total_entries - nvs_free_entries);
-    cJSON_AddItemToObject(json, "nvs", nvs_info);
+/**
+ * @brief Parse ?tier=raw|1s|1m&window=<seconds>&format=json|binary
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown value
+ */
+static esp_err_t parse_history_query(httpd_req_t *req, history_query_t *query)
+{
+    char buf[64];
+    char value[16];
 
-    // Configuration status
-    system_config_t current_config;
-    esp_err_t config_status = config_get_current(&current_config);
-    cJSON *config_info = cJSON_CreateObject();
-    cJSON_AddStringToObject(config_info, "status", 
-                           (config_status == ESP_OK) ? "healthy" : "error");
-    if (config_status == ESP_OK) {
-        cJSON_AddNumberToObject(config_info, "version", current_config.config_version);
-        cJSON_AddNumberToObject(config_info, "save_count", current_config.save_count);
+    query->tier = MEASUREMENT_HISTORY_SECOND;
+    query->window_s = 0;
+    query->binary = false;
+    if (httpd_req_get_url_query_str(req, buf, sizeof(buf)) != ESP_OK) {
+        return ESP_OK;
     }
-    cJSON_AddItemToObject(json, "configuration", config_info);
 
-    // WiFi status (basic info)
-    wifi_ap_record_t ap_info;
-    esp_err_t wifi_status = esp_wifi_sta_get_ap_info(&ap_info);
-    cJSON *wifi_info = cJSON_CreateObject();
-    if (wifi_status == ESP_OK) {
-        cJSON_AddStringToObject(wifi_info, "status", "connected");
-        cJSON_AddStringToObject(wifi_info, "ssid", (char*)ap_info.ssid);
-        cJSON_AddNumberToObject(wifi_info, "rssi", ap_info.rssi);
-    } else {
-        cJSON_AddStringToObject(wifi_info, "status", "disconnected");
+    if (httpd_query_key_value(buf, "tier", value, sizeof(value)) == ESP_OK) {
+        measurement_history_tier_t tier;
+        for (tier = 0; tier < MEASUREMENT_HISTORY_TIER_COUNT; tier++) {
+            if (strcmp(value, measurement_history_tier_str(tier)) == 0) {
+                break;
+            }
+        }
+        if (tier == MEASUREMENT_HISTORY_TIER_COUNT) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        query->tier = tier;
+    }
+    if (httpd_query_key_value(buf, "window", value, sizeof(value)) == ESP_OK) {
+        char *end;
+        unsigned long window = strtoul(value, &end, 10);
+        if (end == value || *end != '\0' || window > UINT32_MAX) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        query->window_s = (uint32_t)window;
     }
-    cJSON_AddItemToObject(json, "wifi", wifi_info);
+    if (httpd_query_key_value(buf, "format", value, sizeof(value)) == ESP_OK) {
+        if (strcmp(value, "binary") == 0) {
+            query->binary = true;
+        } else if (strcmp(value, "json") != 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    return ESP_OK;
+}
 
-    // Overall system health assessment
-    bool system_healthy = (nvs_health == ESP_OK) && 
-                         (config_status == ESP_OK) && 
-                         (free_heap > 50000); // At least 50KB free
+static inline void put_le16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
 
-    cJSON_AddStringToObject(json, "overall_status", system_healthy ? "healthy" : "degraded");
-    cJSON_AddStringToObject(json, "device_type", "ESP32 Distance Sensor");
-    cJSON_AddStringToObject(json, "firmware_version", "1.0.0");
+static inline void put_le32(uint8_t *p, uint32_t value)
+{
+    put_le16(p, (uint16_t)value);
+    put_le16(p + 2, (uint16_t)(value >> 16));
+}
 
-    // Convert to string and send
-    char *json_string = cJSON_Print(json);
-    if (json_string == NULL) {
-        ESP_LOGE(TAG, "Failed to print JSON");
-        cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "JSON serialization failed");
-        return ESP_FAIL;
+/**
+ * @brief Send the points of a history snapshot as little-endian uint16 values
+ *
+ * 16-byte header: "MH", version 1, tier, period_us (u32), end_ms (u32),
+ * count (u16), reserved (u16). Then count values in mm, oldest first,
+ * 0xFFFF for a gap.
+ */
+static esp_err_t send_history_binary(httpd_req_t *req, const history_query_t *query,
+                                     const measurement_history_info_t *info,
+                                     measurement_history_cursor_t *cursor, size_t count)
+{
+    uint8_t *chunk = request_arena_alloc(req, WEB_SERVER_HISTORY_CHUNK_BYTES);
+    if (chunk == NULL) {
+        return send_arena_exhausted(req);
     }
 
-    httpd_resp_send(req, json_string, HTTPD_RESP_USE_STRLEN);
-
-    // Cleanup
-    free(json_string);
-    cJSON_Delete(json);
+    chunk[0] = 'M';
+    chunk[1] = 'H';
+    chunk[2] = 1;
+    chunk[3] = (uint8_t)query->tier;
+    put_le32(&chunk[4], info->period_us);
+    put_le32(&chunk[8], (uint32_t)(info->end_us / 1000));
+    put_le16(&chunk[12], (uint16_t)count);
+    put_le16(&chunk[14], 0);
+    size_t len = WEB_SERVER_HISTORY_HEADER_BYTES;
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    size_t total = WEB_SERVER_HISTORY_HEADER_BYTES + count * sizeof(uint16_t);
+    if (total <= WEB_SERVER_HISTORY_CHUNK_BYTES) {
+        // Small responses go out in one piece with a Content-Length
+        uint16_t value;
+        while (measurement_history_next(cursor, &value)) {
+            put_le16(&chunk[len], value);
+            len += sizeof(uint16_t);
+        }
+        return httpd_resp_send(req, (const char *)chunk, len);
+    }
 
-    ESP_LOGD(TAG, "System health information sent successfully");
-    return ESP_OK;
+    uint16_t value;
+    while (measurement_history_next(cursor, &value)) {
+        if (len + sizeof(uint16_t) > WEB_SERVER_HISTORY_CHUNK_BYTES) {
+            esp_err_t ret = httpd_resp_send_chunk(req, (const char *)chunk, len);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            len = 0;
+        }
+        put_le16(&chunk[len], value);
+        len += sizeof(uint16_t);
+    }
+    esp_err_t ret = httpd_resp_send_chunk(req, (const char *)chunk, len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
 }
 
 /**
- * @brief GET /api/distance - Get current distance measurement
- * 
- * NOTE: This handler is disabled in the template version.
- * Users should implement their own sensor data endpoints based on their hardware.
+ * @brief GET /api/distance/history - Recent filtered distances
+ *
+ * Query: tier=raw|1s|1m (default 1s), window=<seconds> (default: all points
+ * of the tier), format=json|binary (default json). The JSON form is
+ * {"tier","period_ms","end_ms","count","unit":"mm","values":[...]} with
+ * values oldest first and null for gaps; value i of count was taken at
+ * end_ms - (count - 1 - i) * period_ms. See send_history_binary() for the
+ * binary form, which is a quarter of the size for typical distances.
  */
-/*
-static esp_err_t distance_data_handler(httpd_req_t *req)
+static esp_err_t distance_history_handler(httpd_req_t *req)
 {
-    // Template: Implement your own sensor data endpoint here
-    httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    return httpd_resp_send(req, "{\"error\":\"Not implemented in template\"}", HTTPD_RESP_USE_STRLEN);
+
+    history_query_t query;
+    if (parse_history_query(req, &query) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid tier, window or format");
+        return ESP_OK;
+    }
+
+    uint8_t *snapshot = request_arena_alloc(req, MEASUREMENT_HISTORY_TIER_BYTES);
+    if (snapshot == NULL) {
+        return send_arena_exhausted(req);
+    }
+    measurement_history_info_t info;
+    measurement_history_cursor_t cursor;
+    measurement_history_snapshot(query.tier, snapshot, MEASUREMENT_HISTORY_TIER_BYTES, &info, &cursor);
+
+    // Skip the points older than the window
+    size_t count = info.count;
+    if (query.window_s > 0 && info.period_us > 0) {
+        uint64_t in_window = (uint64_t)query.window_s * 1000000ULL / info.period_us + 1;
+        if (in_window < count) {
+            uint16_t value;
+            for (size_t skip = count - (size_t)in_window; skip > 0; skip--) {
+                measurement_history_next(&cursor, &value);
+            }
+            count = (size_t)in_window;
+        }
+    }
+
+    if (query.binary) {
+        return send_history_binary(req, &query, &info, &cursor, count);
+    }
+
+    char *json_buf = request_arena_alloc(req, JSON_WRITER_BUFFER_SIZE);
+    if (json_buf == NULL) {
+        return send_arena_exhausted(req);
+    }
+    httpd_resp_set_type(req, "application/json");
+    json_writer_t json;
+    json_writer_init(&json, req, json_buf, JSON_WRITER_BUFFER_SIZE);
+    json_writer_object_begin(&json, NULL);
+    json_writer_string(&json, "tier", measurement_history_tier_str(query.tier));
+    json_writer_number(&json, "period_ms", info.period_us / 1000.0);
+    json_writer_number(&json, "end_ms", (double)(info.end_us / 1000));
+    json_writer_number(&json, "count", count);
+    json_writer_string(&json, "unit", "mm");
+    json_writer_array_begin(&json, "values");
+    uint16_t value;
+    while (measurement_history_next(&cursor, &value)) {
+        json_writer_number(&json, NULL, value == MEASUREMENT_HISTORY_GAP ? NAN : value);
+    }
+    json_writer_array_end(&json);
+    json_writer_object_end(&json);
+    return json_writer_finish(&json);
 }
-*/
 
 /**
  * @brief OPTIONS /api/ wildcard - CORS preflight handler
@@ -6,7 +6,12 @@
  * - Multi-page responsive web interface with navbar navigation
  * - Static file serving from embedded flash assets (HTML, CSS, JS)
  * - WiFi configuration API endpoints (scan, connect, status, reset)
+ * - /api/batch returning status, health and configuration in one response
+ * - Persistent connections with an idle timeout and a per-client socket budget
+ * - Optional HTTPS mode (CONFIG_WEB_SERVER_HTTPS) with TLS session tickets
  * - Integration with DNS server module for captive portal functionality
+ * - Slow handlers (scan, connect, reset, config writes) on an async worker
+ *   pool so fast GETs never queue behind them
  * - CORS-secured API endpoints with proper MIME type handling
  */
 
@@ -14,25 +19,66 @@
 
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef CONFIG_WEB_SERVER_HTTPS
+#define WEB_SERVER_DEFAULT_PORT 443
+#define WEB_SERVER_DEFAULT_STACK_SIZE 10240   ///< TLS handshakes run on the httpd task
+#else
+#define WEB_SERVER_DEFAULT_PORT 80
+#define WEB_SERVER_DEFAULT_STACK_SIZE 4096
+#endif
+
 /**
  * @brief Web server configuration structure
  */
 typedef struct {
-    uint16_t port;              ///< HTTP server port (default: 80)
+    uint16_t port;              ///< Server port (default: 80, 443 with CONFIG_WEB_SERVER_HTTPS)
     size_t max_open_sockets;    ///< Maximum concurrent connections (default: 7)
+    size_t max_uri_handlers;    ///< URI handler slots (default: 32)
+    uint16_t backlog_conn;      ///< Listen backlog (default: 5)
+    size_t stack_size;          ///< httpd task stack in bytes (default: 4096, 10240 with HTTPS)
+    unsigned task_priority;     ///< httpd task priority (default: tskIDLE_PRIORITY + 5)
+    BaseType_t core_id;         ///< httpd task core affinity (default: tskNO_AFFINITY)
+    uint16_t recv_timeout_s;    ///< Socket receive timeout in seconds (default: 5)
+    uint16_t send_timeout_s;    ///< Socket send timeout in seconds (default: 5)
+    bool lru_purge_enable;      ///< Close least recently used socket when full (default: true)
+    bool keep_alive_enable;     ///< TCP keep-alive probes on client sockets (default: false)
+    int keep_alive_idle_s;      ///< Idle time before the first probe (default: 5)
+    int keep_alive_interval_s;  ///< Time between probes (default: 5)
+    int keep_alive_count;       ///< Unanswered probes before the socket is closed (default: 3)
+    uint16_t idle_timeout_s;    ///< Close HTTP connections idle this long, 0 never (default: 15)
+    size_t max_sockets_per_client; ///< Sockets one client address may hold, 0 no limit (default: 4)
+    size_t async_workers;       ///< Worker tasks for slow handlers, 0 runs them on the httpd task (default: 2)
+    size_t async_stack_size;    ///< Worker task stack in bytes (default: 4096)
 } web_server_config_t;
 
 /**
  * @brief Default web server configuration
  */
 #define WEB_SERVER_DEFAULT_CONFIG() { \
-    .port = 80, \
-    .max_open_sockets = 7 \
+    .port = WEB_SERVER_DEFAULT_PORT, \
+    .max_open_sockets = 7, \
+    .max_uri_handlers = 32, \
+    .backlog_conn = 5, \
+    .stack_size = WEB_SERVER_DEFAULT_STACK_SIZE, \
+    .task_priority = tskIDLE_PRIORITY + 5, \
+    .core_id = tskNO_AFFINITY, \
+    .recv_timeout_s = 5, \
+    .send_timeout_s = 5, \
+    .lru_purge_enable = true, \
+    .keep_alive_enable = false, \
+    .keep_alive_idle_s = 5, \
+    .keep_alive_interval_s = 5, \
+    .keep_alive_count = 3, \
+    .idle_timeout_s = 15, \
+    .max_sockets_per_client = 4, \
+    .async_workers = 2, \
+    .async_stack_size = 4096 \
 }
 
 /**
@@ -95,6 +141,32 @@ uint16_t web_server_get_port(void);
  */
 esp_err_t static_file_handler(httpd_req_t *req);
 
+/**
+ * @brief JSON documents served by the API
+ */
+typedef enum {
+    WEB_SERVER_DOC_STATUS,      ///< GET /status
+    WEB_SERVER_DOC_CONFIG,      ///< GET /api/config
+    WEB_SERVER_DOC_HEALTH,      ///< GET /api/system/health
+    WEB_SERVER_DOC_BATCH,       ///< GET /api/batch
+} web_server_document_t;
+
+/**
+ * @brief Serialize an API document into a buffer
+ *
+ * Produces the same JSON the endpoint sends, without HTTP. Intended for
+ * benchmarks: the health document keeps per-call CPU sampling state, so this
+ * must not run while the server is handling requests.
+ *
+ * @param doc Document to render
+ * @param buf Output buffer (NUL-terminated on success)
+ * @param size Size of the output buffer
+ * @param[out] length Document length in bytes (optional)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown document,
+ *         ESP_ERR_NO_MEM if the buffer is too small
+ */
+esp_err_t web_server_render_document(web_server_document_t doc, char *buf, size_t size, size_t *length);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -45,13 +45,25 @@
  * - STA failure: Sets flag to "AP"
  * - AP startup: Sets flag to "STA" (immediate escape route)
  * - User action: Just restart (let boot logic handle it)
+ *
+ * FAST RECONNECT (CONFIG_WIFI_STA_FAST_RECONNECT):
+ * - Every successful connection stores BSSID + channel of the AP ("fast_conn")
+ * - STA boot connects straight to that AP on that channel, no full scan
+ * - The DHCP client asks for the previous lease (LWIP_DHCP_RESTORE_LAST_IP);
+ *   CONFIG_WIFI_STA_STATIC_IP skips DHCP entirely
+ * - Fast attempt fails or times out → cache dropped, full scan connect with
+ *   the normal STA timeout
  */
 
 #include "wifi_manager.h"
+#include "wifi_scan_cache.h"
 #include "web_server.h"
+#include "config_manager.h"
 #include "config.h"
+#include "boot_manager.h"
 #include "esp_log.h"
 #include "esp_wifi.h"
+#include "esp_mac.h"
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "esp_timer.h"
@@ -69,6 +81,7 @@ static const char *TAG = "wifi_manager";
 #define NVS_SSID_KEY "ssid"
 #define NVS_PASSWORD_KEY "password"
 #define NVS_BOOT_MODE_KEY "boot_mode"
+#define NVS_FAST_CONNECT_KEY "fast_conn"
 
 // Boot mode values
 #define BOOT_MODE_STA "STA"
@@ -78,6 +91,20 @@ static const char *TAG = "wifi_manager";
 #define STA_TIMEOUT_MS (10 * 1000)      // 10 seconds STA timeout
 #define AP_TIMEOUT_MS (10 * 60 * 1000)  // 10 minutes AP timeout
 #define RESTART_DELAY_MS (3 * 1000)     // 3 seconds before restart
+#define AP_SCAN_INTERVAL_MS (60 * 1000) // Background scan period in AP mode
+
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+#define FAST_CONNECT_TIMEOUT_MS CONFIG_WIFI_STA_FAST_RECONNECT_TIMEOUT_MS
+
+/**
+ * @brief Access point of the last successful connection (NVS blob)
+ */
+typedef struct {
+    char ssid[32];          ///< Network the entry belongs to
+    uint8_t bssid[6];       ///< Access point MAC address
+    uint8_t channel;        ///< Primary channel of the access point
+} fast_connect_cache_t;
+#endif
 
 // Global state (minimal)
 static bool wifi_initialized = false;
@@ -85,9 +112,16 @@ static wifi_manager_mode_t current_mode = WIFI_MODE_DISCONNECTED;
 static wifi_credentials_t stored_credentials = {0};
 static esp_timer_handle_t timeout_timer = NULL;
 static esp_timer_handle_t restart_timer = NULL;
+static esp_timer_handle_t scan_timer = NULL;
 static esp_netif_t *netif_sta = NULL;
 static esp_netif_t *netif_ap = NULL;
 static EventGroupHandle_t wifi_event_group = NULL;
+static uint32_t sta_connect_time_ms = 0;
+static bool sta_fast_connect = false;       // Current attempt targets the cached AP
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+static fast_connect_cache_t fast_cache = {0};
+static bool fast_cache_valid = false;
+#endif
 
 // Event group bits
 #define WIFI_CONNECTED_BIT BIT0
@@ -97,11 +131,23 @@ static EventGroupHandle_t wifi_event_group = NULL;
 static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 static void timeout_callback(void* arg);
 static void restart_callback(void* arg);
+static void scan_timer_callback(void* arg);
+static void handle_scan_done(void);
 static esp_err_t load_credentials_from_nvs(void);
 static esp_err_t save_boot_mode(const char* mode);
 static esp_err_t get_boot_mode(char* mode, size_t max_len);
 static esp_err_t start_sta_boot(void);
 static esp_err_t start_ap_boot(void);
+static void sta_set_config(bool use_cache);
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+static void load_fast_connect(void);
+static void save_fast_connect(void);
+static void clear_fast_connect(void);
+static void sta_fallback_full_scan(void);
+#endif
+#ifdef CONFIG_WIFI_STA_STATIC_IP
+static esp_err_t apply_static_ip(void);
+#endif
 
 //=============================================================================
 // PUBLIC API FUNCTIONS
@@ -162,6 +208,14 @@ esp_err_t wifi_manager_init(void)
     };
     ESP_ERROR_CHECK(esp_timer_create(&restart_args, &restart_timer));
 
+    esp_timer_create_args_t scan_args = {
+        .callback = scan_timer_callback,
+        .arg = NULL,
+        .name = "wifi_scan"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&scan_args, &scan_timer));
+    ESP_ERROR_CHECK(wifi_scan_cache_init());
+
     wifi_initialized = true;
     ESP_LOGI(TAG, "WiFi manager initialized successfully");
     return ESP_OK;
@@ -213,6 +267,11 @@ esp_err_t wifi_manager_stop(void)
         esp_timer_delete(restart_timer);
         restart_timer = NULL;
     }
+    if (scan_timer) {
+        esp_timer_stop(scan_timer);
+        esp_timer_delete(scan_timer);
+        scan_timer = NULL;
+    }
 
     // Stop web server and WiFi
     web_server_stop();
@@ -233,6 +292,8 @@ esp_err_t wifi_manager_get_status(wifi_status_t *status)
     status->retry_count = 0; // Not used in restart-based approach
     status->has_credentials = (stored_credentials.ssid[0] != '\0');
     status->rssi = 0; // TODO: Get actual RSSI
+    status->connect_time_ms = (current_mode == WIFI_MODE_STA_CONNECTED) ? sta_connect_time_ms : 0;
+    status->fast_connect = (current_mode == WIFI_MODE_STA_CONNECTED) && sta_fast_connect;
 
     if (current_mode == WIFI_MODE_STA_CONNECTED) {
         strncpy(status->connected_ssid, stored_credentials.ssid, sizeof(status->connected_ssid) - 1);
@@ -297,6 +358,7 @@ esp_err_t wifi_manager_clear_credentials(void)
     if (ret == ESP_OK) {
         nvs_erase_key(nvs_handle, NVS_SSID_KEY);
         nvs_erase_key(nvs_handle, NVS_PASSWORD_KEY);
+        nvs_erase_key(nvs_handle, NVS_FAST_CONNECT_KEY);
         nvs_commit(nvs_handle);
         nvs_close(nvs_handle);
     }
@@ -323,6 +385,43 @@ esp_err_t wifi_manager_switch_to_ap(void)
     return ESP_OK;
 }
 
+esp_err_t wifi_manager_scan_start(void)
+{
+    if (!wifi_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (current_mode == WIFI_MODE_STA_CONNECTING) {
+        // Scanning now would delay the connection attempt
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!wifi_scan_cache_begin()) {
+        return ESP_OK; // Already running, results will arrive with it
+    }
+
+    // Scanning needs the STA interface; APSTA keeps the AP (and clients) up
+    wifi_mode_t mode;
+    if (esp_wifi_get_mode(&mode) == ESP_OK && mode == WIFI_MODE_AP) {
+        ESP_LOGI(TAG, "Enabling STA interface for background scanning");
+        esp_wifi_set_mode(WIFI_MODE_APSTA);
+    }
+
+    wifi_scan_config_t scan_config = {
+        .ssid = NULL,
+        .bssid = NULL,
+        .channel = 0,
+        .show_hidden = false
+    };
+    esp_err_t ret = esp_wifi_scan_start(&scan_config, false);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start WiFi scan: %s", esp_err_to_name(ret));
+        wifi_scan_cache_abort();
+        return ret;
+    }
+
+    ESP_LOGD(TAG, "Background WiFi scan started");
+    return ESP_OK;
+}
+
 esp_err_t wifi_manager_get_ip_address(char *ip_str, size_t max_len)
 {
     if (!ip_str || max_len < 16) {
@@ -411,16 +510,14 @@ static esp_err_t get_boot_mode(char* mode, size_t max_len)
     return ret;
 }
 
-static esp_err_t start_sta_boot(void)
+/**
+ * @brief Configure the STA interface with the stored credentials
+ *
+ * @param use_cache Connect directly to the cached AP on its channel instead
+ *                  of scanning all channels
+ */
+static void sta_set_config(bool use_cache)
 {
-    ESP_LOGI(TAG, "=== STA BOOT MODE ===");
-    
-    // Start WiFi
-    ESP_ERROR_CHECK(esp_wifi_start());
-    
-    // Configure STA mode with stored credentials (even if empty)
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    
     wifi_config_t wifi_config = {0};
     strncpy((char*)wifi_config.sta.ssid, stored_credentials.ssid, sizeof(wifi_config.sta.ssid) - 1);
     strncpy((char*)wifi_config.sta.password, stored_credentials.password, sizeof(wifi_config.sta.password) - 1);
@@ -429,18 +526,210 @@ static esp_err_t start_sta_boot(void)
     wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
     wifi_config.sta.pmf_cfg.capable = true;
     wifi_config.sta.pmf_cfg.required = false;
+
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+    if (use_cache) {
+        // Single-channel probe for one BSSID, no scan of the other channels
+        memcpy(wifi_config.sta.bssid, fast_cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.bssid_set = true;
+        wifi_config.sta.channel = fast_cache.channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+        ESP_LOGI(TAG, "Fast reconnect to " MACSTR " on channel %d",
+                 MAC2STR(fast_cache.bssid), fast_cache.channel);
+    } else
+#endif
+    {
+        // Full scan, strongest AP of the network wins
+        wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wifi_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+    sta_fast_connect = use_cache;
+#ifdef CONFIG_POWER_MANAGER_WIFI_PS_MAX_MODEM
+    // Beacon intervals the radio sleeps through in maximum modem sleep
+    wifi_config.sta.listen_interval = CONFIG_POWER_MANAGER_WIFI_LISTEN_INTERVAL;
+#endif
     
     ESP_LOGI(TAG, "Attempting STA connection to: '%s'", wifi_config.sta.ssid);
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+}
+
+static esp_err_t start_sta_boot(void)
+{
+    ESP_LOGI(TAG, "=== STA BOOT MODE ===");
+
+    bool use_cache = false;
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+    load_fast_connect();
+    use_cache = fast_cache_valid;
+#endif
+#ifdef CONFIG_WIFI_STA_STATIC_IP
+    // Address is in place before association, so no DHCP exchange follows it
+    if (apply_static_ip() != ESP_OK) {
+        ESP_LOGW(TAG, "Invalid static IP configuration - using DHCP");
+    }
+#endif
     
+    // Configure STA mode with stored credentials (even if empty)
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    sta_set_config(use_cache);
+#ifdef CONFIG_POWER_MANAGER_ENABLE
+#ifdef CONFIG_POWER_MANAGER_WIFI_PS_MAX_MODEM
+    esp_wifi_set_ps(WIFI_PS_MAX_MODEM);
+#else
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+#endif
+#endif
+    
+    // Set before starting: STA_START is handled on the higher-priority event
+    // task and only connects in this mode
     current_mode = WIFI_MODE_STA_CONNECTING;
     
-    // Start timeout timer (10 seconds)
+    // Start WiFi
+    ESP_ERROR_CHECK(esp_wifi_start());
+    
+    // Start timeout timer (short for the cached AP, fallback scan gets the full time)
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+    if (use_cache) {
+        esp_timer_start_once(timeout_timer, FAST_CONNECT_TIMEOUT_MS * 1000);
+        return ESP_OK;
+    }
+#endif
     esp_timer_start_once(timeout_timer, STA_TIMEOUT_MS * 1000);
     
     return ESP_OK;
 }
 
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+/**
+ * @brief Load the cached AP, valid only for the stored SSID
+ */
+static void load_fast_connect(void)
+{
+    fast_cache_valid = false;
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    size_t size = sizeof(fast_cache);
+    esp_err_t ret = nvs_get_blob(nvs_handle, NVS_FAST_CONNECT_KEY, &fast_cache, &size);
+    nvs_close(nvs_handle);
+
+    if (ret != ESP_OK || size != sizeof(fast_cache)) {
+        ESP_LOGD(TAG, "No fast reconnect data");
+        return;
+    }
+    fast_cache.ssid[sizeof(fast_cache.ssid) - 1] = '\0';
+    if (stored_credentials.ssid[0] == '\0' || strcmp(fast_cache.ssid, stored_credentials.ssid) != 0 ||
+        fast_cache.channel < 1 || fast_cache.channel > 14) {
+        ESP_LOGI(TAG, "Fast reconnect data does not match stored network, ignoring");
+        return;
+    }
+    fast_cache_valid = true;
+}
+
+/**
+ * @brief Remember the AP of the current connection (flash write only on change)
+ */
+static void save_fast_connect(void)
+{
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+
+    fast_connect_cache_t entry = {0};
+    strncpy(entry.ssid, stored_credentials.ssid, sizeof(entry.ssid) - 1);
+    memcpy(entry.bssid, ap_info.bssid, sizeof(entry.bssid));
+    entry.channel = ap_info.primary;
+    if (fast_cache_valid && memcmp(&entry, &fast_cache, sizeof(entry)) == 0) {
+        return;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, NVS_FAST_CONNECT_KEY, &entry, sizeof(entry));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save fast reconnect data: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    fast_cache = entry;
+    fast_cache_valid = true;
+    ESP_LOGI(TAG, "Fast reconnect data saved: " MACSTR " channel %d", MAC2STR(entry.bssid), entry.channel);
+}
+
+/**
+ * @brief Forget the cached AP (it was not reachable)
+ */
+static void clear_fast_connect(void)
+{
+    fast_cache_valid = false;
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        nvs_erase_key(nvs_handle, NVS_FAST_CONNECT_KEY);
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Give up on the cached AP and connect with a full scan
+ */
+static void sta_fallback_full_scan(void)
+{
+    ESP_LOGW(TAG, "Fast reconnect failed - falling back to full scan");
+    clear_fast_connect();
+
+    esp_timer_stop(timeout_timer);
+    esp_wifi_disconnect();
+    sta_set_config(false);
+    esp_timer_start_once(timeout_timer, STA_TIMEOUT_MS * 1000);
+    esp_wifi_connect();
+}
+#endif
+
+#ifdef CONFIG_WIFI_STA_STATIC_IP
+/**
+ * @brief Stop the DHCP client and assign the configured static address
+ */
+static esp_err_t apply_static_ip(void)
+{
+    esp_netif_ip_info_t ip_info = {0};
+    if (esp_netif_str_to_ip4(CONFIG_WIFI_STA_STATIC_IP_ADDR, &ip_info.ip) != ESP_OK ||
+        esp_netif_str_to_ip4(CONFIG_WIFI_STA_STATIC_NETMASK, &ip_info.netmask) != ESP_OK ||
+        esp_netif_str_to_ip4(CONFIG_WIFI_STA_STATIC_GATEWAY, &ip_info.gw) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = esp_netif_dhcpc_stop(netif_sta);
+    if (ret != ESP_OK && ret != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) {
+        return ret;
+    }
+    ret = esp_netif_set_ip_info(netif_sta, &ip_info);
+    if (ret != ESP_OK) {
+        esp_netif_dhcpc_start(netif_sta);
+        return ret;
+    }
+
+    esp_netif_dns_info_t dns = {0};
+    if (esp_netif_str_to_ip4(CONFIG_WIFI_STA_STATIC_DNS, &dns.ip.u_addr.ip4) == ESP_OK) {
+        dns.ip.type = ESP_IPADDR_TYPE_V4;
+        esp_netif_set_dns_info(netif_sta, ESP_NETIF_DNS_MAIN, &dns);
+    }
+
+    ESP_LOGI(TAG, "Static IP " IPSTR " (DHCP disabled)", IP2STR(&ip_info.ip));
+    return ESP_OK;
+}
+#endif
+
 static esp_err_t start_ap_boot(void)
 {
     ESP_LOGI(TAG, "=== AP BOOT MODE ===");
@@ -470,6 +759,9 @@ static esp_err_t start_ap_boot(void)
     ESP_LOGI(TAG, "AP mode configured: %s", DEFAULT_WIFI_AP_SSID);
     
     current_mode = WIFI_MODE_AP_ACTIVE;
+
+    // Keep scan results fresh for the setup page (first scan on AP start)
+    esp_timer_start_periodic(scan_timer, AP_SCAN_INTERVAL_MS * 1000ULL);
     
     // Start web server for AP mode
     web_server_config_t web_config = WEB_SERVER_DEFAULT_CONFIG();
@@ -495,8 +787,11 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
     if (event_base == WIFI_EVENT) {
         switch (event_id) {
             case WIFI_EVENT_STA_START:
-                ESP_LOGI(TAG, "WiFi STA started, connecting...");
-                esp_wifi_connect();
+                // STA is also started for scanning in AP mode - only connect in STA boot
+                if (current_mode == WIFI_MODE_STA_CONNECTING) {
+                    ESP_LOGI(TAG, "WiFi STA started, connecting...");
+                    esp_wifi_connect();
+                }
                 break;
                 
             case WIFI_EVENT_STA_CONNECTED:
@@ -507,6 +802,13 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
                 wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
                 ESP_LOGW(TAG, "WiFi STA disconnected (reason: %d)", event->reason);
                 
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+                // A failed attempt at the cached AP goes straight to a full scan
+                if (current_mode == WIFI_MODE_STA_CONNECTING && sta_fast_connect) {
+                    sta_fallback_full_scan();
+                    break;
+                }
+#endif
                 if (current_mode == WIFI_MODE_STA_CONNECTING || current_mode == WIFI_MODE_STA_CONNECTED) {
                     if (event->reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || 
                         event->reason == WIFI_REASON_HANDSHAKE_TIMEOUT) {
@@ -524,6 +826,11 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
             case WIFI_EVENT_AP_START:
                 ESP_LOGI(TAG, "WiFi AP started successfully");
                 // Web server is started in start_ap_boot() function, not here
+                wifi_manager_scan_start();
+                break;
+
+            case WIFI_EVENT_SCAN_DONE:
+                handle_scan_done();
                 break;
                 
             default:
@@ -536,6 +843,15 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
         
         // Stop timeout timer - we're fully connected
         esp_timer_stop(timeout_timer);
+
+        // Boot to first usable packet, the figure fast reconnect optimizes
+        sta_connect_time_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        ESP_LOGI(TAG, "STA ready %lu ms after boot (%s)", (unsigned long)sta_connect_time_ms,
+                 sta_fast_connect ? "fast reconnect" : "full scan");
+        boot_manager_mark("sta_got_ip");
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+        save_fast_connect();
+#endif
         
         current_mode = WIFI_MODE_STA_CONNECTED;
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
@@ -553,6 +869,13 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
 
 static void timeout_callback(void* arg)
 {
+#ifdef CONFIG_WIFI_STA_FAST_RECONNECT
+    if (current_mode == WIFI_MODE_STA_CONNECTING && sta_fast_connect) {
+        ESP_LOGW(TAG, "Fast reconnect timeout (%d ms)", FAST_CONNECT_TIMEOUT_MS);
+        sta_fallback_full_scan();
+        return;
+    }
+#endif
     if (current_mode == WIFI_MODE_STA_CONNECTING) {
         ESP_LOGW(TAG, "STA connection timeout (%d seconds) - switching to AP mode", STA_TIMEOUT_MS / 1000);
         
@@ -570,10 +893,42 @@ static void timeout_callback(void* arg)
 
 static void restart_callback(void* arg)
 {
+    config_flush();
     ESP_LOGI(TAG, "Restarting device for WiFi mode change...");
     esp_restart();
 }
 
+static void scan_timer_callback(void* arg)
+{
+    wifi_manager_scan_start();
+}
+
+static void handle_scan_done(void)
+{
+    // Static: the event loop task stack is small and only this handler uses them
+    static wifi_ap_record_t records[WIFI_SCAN_CACHE_SIZE];
+    static wifi_scan_entry_t entries[WIFI_SCAN_CACHE_SIZE];
+
+    uint16_t count = WIFI_SCAN_CACHE_SIZE;
+    esp_err_t ret = esp_wifi_scan_get_ap_records(&count, records);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to read scan results: %s", esp_err_to_name(ret));
+        esp_wifi_clear_ap_list();
+        wifi_scan_cache_abort();
+        return;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        memcpy(entries[i].ssid, records[i].ssid, sizeof(entries[i].ssid));
+        entries[i].ssid[sizeof(entries[i].ssid) - 1] = '\0';
+        memcpy(entries[i].bssid, records[i].bssid, sizeof(entries[i].bssid));
+        entries[i].rssi = records[i].rssi;
+        entries[i].channel = records[i].primary;
+        entries[i].authmode = (uint8_t)records[i].authmode;
+    }
+    wifi_scan_cache_complete(entries, count);
+}
+
 // Minimal monitoring function (legacy compatibility)
 esp_err_t wifi_manager_monitor(void)
 {
@@ -46,8 +46,44 @@ typedef struct {
     int8_t rssi;                   ///< Signal strength (dBm)
     uint8_t retry_count;           ///< Current retry attempt
     bool has_credentials;          ///< Whether stored credentials exist
+    uint32_t connect_time_ms;      ///< Boot to STA IP address of the current connection (0 if none)
+    bool fast_connect;             ///< Current connection used the cached BSSID/channel
 } wifi_status_t;
 
+/**
+ * @brief Maximum number of access points kept in the scan cache
+ */
+#define WIFI_SCAN_CACHE_SIZE 16
+
+/**
+ * @brief Cached scan result for one access point (BSSID)
+ */
+typedef struct {
+    char ssid[33];                  ///< Network name (NUL-terminated)
+    uint8_t bssid[6];               ///< Access point MAC address
+    int8_t rssi;                    ///< Signal strength at last sighting (dBm)
+    uint8_t channel;                ///< Primary channel
+    uint8_t authmode;               ///< wifi_auth_mode_t value
+    uint32_t age_ms;                ///< Time since this BSSID was last seen
+} wifi_scan_entry_t;
+
+/**
+ * @brief Scan cache summary
+ */
+typedef struct {
+    size_t count;                   ///< Number of cached access points
+    uint32_t age_ms;                ///< Time since last completed scan (UINT32_MAX if none)
+    bool scanning;                  ///< A scan is currently running
+} wifi_scan_info_t;
+
+/**
+ * @brief Callback invoked after every completed background scan
+ *
+ * Runs in the context of the task that completed the scan (event loop task
+ * on hardware); keep it short.
+ */
+typedef void (*wifi_scan_done_cb_t)(void *arg);
+
 /**
  * @brief Initialize WiFi manager with smart boot logic
  * 
@@ -117,6 +153,39 @@ esp_err_t wifi_manager_get_ip_address(char *ip_str, size_t max_len);
  */
 esp_err_t wifi_manager_switch_to_ap(void);
 
+/**
+ * @brief Request a background WiFi scan
+ *
+ * Returns immediately; results are merged into the scan cache when the scan
+ * completes. In AP mode a scan is also scheduled periodically so the setup
+ * page always has recent results.
+ *
+ * @return ESP_OK if a scan was started or is already running, error code otherwise
+ */
+esp_err_t wifi_manager_scan_start(void);
+
+/**
+ * @brief Copy the cached scan results, strongest signal first
+ *
+ * Never blocks on the radio. Access points not seen for a while are dropped
+ * from the cache.
+ *
+ * @param entries Output array (may be NULL to only fetch the summary)
+ * @param max_entries Capacity of entries
+ * @param info Optional cache summary
+ * @return Number of entries copied
+ */
+size_t wifi_manager_get_scan_results(wifi_scan_entry_t *entries, size_t max_entries, wifi_scan_info_t *info);
+
+/**
+ * @brief Register a callback for completed scans (one callback supported)
+ *
+ * @param cb Callback, NULL to unregister
+ * @param arg Argument passed to the callback
+ * @return ESP_OK
+ */
+esp_err_t wifi_manager_register_scan_callback(wifi_scan_done_cb_t cb, void *arg);
+
 /**
  * @brief Perform lightweight WiFi health monitoring
  * 
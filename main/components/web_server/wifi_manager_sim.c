@@ -7,6 +7,7 @@
  */
 
 #include "wifi_manager.h"
+#include "wifi_scan_cache.h"
 #include "web_server.h"
 #include "netif_uart_tunnel_sim.h"
 #include "esp_err.h"
@@ -24,6 +25,13 @@ static wifi_credentials_t sim_credentials = {0};
 static char sim_ip[16] = "192.168.100.2"; // IP address for UART tunnel
 static bool netif_initialized = false;
 
+// Fixed networks reported by the simulated scan
+static const wifi_scan_entry_t sim_networks[] = {
+    { .ssid = "SimNet-Home",  .bssid = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01}, .rssi = -42, .channel = 6,  .authmode = 3 },
+    { .ssid = "SimNet-Guest", .bssid = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02}, .rssi = -67, .channel = 11, .authmode = 0 },
+    { .ssid = "SimNet-Lab",   .bssid = {0x02, 0x00, 0x00, 0x00, 0x00, 0x03}, .rssi = -80, .channel = 1,  .authmode = 4 },
+};
+
 esp_err_t wifi_manager_init(void)
 {
     ESP_LOGI(TAG, "Initializing WiFi manager simulator");
@@ -55,6 +63,12 @@ esp_err_t wifi_manager_init(void)
         ESP_LOGI(TAG, "Network interface layer initialized");
     }
     
+    ret = wifi_scan_cache_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize scan cache: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
     sim_mode = WIFI_MODE_DISCONNECTED;
     ESP_LOGI(TAG, "WiFi manager simulator initialized successfully");
     return ESP_OK;
@@ -116,6 +130,8 @@ esp_err_t wifi_manager_get_status(wifi_status_t *status)
     status->rssi = 0;
     status->retry_count = 0;
     status->has_credentials = (sim_credentials.ssid[0] != '\0');
+    status->connect_time_ms = 0;
+    status->fast_connect = false;
     if (sim_mode == WIFI_MODE_STA_CONNECTED) {
         strncpy(status->connected_ssid, sim_credentials.ssid, sizeof(status->connected_ssid)-1);
         status->connected_ssid[sizeof(status->connected_ssid)-1] = '\0';
@@ -153,6 +169,14 @@ esp_err_t wifi_manager_get_ip_address(char *ip_str, size_t max_len)
     return ESP_OK;
 }
 
+esp_err_t wifi_manager_scan_start(void)
+{
+    if (!wifi_scan_cache_begin()) return ESP_OK;
+    // Simulated scan completes immediately
+    wifi_scan_cache_complete(sim_networks, sizeof(sim_networks) / sizeof(sim_networks[0]));
+    return ESP_OK;
+}
+
 esp_err_t wifi_manager_switch_to_ap(void)
 {
     sim_mode = WIFI_MODE_AP_ACTIVE;
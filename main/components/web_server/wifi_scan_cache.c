@@ -0,0 +1,177 @@
+/**
+ * @file wifi_scan_cache.c
+ * @brief Scan result cache shared by the hardware and emulator WiFi managers
+ */
+
+#include "wifi_scan_cache.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdint.h>
+#include <string.h>
+
+static const char *TAG = "wifi_scan";
+
+typedef struct {
+    wifi_scan_entry_t entry;
+    int64_t last_seen_us;
+    bool used;
+} cache_slot_t;
+
+static SemaphoreHandle_t cache_mutex = NULL;
+static cache_slot_t cache[WIFI_SCAN_CACHE_SIZE];
+static int64_t last_scan_us = -1;
+static bool scanning = false;
+static wifi_scan_done_cb_t done_cb = NULL;
+static void *done_cb_arg = NULL;
+
+esp_err_t wifi_scan_cache_init(void)
+{
+    if (cache_mutex == NULL) {
+        cache_mutex = xSemaphoreCreateMutex();
+        if (cache_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create scan cache mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+bool wifi_scan_cache_begin(void)
+{
+    if (cache_mutex == NULL) {
+        return false;
+    }
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    bool started = !scanning;
+    scanning = true;
+    xSemaphoreGive(cache_mutex);
+    return started;
+}
+
+void wifi_scan_cache_abort(void)
+{
+    if (cache_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    scanning = false;
+    xSemaphoreGive(cache_mutex);
+}
+
+static cache_slot_t *find_slot(const uint8_t *bssid)
+{
+    cache_slot_t *oldest = NULL;
+    for (int i = 0; i < WIFI_SCAN_CACHE_SIZE; i++) {
+        if (!cache[i].used) {
+            if (oldest == NULL || oldest->used) {
+                oldest = &cache[i];
+            }
+            continue;
+        }
+        if (memcmp(cache[i].entry.bssid, bssid, sizeof(cache[i].entry.bssid)) == 0) {
+            return &cache[i];
+        }
+        if (oldest == NULL || (oldest->used && cache[i].last_seen_us < oldest->last_seen_us)) {
+            oldest = &cache[i];
+        }
+    }
+    return oldest;
+}
+
+void wifi_scan_cache_complete(const wifi_scan_entry_t *entries, size_t count)
+{
+    if (cache_mutex == NULL) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < count; i++) {
+        cache_slot_t *slot = find_slot(entries[i].bssid);
+        slot->entry = entries[i];
+        slot->entry.ssid[sizeof(slot->entry.ssid) - 1] = '\0';
+        slot->entry.age_ms = 0;
+        slot->last_seen_us = now;
+        slot->used = true;
+    }
+    last_scan_us = now;
+    scanning = false;
+    wifi_scan_done_cb_t cb = done_cb;
+    void *cb_arg = done_cb_arg;
+    xSemaphoreGive(cache_mutex);
+
+    ESP_LOGD(TAG, "Scan complete: %zu access points", count);
+
+    // Notify outside the lock so the callback may read the cache
+    if (cb != NULL) {
+        cb(cb_arg);
+    }
+}
+
+size_t wifi_manager_get_scan_results(wifi_scan_entry_t *entries, size_t max_entries, wifi_scan_info_t *info)
+{
+    if (cache_mutex == NULL) {
+        if (info != NULL) {
+            info->count = 0;
+            info->age_ms = UINT32_MAX;
+            info->scanning = false;
+        }
+        return 0;
+    }
+
+    int64_t now = esp_timer_get_time();
+    size_t copied = 0;
+    size_t cached = 0;
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < WIFI_SCAN_CACHE_SIZE; i++) {
+        if (!cache[i].used) {
+            continue;
+        }
+        int64_t age_ms = (now - cache[i].last_seen_us) / 1000;
+        if (age_ms > WIFI_SCAN_CACHE_MAX_AGE_MS) {
+            cache[i].used = false;
+            continue;
+        }
+        cached++;
+        if (entries == NULL || max_entries == 0) {
+            continue;
+        }
+        if (copied == max_entries && entries[copied - 1].rssi >= cache[i].entry.rssi) {
+            continue; // Weaker than everything kept so far
+        }
+
+        // Insertion sort by RSSI, strongest first; a full list drops its weakest
+        wifi_scan_entry_t entry = cache[i].entry;
+        entry.age_ms = (uint32_t)age_ms;
+        size_t pos = (copied < max_entries) ? copied++ : copied - 1;
+        while (pos > 0 && entries[pos - 1].rssi < entry.rssi) {
+            entries[pos] = entries[pos - 1];
+            pos--;
+        }
+        entries[pos] = entry;
+    }
+    if (info != NULL) {
+        info->count = cached;
+        info->age_ms = (last_scan_us < 0) ? UINT32_MAX : (uint32_t)((now - last_scan_us) / 1000);
+        info->scanning = scanning;
+    }
+    xSemaphoreGive(cache_mutex);
+
+    return copied;
+}
+
+esp_err_t wifi_manager_register_scan_callback(wifi_scan_done_cb_t cb, void *arg)
+{
+    esp_err_t ret = wifi_scan_cache_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    done_cb = cb;
+    done_cb_arg = arg;
+    xSemaphoreGive(cache_mutex);
+    return ESP_OK;
+}
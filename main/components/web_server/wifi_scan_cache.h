@@ -0,0 +1,57 @@
+/**
+ * @file wifi_scan_cache.h
+ * @brief Scan result cache shared by the hardware and emulator WiFi managers
+ *
+ * Private to the web_server component. The public read API
+ * (wifi_manager_get_scan_results(), wifi_manager_register_scan_callback())
+ * is implemented on top of this cache; the platform specific
+ * wifi_manager_scan_start() feeds it.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "wifi_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum age before an unseen access point is dropped (5 minutes)
+ */
+#define WIFI_SCAN_CACHE_MAX_AGE_MS (5 * 60 * 1000)
+
+/**
+ * @brief Create the cache lock (idempotent)
+ */
+esp_err_t wifi_scan_cache_init(void);
+
+/**
+ * @brief Mark a scan as started
+ *
+ * @return false if a scan is already running (the caller must not start another)
+ */
+bool wifi_scan_cache_begin(void);
+
+/**
+ * @brief Mark a scan started with wifi_scan_cache_begin() as failed
+ */
+void wifi_scan_cache_abort(void);
+
+/**
+ * @brief Merge the results of a completed scan and notify the callback
+ *
+ * Entries are keyed by BSSID. When the cache is full, the least recently
+ * seen access point is replaced.
+ *
+ * @param entries Results of the scan (age_ms is ignored)
+ * @param count Number of entries
+ */
+void wifi_scan_cache_complete(const wifi_scan_entry_t *entries, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
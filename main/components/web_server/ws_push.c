@@ -0,0 +1,505 @@
+/**
+ * @file ws_push.c
+ * @brief WebSocket push channel for live dashboard updates
+ *
+ * See ws_push.h for the protocol. Client and topic state is protected by a
+ * mutex; the actual sends only ever run on the httpd task.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#include "ws_push.h"
+#include "json_reader.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "ws_push";
+
+#define WS_PUSH_MAX_REQUEST 128     ///< Maximum client -> server frame size
+
+static const char *const topic_names[WS_TOPIC_COUNT] = {
+    [WS_TOPIC_STATUS] = "status",
+    [WS_TOPIC_HEALTH] = "health",
+    [WS_TOPIC_MEASUREMENT] = "measurement",
+    [WS_TOPIC_SCAN] = "scan",
+};
+
+/**
+ * @brief Connected WebSocket client
+ */
+typedef struct {
+    int fd;                 ///< Socket descriptor, -1 if slot is free
+    uint32_t topics;        ///< Subscribed topics (bit per ws_topic_t)
+    uint32_t pending;       ///< Topics with an unsent newer message
+    uint8_t stalls;         ///< Consecutive failed or blocked sends
+} ws_client_t;
+
+/**
+ * @brief Latest message of a topic
+ */
+typedef struct {
+    char message[WS_PUSH_MAX_MESSAGE];
+    size_t len;             ///< 0 if nothing was published yet
+} ws_topic_state_t;
+
+static httpd_handle_t s_server = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static ws_client_t s_clients[WS_PUSH_MAX_CLIENTS];
+static ws_topic_state_t s_topics[WS_TOPIC_COUNT];
+static bool s_work_queued = false;
+
+// Only used on the httpd task, so a single static buffer is enough
+static char s_send_buf[WS_PUSH_MAX_MESSAGE];
+
+// ============================================================================
+// Client Table (call with s_mutex held)
+// ============================================================================
+
+static ws_client_t *find_client(int fd)
+{
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        if (s_clients[i].fd == fd)
+        {
+            return &s_clients[i];
+        }
+    }
+    return NULL;
+}
+
+static void remove_client(ws_client_t *client)
+{
+    ESP_LOGI(TAG, "WebSocket client %d removed", client->fd);
+    client->fd = -1;
+    client->topics = 0;
+    client->pending = 0;
+    client->stalls = 0;
+}
+
+static bool any_pending(void)
+{
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        if (s_clients[i].fd >= 0 && s_clients[i].pending != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// Sending (httpd task)
+// ============================================================================
+
+/**
+ * @brief Check without blocking whether the socket can take more data
+ */
+static bool socket_writable(int fd)
+{
+    fd_set write_fds;
+    FD_ZERO(&write_fds);
+    FD_SET(fd, &write_fds);
+    struct timeval timeout = {0};
+    return select(fd + 1, NULL, &write_fds, NULL, &timeout) > 0;
+}
+
+/**
+ * @brief Send all pending messages, coalesced per topic
+ */
+static void send_pending_work(void *arg)
+{
+    (void)arg;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_work_queued = false;
+    xSemaphoreGive(s_mutex);
+
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        for (int topic = 0; topic < WS_TOPIC_COUNT; topic++)
+        {
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            ws_client_t *client = &s_clients[i];
+            int fd = client->fd;
+            if (fd < 0 || !(client->pending & (1U << topic)))
+            {
+                xSemaphoreGive(s_mutex);
+                continue;
+            }
+
+            if (httpd_ws_get_fd_info(s_server, fd) != HTTPD_WS_CLIENT_WEBSOCKET)
+            {
+                // Session was closed by the client or purged by the server
+                remove_client(client);
+                xSemaphoreGive(s_mutex);
+                break;
+            }
+
+            if (!socket_writable(fd))
+            {
+                // Leave the topic pending; a newer message simply replaces it
+                if (++client->stalls >= WS_PUSH_MAX_STALLS)
+                {
+                    ESP_LOGW(TAG, "WebSocket client %d not keeping up, closing", fd);
+                    remove_client(client);
+                    xSemaphoreGive(s_mutex);
+                    httpd_sess_trigger_close(s_server, fd);
+                }
+                else
+                {
+                    xSemaphoreGive(s_mutex);
+                }
+                break;
+            }
+
+            size_t len = s_topics[topic].len;
+            memcpy(s_send_buf, s_topics[topic].message, len);
+            client->pending &= ~(1U << topic);
+            xSemaphoreGive(s_mutex);
+
+            httpd_ws_frame_t frame = {
+                .final = true,
+                .type = HTTPD_WS_TYPE_TEXT,
+                .payload = (uint8_t *)s_send_buf,
+                .len = len,
+            };
+            esp_err_t ret = httpd_ws_send_frame_async(s_server, fd, &frame);
+
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            if (client->fd == fd)
+            {
+                if (ret == ESP_OK)
+                {
+                    client->stalls = 0;
+                }
+                else if (++client->stalls >= WS_PUSH_MAX_STALLS)
+                {
+                    ESP_LOGW(TAG, "WebSocket send to %d failed: %s", fd, esp_err_to_name(ret));
+                    remove_client(client);
+                }
+                else
+                {
+                    client->pending |= (1U << topic);
+                }
+            }
+            xSemaphoreGive(s_mutex);
+        }
+    }
+}
+
+/**
+ * @brief Queue the send work on the httpd task unless already queued
+ *
+ * Call with s_mutex held; returns true if the caller must queue the work.
+ */
+static bool claim_work(void)
+{
+    if (s_work_queued || !any_pending())
+    {
+        return false;
+    }
+    s_work_queued = true;
+    return true;
+}
+
+static void queue_work(void)
+{
+    if (httpd_queue_work(s_server, send_pending_work, NULL) != ESP_OK)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_work_queued = false;
+        xSemaphoreGive(s_mutex);
+        ESP_LOGW(TAG, "Failed to queue WebSocket push work");
+    }
+}
+
+// ============================================================================
+// Request Handling
+// ============================================================================
+
+static esp_err_t subscribe_cb(void *ctx, const char *path, json_reader_type_t type,
+                              const char *value, size_t len)
+{
+    uint32_t *topics = (uint32_t *)ctx;
+    if (type != JSON_READER_STRING || strcmp(path, "subscribe") != 0)
+    {
+        return ESP_OK;
+    }
+    for (int topic = 0; topic < WS_TOPIC_COUNT; topic++)
+    {
+        if (strcmp(value, topic_names[topic]) == 0)
+        {
+            *topics |= (1U << topic);
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t handle_handshake(httpd_req_t *req)
+{
+    int fd = httpd_req_to_sockfd(req);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ws_client_t *client = find_client(fd);
+    if (client == NULL)
+    {
+        client = find_client(-1);
+    }
+    if (client != NULL)
+    {
+        client->fd = fd;
+        client->topics = 0;
+        client->pending = 0;
+        client->stalls = 0;
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (client == NULL)
+    {
+        ESP_LOGW(TAG, "Too many WebSocket clients, rejecting %d", fd);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "WebSocket client %d connected", fd);
+    return ESP_OK;
+}
+
+esp_err_t ws_push_handler(httpd_req_t *req)
+{
+    if (s_mutex == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (req->method == HTTP_GET)
+    {
+        return handle_handshake(req);
+    }
+
+    uint8_t payload[WS_PUSH_MAX_REQUEST];
+    httpd_ws_frame_t frame = {
+        .payload = payload,
+    };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+    if (frame.len > sizeof(payload))
+    {
+        ESP_LOGW(TAG, "WebSocket frame too large (%zu bytes)", frame.len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    ret = httpd_ws_recv_frame(req, &frame, sizeof(payload));
+    if (ret != ESP_OK || frame.type != HTTPD_WS_TYPE_TEXT)
+    {
+        return ret;
+    }
+
+    uint32_t topics = 0;
+    json_reader_t reader;
+    json_reader_init(&reader, subscribe_cb, &topics);
+    json_reader_feed(&reader, (const char *)frame.payload, frame.len);
+    if (json_reader_finish(&reader) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Ignoring malformed WebSocket request");
+        return ESP_OK;
+    }
+
+    int fd = httpd_req_to_sockfd(req);
+    bool need_work = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ws_client_t *client = find_client(fd);
+    if (client != NULL)
+    {
+        client->topics = topics;
+        // Send the current state of every newly subscribed topic right away
+        client->pending = 0;
+        for (int topic = 0; topic < WS_TOPIC_COUNT; topic++)
+        {
+            if ((topics & (1U << topic)) && s_topics[topic].len > 0)
+            {
+                client->pending |= (1U << topic);
+            }
+        }
+        need_work = claim_work();
+    }
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGD(TAG, "WebSocket client %d subscribed to 0x%02lx", fd, (unsigned long)topics);
+    if (need_work)
+    {
+        queue_work();
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t ws_push_init(httpd_handle_t server)
+{
+    if (s_mutex == NULL)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_server = server;
+    s_work_queued = false;
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        s_clients[i].fd = -1;
+        s_clients[i].topics = 0;
+        s_clients[i].pending = 0;
+        s_clients[i].stalls = 0;
+    }
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "WebSocket push channel initialized (max %d clients)", WS_PUSH_MAX_CLIENTS);
+    return ESP_OK;
+}
+
+void ws_push_deinit(void)
+{
+    if (s_mutex == NULL)
+    {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        s_clients[i].fd = -1;
+        s_clients[i].topics = 0;
+        s_clients[i].pending = 0;
+    }
+    s_server = NULL;
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t ws_push_publish(ws_topic_t topic, const char *json, size_t len)
+{
+    if (s_mutex == NULL || topic >= WS_TOPIC_COUNT)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char prefix[32];
+    int prefix_len = snprintf(prefix, sizeof(prefix), "{\"type\":\"%s\",\"data\":", topic_names[topic]);
+    size_t message_len = prefix_len + len + 1;
+    if (message_len > WS_PUSH_MAX_MESSAGE)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    bool need_work = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ws_topic_state_t *state = &s_topics[topic];
+
+    // Change detection: identical documents are not pushed again
+    bool changed = state->len != message_len ||
+                   memcmp(state->message + prefix_len, json, len) != 0;
+    if (changed && s_server != NULL)
+    {
+        memcpy(state->message, prefix, prefix_len);
+        memcpy(state->message + prefix_len, json, len);
+        state->message[message_len - 1] = '}';
+        state->len = message_len;
+
+        for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+        {
+            if (s_clients[i].fd >= 0 && (s_clients[i].topics & (1U << topic)))
+            {
+                s_clients[i].pending |= (1U << topic);
+            }
+        }
+        need_work = claim_work();
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (need_work)
+    {
+        queue_work();
+    }
+    return ESP_OK;
+}
+
+void ws_push_client_closed(int fd)
+{
+    if (s_mutex == NULL || fd < 0)
+    {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ws_client_t *client = find_client(fd);
+    if (client != NULL)
+    {
+        remove_client(client);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void ws_push_kick(void)
+{
+    if (s_mutex == NULL)
+    {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool need_work = s_server != NULL && claim_work();
+    xSemaphoreGive(s_mutex);
+
+    if (need_work)
+    {
+        queue_work();
+    }
+}
+
+size_t ws_push_client_count(void)
+{
+    size_t count = 0;
+    if (s_mutex == NULL)
+    {
+        return 0;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        if (s_clients[i].fd >= 0)
+        {
+            count++;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return count;
+}
+
+uint32_t ws_push_subscribed_topics(void)
+{
+    uint32_t topics = 0;
+    if (s_mutex == NULL)
+    {
+        return 0;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        if (s_clients[i].fd >= 0)
+        {
+            topics |= s_clients[i].topics;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return topics;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file ws_push.h
+ * @brief WebSocket push channel for live dashboard updates
+ *
+ * Clients connect to /ws and subscribe to topics with a text frame:
+ *
+ *     {"subscribe":["status","health","measurement","scan"]}
+ *
+ * Producers publish the current JSON document of a topic with
+ * ws_push_publish(). A message is only pushed when the document differs from
+ * the previously published one, and only to clients subscribed to the topic:
+ *
+ *     {"type":"status","data":{...}}
+ *
+ * Every client has a pending-topic mask instead of an unbounded send queue.
+ * If a client cannot keep up, newer documents replace older pending ones, so
+ * it always receives the latest state. A client whose socket stays unwritable
+ * for WS_PUSH_MAX_STALLS attempts is disconnected.
+ *
+ * All WebSocket sends run on the httpd task via httpd_queue_work(), so
+ * producers never block on the network.
+ *
+ * @author ESP32 Distance Project
+ * @date 2025
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WS_PUSH_MAX_CLIENTS 4       ///< Concurrent WebSocket clients
+#define WS_PUSH_MAX_MESSAGE 768     ///< Maximum message size per topic
+#define WS_PUSH_MAX_STALLS 5        ///< Failed/blocked sends before a client is dropped
+
+/**
+ * @brief Push topics
+ */
+typedef enum {
+    WS_TOPIC_STATUS = 0,            ///< WiFi status (same document as GET /status)
+    WS_TOPIC_HEALTH,                ///< System health summary
+    WS_TOPIC_MEASUREMENT,           ///< Latest sensor measurement
+    WS_TOPIC_SCAN,                  ///< WiFi scan results
+    WS_TOPIC_COUNT
+} ws_topic_t;
+
+/**
+ * @brief Initialize the push channel for a running HTTP server
+ *
+ * @param server HTTP server handle the /ws handler is registered on
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the mutex cannot be created
+ */
+esp_err_t ws_push_init(httpd_handle_t server);
+
+/**
+ * @brief Drop all clients and release the server handle
+ */
+void ws_push_deinit(void);
+
+/**
+ * @brief URI handler for /ws (register with is_websocket = true)
+ */
+esp_err_t ws_push_handler(httpd_req_t *req);
+
+/**
+ * @brief Publish the current document of a topic
+ *
+ * Safe to call from any task. Nothing is sent if the document equals the
+ * last published one or no client subscribed to the topic.
+ *
+ * @param topic Topic
+ * @param json JSON document (the "data" member of the pushed message)
+ * @param len Length of json in bytes
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the message is too large,
+ *         ESP_ERR_INVALID_STATE if the channel is not initialized
+ */
+esp_err_t ws_push_publish(ws_topic_t topic, const char *json, size_t len);
+
+/**
+ * @brief Forget a client whose session is being closed
+ *
+ * Call from the httpd close callback for every closed socket.
+ *
+ * @param fd Socket descriptor of the closed session
+ */
+void ws_push_client_closed(int fd);
+
+/**
+ * @brief Retry pending sends to clients that were not writable
+ */
+void ws_push_kick(void);
+
+/**
+ * @brief Get the number of connected WebSocket clients
+ */
+size_t ws_push_client_count(void);
+
+/**
+ * @brief Get the bit mask of topics at least one client subscribed to
+ */
+uint32_t ws_push_subscribed_topics(void);
+
+#ifdef __cplusplus
+}
+#endif
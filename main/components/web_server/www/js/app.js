@@ -6,6 +6,9 @@
 // Global configuration
 const CONFIG = {
     refreshInterval: 1000,  // 1 second - faster updates for testing
+    liveRetryMax: 30000,  // Max delay between WebSocket reconnect attempts
+    historyInterval: 15000,  // 15 seconds - history chart refresh
+    historyWindow: 300,  // Seconds of 1 s history shown in the chart
     notificationDuration: 3000,  // 3 seconds
     apiTimeout: 10000  // 10 seconds
 };
@@ -110,14 +113,53 @@ async function apiCall(endpoint, options = {}) {
 }
 
 // Dashboard-specific functions
-async function refreshData() {
-    // Show loading state
+function updateDistanceDisplay(data) {
     const distanceValue = document.getElementById('distance-value');
     const distanceStatus = document.getElementById('distance-status');
     const lastUpdate = document.getElementById('last-update');
-    
-    // Skip loading state for smoother updates
-    
+
+    if (distanceValue) {
+        if (data.status === 'ok') {
+            distanceValue.textContent = `${data.distance_cm.toFixed(1)} cm`;
+            distanceStatus.textContent = 'Active';
+            distanceValue.className = 'distance-value success';
+            distanceStatus.className = 'distance-status success';
+        } else {
+            // Handle error states
+            let errorMessage;
+            switch (data.status) {
+                case 'timeout':
+                    errorMessage = 'Sensor Timeout';
+                    break;
+                case 'out_of_range':
+                    errorMessage = 'Out of Range';
+                    break;
+                case 'no_echo':
+                    errorMessage = 'No Echo';
+                    break;
+                case 'invalid':
+                    errorMessage = 'Invalid Reading';
+                    break;
+                default:
+                    errorMessage = 'Sensor Error';
+            }
+
+            distanceValue.textContent = '-- cm';
+            distanceStatus.textContent = errorMessage;
+            distanceValue.className = 'distance-value error';
+            distanceStatus.className = 'distance-status error';
+        }
+    }
+
+    if (lastUpdate) {
+        lastUpdate.textContent = formatTimestamp(Date.now());
+    }
+}
+
+async function refreshData() {
+    const distanceValue = document.getElementById('distance-value');
+    const distanceStatus = document.getElementById('distance-status');
+
     try {
         // Fetch real distance data from API
         const response = await fetch('/api/distance', {
@@ -127,73 +169,109 @@ async function refreshData() {
             },
             timeout: CONFIG.apiTimeout
         });
-        
+
         if (!response.ok) {
             throw new Error(`HTTP error! status: ${response.status}`);
         }
-        
-        const data = await response.json();
-        
-        // Update display with real data
-        if (distanceValue) {
-            if (data.status === 'ok') {
-                distanceValue.textContent = `${data.distance_cm.toFixed(1)} cm`;
-                distanceStatus.textContent = 'Active';
-                distanceValue.className = 'distance-value success';
-                distanceStatus.className = 'distance-status success';
-            } else {
-                // Handle error states
-                let errorMessage;
-                switch (data.status) {
-                    case 'timeout':
-                        errorMessage = 'Sensor Timeout';
-                        break;
-                    case 'out_of_range':
-                        errorMessage = 'Out of Range';
-                        break;
-                    case 'no_echo':
-                        errorMessage = 'No Echo';
-                        break;
-                    case 'invalid':
-                        errorMessage = 'Invalid Reading';
-                        break;
-                    default:
-                        errorMessage = 'Sensor Error';
-                }
-                
-                distanceValue.textContent = '-- cm';
-                distanceStatus.textContent = errorMessage;
-                distanceValue.className = 'distance-value error';
-                distanceStatus.className = 'distance-status error';
-            }
-        }
-        
-        if (lastUpdate) {
-            lastUpdate.textContent = formatTimestamp(Date.now());
-        }
-        
-        // Remove the annoying success notification - only show errors
-        
+
+        updateDistanceDisplay(await response.json());
+
     } catch (error) {
         console.error('Failed to fetch distance data:', error);
-        
+
         if (distanceValue) {
             distanceValue.textContent = '-- cm';
             distanceStatus.textContent = 'Connection Error';
             distanceValue.className = 'distance-value error';
             distanceStatus.className = 'distance-status error';
         }
-        
+
         // Only show notification for errors
         showNotification('Failed to refresh data: ' + error.message, 'error');
     }
 }
 
+// Live updates over WebSocket (/ws); polling is only used as fallback
+let liveSocket = null;
+let liveRetryTimer = null;
+let liveFailures = 0;
+
+function isDashboard() {
+    return window.location.pathname.includes('index.html') || window.location.pathname === '/';
+}
+
+function handleLiveMessage(message) {
+    switch (message.type) {
+        case 'measurement':
+            // Pushes are arriving, polling is no longer needed
+            stopAutoRefresh();
+            updateDistanceDisplay(message.data);
+            break;
+    }
+}
+
+function startLiveUpdates() {
+    if (!isDashboard() || liveSocket) {
+        return;
+    }
+    if (!('WebSocket' in window)) {
+        startAutoRefresh();
+        return;
+    }
+
+    const protocol = window.location.protocol === 'https:' ? 'wss:' : 'ws:';
+    const socket = new WebSocket(`${protocol}//${window.location.host}/ws`);
+    liveSocket = socket;
+
+    socket.onopen = function() {
+        liveFailures = 0;
+        // Keep polling until the first push: the server only publishes the
+        // topic once it has measurements
+        startAutoRefresh();
+        socket.send(JSON.stringify({ subscribe: ['measurement'] }));
+    };
+
+    socket.onmessage = function(event) {
+        try {
+            handleLiveMessage(JSON.parse(event.data));
+        } catch (error) {
+            console.error('Invalid live update:', error);
+        }
+    };
+
+    socket.onclose = function() {
+        if (liveSocket !== socket) {
+            return;
+        }
+        liveSocket = null;
+        liveFailures++;
+
+        // Keep the dashboard updating by polling while reconnecting
+        startAutoRefresh();
+        if (!document.hidden) {
+            const delay = Math.min(CONFIG.liveRetryMax, 2000 * liveFailures);
+            liveRetryTimer = setTimeout(startLiveUpdates, delay);
+        }
+    };
+}
+
+function stopLiveUpdates() {
+    if (liveRetryTimer) {
+        clearTimeout(liveRetryTimer);
+        liveRetryTimer = null;
+    }
+    if (liveSocket) {
+        const socket = liveSocket;
+        liveSocket = null;
+        socket.close();
+    }
+}
+
 // Auto-refresh functionality for dashboard
 let autoRefreshInterval = null;
 
 function startAutoRefresh() {
-    if (window.location.pathname.includes('index.html') || window.location.pathname === '/') {
+    if (isDashboard() && !autoRefreshInterval) {
         autoRefreshInterval = setInterval(refreshData, CONFIG.refreshInterval);
     }
 }
@@ -205,6 +283,100 @@ function stopAutoRefresh() {
     }
 }
 
+// Distance history chart (binary /api/distance/history, one uint16 per point)
+let historyInterval = null;
+
+function parseHistory(buffer) {
+    const view = new DataView(buffer);
+    if (view.byteLength < 16 || view.getUint8(0) !== 0x4D || view.getUint8(1) !== 0x48) {
+        throw new Error('Invalid history response');
+    }
+    const count = view.getUint16(12, true);
+    const values = [];
+    for (let i = 0; i < count && 16 + 2 * i + 2 <= view.byteLength; i++) {
+        const value = view.getUint16(16 + 2 * i, true);
+        values.push(value === 0xFFFF ? null : value);
+    }
+    return values;
+}
+
+function drawHistory(canvas, values) {
+    const context = canvas.getContext('2d');
+    const width = canvas.width = canvas.clientWidth;
+    const height = canvas.height;
+    context.clearRect(0, 0, width, height);
+
+    const valid = values.filter(value => value !== null);
+    if (valid.length === 0) {
+        return;
+    }
+    const min = Math.min(...valid);
+    const span = Math.max(Math.max(...valid) - min, 10);
+    const step = values.length > 1 ? width / (values.length - 1) : 0;
+
+    context.strokeStyle = '#3498db';
+    context.lineWidth = 2;
+    context.beginPath();
+    let drawing = false;
+    values.forEach((value, index) => {
+        if (value === null) {
+            // Leave gaps where the sensor had no valid reading
+            drawing = false;
+            return;
+        }
+        const x = index * step;
+        const y = height - 4 - ((value - min) / span) * (height - 8);
+        if (drawing) {
+            context.lineTo(x, y);
+        } else {
+            context.moveTo(x, y);
+            drawing = true;
+        }
+    });
+    context.stroke();
+}
+
+async function loadHistory() {
+    const canvas = document.getElementById('history-chart');
+    const summary = document.getElementById('history-summary');
+    if (!canvas) {
+        return;
+    }
+
+    try {
+        const response = await fetch(`/api/distance/history?tier=1s&window=${CONFIG.historyWindow}&format=binary`);
+        if (!response.ok) {
+            throw new Error(`HTTP error! status: ${response.status}`);
+        }
+        const values = parseHistory(await response.arrayBuffer());
+        drawHistory(canvas, values);
+
+        const valid = values.filter(value => value !== null);
+        if (summary) {
+            summary.textContent = valid.length > 0
+                ? `${(Math.min(...valid) / 10).toFixed(1)} - ${(Math.max(...valid) / 10).toFixed(1)} cm`
+                : 'No data';
+        }
+    } catch (error) {
+        // The chart is secondary; keep the last one instead of notifying
+        console.error('Failed to fetch distance history:', error);
+    }
+}
+
+function startHistoryRefresh() {
+    if (isDashboard() && !historyInterval) {
+        loadHistory();
+        historyInterval = setInterval(loadHistory, CONFIG.historyInterval);
+    }
+}
+
+function stopHistoryRefresh() {
+    if (historyInterval) {
+        clearInterval(historyInterval);
+        historyInterval = null;
+    }
+}
+
 // Page-specific initialization
 function initializePage() {
     updateActiveNav();
@@ -217,7 +389,8 @@ function initializePage() {
             // Dashboard initialization
             if (typeof refreshData === 'function') {
                 refreshData();
-                startAutoRefresh();
+                startLiveUpdates();
+                startHistoryRefresh();
             }
             break;
             
@@ -247,19 +420,26 @@ window.addEventListener('unhandledrejection', function(event) {
 window.addEventListener('online', function() {
     // Connection restored silently - no popup needed
     console.log('Connection restored');
+    startLiveUpdates();
+    startHistoryRefresh();
 });
 
 window.addEventListener('offline', function() {
     showNotification('Connection lost', 'error');
+    stopLiveUpdates();
     stopAutoRefresh();
+    stopHistoryRefresh();
 });
 
 // Page visibility API for auto-refresh management
 document.addEventListener('visibilitychange', function() {
     if (document.hidden) {
+        stopLiveUpdates();
         stopAutoRefresh();
+        stopHistoryRefresh();
     } else {
-        startAutoRefresh();
+        startLiveUpdates();
+        startHistoryRefresh();
     }
 });
 
@@ -357,6 +537,7 @@ document.addEventListener('DOMContentLoaded', initializePage);
 
 // Cleanup on page unload
 window.addEventListener('beforeunload', function() {
+    stopLiveUpdates();
     stopAutoRefresh();
     
     if ('PerformanceObserver' in window) {
@@ -1,12 +1,16 @@
 /**
  * @file main.c
  * @brief ESP32 Template - Minimal Application Entry Point
- * 
+ *
  * This is a minimal template for ESP32 applications. It demonstrates:
  * - Basic initialization and logging
  * - NVS flash initialization
+ * - Dependency-ordered, concurrent component initialization (boot_manager)
+ * - Optional DFS/light sleep power management (power_manager)
+ * - Distance measurement pipeline, fed by a mock source in emulator builds (measurement)
+ * - Optional on-device micro-benchmarks (benchmark, CONFIG_BENCHMARK_ENABLE)
  * - Main application loop structure
- * 
+ *
  * Add your application components and logic here.
  */
 
@@ -17,36 +21,125 @@
 #include "esp_system.h"
 #include "esp_timer.h"
 #include "nvs_flash.h"
+#include "boot_manager.h"
+#include "config_manager.h"
+#include "wifi_manager.h"
+#include "power_manager.h"
+#include "measurement.h"
+#ifdef CONFIG_WEB_SERVER_HTTPS
+#include "cert_handler.h"
+#endif
+#ifdef CONFIG_BENCHMARK_ENABLE
+#include "benchmark.h"
+#endif
 
 static const char *TAG = "main";
 
 /**
- * @brief Main application entry point
- * 
- * This is where your ESP32 application starts. Initialize your components
- * and start your application logic here.
+ * @brief Initialize NVS (Non-Volatile Storage)
+ *
+ * Required by the configuration manager and WiFi. Components call
+ * nvs_flash_init() again when used standalone; once the partition is
+ * mounted here those calls return immediately.
  */
-void app_main(void)
+static esp_err_t init_nvs(void)
 {
-    ESP_LOGI(TAG, "ESP32 Template Starting...");
-    ESP_LOGI(TAG, "ESP-IDF Version: %s", esp_get_idf_version());
-    
-    // Initialize NVS (Non-Volatile Storage)
-    // This is required for WiFi, Bluetooth, and other system components
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_LOGW(TAG, "NVS partition was truncated and needs to be erased");
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
-    ESP_ERROR_CHECK(ret);
-    ESP_LOGI(TAG, "NVS Flash initialized successfully");
-    
-    // TODO: Initialize your components here
-    // Example: config_manager_init();
-    // Example: wifi_manager_init();
-    // Example: web_server_start();
-    
+    return ret;
+}
+
+#ifdef CONFIG_BENCHMARK_ENABLE
+/**
+ * @brief Run the micro-benchmarks without failing the boot
+ *
+ * WiFi waits for this stage, so a failing benchmark must not skip it.
+ */
+static esp_err_t run_benchmarks(void)
+{
+    esp_err_t ret = benchmark_run();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Benchmark run incomplete: %s", esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+#endif
+
+// Boot stages, in table order. Dependencies may only point to earlier entries.
+enum {
+    STAGE_NVS,
+    STAGE_POWER,
+    STAGE_CONFIG,
+#ifdef CONFIG_WEB_SERVER_HTTPS
+    STAGE_CERTS,
+#endif
+#ifdef CONFIG_BENCHMARK_ENABLE
+    STAGE_BENCHMARK,
+#endif
+    STAGE_MEASUREMENT,
+    STAGE_WIFI_INIT,
+    STAGE_WIFI_START,
+};
+
+#ifdef CONFIG_WEB_SERVER_HTTPS
+#define CERTS_DONE BOOT_STAGE_BIT(STAGE_CERTS)
+#else
+#define CERTS_DONE 0
+#endif
+
+#ifdef CONFIG_BENCHMARK_ENABLE
+// Benchmarks run alone: after every other early stage and before the radio starts
+#define BENCHMARK_DONE BOOT_STAGE_BIT(STAGE_BENCHMARK)
+#else
+#define BENCHMARK_DONE 0
+#endif
+
+static const boot_stage_t boot_stages[] = {
+    [STAGE_NVS]        = { .name = "nvs",        .init = init_nvs },
+    [STAGE_POWER]      = { .name = "power",      .init = power_manager_init },
+    [STAGE_CONFIG]     = { .name = "config",     .init = config_init,
+                           .depends_on = BOOT_STAGE_BIT(STAGE_NVS) },
+#ifdef CONFIG_WEB_SERVER_HTTPS
+    // Only touches embedded data, so parsing overlaps with WiFi bring-up
+    [STAGE_CERTS]      = { .name = "certs",      .init = cert_handler_init },
+#endif
+#ifdef CONFIG_BENCHMARK_ENABLE
+    [STAGE_BENCHMARK]  = { .name = "benchmark",  .init = run_benchmarks, .stack_size = 6144,
+                           .depends_on = BOOT_STAGE_BIT(STAGE_NVS) | BOOT_STAGE_BIT(STAGE_POWER) |
+                                         BOOT_STAGE_BIT(STAGE_CONFIG) | CERTS_DONE },
+#endif
+    // Sampling starts after the benchmarks so the sampler does not skew them
+    [STAGE_MEASUREMENT] = { .name = "measurement", .init = measurement_init,
+                           .depends_on = BOOT_STAGE_BIT(STAGE_CONFIG) | BENCHMARK_DONE },
+    [STAGE_WIFI_INIT]  = { .name = "wifi_init",  .init = wifi_manager_init,
+                           .depends_on = BOOT_STAGE_BIT(STAGE_NVS) | BENCHMARK_DONE },
+    // Association and the web server start continue in the event task;
+    // power management is configured before the first request can arrive
+    [STAGE_WIFI_START] = { .name = "wifi_start", .init = wifi_manager_start,
+                           .depends_on = BOOT_STAGE_BIT(STAGE_WIFI_INIT) | BOOT_STAGE_BIT(STAGE_CONFIG) |
+                                         BOOT_STAGE_BIT(STAGE_POWER) },
+};
+
+/**
+ * @brief Main application entry point
+ *
+ * This is where your ESP32 application starts. Add your components to the
+ * boot stage table above and start your application logic here.
+ */
+void app_main(void)
+{
+    ESP_LOGI(TAG, "ESP32 Template Starting...");
+    ESP_LOGI(TAG, "ESP-IDF Version: %s", esp_get_idf_version());
+
+    esp_err_t ret = boot_manager_run(boot_stages, sizeof(boot_stages) / sizeof(boot_stages[0]));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Boot incomplete: %s", esp_err_to_name(ret));
+    }
+
     ESP_LOGI(TAG, "Template initialized successfully");
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "==============================================");
@@ -54,7 +147,7 @@ void app_main(void)
     ESP_LOGI(TAG, "  Add your application code in main/main.c");
     ESP_LOGI(TAG, "==============================================");
     ESP_LOGI(TAG, "");
-    
+
     // Main application loop
     // Replace this with your application logic
     while (1) {
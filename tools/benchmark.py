@@ -0,0 +1,577 @@
+#!/usr/bin/env python3
+"""
+Benchmark runner and regression check for the ESP32 web server
+
+Commands:
+    device    Collect the on-device micro-benchmark results (the BENCH lines
+              logged by a CONFIG_BENCHMARK_ENABLE build) from the QEMU console
+              or from a saved serial log
+    load      Drive concurrent HTTP clients against a device and report
+              requests/sec, p50/p99 latency, errors and the heap minimum
+    stream    Subscribe to the WebSocket "measurement" topic and report how
+              many pipeline samples reach the dashboard path, samples lost
+              on the way and the age of the pushed samples
+    check     Compare results against a stored baseline and fail on
+              regressions
+    baseline  Store results as the new baseline
+
+Typical QEMU session (tools/run-qemu-network.sh with the TUN bridge running;
+requests reach the emulated device through the UART tunnel):
+
+    python tools/benchmark.py device --console localhost:5555 --save device.json
+    python tools/benchmark.py load --host 192.168.100.2 --save load.json
+    python tools/benchmark.py stream --host 192.168.100.2 --save stream.json
+    python tools/benchmark.py check device.json load.json stream.json --baseline tools/benchmarks/qemu.json
+
+Record a baseline once from a known-good build with the baseline command and
+commit it; QEMU and real hardware need separate baselines. Only the Python
+standard library is needed.
+"""
+
+import argparse
+import base64
+import http.client
+import json
+import os
+import re
+import socket
+import ssl
+import statistics
+import sys
+import threading
+import time
+
+# I (1234) benchmark: BENCH json_status n=200 mean_us=41.250 ... bytes=187
+BENCH_LINE = re.compile(r'BENCH (\S+) (.*)$')
+BENCH_FIELD = re.compile(r'(\w+)=(\S+)')
+
+DEFAULT_PATHS = ['/status', '/api/config', '/api/system/health', '/index.html']
+
+# Metric name -> True when larger values are better
+METRIC_DIRECTION = {
+    'mean_us': False,
+    'p50_us': False,
+    'p99_us': False,
+    'rps': True,
+    'p50_ms': False,
+    'p99_ms': False,
+    'min_free_bytes': True,
+    'push_rate': True,
+    'samples_per_s': True,
+    'p99_age_ms': False,
+}
+
+
+def percentile(samples, fraction):
+    """Nearest-rank percentile of a list of numbers"""
+    if not samples:
+        return None
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, int(len(ordered) * fraction))
+    return ordered[index]
+
+
+def save_results(path, results):
+    """Write results as JSON"""
+    with open(path, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+        f.write('\n')
+    print(f"\nResults saved to {path}")
+
+
+def parse_bench_lines(lines):
+    """Collect BENCH lines into {'benchmarks': {...}, 'heap': {...}}
+
+    Returns (results, done) where done tells whether the run completed.
+    """
+    results = {'benchmarks': {}}
+    done = False
+    for line in lines:
+        match = BENCH_LINE.search(line.strip())
+        if not match:
+            continue
+        name, rest = match.groups()
+        fields = {key: float(value) for key, value in BENCH_FIELD.findall(rest)}
+        if name == 'done':
+            done = True
+        elif name == 'heap':
+            results['heap'] = fields
+        else:
+            results['benchmarks'][name] = fields
+    return results, done
+
+
+def console_lines(address, timeout):
+    """Yield log lines from the QEMU UART0 TCP console until timeout"""
+    host, _, port = address.rpartition(':')
+    deadline = time.monotonic() + timeout
+    with socket.create_connection((host or 'localhost', int(port)), timeout=timeout) as sock:
+        buffer = b''
+        while time.monotonic() < deadline:
+            sock.settimeout(max(0.1, deadline - time.monotonic()))
+            try:
+                data = sock.recv(4096)
+            except socket.timeout:
+                break
+            if not data:
+                break
+            buffer += data
+            *lines, buffer = buffer.split(b'\n')
+            for line in lines:
+                yield line.decode('utf-8', errors='replace')
+
+
+def device_benchmark(args):
+    """Collect on-device micro-benchmark results"""
+    if args.log:
+        with open(args.log, errors='replace') as f:
+            results, done = parse_bench_lines(f)
+    else:
+        print(f"Waiting for benchmark output on {args.console} (reset the device if it already booted)")
+        collected = []
+        done = False
+        try:
+            for line in console_lines(args.console, args.timeout):
+                collected.append(line)
+                if 'BENCH done' in line:
+                    done = True
+                    break
+        except OSError as e:
+            print(f"❌ Cannot read console: {e}")
+            return 1
+        results, _ = parse_bench_lines(collected)
+
+    if not results['benchmarks']:
+        print("❌ No BENCH lines found - is CONFIG_BENCHMARK_ENABLE set?")
+        return 1
+    if not done:
+        print("⚠️  Benchmark run did not complete, results are partial")
+
+    print(f"\n  {'Benchmark':24} {'mean us':>10} {'p50 us':>10} {'p99 us':>10} {'bytes':>7}")
+    for name, fields in results['benchmarks'].items():
+        print(f"  {name:24} {fields.get('mean_us', 0):10.2f} {fields.get('p50_us', 0):10.2f} "
+              f"{fields.get('p99_us', 0):10.2f} {int(fields.get('bytes', 0)):7d}")
+    if 'heap' in results:
+        print(f"\n  Heap minimum during run: {int(results['heap'].get('min_free_bytes', 0))} bytes")
+
+    if args.save:
+        save_results(args.save, {'device': results})
+    return 0
+
+
+def open_connection(args):
+    """HTTP(S) connection to the device; the self-signed certificate is accepted"""
+    if args.https:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+        context.check_hostname = False
+        context.verify_mode = ssl.CERT_NONE
+        return http.client.HTTPSConnection(args.host, args.port, timeout=args.timeout, context=context)
+    return http.client.HTTPConnection(args.host, args.port, timeout=args.timeout)
+
+
+def load_worker(args, paths, stop, samples, errors, lock):
+    """Issue requests round-robin over paths until stop is set"""
+    index = 0
+    connection = None
+    while not stop.is_set():
+        path = paths[index % len(paths)]
+        index += 1
+        start = time.perf_counter()
+        try:
+            if connection is None:
+                connection = open_connection(args)
+            connection.request('GET', path, headers={'Accept-Encoding': 'gzip'})
+            response = connection.getresponse()
+            response.read()
+            elapsed_ms = (time.perf_counter() - start) * 1000.0
+            ok = response.status < 400
+            if response.will_close:
+                connection.close()
+                connection = None
+        except (OSError, http.client.HTTPException):
+            elapsed_ms = None
+            ok = False
+            if connection is not None:
+                connection.close()
+                connection = None
+
+        with lock:
+            if ok:
+                samples[path].append(elapsed_ms)
+            else:
+                errors[path] += 1
+    if connection is not None:
+        connection.close()
+
+
+def fetch_json(args, path):
+    """GET a JSON document from the device, None on failure"""
+    try:
+        connection = open_connection(args)
+        connection.request('GET', path)
+        response = connection.getresponse()
+        body = response.read()
+        connection.close()
+        return json.loads(body) if response.status == 200 else None
+    except (OSError, http.client.HTTPException, ValueError):
+        return None
+
+
+def summarize_load(samples, errors, duration):
+    """Requests/sec and latency percentiles of one set of samples"""
+    return {
+        'requests': len(samples),
+        'errors': errors,
+        'rps': len(samples) / duration if duration > 0 else 0,
+        'p50_ms': statistics.median(samples) if samples else None,
+        'p99_ms': percentile(samples, 0.99),
+    }
+
+
+def load_benchmark(args):
+    """Run concurrent HTTP clients against a device"""
+    paths = args.paths or DEFAULT_PATHS
+    if args.port is None:
+        args.port = 443 if args.https else 80
+
+    print(f"Load test: {args.clients} clients for {args.duration}s against {args.host}:{args.port}")
+    print(f"Paths: {', '.join(paths)}\n")
+
+    samples = {path: [] for path in paths}
+    errors = {path: 0 for path in paths}
+    lock = threading.Lock()
+    stop = threading.Event()
+    workers = []
+    for i in range(args.clients):
+        # Stagger the start path so clients do not hit the same handler in lockstep
+        rotated = paths[i % len(paths):] + paths[:i % len(paths)]
+        worker = threading.Thread(target=load_worker, args=(args, rotated, stop, samples, errors, lock),
+                                  daemon=True)
+        workers.append(worker)
+
+    start = time.monotonic()
+    for worker in workers:
+        worker.start()
+    time.sleep(args.duration)
+    stop.set()
+    for worker in workers:
+        worker.join(timeout=args.timeout + 1)
+    duration = time.monotonic() - start
+
+    results = {'host': args.host, 'clients': args.clients, 'duration_s': duration, 'paths': {}}
+    all_samples = []
+    print(f"  {'Path':24} {'req/s':>8} {'p50 ms':>8} {'p99 ms':>8} {'errors':>7}")
+    for path in paths:
+        summary = summarize_load(samples[path], errors[path], duration)
+        results['paths'][path] = summary
+        all_samples.extend(samples[path])
+        print(f"  {path:24} {summary['rps']:8.1f} {summary['p50_ms'] or float('nan'):8.1f} "
+              f"{summary['p99_ms'] or float('nan'):8.1f} {summary['errors']:7d}")
+    results['total'] = summarize_load(all_samples, sum(errors.values()), duration)
+    total = results['total']
+    print(f"  {'total':24} {total['rps']:8.1f} {total['p50_ms'] or float('nan'):8.1f} "
+          f"{total['p99_ms'] or float('nan'):8.1f} {total['errors']:7d}")
+
+    health = fetch_json(args, '/api/system/health')
+    if health and 'minimum_free_heap_bytes' in health:
+        results['heap'] = {'min_free_bytes': health['minimum_free_heap_bytes']}
+        print(f"\n  Heap minimum since boot: {health['minimum_free_heap_bytes']} bytes")
+    else:
+        print("\n  ⚠️  Could not read /api/system/health for the heap minimum")
+
+    if args.save:
+        save_results(args.save, {'load': results})
+    return 0 if all_samples else 1
+
+
+def recv_exact(sock, count):
+    """Read exactly count bytes"""
+    data = b''
+    while len(data) < count:
+        chunk = sock.recv(count - len(data))
+        if not chunk:
+            raise ConnectionError('connection closed')
+        data += chunk
+    return data
+
+
+def ws_connect(args, path):
+    """Open a WebSocket connection (RFC 6455 handshake)"""
+    sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+    if args.https:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+        context.check_hostname = False
+        context.verify_mode = ssl.CERT_NONE
+        sock = context.wrap_socket(sock, server_hostname=args.host)
+    key = base64.b64encode(os.urandom(16)).decode()
+    sock.sendall((f"GET {path} HTTP/1.1\r\nHost: {args.host}\r\nUpgrade: websocket\r\n"
+                  f"Connection: Upgrade\r\nSec-WebSocket-Key: {key}\r\n"
+                  f"Sec-WebSocket-Version: 13\r\n\r\n").encode())
+    response = b''
+    while b'\r\n\r\n' not in response:
+        response += recv_exact(sock, 1)
+    if b' 101 ' not in response.split(b'\r\n', 1)[0]:
+        raise ConnectionError(response.split(b'\r\n', 1)[0].decode(errors='replace'))
+    return sock
+
+
+def ws_send_text(sock, text):
+    """Send a masked text frame"""
+    payload = text.encode()
+    header = bytes([0x81])
+    if len(payload) < 126:
+        header += bytes([0x80 | len(payload)])
+    else:
+        header += bytes([0x80 | 126]) + len(payload).to_bytes(2, 'big')
+    mask = os.urandom(4)
+    sock.sendall(header + mask + bytes(b ^ mask[i % 4] for i, b in enumerate(payload)))
+
+
+def ws_recv(sock):
+    """Receive one frame; returns (opcode, payload)"""
+    first, second = recv_exact(sock, 2)
+    length = second & 0x7F
+    if length == 126:
+        length = int.from_bytes(recv_exact(sock, 2), 'big')
+    elif length == 127:
+        length = int.from_bytes(recv_exact(sock, 8), 'big')
+    mask = recv_exact(sock, 4) if second & 0x80 else None
+    payload = recv_exact(sock, length)
+    if mask:
+        payload = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+    return first & 0x0F, payload
+
+
+def stream_benchmark(args):
+    """Measure the sample-to-dashboard path over the WebSocket push channel"""
+    if args.port is None:
+        args.port = 443 if args.https else 80
+
+    print(f"Stream test: measurement topic for {args.duration}s from {args.host}:{args.port}\n")
+    try:
+        sock = ws_connect(args, '/ws')
+    except (OSError, ConnectionError) as error:
+        print(f"❌ WebSocket connection failed: {error}")
+        return 1
+    ws_send_text(sock, json.dumps({'subscribe': ['measurement']}))
+
+    pushes = 0
+    samples = 0
+    dropped = 0
+    lost = 0
+    ages = []
+    last_seq = None
+    start = time.monotonic()
+    try:
+        while time.monotonic() - start < args.duration:
+            opcode, payload = ws_recv(sock)
+            if opcode == 0x8:
+                print("⚠️  Device closed the connection")
+                break
+            if opcode != 0x1:
+                continue
+            message = json.loads(payload)
+            if message.get('type') != 'measurement':
+                continue
+            data = message['data']
+            pushes += 1
+            samples += data.get('samples', 1)
+            dropped += data.get('dropped', 0)
+            ages.append(data.get('age_ms', 0))
+            # Pushes coalesced by ws_push for a slow client show up as a sequence gap
+            if last_seq is not None:
+                lost += max(0, data['seq'] - last_seq - data.get('samples', 1) - data.get('dropped', 0))
+            last_seq = data['seq']
+    except (OSError, ConnectionError, ValueError, KeyError) as error:
+        print(f"⚠️  Stream interrupted: {error}")
+    finally:
+        sock.close()
+    duration = time.monotonic() - start
+
+    results = {
+        'host': args.host,
+        'duration_s': duration,
+        'pushes': pushes,
+        'push_rate': pushes / duration if duration > 0 else 0,
+        'samples_per_s': samples / duration if duration > 0 else 0,
+        'dropped': dropped,
+        'lost_in_push': lost,
+        'p50_age_ms': statistics.median(ages) if ages else None,
+        'p99_age_ms': percentile(ages, 0.99),
+    }
+    health = fetch_json(args, '/api/system/health')
+    if health and 'measurement' in health:
+        results['source'] = health['measurement']
+
+    print(f"  Pushes:          {pushes} ({results['push_rate']:.1f}/s)")
+    print(f"  Samples:         {samples} ({results['samples_per_s']:.1f}/s)")
+    print(f"  Dropped (ring):  {dropped}")
+    print(f"  Lost (push):     {lost}")
+    if ages:
+        print(f"  Sample age:      p50 {results['p50_age_ms']:.0f} ms, p99 {results['p99_age_ms']:.0f} ms")
+    if 'source' in results:
+        source = results['source']
+        print(f"  Source:          {source.get('source')} every {source.get('interval_us')} us, "
+              f"{source.get('late_ticks')} late periods")
+
+    if args.save:
+        save_results(args.save, {'stream': results})
+    return 0 if pushes else 1
+
+
+def load_results(paths):
+    """Merge result files written with --save"""
+    merged = {}
+    for path in paths:
+        with open(path) as f:
+            merged.update(json.load(f))
+    return merged
+
+
+def flatten_metrics(results):
+    """Map 'section/item/metric' to value for every comparable metric"""
+    metrics = {}
+    device = results.get('device', {})
+    for name, fields in device.get('benchmarks', {}).items():
+        for metric in ('mean_us', 'p50_us', 'p99_us'):
+            if metric in fields:
+                metrics[f'device/{name}/{metric}'] = fields[metric]
+    if 'heap' in device:
+        metrics['device/heap/min_free_bytes'] = device['heap'].get('min_free_bytes')
+
+    load = results.get('load', {})
+    for path, summary in dict(load.get('paths', {}), total=load.get('total', {})).items():
+        for metric in ('rps', 'p50_ms', 'p99_ms'):
+            if summary.get(metric) is not None:
+                metrics[f'load/{path}/{metric}'] = summary[metric]
+        if summary.get('errors'):
+            metrics[f'load/{path}/errors'] = summary['errors']
+    if 'heap' in load:
+        metrics['load/heap/min_free_bytes'] = load['heap'].get('min_free_bytes')
+
+    stream = results.get('stream', {})
+    for metric in ('push_rate', 'samples_per_s', 'p99_age_ms'):
+        if stream.get(metric) is not None:
+            metrics[f'stream/measurement/{metric}'] = stream[metric]
+    return {key: value for key, value in metrics.items() if value is not None}
+
+
+def check_results(args):
+    """Compare results with a baseline; exit status 1 on regression"""
+    try:
+        with open(args.baseline) as f:
+            baseline = flatten_metrics(json.load(f))
+    except FileNotFoundError:
+        print(f"❌ Baseline {args.baseline} not found - create it with the baseline command")
+        return 1
+    current = flatten_metrics(load_results(args.results))
+
+    tolerance = args.tolerance / 100.0
+    regressions = 0
+    compared = 0
+    print(f"Comparing against {args.baseline} (tolerance {args.tolerance:.0f}%)\n")
+    for key in sorted(current):
+        metric = key.rsplit('/', 1)[1]
+        value = current[key]
+        if metric == 'errors':
+            print(f"  ❌ {key}: {int(value)} failed requests")
+            regressions += 1
+            continue
+        if key not in baseline or metric not in METRIC_DIRECTION:
+            continue
+        compared += 1
+        reference = baseline[key]
+        if METRIC_DIRECTION[metric]:
+            regressed = value < reference * (1.0 - tolerance)
+        else:
+            regressed = value > reference * (1.0 + tolerance)
+        change = (value - reference) / reference * 100.0 if reference else 0.0
+        if regressed:
+            regressions += 1
+            print(f"  ❌ {key}: {value:.2f} vs {reference:.2f} ({change:+.1f}%)")
+        elif args.verbose:
+            print(f"  ✅ {key}: {value:.2f} vs {reference:.2f} ({change:+.1f}%)")
+
+    # A benchmark that fails on the device is left out of its BENCH lines,
+    # so a baseline metric missing from a section that was run is a regression.
+    # Error counts are only recorded when non-zero, so a missing one is fine.
+    sections = {key.split('/', 1)[0] for key in current}
+    missing = sorted(key for key in baseline
+                     if key not in current and key.split('/', 1)[0] in sections
+                     and key.rsplit('/', 1)[1] != 'errors')
+    for key in missing:
+        print(f"  ❌ {key}: missing from the results")
+    regressions += len(missing)
+
+    print(f"\n{compared} metrics compared, {len(missing)} missing, {regressions} regressions")
+    return 1 if regressions else 0
+
+
+def store_baseline(args):
+    """Merge results into the baseline file"""
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    baseline.update(load_results(args.results))
+    directory = os.path.dirname(args.baseline)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    save_results(args.baseline, baseline)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmark runner and regression check')
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    device = subparsers.add_parser('device', help='Collect on-device micro-benchmark results')
+    source = device.add_mutually_exclusive_group()
+    source.add_argument('--console', default='localhost:5555',
+                        help='QEMU UART0 console address (default: localhost:5555)')
+    source.add_argument('--log', help='Read a saved serial log instead of the console')
+    device.add_argument('--timeout', type=float, default=120.0, help='Seconds to wait for the run')
+    device.add_argument('--save', help='Write results as JSON')
+
+    load = subparsers.add_parser('load', help='HTTP load test against a device')
+    load.add_argument('--host', default='192.168.100.2', help='Device address (default: QEMU 192.168.100.2)')
+    load.add_argument('--port', type=int, help='Port (default: 80, or 443 with --https)')
+    load.add_argument('--https', action='store_true', help='Use HTTPS (CONFIG_WEB_SERVER_HTTPS builds)')
+    load.add_argument('-c', '--clients', type=int, default=4, help='Concurrent clients')
+    load.add_argument('-d', '--duration', type=float, default=20.0, help='Test duration in seconds')
+    load.add_argument('--timeout', type=float, default=10.0, help='Request timeout in seconds')
+    load.add_argument('--paths', nargs='+', help=f"Paths to request (default: {' '.join(DEFAULT_PATHS)})")
+    load.add_argument('--save', help='Write results as JSON')
+
+    stream = subparsers.add_parser('stream', help='Measure the WebSocket measurement stream')
+    stream.add_argument('--host', default='192.168.100.2', help='Device address (default: QEMU 192.168.100.2)')
+    stream.add_argument('--port', type=int, help='Port (default: 80, or 443 with --https)')
+    stream.add_argument('--https', action='store_true', help='Use HTTPS (CONFIG_WEB_SERVER_HTTPS builds)')
+    stream.add_argument('-d', '--duration', type=float, default=20.0, help='Test duration in seconds')
+    stream.add_argument('--timeout', type=float, default=10.0, help='Socket timeout in seconds')
+    stream.add_argument('--save', help='Write results as JSON')
+
+    check = subparsers.add_parser('check', help='Fail if results regressed against a baseline')
+    check.add_argument('results', nargs='+', help='JSON files written with --save')
+    check.add_argument('--baseline', required=True, help='Baseline JSON file')
+    check.add_argument('--tolerance', type=float, default=15.0, help='Allowed change in percent')
+    check.add_argument('-v', '--verbose', action='store_true', help='Also list metrics within tolerance')
+
+    baseline = subparsers.add_parser('baseline', help='Store results as the new baseline')
+    baseline.add_argument('results', nargs='+', help='JSON files written with --save')
+    baseline.add_argument('--baseline', required=True, help='Baseline JSON file to create or update')
+
+    args = parser.parse_args()
+    if args.command == 'device':
+        return device_benchmark(args)
+    if args.command == 'load':
+        return load_benchmark(args)
+    if args.command == 'stream':
+        return stream_benchmark(args)
+    if args.command == 'check':
+        return check_results(args)
+    return store_baseline(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""
+Web Asset Builder for ESP32 Web Server
+
+Prepares the files in main/components/web_server/www for embedding into the
+firmware. Called by the web_server component's CMakeLists.txt at build time.
+
+For every input file the builder writes two outputs into the output directory,
+keeping the relative path:
+- <file>     Minified plain version (fallback for clients without gzip)
+- <file>.gz  Gzip-compressed version of the minified file
+
+With --table the builder also generates a C source file containing the asset
+table used by web_assets_find() (see web_assets.h). Entries are sorted by URI
+path for binary search and carry the MIME type and a strong ETag derived from
+the content hash of each representation.
+
+Minification is deliberately conservative (line based) so it can never change
+program behaviour:
+- Leading/trailing whitespace and empty lines are removed
+- HTML comments and CSS block comments are removed
+- Full-line // comments are removed from JavaScript (files and <script> blocks)
+
+Usage:
+    python build_web_assets.py --src www --out build/www index.html css/style.css
+    python build_web_assets.py --src www --out build/www --table build/web_assets_table.c ...
+
+Author: ESP32 Distance Project
+Date: 2025
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+HTML_COMMENT_RE = re.compile(r'<!--.*?-->', re.DOTALL)
+CSS_COMMENT_RE = re.compile(r'/\*.*?\*/', re.DOTALL)
+
+MIME_TYPES = {
+    '.html': 'text/html',
+    '.htm': 'text/html',
+    '.css': 'text/css',
+    '.js': 'application/javascript',
+    '.json': 'application/json',
+    '.svg': 'image/svg+xml',
+    '.png': 'image/png',
+    '.ico': 'image/x-icon',
+}
+
+# Number of hex digits of the SHA-256 content hash used for ETags
+ETAG_HASH_DIGITS = 16
+
+
+def minify_lines(text, js_comments=False):
+    """Strip whitespace and empty lines, optionally dropping // comment lines"""
+    lines = []
+    for line in text.splitlines():
+        line = line.strip()
+        if not line:
+            continue
+        if js_comments and line.startswith('//'):
+            continue
+        lines.append(line)
+    return '\n'.join(lines) + '\n'
+
+
+def minify_html(text):
+    """Minify HTML, treating inline <script> blocks as JavaScript"""
+    text = HTML_COMMENT_RE.sub('', text)
+    lines = []
+    in_script = False
+    for line in text.splitlines():
+        stripped = line.strip()
+        if not stripped:
+            continue
+        if in_script and stripped.startswith('//'):
+            continue
+        lines.append(stripped)
+        # Track script blocks so // comments are only dropped inside them
+        if '<script' in stripped and '</script>' not in stripped:
+            in_script = True
+        elif '</script>' in stripped:
+            in_script = False
+    return '\n'.join(lines) + '\n'
+
+
+def minify(path, data):
+    """Minify file contents based on the file extension"""
+    ext = os.path.splitext(path)[1].lower()
+    try:
+        text = data.decode('utf-8')
+    except UnicodeDecodeError:
+        return data  # Binary asset, embed unchanged
+
+    if ext in ('.html', '.htm'):
+        text = minify_html(text)
+    elif ext == '.css':
+        text = minify_lines(CSS_COMMENT_RE.sub('', text))
+    elif ext == '.js':
+        text = minify_lines(text, js_comments=True)
+    else:
+        return data
+    return text.encode('utf-8')
+
+
+def write_file(path, data):
+    """Write output file, creating parent directories as needed"""
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, 'wb') as f:
+        f.write(data)
+
+
+def build_asset(src_dir, out_dir, rel_path, do_minify):
+    """Produce the plain and gzip outputs for one asset"""
+    with open(os.path.join(src_dir, rel_path), 'rb') as f:
+        original = f.read()
+
+    plain = minify(rel_path, original) if do_minify else original
+    # mtime=0 keeps the output reproducible between builds
+    compressed = gzip.compress(plain, compresslevel=9, mtime=0)
+
+    write_file(os.path.join(out_dir, rel_path), plain)
+    write_file(os.path.join(out_dir, rel_path + '.gz'), compressed)
+
+    return {
+        'path': '/' + rel_path.replace(os.sep, '/'),
+        'file': os.path.basename(rel_path),
+        'mime': MIME_TYPES.get(os.path.splitext(rel_path)[1].lower(), 'text/plain'),
+        'etag': hashlib.sha256(plain).hexdigest()[:ETAG_HASH_DIGITS],
+        'original_size': len(original),
+        'plain_size': len(plain),
+        'gz_size': len(compressed),
+    }
+
+
+def binary_symbol(filename):
+    """Symbol prefix used by ESP-IDF target_add_binary_data() for a file"""
+    return '_binary_' + re.sub(r'[^A-Za-z0-9]', '_', filename)
+
+
+def generate_table(assets):
+    """Generate the C source for the sorted asset table"""
+    # Binary search in web_assets_find() relies on strcmp() ordering
+    assets = sorted(assets, key=lambda a: a['path'].encode('utf-8'))
+
+    out = [
+        '/* Generated by tools/build_web_assets.py - do not edit */',
+        '',
+        '#include "web_assets.h"',
+        '',
+    ]
+    for asset in assets:
+        for suffix in ('', '.gz'):
+            sym = binary_symbol(asset['file'] + suffix)
+            name = sym[len('_binary_'):]
+            out.append(f'extern const uint8_t {name}_start[] asm("{sym}_start");')
+    out.append('')
+    out.append('const web_asset_t web_assets[] = {')
+    for asset in assets:
+        plain = binary_symbol(asset['file'])[len('_binary_'):]
+        gz = binary_symbol(asset['file'] + '.gz')[len('_binary_'):]
+        out.append('    {')
+        out.append(f'        .path = "{asset["path"]}",')
+        out.append(f'        .mime_type = "{asset["mime"]}",')
+        out.append(f'        .etag = "\\"{asset["etag"]}\\"",')
+        out.append(f'        .gz_etag = "\\"{asset["etag"]}-gz\\"",')
+        out.append(f'        .data = {plain}_start,')
+        out.append(f'        .gz_data = {gz}_start,')
+        out.append(f'        .size = {asset["plain_size"]},')
+        out.append(f'        .gz_size = {asset["gz_size"]},')
+        out.append('    },')
+    out.append('};')
+    out.append('')
+    out.append('const size_t web_assets_count = sizeof(web_assets) / sizeof(web_assets[0]);')
+    out.append('')
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Minify and gzip embedded web assets')
+    parser.add_argument('--src', required=True, help='Source directory (www)')
+    parser.add_argument('--out', required=True, help='Output directory')
+    parser.add_argument('--no-minify', action='store_true', help='Only gzip, do not minify')
+    parser.add_argument('--quiet', '-q', action='store_true', help='Do not print size summary')
+    parser.add_argument('--table', help='Generate C asset table source at this path')
+    parser.add_argument('files', nargs='+', help='Asset paths relative to --src')
+    args = parser.parse_args()
+
+    assets = []
+    for rel_path in args.files:
+        asset = build_asset(args.src, args.out, rel_path, not args.no_minify)
+        assets.append(asset)
+        if not args.quiet:
+            print(f"  {rel_path}: {asset['original_size']} -> {asset['plain_size']} bytes (minified), "
+                  f"{asset['gz_size']} bytes (gzip)")
+
+    # Blobs are embedded by file name, so names must be unique across directories
+    names = [asset['file'] for asset in assets]
+    if len(set(names)) != len(names):
+        print("Error: web asset file names must be unique", file=sys.stderr)
+        return 1
+
+    if args.table:
+        write_file(args.table, generate_table(assets).encode('utf-8'))
+
+    total_original = sum(asset['original_size'] for asset in assets)
+    total_gz = sum(asset['gz_size'] for asset in assets)
+
+    if not args.quiet:
+        print(f"Web assets: {total_original} bytes -> {total_gz} bytes gzip "
+              f"({100 * total_gz // max(total_original, 1)}%)")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
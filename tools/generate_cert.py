@@ -3,6 +3,13 @@
 ESP32 Certificate Generator
 Generates self-signed certificates for HTTPS server without requiring OpenSSL binary
 
+Key types:
+- rsa   (default) RSA 2048-bit
+- ecdsa ECDSA P-256; TLS handshakes on the ESP32 are several times faster
+        than with RSA because signing needs far less computation
+
+Select with --key-type or the CERT_KEY_TYPE environment variable.
+
 🔒 SECURITY WARNING: 
 The generated private keys and certificates are for local IoT device use only.
 These files should NEVER be committed to version control (git).
@@ -13,13 +20,27 @@ try:
     from cryptography import x509
     from cryptography.x509.oid import NameOID
     from cryptography.hazmat.primitives import hashes, serialization
-    from cryptography.hazmat.primitives.asymmetric import rsa
+    from cryptography.hazmat.primitives.asymmetric import ec, rsa
+    import argparse
     from ipaddress import IPv4Address
     import datetime
     import sys
     import os
 
-    def generate_certificate(output_dir=".", validity_days=9125):
+    KEY_TYPES = ("rsa", "ecdsa")
+
+    def generate_private_key(key_type):
+        """Generate the server private key of the requested type"""
+        if key_type == "ecdsa":
+            print("Generating ECDSA private key (P-256)...")
+            return ec.generate_private_key(ec.SECP256R1())
+        print("Generating RSA private key (2048-bit)...")
+        return rsa.generate_private_key(
+            public_exponent=65537,
+            key_size=2048,
+        )
+
+    def generate_certificate(output_dir=".", validity_days=9125, key_type="rsa"):
         """Generate self-signed certificate and private key"""
         
         # Create output directory if it doesn't exist
@@ -36,13 +57,10 @@ try:
         print(f"Server private key: {key_file}")
         print(f"CA certificate: {ca_cert_file}")
         print(f"Validity period: {validity_days} days (25 years)")
+        print(f"Key type: {key_type}")
         
         # Generate private key
-        print("Generating RSA private key (2048-bit)...")
-        private_key = rsa.generate_private_key(
-            public_exponent=65537,
-            key_size=2048,
-        )
+        private_key = generate_private_key(key_type)
         
         # Generate certificate
         print("Creating certificate...")
@@ -103,8 +121,16 @@ try:
 
     if __name__ == "__main__":
         # Get output directory from environment variable or use current directory
-        output_dir = os.environ.get('CERT_OUTPUT_DIR', '.')
-        generate_certificate(output_dir)
+        parser = argparse.ArgumentParser(description='Generate self-signed HTTPS certificates')
+        parser.add_argument('--output-dir', default=os.environ.get('CERT_OUTPUT_DIR', '.'),
+                            help='Output directory (default: $CERT_OUTPUT_DIR or .)')
+        parser.add_argument('--key-type', choices=KEY_TYPES,
+                            default=os.environ.get('CERT_KEY_TYPE', 'rsa'),
+                            help='Server key type (default: $CERT_KEY_TYPE or rsa)')
+        args = parser.parse_args()
+        if args.key_type not in KEY_TYPES:
+            parser.error(f"invalid key type: {args.key_type}")
+        generate_certificate(args.output_dir, key_type=args.key_type)
 
 except ImportError as e:
     print(f"ERROR: cryptography library not available: {e}")
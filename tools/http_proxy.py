@@ -8,6 +8,8 @@ Allows VS Code Simple Browser to access ESP32 webserver via GitHub port forwardi
 Features:
 - Automatic retry with exponential backoff
 - Handles ESP32/QEMU restarts gracefully
+- Concurrent requests (one thread each) with responses streamed in chunks,
+  so a large asset does not hold up the rest of the page
 - Quiet mode (--quiet): Only logs errors
 - Errors logged to temp/proxy_errors.log
 """
@@ -24,6 +26,11 @@ PORT = 8080
 ESP32_URL = "http://192.168.100.2"
 MAX_RETRIES = 5
 INITIAL_BACKOFF = 0.5  # seconds
+COPY_CHUNK_SIZE = 16384
+
+# Connection-level headers that must not be forwarded (the body is re-sent
+# unchunked and the proxy closes each client connection)
+HOP_BY_HOP_HEADERS = {'connection', 'keep-alive', 'transfer-encoding', 'te', 'trailer', 'upgrade'}
 
 # Parse command line arguments
 QUIET_MODE = '--quiet' in sys.argv
@@ -63,9 +70,14 @@ class ProxyHandler(http.server.SimpleHTTPRequestHandler):
                     # Success! Forward the response
                     self.send_response(response.status)
                     for header, value in response.headers.items():
-                        self.send_header(header, value)
+                        if header.lower() not in HOP_BY_HOP_HEADERS:
+                            self.send_header(header, value)
                     self.end_headers()
-                    self.wfile.write(response.read())
+                    while True:
+                        chunk = response.read(COPY_CHUNK_SIZE)
+                        if not chunk:
+                            break
+                        self.wfile.write(chunk)
                     
                     if not QUIET_MODE:
                         log_info(f"✓ {self.path} -> {response.status}")
@@ -116,7 +128,9 @@ if __name__ == "__main__":
         log_info(f"Quiet mode: Errors logged to {ERROR_LOG}")
     log_info("Press Ctrl+C to stop\n")
     
-    with socketserver.TCPServer(("", PORT), ProxyHandler) as httpd:
+    socketserver.ThreadingTCPServer.allow_reuse_address = True
+    socketserver.ThreadingTCPServer.daemon_threads = True
+    with socketserver.ThreadingTCPServer(("", PORT), ProxyHandler) as httpd:
         try:
             httpd.serve_forever()
         except KeyboardInterrupt:
@@ -10,12 +10,31 @@ Architecture:
 - Writes frames to TUN device (Linux network stack)
 - Bidirectional: TUN → Serial also works
 
-Framing Protocol:
-- [LENGTH:2 bytes big-endian][DATA:N bytes]
-- Maximum frame size: 1500 bytes (MTU)
+Framing Protocol (v2, must match netif_uart_tunnel_sim.h):
+- [SYNC:2 = A5 5A][LENGTH:2 big-endian][DATA:N bytes][CRC16:2 big-endian]
+- CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over LENGTH and DATA
+- DATA is an Ethernet frame, at most 1514 bytes (1500 byte MTU + header)
+- Frames are streamed back to back; several packets are batched per write
+- Corrupt or partial frames are skipped by rescanning for the next sync
+  marker, so frames buffered behind line noise are kept
+
+Batching:
+- TUN -> serial: every queued packet is read (non-blocking TUN fd) and sent
+  with one scatter-gather sendmsg(); header, packet and CRC are separate
+  buffers, so packets are never copied into a joined frame
+- Serial -> TUN: one recv_into() per burst, every complete frame decoded
+  through a memoryview (CRC computed in place) and written to TUN as a view
+- TUN itself carries one packet per read()/write(); that is the kernel API
+
+Self-test (--self-test):
+- Runs the bridge, waits for the ESP32, then measures ping latency, a ping
+  flood and bulk TCP download over HTTP
+- Compares bridge CPU time, serial line utilization and the ESP32 tunnel
+  counters from /api/system/health to report which side limits throughput
 
 Usage:
     sudo ./serial_tun_bridge.py
+    sudo ./serial_tun_bridge.py --self-test [--duration 10] [--baud 921600]
 
 Requirements:
     - Root privileges (for TUN device creation)
@@ -33,6 +52,13 @@ import select
 import signal
 import logging
 import argparse
+import binascii
+import http.client
+import json
+import re
+import subprocess
+import threading
+import time
 
 # Setup logging (will be configured based on command line arguments)
 logger = logging.getLogger(__name__)
@@ -46,12 +72,90 @@ TUN_NETMASK = '255.255.255.0'
 ESP32_IP = '192.168.100.2'
 MAX_FRAME_SIZE = 1500
 
+# Tunnel framing v2
+FRAME_SYNC = b'\xa5\x5a'
+FRAME_HEADER_SIZE = 4   # sync (2) + length (2)
+FRAME_CRC_SIZE = 2
+TX_BATCH_MAX = 32       # Max TUN packets coalesced into one serial write
+TX_IOV_MAX = 4 * TX_BATCH_MAX  # Buffers per sendmsg(): header, Ethernet header, packet, CRC
+SERIAL_RECV_SIZE = 65536
+SERIAL_SOCK_BUFFER = 256 * 1024
+LENGTH_FIELD = struct.Struct('>H')
+
 # Ethernet Header Constants (for lwIP compatibility)
 # ESP32 lwIP expects Ethernet frames, but TUN gives us raw IP packets
 ETH_HEADER_SIZE = 14
 HOST_MAC = bytes([0x02, 0x00, 0x00, 0x00, 0x00, 0x01])  # Fake MAC for host
 ESP32_MAC = bytes([0x02, 0x00, 0x00, 0x00, 0x00, 0x02])  # Fake MAC for ESP32
 ETH_TYPE_IP = 0x0800  # EtherType for IPv4
+MAX_ETH_FRAME = MAX_FRAME_SIZE + ETH_HEADER_SIZE
+
+
+def frame_crc(length_and_data):
+    """CRC-16/CCITT-FALSE used by the tunnel framing"""
+    return binascii.crc_hqx(length_and_data, 0xFFFF)
+
+
+def frame_parts(eth_header, ip_packet):
+    """
+    v2 frame of eth_header + ip_packet as a list of buffers for sendmsg()
+
+    The CRC is chained over the pieces, so the packet is never copied.
+    """
+    header = FRAME_SYNC + LENGTH_FIELD.pack(len(eth_header) + len(ip_packet))
+    crc = binascii.crc_hqx(ip_packet, binascii.crc_hqx(eth_header, frame_crc(header[2:])))
+    return [header, eth_header, ip_packet, LENGTH_FIELD.pack(crc)]
+
+
+def decode_frames(buffer, stats=None):
+    """
+    Extract complete frames from a receive buffer (bytearray, consumed in place)
+
+    Returns the list of Ethernet frames found. A trailing partial frame stays
+    in the buffer until more data arrives. On a bad length or CRC only the
+    first sync byte is dropped and the scan resumes inside the rejected
+    frame, so a valid frame hidden behind noise is still found. CRCs are
+    computed on a view of the buffer; only accepted frames are copied.
+    """
+    frames = []
+    pos = 0
+    with memoryview(buffer) as view:
+        while True:
+            start = buffer.find(FRAME_SYNC, pos)
+            if start < 0:
+                # Keep a trailing first sync byte, it may start the next frame
+                # (unless it is the last byte of a frame just decoded)
+                keep = 1 if pos < len(buffer) and buffer.endswith(FRAME_SYNC[:1]) else 0
+                if stats is not None:
+                    stats['sync_errors'] += len(buffer) - pos - keep
+                consumed = len(buffer) - keep
+                break
+            if stats is not None:
+                stats['sync_errors'] += start - pos
+            consumed = start
+            if len(buffer) - start < FRAME_HEADER_SIZE:
+                break
+            frame_len = LENGTH_FIELD.unpack_from(buffer, start + 2)[0]
+            if frame_len == 0 or frame_len > MAX_ETH_FRAME:
+                if stats is not None:
+                    stats['sync_errors'] += 1
+                pos = start + 1
+                continue
+            end = start + FRAME_HEADER_SIZE + frame_len + FRAME_CRC_SIZE
+            if len(buffer) < end:
+                break
+            crc = LENGTH_FIELD.unpack_from(buffer, end - FRAME_CRC_SIZE)[0]
+            if frame_crc(view[start + 2:end - FRAME_CRC_SIZE]) != crc:
+                if stats is not None:
+                    stats['crc_errors'] += 1
+                pos = start + 1
+                continue
+            frames.append(bytes(view[start + FRAME_HEADER_SIZE:end - FRAME_CRC_SIZE]))
+            pos = end
+    # The view must be released before the bytearray can shrink
+    del buffer[:consumed]
+    return frames
+
 
 # TUN device handling
 try:
@@ -61,17 +165,42 @@ except ImportError:
     HAVE_PYTUN = False
     logger.warning("pytun not available, using manual TUN device creation")
 
+def describe_packet(ip_packet):
+    """Short protocol/address summary of an IPv4 packet for debug logs"""
+    if len(ip_packet) < 20 or (ip_packet[0] >> 4) != 4:
+        return "non-IPv4"
+    proto_map = {1: "ICMP", 6: "TCP", 17: "UDP"}
+    protocol = ip_packet[9]
+    src_ip = ".".join(str(b) for b in ip_packet[12:16])
+    dst_ip = ".".join(str(b) for b in ip_packet[16:20])
+    return f"{proto_map.get(protocol, f'Proto{protocol}')} (proto={protocol}), {src_ip}→{dst_ip}"
+
+
+def new_bridge_stats():
+    """Bridge counters; 'busy_s' is the time spent moving data, not waiting"""
+    return {
+        'crc_errors': 0, 'sync_errors': 0,
+        'rx_frames': 0, 'rx_bytes': 0, 'rx_bursts': 0,
+        'tx_frames': 0, 'tx_bytes': 0, 'tx_batches': 0,
+        'busy_s': 0.0,
+    }
+
+
 class SerialTunBridge:
-    def __init__(self):
+    def __init__(self, port=SERIAL_PORT):
+        self.port = port
         self.serial_sock = None
         self.tun = None
         self.running = False
+        self.rx_buffer = bytearray()
+        self.rx_chunk = bytearray(SERIAL_RECV_SIZE)
+        self.eth_header = ESP32_MAC + HOST_MAC + struct.pack('>H', ETH_TYPE_IP)
+        self.stats = new_bridge_stats()
+        self.connected = threading.Event()
 
     def create_tun_device_manual(self):
         """Create TUN device manually using ioctl and system commands"""
-        import subprocess
         import fcntl
-        import struct
         
         logger.info(f"Creating TUN device {TUN_NAME} manually...")
         
@@ -151,87 +280,62 @@ class SerialTunBridge:
             return self.tun
 
     def connect_to_serial(self):
-        """Connect to QEMU UART TCP socket - retry forever"""
-        logger.info(f"Connecting to QEMU UART at {SERIAL_HOST}:{SERIAL_PORT}...")
+        """Connect to QEMU UART TCP socket - retry until connected or stopped"""
+        logger.info(f"Connecting to QEMU UART at {SERIAL_HOST}:{self.port}...")
         
         attempt = 0
-        while True:  # Retry forever
+        while self.running:
             try:
                 sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-                sock.connect((SERIAL_HOST, SERIAL_PORT))
+                # Frames are already batched per write; do not let Nagle hold them back
+                sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, SERIAL_SOCK_BUFFER)
+                sock.setsockopt(socket.SOL_SOCKET, socket.SO_SNDBUF, SERIAL_SOCK_BUFFER)
+                sock.connect((SERIAL_HOST, self.port))
                 logger.info(f"Connected to QEMU UART (after {attempt} attempts)")
                 return sock
             except ConnectionRefusedError:
+                sock.close()
                 attempt += 1
                 if attempt == 1 or attempt % 10 == 0:  # Log first and every 10th attempt
                     logger.warning(f"Connection refused, retrying... (attempt {attempt})")
-                import time
                 time.sleep(1)
             except Exception as e:
+                sock.close()
                 logger.error(f"Failed to connect to serial: {e}")
-                import time
                 time.sleep(1)
+        return None
 
     def serial_to_tun(self):
-        """Read Ethernet frame from serial, extract IP packet, write to TUN"""
+        """Read a burst from serial, decode every complete frame, write IP packets to TUN"""
         try:
-            # Read frame length (2 bytes, big-endian) - MUST read exactly 2 bytes
-            len_data = b''
-            while len(len_data) < 2:
-                chunk = self.serial_sock.recv(2 - len(len_data))
-                if not chunk:
-                    return False
-                len_data += chunk
-            
-            frame_len = struct.unpack('>H', len_data)[0]
-            
-            if frame_len == 0 or frame_len > MAX_FRAME_SIZE + ETH_HEADER_SIZE:
-                logger.warning(f"Invalid frame length: {frame_len}")
-                return True
-            
-            # Read Ethernet frame
-            eth_frame = b''
-            while len(eth_frame) < frame_len:
-                chunk = self.serial_sock.recv(frame_len - len(eth_frame))
-                if not chunk:
-                    return False
-                eth_frame += chunk
-            
-            logger.info(f"Serial→TUN: Received {frame_len} bytes Ethernet frame")
-            
-            # Strip Ethernet header (14 bytes) to get IP packet
-            if frame_len < ETH_HEADER_SIZE:
-                logger.warning(f"Frame too short for Ethernet header: {frame_len}")
-                return True
-                
-            ip_packet = eth_frame[ETH_HEADER_SIZE:]
-            ip_len = len(ip_packet)
-            
-            # Log packet info with protocol names
-            src_ip = "?"
-            dst_ip = "?"
-            protocol = "?"
-            proto_name = "?"
-            if ip_len >= 20:  # Minimum IP header
-                try:
-                    version = (ip_packet[0] >> 4) & 0xF
-                    if version == 4:
-                        src_ip = ".".join(str(b) for b in ip_packet[12:16])
-                        dst_ip = ".".join(str(b) for b in ip_packet[16:20])
-                        protocol = ip_packet[9]
-                        # Map protocol numbers to names
-                        proto_map = {1: "ICMP", 6: "TCP", 17: "UDP"}
-                        proto_name = proto_map.get(protocol, f"Proto{protocol}")
-                        proto_map = {1: "ICMP", 6: "TCP", 17: "UDP"}
-                        proto_name = proto_map.get(protocol, f"Proto{protocol}")
-                except:
-                    pass
-            
-            logger.info(f"Serial→TUN: {ip_len} bytes IP, {proto_name} (proto={protocol}), {src_ip}→{dst_ip}")
-            
-            # Write IP packet to TUN
-            self.tun.write(ip_packet)
-            
+            received = self.serial_sock.recv_into(self.rx_chunk)
+            if not received:
+                return False
+            with memoryview(self.rx_chunk) as chunk:
+                self.rx_buffer += chunk[:received]
+            self.stats['rx_bursts'] += 1
+
+            crc_errors = self.stats['crc_errors']
+            tun_fd = self.tun.fileno()
+            for eth_frame in decode_frames(self.rx_buffer, self.stats):
+                # Strip Ethernet header (14 bytes) to get IP packet
+                if len(eth_frame) < ETH_HEADER_SIZE:
+                    logger.warning(f"Frame too short for Ethernet header: {len(eth_frame)}")
+                    continue
+
+                ip_packet = memoryview(eth_frame)[ETH_HEADER_SIZE:]
+                if logger.isEnabledFor(logging.DEBUG):
+                    logger.debug(f"Serial→TUN: {len(ip_packet)} bytes IP, {describe_packet(ip_packet)}")
+
+                # Write IP packet to TUN (one packet per write is the TUN API)
+                os.write(tun_fd, ip_packet)
+                self.stats['rx_frames'] += 1
+                self.stats['rx_bytes'] += len(eth_frame)
+
+            if self.stats['crc_errors'] != crc_errors:
+                logger.warning(f"Serial→TUN: CRC errors, resynced (total {self.stats['crc_errors']})")
+
             return True
             
         except Exception as e:
@@ -239,49 +343,29 @@ class SerialTunBridge:
             return False
 
     def tun_to_serial(self):
-        """Read IP packet from TUN, add Ethernet header, write to serial"""
+        """Read all pending IP packets from TUN and send them with one sendmsg()"""
         try:
-            # Read from TUN (raw IP packet)
-            ip_packet = self.tun.read(MAX_FRAME_SIZE)
-            
-            if not ip_packet:
-                return True
-            
-            ip_len = len(ip_packet)
-            
-            # Log packet info with protocol names
-            src_ip = "?"
-            dst_ip = "?"
-            protocol = "?"
-            proto_name = "?"
-            if ip_len >= 20:  # Minimum IP header
+            # Each frame is [sync+len][Dest MAC][Src MAC][EtherType][IP Packet][CRC]
+            parts = []
+            tun_fd = self.tun.fileno()
+            while len(parts) < TX_IOV_MAX:
+                # The TUN fd is non-blocking: read until the queue is empty
                 try:
-                    version = (ip_packet[0] >> 4) & 0xF
-                    if version == 4:
-                        src_ip = ".".join(str(b) for b in ip_packet[12:16])
-                        dst_ip = ".".join(str(b) for b in ip_packet[16:20])
-                        protocol = ip_packet[9]
-                        # Map protocol numbers to names
-                        proto_map = {1: "ICMP", 6: "TCP", 17: "UDP"}
-                        proto_name = proto_map.get(protocol, f"Proto{protocol}")
-                except:
-                    pass
-            
-            logger.info(f"TUN→Serial: {ip_len} bytes IP, {proto_name} (proto={protocol}), {src_ip}→{dst_ip}")
-            
-            # Build Ethernet frame: [Dest MAC][Src MAC][EtherType][IP Packet]
-            eth_header = ESP32_MAC + HOST_MAC + struct.pack('>H', ETH_TYPE_IP)
-            eth_frame = eth_header + ip_packet
-            frame_len = len(eth_frame)
-            
-            logger.info(f"TUN→Serial: Added Ethernet header, total {frame_len} bytes")
-            
-            # Send length header (big-endian)
-            len_data = struct.pack('>H', frame_len)
-            self.serial_sock.sendall(len_data)
-            
-            # Send Ethernet frame
-            self.serial_sock.sendall(eth_frame)
+                    ip_packet = os.read(tun_fd, MAX_FRAME_SIZE)
+                except BlockingIOError:
+                    break
+                if not ip_packet:
+                    break
+
+                if logger.isEnabledFor(logging.DEBUG):
+                    logger.debug(f"TUN→Serial: {len(ip_packet)} bytes IP, {describe_packet(ip_packet)}")
+                parts.extend(frame_parts(self.eth_header, ip_packet))
+                self.stats['tx_frames'] += 1
+                self.stats['tx_bytes'] += ETH_HEADER_SIZE + len(ip_packet)
+
+            if parts:
+                self.send_parts(parts)
+                self.stats['tx_batches'] += 1
             
             return True
             
@@ -289,6 +373,14 @@ class SerialTunBridge:
             logger.error(f"Error in tun_to_serial: {e}")
             return False
 
+    def send_parts(self, parts):
+        """Send a list of buffers, normally with a single sendmsg() call"""
+        sent = self.serial_sock.sendmsg(parts)
+        total = sum(len(part) for part in parts)
+        if sent < total:
+            # Socket buffer full: fall back to a blocking send of the rest
+            self.serial_sock.sendall(b''.join(parts)[sent:])
+
     def cleanup(self):
         """Cleanup resources"""
         logger.info("Cleaning up...")
@@ -305,7 +397,6 @@ class SerialTunBridge:
                 self.tun.close()
             else:
                 self.tun.close()
-                import subprocess
                 subprocess.call(['ip', 'tuntap', 'del', 'dev', TUN_NAME, 'mode', 'tun'])
             self.tun = None
 
@@ -319,6 +410,7 @@ class SerialTunBridge:
         if not self.create_tun_device():
             logger.error("Failed to create TUN device")
             return 1
+        os.set_blocking(self.tun.fileno(), False)
         
         self.running = True
         
@@ -326,14 +418,16 @@ class SerialTunBridge:
         while self.running:
             # Connect (or reconnect) to serial
             self.serial_sock = self.connect_to_serial()
+            self.rx_buffer = bytearray()  # Drop partial frame from the old connection
             if not self.serial_sock:
-                logger.error("Failed to connect to serial, retrying...")
-                import time
-                time.sleep(2)
+                if self.running:
+                    logger.error("Failed to connect to serial, retrying...")
+                    time.sleep(2)
                 continue
             
             logger.info("Bridge active. Press Ctrl+C to stop.")
             logger.info(f"ESP32 should be accessible at {ESP32_IP}")
+            self.connected.set()
             
             # Bridge loop for this connection
             while self.running:
@@ -341,6 +435,7 @@ class SerialTunBridge:
                 rlist = [self.serial_sock, self.tun]
                 readable, _, _ = select.select(rlist, [], [], 1.0)
                 
+                busy_start = time.perf_counter()
                 for r in readable:
                     if r == self.serial_sock:
                         if not self.serial_to_tun():
@@ -358,13 +453,200 @@ class SerialTunBridge:
                             self.running = False
                             break
                 
+                if readable:
+                    self.stats['busy_s'] += time.perf_counter() - busy_start
+
                 # If serial_sock is None, break inner loop to reconnect
                 if self.serial_sock is None:
+                    self.connected.clear()
                     break
         
         self.cleanup()
         return 0
 
+# Self-test: throughput/latency over the tunnel and where the limit is
+HEALTH_PATH = '/api/system/health'
+BULK_PATH = '/js/app.js'        # Largest static asset, served without request processing
+FRAME_OVERHEAD = FRAME_HEADER_SIZE + FRAME_CRC_SIZE
+BUSY_LIMIT = 0.7                # Bridge busy fraction at which the host is the limit
+LINE_LIMIT = 0.7                # Share of the nominal line rate at which the UART is the limit
+ESP_TX_LATENCY_LIMIT_US = 5000  # ESP32 linkoutput() time at which its TX ring is the limit
+
+
+def parse_ping(output):
+    """Packet counts and round-trip times from ping's summary lines"""
+    result = {}
+    counts = re.search(r'(\d+) packets transmitted, (\d+) received', output)
+    if counts:
+        result['sent'] = int(counts.group(1))
+        result['received'] = int(counts.group(2))
+        result['loss_pct'] = 100.0 * (result['sent'] - result['received']) / max(result['sent'], 1)
+    rtt = re.search(r'= ([\d.]+)/([\d.]+)/([\d.]+)/([\d.]+) ms', output)
+    if rtt:
+        result['rtt_min_ms'] = float(rtt.group(1))
+        result['rtt_avg_ms'] = float(rtt.group(2))
+        result['rtt_max_ms'] = float(rtt.group(3))
+    return result
+
+
+def tunnel_drops(tunnel):
+    """Frames the ESP32 side lost, by reason"""
+    drops = dict(tunnel.get('rx_dropped', {}))
+    drops.update({f'tx_{key}': value for key, value in tunnel.get('tx_dropped', {}).items()})
+    drops['uart_overruns'] = tunnel.get('uart_overruns', 0)
+    return drops
+
+
+class SelfTest:
+    """Drives traffic through a running bridge and reports the bottleneck"""
+
+    def __init__(self, bridge, duration, baud):
+        self.bridge = bridge
+        self.duration = duration
+        self.line_rate = baud / 10.0    # Bytes per second, 8N1
+        self.exit_code = 1
+
+    def run_and_stop(self):
+        try:
+            self.exit_code = self.run()
+        except Exception as e:
+            logger.error(f"Self-test failed: {e}")
+        finally:
+            self.bridge.running = False
+
+    def fetch_tunnel_stats(self):
+        conn = http.client.HTTPConnection(ESP32_IP, 80, timeout=10)
+        try:
+            conn.request('GET', HEALTH_PATH)
+            response = conn.getresponse()
+            body = response.read()
+            if response.status != 200:
+                raise RuntimeError(f"{HEALTH_PATH} returned {response.status}")
+            return json.loads(body).get('tunnel', {})
+        finally:
+            conn.close()
+
+    def wait_for_esp32(self, timeout=60):
+        if not self.bridge.connected.wait(timeout):
+            raise RuntimeError("QEMU UART not connected")
+        deadline = time.monotonic() + timeout
+        while True:
+            try:
+                return self.fetch_tunnel_stats()
+            except (OSError, RuntimeError, ValueError):
+                if time.monotonic() > deadline:
+                    raise RuntimeError(f"ESP32 not reachable at {ESP32_IP}")
+                time.sleep(1)
+
+    def ping(self, *args):
+        command = ['ping', '-q', '-n', *args, ESP32_IP]
+        completed = subprocess.run(command, capture_output=True, text=True,
+                                   timeout=self.duration + 30)
+        return parse_ping(completed.stdout)
+
+    def bulk_download(self):
+        """Repeated GETs of a static asset over one keep-alive connection"""
+        total = 0
+        requests = 0
+        errors = 0
+        conn = http.client.HTTPConnection(ESP32_IP, 80, timeout=10)
+        start = time.perf_counter()
+        deadline = start + self.duration
+        while time.perf_counter() < deadline:
+            try:
+                conn.request('GET', BULK_PATH)
+                response = conn.getresponse()
+                total += len(response.read())
+                requests += 1
+                if response.will_close:
+                    conn.close()
+            except (OSError, http.client.HTTPException):
+                errors += 1
+                conn.close()
+        conn.close()
+        elapsed = time.perf_counter() - start
+        return {'bytes': total, 'requests': requests, 'errors': errors,
+                'kbytes_per_s': total / elapsed / 1000.0}
+
+    def measure(self, name, fn):
+        """Run one phase and collect host and ESP32 counters around it"""
+        tunnel_before = self.fetch_tunnel_stats()
+        bridge_before = dict(self.bridge.stats)
+        start = time.perf_counter()
+        result = fn()
+        elapsed = time.perf_counter() - start
+        bridge = {key: self.bridge.stats[key] - bridge_before[key] for key in bridge_before}
+        tunnel_after = self.fetch_tunnel_stats()
+
+        drops_before = tunnel_drops(tunnel_before)
+        drops = {key: value - drops_before.get(key, 0)
+                 for key, value in tunnel_drops(tunnel_after).items()}
+
+        # Average ESP32 TX time of the frames sent during the phase
+        tx_frames = tunnel_after.get('tx_frames', 0) - tunnel_before.get('tx_frames', 0)
+        tx_total_us = (tunnel_after.get('tx_latency', {}).get('avg_us', 0) * tunnel_after.get('tx_frames', 0) -
+                       tunnel_before.get('tx_latency', {}).get('avg_us', 0) * tunnel_before.get('tx_frames', 0))
+
+        to_esp32 = bridge['tx_bytes'] + FRAME_OVERHEAD * bridge['tx_frames']
+        from_esp32 = bridge['rx_bytes'] + FRAME_OVERHEAD * bridge['rx_frames']
+        result.update({
+            'name': name,
+            'seconds': elapsed,
+            'bridge_busy': bridge['busy_s'] / elapsed,
+            'line_use': max(to_esp32, from_esp32) / elapsed / self.line_rate,
+            'frames_per_write': bridge['tx_frames'] / max(bridge['tx_batches'], 1),
+            'frames_per_read': bridge['rx_frames'] / max(bridge['rx_bursts'], 1),
+            'host_framing_errors': bridge['crc_errors'] + bridge['sync_errors'],
+            'esp32_drops': {key: value for key, value in drops.items() if value > 0},
+            'esp32_tx_latency_us': tx_total_us / tx_frames if tx_frames > 0 else 0,
+        })
+        result['bottleneck'] = self.bottleneck(result)
+        return result
+
+    @staticmethod
+    def bottleneck(result):
+        if result['bridge_busy'] >= BUSY_LIMIT:
+            return f"host: bridge busy {result['bridge_busy']:.0%} of the time"
+        if result['esp32_drops']:
+            reasons = ', '.join(f'{key}={value}' for key, value in result['esp32_drops'].items())
+            return f"ESP32: tunnel dropped frames ({reasons})"
+        if result['line_use'] >= LINE_LIMIT:
+            return f"UART line: {result['line_use']:.0%} of the nominal rate"
+        if result['esp32_tx_latency_us'] >= ESP_TX_LATENCY_LIMIT_US:
+            return f"ESP32: UART TX ring full ({result['esp32_tx_latency_us']:.0f} us per frame)"
+        # Neither the bridge nor the line is saturated and nothing was dropped
+        return (f"ESP32 processing (lwIP/application): line {result['line_use']:.0%} used, "
+                f"bridge {result['bridge_busy']:.0%} busy")
+
+    def run(self):
+        logger.info("Self-test: waiting for the ESP32...")
+        self.wait_for_esp32()
+
+        latency = self.ping('-c', '20', '-i', '0.05', '-s', '56')
+        phases = [
+            self.measure('ping flood', lambda: self.ping('-f', '-w', str(self.duration), '-s', '1400')),
+            self.measure('bulk TCP', self.bulk_download),
+        ]
+
+        print("\nTunnel self-test")
+        print(f"  latency:     rtt avg {latency.get('rtt_avg_ms', float('nan')):.2f} ms, "
+              f"max {latency.get('rtt_max_ms', float('nan')):.2f} ms, "
+              f"loss {latency.get('loss_pct', 100):.0f}%")
+        for phase in phases:
+            if 'kbytes_per_s' in phase:
+                summary = (f"{phase['kbytes_per_s']:.1f} KB/s, {phase['requests']} requests, "
+                           f"{phase['errors']} errors")
+            else:
+                summary = (f"{phase.get('received', 0)}/{phase.get('sent', 0)} replies, "
+                           f"rtt avg {phase.get('rtt_avg_ms', float('nan')):.2f} ms")
+            print(f"  {phase['name'] + ':':12} {summary}")
+            print(f"  {'':12} line {phase['line_use']:.0%}, bridge busy {phase['bridge_busy']:.0%}, "
+                  f"{phase['frames_per_write']:.1f} frames/write, {phase['frames_per_read']:.1f} frames/read, "
+                  f"ESP32 TX {phase['esp32_tx_latency_us']:.0f} us/frame")
+            print(f"  {'':12} bottleneck: {phase['bottleneck']}")
+        return 0
+
+
 def main():
     # Parse command line arguments
     parser = argparse.ArgumentParser(
@@ -382,6 +664,23 @@ def main():
         default=SERIAL_PORT,
         help=f'QEMU UART TCP port (default: {SERIAL_PORT})'
     )
+    parser.add_argument(
+        '--self-test',
+        action='store_true',
+        help='Run a latency/throughput test through the bridge, report the bottleneck and exit'
+    )
+    parser.add_argument(
+        '--duration',
+        type=int,
+        default=10,
+        help='Seconds per self-test phase (default: 10)'
+    )
+    parser.add_argument(
+        '--baud',
+        type=int,
+        default=921600,
+        help='UART tunnel baud rate for line utilization (CONFIG_UART_TUNNEL_BAUD_RATE, default: 921600)'
+    )
     args = parser.parse_args()
     
     # Configure logging based on quiet mode
@@ -416,8 +715,14 @@ def main():
         print(f"ESP32 IP: {ESP32_IP}")
         print("Press Ctrl+C to stop\n")
     
-    bridge = SerialTunBridge()
-    return bridge.run()
+    bridge = SerialTunBridge(args.port)
+    if not args.self_test:
+        return bridge.run()
+
+    self_test = SelfTest(bridge, args.duration, args.baud)
+    threading.Thread(target=self_test.run_and_stop, daemon=True).start()
+    ret = bridge.run()
+    return ret or self_test.exit_code
 
 if __name__ == '__main__':
     sys.exit(main())
@@ -1,42 +1,294 @@
 #!/usr/bin/env python3
 """
-Test script to verify cryptography library availability in ESP-IDF environment
+Crypto checks and TLS handshake benchmark for the ESP32 HTTPS server
+
+Commands:
+    check      Verify the cryptography library needed by generate_cert.py
+               is available (default when no command is given)
+    local      Time host-side signing with RSA-2048 and ECDSA P-256, the
+               operation that dominates a full handshake on the device
+    handshake  Measure full and resumed TLS handshakes against a device
+    compare    Compare saved handshake results, e.g. an RSA and an ECDSA build
+
+The device serves one certificate per build (CONFIG_WEB_SERVER_HTTPS_KEY_TYPE).
+To compare key types, benchmark each build and save the results:
+
+    python tools/test_crypto.py handshake --host 192.168.4.1 --save rsa.json
+    python tools/test_crypto.py handshake --host 192.168.4.1 --save ecdsa.json
+    python tools/test_crypto.py compare rsa.json ecdsa.json
+
+The handshake benchmark only needs the Python standard library.
 """
 
-print("Testing cryptography library availability...")
-
-try:
-    from cryptography import x509
-    from cryptography.x509.oid import NameOID
-    from cryptography.hazmat.primitives import hashes, serialization
-    from cryptography.hazmat.primitives.asymmetric import rsa
-    from ipaddress import IPv4Address
-    import datetime
-    
-    print("✅ All cryptography modules imported successfully!")
-    print("✅ IPv4Address imported successfully!")
-    print("✅ datetime imported successfully!")
-    
-    # Test basic functionality
-    print("\nTesting basic RSA key generation...")
-    private_key = rsa.generate_private_key(
-        public_exponent=65537,
-        key_size=2048,
-    )
-    print("✅ RSA key generation works!")
-    
-    print("\nTesting certificate builder...")
-    subject = x509.Name([
-        x509.NameAttribute(NameOID.COMMON_NAME, "Test-ESP32"),
-    ])
-    print("✅ Certificate builder works!")
-    
-    print("\n🎉 All tests passed! Certificate generation should work.")
-    
-except ImportError as e:
-    print(f"❌ Import error: {e}")
-    print("Missing cryptography library - would need to install with:")
-    print("pip install cryptography")
-    
-except Exception as e:
-    print(f"❌ Unexpected error: {e}")
\ No newline at end of file
+import argparse
+import json
+import socket
+import ssl
+import statistics
+import sys
+import time
+
+# DER encoded OIDs of the subject public key algorithm
+OID_RSA_ENCRYPTION = bytes.fromhex('06092a864886f70d010101')
+OID_EC_PUBLIC_KEY = bytes.fromhex('06072a8648ce3d0201')
+
+
+def check_library():
+    """Check that certificate generation with the cryptography library works"""
+    print("Testing cryptography library availability...")
+
+    try:
+        from cryptography import x509
+        from cryptography.x509.oid import NameOID
+        from cryptography.hazmat.primitives import hashes, serialization  # noqa: F401
+        from cryptography.hazmat.primitives.asymmetric import ec, rsa
+        from ipaddress import IPv4Address  # noqa: F401
+        import datetime  # noqa: F401
+
+        print("✅ All cryptography modules imported successfully!")
+        print("✅ IPv4Address imported successfully!")
+        print("✅ datetime imported successfully!")
+
+        # Test basic functionality
+        print("\nTesting basic RSA key generation...")
+        rsa.generate_private_key(
+            public_exponent=65537,
+            key_size=2048,
+        )
+        print("✅ RSA key generation works!")
+
+        print("\nTesting ECDSA P-256 key generation...")
+        ec.generate_private_key(ec.SECP256R1())
+        print("✅ ECDSA key generation works!")
+
+        print("\nTesting certificate builder...")
+        x509.Name([
+            x509.NameAttribute(NameOID.COMMON_NAME, "Test-ESP32"),
+        ])
+        print("✅ Certificate builder works!")
+
+        print("\n🎉 All tests passed! Certificate generation should work.")
+        return 0
+
+    except ImportError as e:
+        print(f"❌ Import error: {e}")
+        print("Missing cryptography library - would need to install with:")
+        print("pip install cryptography")
+        return 1
+
+    except Exception as e:
+        print(f"❌ Unexpected error: {e}")
+        return 1
+
+
+def summarize(samples_ms):
+    """Return min/median/mean/max of a list of durations in milliseconds"""
+    if not samples_ms:
+        return None
+    return {
+        'count': len(samples_ms),
+        'min': min(samples_ms),
+        'median': statistics.median(samples_ms),
+        'mean': statistics.mean(samples_ms),
+        'max': max(samples_ms),
+    }
+
+
+def format_summary(summary):
+    """Format a summary produced by summarize() for printing"""
+    if summary is None:
+        return "no samples"
+    return (f"median {summary['median']:8.1f} ms  mean {summary['mean']:8.1f} ms  "
+            f"min {summary['min']:8.1f} ms  max {summary['max']:8.1f} ms  (n={summary['count']})")
+
+
+def local_benchmark(args):
+    """Time RSA-2048 and ECDSA P-256 signatures on the host"""
+    try:
+        from cryptography.hazmat.primitives import hashes
+        from cryptography.hazmat.primitives.asymmetric import ec, padding, rsa
+    except ImportError as e:
+        print(f"❌ Import error: {e}")
+        print("pip install cryptography")
+        return 1
+
+    message = b'\x00' * 64
+    keys = {
+        'RSA-2048': (rsa.generate_private_key(public_exponent=65537, key_size=2048),
+                     lambda key: key.sign(message, padding.PKCS1v15(), hashes.SHA256())),
+        'ECDSA P-256': (ec.generate_private_key(ec.SECP256R1()),
+                        lambda key: key.sign(message, ec.ECDSA(hashes.SHA256()))),
+    }
+
+    print(f"Host signing benchmark ({args.count} signatures each)")
+    print("The device is far slower in absolute terms; the ratio is what carries over.\n")
+    results = {}
+    for name, (key, sign) in keys.items():
+        samples = []
+        for _ in range(args.count):
+            start = time.perf_counter()
+            sign(key)
+            samples.append((time.perf_counter() - start) * 1000.0)
+        results[name] = summarize(samples)
+        print(f"  {name:12} {format_summary(results[name])}")
+
+    ratio = results['RSA-2048']['median'] / results['ECDSA P-256']['median']
+    print(f"\nRSA-2048 / ECDSA P-256 signing time: {ratio:.1f}x")
+    return 0
+
+
+def peer_key_type(der_cert):
+    """Identify the public key algorithm of a DER certificate"""
+    if OID_EC_PUBLIC_KEY in der_cert:
+        return 'ECDSA'
+    if OID_RSA_ENCRYPTION in der_cert:
+        return 'RSA'
+    return 'unknown'
+
+
+def make_context(args):
+    """Client TLS context for the device's self-signed certificate"""
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    context.check_hostname = False
+    context.verify_mode = ssl.CERT_NONE
+    # The device speaks TLS 1.2; with 1.3 ticket resumption is asynchronous
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    if args.ciphers:
+        context.set_ciphers(args.ciphers)
+    return context
+
+
+def timed_handshake(context, args, session=None):
+    """Open a connection and time the TLS handshake alone
+
+    Returns (duration_ms, ssl_socket). The caller closes the socket.
+    """
+    raw = socket.create_connection((args.host, args.port), timeout=args.timeout)
+    tls = context.wrap_socket(raw, server_hostname=args.host, session=session,
+                              do_handshake_on_connect=False)
+    start = time.perf_counter()
+    tls.do_handshake()
+    return (time.perf_counter() - start) * 1000.0, tls
+
+
+def handshake_benchmark(args):
+    """Measure full and resumed handshakes against a device"""
+    context = make_context(args)
+    full_ms = []
+    resumed_ms = []
+    not_resumed = 0
+    result = {'host': args.host, 'port': args.port}
+
+    print(f"Benchmarking TLS handshakes with {args.host}:{args.port} ({args.count} rounds)\n")
+    try:
+        for i in range(args.count):
+            # Full handshake on a fresh connection without a session
+            duration, tls = timed_handshake(context, args)
+            full_ms.append(duration)
+            if i == 0:
+                result['key_type'] = peer_key_type(tls.getpeercert(binary_form=True))
+                result['cipher'] = tls.cipher()[0]
+                result['tls_version'] = tls.version()
+                print(f"  Server key: {result['key_type']}, cipher {result['cipher']} ({result['tls_version']})")
+
+            # Resumption requires a complete request/response exchange first on some stacks
+            if args.request:
+                tls.sendall(f"GET {args.request} HTTP/1.1\r\nHost: {args.host}\r\n\r\n".encode())
+                tls.recv(1024)
+            session = tls.session
+            tls.close()
+
+            # Abbreviated handshake offering the session just established
+            duration, tls = timed_handshake(context, args, session=session)
+            if tls.session_reused:
+                resumed_ms.append(duration)
+            else:
+                not_resumed += 1
+            tls.close()
+
+            if args.delay:
+                time.sleep(args.delay)
+    except (OSError, ssl.SSLError) as e:
+        print(f"❌ Handshake failed: {e}")
+        if not full_ms:
+            return 1
+
+    result['full_ms'] = full_ms
+    result['resumed_ms'] = resumed_ms
+    result['not_resumed'] = not_resumed
+
+    print(f"  Full handshake:    {format_summary(summarize(full_ms))}")
+    print(f"  Resumed handshake: {format_summary(summarize(resumed_ms))}")
+    if not_resumed:
+        print(f"  ⚠️  {not_resumed} resumption attempts fell back to a full handshake"
+              " (CONFIG_WEB_SERVER_HTTPS_SESSION_TICKETS disabled?)")
+    if full_ms and resumed_ms:
+        speedup = statistics.median(full_ms) / statistics.median(resumed_ms)
+        print(f"  Resumption speedup: {speedup:.1f}x")
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            json.dump(result, f, indent=2)
+        print(f"\nResults saved to {args.save}")
+    return 0
+
+
+def compare_results(args):
+    """Print saved handshake results side by side"""
+    runs = []
+    for path in args.results:
+        with open(path) as f:
+            runs.append((path, json.load(f)))
+
+    print("Handshake comparison (median)\n")
+    print(f"  {'Run':24} {'Key':8} {'Full ms':>10} {'Resumed ms':>11}  Cipher")
+    for path, run in runs:
+        full = summarize(run.get('full_ms', []))
+        resumed = summarize(run.get('resumed_ms', []))
+        print(f"  {path:24} {run.get('key_type', '?'):8} "
+              f"{full['median'] if full else float('nan'):10.1f} "
+              f"{resumed['median'] if resumed else float('nan'):11.1f}  {run.get('cipher', '?')}")
+
+    by_key = {run.get('key_type'): summarize(run.get('full_ms', [])) for _, run in runs}
+    if by_key.get('RSA') and by_key.get('ECDSA'):
+        ratio = by_key['RSA']['median'] / by_key['ECDSA']['median']
+        print(f"\nFull handshake RSA / ECDSA: {ratio:.1f}x")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Crypto checks and TLS handshake benchmark')
+    subparsers = parser.add_subparsers(dest='command')
+
+    subparsers.add_parser('check', help='Check cryptography library availability')
+
+    local = subparsers.add_parser('local', help='Host-side RSA vs ECDSA signing benchmark')
+    local.add_argument('-n', '--count', type=int, default=200, help='Signatures per key type')
+
+    handshake = subparsers.add_parser('handshake', help='Benchmark TLS handshakes against a device')
+    handshake.add_argument('--host', default='192.168.4.1', help='Device address (default: 192.168.4.1)')
+    handshake.add_argument('--port', type=int, default=443, help='HTTPS port (default: 443)')
+    handshake.add_argument('-n', '--count', type=int, default=10, help='Full + resumed handshake rounds')
+    handshake.add_argument('--timeout', type=float, default=10.0, help='Socket timeout in seconds')
+    handshake.add_argument('--delay', type=float, default=0.2,
+                           help='Pause between rounds so the device can free sockets')
+    handshake.add_argument('--ciphers', help='OpenSSL cipher string to offer')
+    handshake.add_argument('--request', default='/status',
+                           help='Request sent before resuming, empty to skip')
+    handshake.add_argument('--save', help='Write results as JSON for the compare command')
+
+    compare = subparsers.add_parser('compare', help='Compare saved handshake results')
+    compare.add_argument('results', nargs='+', help='JSON files written by handshake --save')
+
+    args = parser.parse_args()
+    if args.command == 'local':
+        return local_benchmark(args)
+    if args.command == 'handshake':
+        return handshake_benchmark(args)
+    if args.command == 'compare':
+        return compare_results(args)
+    return check_library()
+
+
+if __name__ == '__main__':
+    sys.exit(main())
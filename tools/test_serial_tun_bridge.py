@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""
+Host tests for the v2 tunnel framing in serial_tun_bridge.py
+
+Runs without root, QEMU or a TUN device:
+
+    python3 tools/test_serial_tun_bridge.py
+"""
+
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import serial_tun_bridge as bridge  # noqa: E402
+
+ETH_HEADER = bridge.ESP32_MAC + bridge.HOST_MAC + b'\x08\x00'
+
+
+def encode(ip_packet):
+    return b''.join(bridge.frame_parts(ETH_HEADER, ip_packet))
+
+
+def packet_with_crc_tail(tail):
+    """IP-like payload whose frame CRC ends in the given byte"""
+    for i in range(65536):
+        packet = b'\x45' + i.to_bytes(2, 'big') + bytes(40)
+        if encode(packet)[-1] == tail:
+            return packet
+    raise AssertionError(f"no payload with CRC ending in {tail:#04x}")
+
+
+class DecodeFramesTest(unittest.TestCase):
+    def decode(self, buffer):
+        stats = bridge.new_bridge_stats()
+        frames = bridge.decode_frames(buffer, stats)
+        return frames, stats
+
+    def test_round_trip(self):
+        packet = bytes(range(256)) * 4
+        buffer = bytearray(encode(packet) * 3)
+        frames, stats = self.decode(buffer)
+        self.assertEqual(frames, [ETH_HEADER + packet] * 3)
+        self.assertEqual(buffer, bytearray())
+        self.assertEqual(stats['sync_errors'], 0)
+        self.assertEqual(stats['crc_errors'], 0)
+
+    def test_crc_ending_in_sync_byte(self):
+        # The last CRC byte equals the first sync byte; it must not be kept
+        # as the start of the next frame
+        first = packet_with_crc_tail(bridge.FRAME_SYNC[0])
+        second = bytes(60)
+        buffer = bytearray(encode(first))
+        frames, stats = self.decode(buffer)
+        self.assertEqual(frames, [ETH_HEADER + first])
+        self.assertEqual(buffer, bytearray())
+        self.assertEqual(stats['sync_errors'], 0)
+
+        buffer += encode(second)
+        frames, stats = self.decode(buffer)
+        self.assertEqual(frames, [ETH_HEADER + second])
+        self.assertEqual(stats['sync_errors'], 0)
+
+    def test_partial_frame_is_kept(self):
+        frame = encode(bytes(100))
+        buffer = bytearray(frame[:50])
+        frames, _ = self.decode(buffer)
+        self.assertEqual(frames, [])
+        buffer += frame[50:]
+        frames, _ = self.decode(buffer)
+        self.assertEqual(frames, [ETH_HEADER + bytes(100)])
+
+    def test_trailing_sync_byte_after_noise_is_kept(self):
+        buffer = bytearray(b'\x00\x11' + bridge.FRAME_SYNC[:1])
+        frames, stats = self.decode(buffer)
+        self.assertEqual(frames, [])
+        self.assertEqual(buffer, bytearray(bridge.FRAME_SYNC[:1]))
+        self.assertEqual(stats['sync_errors'], 2)
+
+    def test_resync_after_corrupt_frame(self):
+        good = encode(bytes(80))
+        corrupt = bytearray(good)
+        corrupt[10] ^= 0xFF
+        buffer = bytearray(b'\x42' + bytes(corrupt) + good)
+        frames, stats = self.decode(buffer)
+        self.assertEqual(frames, [ETH_HEADER + bytes(80)])
+        self.assertEqual(stats['crc_errors'], 1)
+
+
+if __name__ == '__main__':
+    unittest.main()